@@ -2,13 +2,19 @@
 Read a ctout output file from randoutbreaksim.
 
 Load timeline information from a ctout output file.
+If the file is a manifest of sharded outputs, the entries of the shards are concatenated in the order they are listed.
+Individual paths can be read through the entries of the index sidecar file of a ctout file (see output_index.py) using read_indexed.
 Entry format is time of positive test time (in minutes), pre-symptomatic period duration(in minutes), child's ID, parent ID (negative if child's infectious period is not interrupted through CT), and the number of traced contacts.
 
 """
 
 import numpy as np
+import manifest_read
 
 def read(filename):
+    return np.concatenate([read_file(shard) for shard in manifest_read.shards(filename)])
+
+def read_file(filename):
     entrytype=np.dtype('<i4, <i4, <i4, <i4, <u4')
 
     f = open(filename, 'rb')
@@ -18,3 +24,11 @@ def read(filename):
     f.close()
 
     return entries
+
+def read_indexed(filename, entries):
+    """Return a list containing the entries of the ctout file filename (not a manifest) for each path described by the provided index entries."""
+    entrytype=np.dtype('<i4, <i4, <i4, <i4, <u4')
+
+    data = np.memmap(filename, dtype=entrytype, mode='r')
+
+    return [np.array(data[e['offset']//20:e['offset']//20+e['count']]) for e in entries]
@@ -0,0 +1,29 @@
+"""@package manifest_read
+Read a manifest of sharded output files from randoutbreaksim.
+
+A manifest is written in place of a tlout or ctout output file when the outputs are sharded.
+It lists the shard files, each of them being a complete output file in the regular format.
+"""
+
+import os
+
+MANIFEST_MAGIC = b'randoutbreaksim manifest 1'
+
+def is_manifest(filename):
+    with open(filename, 'rb') as f:
+        return f.read(len(MANIFEST_MAGIC)) == MANIFEST_MAGIC
+
+def shards(filename):
+    """Return the list of files to read for filename: the shard files if filename is a manifest, or filename itself otherwise."""
+
+    if(not is_manifest(filename)):
+        return [filename]
+
+    dirname = os.path.dirname(filename)
+
+    with open(filename, 'r') as f:
+        lines = f.read().splitlines()
+
+    nshards = int(next(l for l in lines if l.startswith('nshards ')).split()[1])
+    start = lines.index('nshards %i' % nshards) + 1
+    return [os.path.join(dirname, l.split(' ', 1)[1]) for l in lines[start:start+nshards]]
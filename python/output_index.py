@@ -0,0 +1,30 @@
+"""@package output_index
+Read the path index sidecar file of a tlout, ctout or treeout output file from randoutbreaksim.
+
+The index of an output file is named after the file followed by '.idx'. It contains one entry per path record, sorted by offset.
+Entry fields are the byte offset of the record in the output file, the path index, the record size in bytes, the number of time bins (tlout), of entries (ctout) or of nodes (treeout) in the record, and flags.
+"""
+
+import numpy as np
+
+EXTINCT = 1
+MAXEDOUT = 2
+
+TLOUT = 0
+CTOUT = 1
+TREEOUT = 2
+
+entrytype = np.dtype([('offset', '<u8'), ('path', '<u8'), ('size', '<u4'), ('count', '<u4'), ('flags', '<u4')])
+
+def read(filename):
+    """Return the output kind and the index entries of the output file filename."""
+    f = open(filename+'.idx', 'rb')
+
+    if(f.read(8) != b'ROSINDEX'):
+        f.close()
+        raise ValueError(filename+'.idx is not an index file')
+    version, kind = np.fromfile(f, dtype='<u4', count=2)
+    entries = np.fromfile(f, dtype=entrytype)
+    f.close()
+
+    return kind, entries
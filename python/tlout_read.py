@@ -2,20 +2,140 @@
 Read a tlout output file from randoutbreaksim.
 
 Load timeline information from a tlout output file, and call a callback function for each path.
+If the file is a manifest of sharded outputs, the shards are read in the order they are listed.
+Files with encoded records (bit 5 of the header flags) are decoded transparently.
+Files that only contain the paths selected by the output selection options (bit 6 of the header flags) have a header that ends with the number of skipped paths, which is returned by skipped_paths.
+Individual paths can be read through the entries of the index sidecar file of a tlout file (see output_index.py) using read_indexed.
 
 Callback function: First argument contains the timelines for the current path, the second argument the index of the bin corresponding to t=0, the third argument is the time where the path maxes out an nimax or npostestmax limit, and the fourth is time time where the path goes extinct.
 The first argument can contain two or three timelines, depending on the output file. The first timeline is the number of currently infected individuals, the second timeline is the number of new infections, and the third timeline is the number of new positive tests.
 """
 
 import numpy as np
+import manifest_read
 
 def read(filename, callback):
+    for shard in manifest_read.shards(filename):
+        read_file(shard, callback)
+
+def skipped_paths(filename):
+    """Return the number of simulated paths that are not written to a tlout file or to the shards of a manifest."""
+    nskipped = 0
+
+    for shard in manifest_read.shards(filename):
+        header = np.fromfile(shard, dtype=np.uint8, count=13)
+
+        if(header[4]&64):
+            nskipped += int(header[5:13].view('<u8')[0])
+
+    return nskipped
+
+def _get_varint(data, pos):
+    value = 0
+    shift = 0
+
+    while True:
+        byte = int(data[pos])
+        pos += 1
+        value |= (byte&0x7F)<<shift
+
+        if(not(byte&0x80)):
+            return value, pos
+        shift += 7
+
+def _unzigzag(u):
+    return (u>>1)^-(u&1)
+
+def _decode_timeline(data, pos, nbins):
+    tl = np.empty(nbins, dtype=np.uint32)
+    prev = 0
+    b = 0
+
+    while(b<nbins):
+        token, pos = _get_varint(data, pos)
+
+        if(token&1):
+            run = (token>>1)+1
+            tl[b:b+run] = prev
+            b += run
+
+        else:
+            prev = (prev+_unzigzag(token>>1))&0xFFFFFFFF
+            tl[b] = prev
+            b += 1
+
+    return tl, pos
+
+def _decode_raw(data, pos, hbf):
+    hasreltime = not((hbf&7)==1)
+    ntimelines = (3 if hbf&8 else 2)*(2 if hbf&16 else 1)
+
+    if(hasreltime):
+        nbins, t0index, maxed_out_time, extinction_time = np.frombuffer(data, dtype='<u4, <u4, <i4, <i4', count=1, offset=pos)[0]
+        pos += 16
+
+    else:
+        nbins, maxed_out_time, extinction_time = np.frombuffer(data, dtype='<u4, <i4, <i4', count=1, offset=pos)[0]
+        t0index = 0
+        pos += 12
+
+    return np.array_split(np.frombuffer(data, dtype='<u4', count=ntimelines*nbins, offset=pos), ntimelines), t0index, maxed_out_time, extinction_time, pos+4*ntimelines*nbins
+
+def _decode_encoded(data, pos, hbf):
+    hasreltime = not((hbf&7)==1)
+    ntimelines = (3 if hbf&8 else 2)*(2 if hbf&16 else 1)
+
+    nbins, pos = _get_varint(data, pos)
+
+    if(hasreltime):
+        t0index, pos = _get_varint(data, pos)
+
+    else:
+        t0index = 0
+    maxed_out_time, pos = _get_varint(data, pos)
+    extinction_time, pos = _get_varint(data, pos)
+    ret = []
+
+    for i in range(ntimelines):
+        tl, pos = _decode_timeline(data, pos, nbins)
+        ret.append(tl)
+
+    return ret, t0index, _unzigzag(maxed_out_time), _unzigzag(extinction_time), pos
+
+def _read_encoded(f, hbf, callback):
+    data = f.read()
+    pos = 0
+
+    while(pos<len(data)):
+        ret, t0index, maxed_out_time, extinction_time, pos = _decode_encoded(data, pos, hbf)
+        callback(ret, t0index, maxed_out_time, extinction_time)
+
+def read_indexed(filename, entries, callback):
+    """Call callback for the paths of the tlout file filename (not a manifest) described by the provided index entries."""
+    data = np.memmap(filename, dtype=np.uint8, mode='r')
+    hbf = int(data[4])
+    decode = (_decode_encoded if hbf&32 else _decode_raw)
+
+    for e in entries:
+        callback(*decode(data, int(e['offset']), hbf)[:4])
+
+    del data
+
+def read_file(filename, callback):
     headertype=np.dtype('<u4, b')
 
     f = open(filename, 'rb')
 
     npers, hbf = np.fromfile(f, dtype=headertype, count=1)[0]
 
+    if(hbf&64):
+        f.seek(8, 1)
+
+    if(hbf&32):
+        _read_encoded(f, hbf, callback)
+        f.close()
+        return
+
     hasreltime = not((hbf&7)==1)
     postestresults = ((hbf&8)==8)
     seccathegory = ((hbf&16)==16)
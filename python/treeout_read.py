@@ -0,0 +1,75 @@
+"""@package treeout_read
+Read a treeout output file from randoutbreaksim.
+
+Load transmission tree information from a treeout output file, and call a callback function for each path.
+If the file is a manifest of sharded outputs, the shards are read in the order they are listed.
+Individual paths can be read through the entries of the index sidecar file of a treeout file (see output_index.py) using read_indexed.
+
+Callback function: The only argument is a structured array containing one entry per infectious individual, in the order the individuals are created.
+Entry format is the parent index (-1 for primary individuals), generation, infection time (in minutes), end of the latent period (in minutes), end of the communicable period (in minutes), communicable period type flags, index of the parent's transmission event that generated the infection, and the number of infections generated by the individual.
+"""
+
+import numpy as np
+import manifest_read
+
+nodetype = np.dtype([('parent', '<i8'), ('generation', '<u4'), ('inftime', '<i8'), ('end_latent', '<i8'), ('end_comm', '<i8'), ('commpertype', 'u1'), ('event', '<u4'), ('ninf', '<u4')])
+
+def read(filename, callback):
+    for shard in manifest_read.shards(filename):
+        read_file(shard, callback)
+
+def _get_varints(data):
+    """Decode all the varints contained in data."""
+    ends = (data<0x80)
+    starts = np.concatenate(([0], np.flatnonzero(ends)[:-1]+1))
+    group = np.concatenate(([0], np.cumsum(ends)[:-1]))
+    shifts = 7*(np.arange(data.size)-starts[group])
+
+    return np.add.reduceat((data&0x7F).astype(np.uint64)<<shifts.astype(np.uint64), starts)
+
+def _unzigzag(u):
+    return (u>>1).astype(np.int64)^-(u&1).astype(np.int64)
+
+def _decode(payload):
+    values = _get_varints(payload)
+    n = int(values[0])
+    cols = values[1:].reshape(8, n)
+    nodes = np.empty(n, dtype=nodetype)
+    idx = np.arange(n, dtype=np.int64)
+    dist = cols[0].astype(np.int64)
+    nodes['parent'] = np.where(dist>0, idx-dist, -1)
+    nodes['generation'] = np.cumsum(_unzigzag(cols[1]))
+    dinf = _unzigzag(cols[2])
+    inftime = np.empty(n, dtype=np.int64)
+
+    #Parents precede their children
+    for i in range(n):
+        inftime[i] = dinf[i]+(inftime[i-dist[i]] if dist[i] else 0)
+    nodes['inftime'] = inftime
+    nodes['end_latent'] = inftime+cols[3].astype(np.int64)
+    nodes['end_comm'] = nodes['end_latent']+cols[4].astype(np.int64)
+    nodes['commpertype'] = cols[5]
+    nodes['event'] = cols[6]
+    nodes['ninf'] = cols[7]
+
+    return nodes
+
+def read_indexed(filename, entries, callback):
+    """Call callback for the paths of the treeout file filename (not a manifest) described by the provided index entries."""
+    data = np.memmap(filename, dtype=np.uint8, mode='r')
+
+    for e in entries:
+        offset = int(e['offset'])
+        size = int(data[offset:offset+4].view('<u4')[0])
+        callback(_decode(np.array(data[offset+4:offset+4+size])))
+
+    del data
+
+def read_file(filename, callback):
+    data = np.fromfile(filename, dtype=np.uint8)
+    pos = 0
+
+    while(pos<data.size):
+        size = int(data[pos:pos+4].view('<u4')[0])
+        callback(_decode(data[pos+4:pos+4+size]))
+        pos += 4+size
@@ -0,0 +1,9 @@
+import treeout_read as treer
+
+def callback(nodes):
+    print('Number of infectious individuals: ',len(nodes))
+
+    for n in nodes:
+        print('Parent: ',n['parent'],', generation: ',n['generation'],', infection time: ',n['inftime']/1440.,', end of latent period: ',n['end_latent']/1440.,', end of communicable period: ',n['end_comm']/1440.,', communicable period type: ',n['commpertype'],', parent event: ',n['event'],', number of infections: ',n['ninf'])
+
+treer.read('../test.tree',callback)
@@ -0,0 +1,223 @@
+/**
+ * @file abc.c
+ * @brief Approximate Bayesian computation of the sampled parameters.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "abc.h"
+
+static int abc_cmp_double(const void* a, const void* b){return (*(double const*)a>*(double const*)b)-(*(double const*)a<*(double const*)b);}
+
+int abc_read_obs(const char* filename, uint32_t** obs, uint32_t* nobs)
+{
+  FILE* f=fopen(filename,"r");
+  char* line=NULL;
+  char* ptr;
+  char* end;
+  size_t alloc=0;
+  uint32_t nalloc=0;
+  uint32_t lineno=0;
+  double v;
+
+  *obs=NULL;
+  *nobs=0;
+
+  if(!f) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in read mode\n",__func__,filename);
+    return -1;
+  }
+
+  while(getline(&line,&alloc,f)>=0) {
+    ++lineno;
+
+    if((ptr=strchr(line,'#'))) *ptr=0;
+    ptr=line+strspn(line," \t\r\n");
+
+    if(!*ptr) continue;
+    v=strtod(ptr,&end);
+
+    if(end==ptr || end[strspn(end," \t\r\n")] || !(v>=0) || v>UINT32_MAX || v!=floor(v)) {
+      fprintf(stderr,"%s: Error: Invalid count on line %u of file '%s'\n",__func__,lineno,filename);
+      free(line);
+      fclose(f);
+      free(*obs);
+      *obs=NULL;
+      return -1;
+    }
+
+    if(*nobs==nalloc) {
+      nalloc=(nalloc?2*nalloc:64);
+      *obs=(uint32_t*)realloc(*obs,nalloc*sizeof(uint32_t));
+    }
+    (*obs)[(*nobs)++]=(uint32_t)v;
+  }
+  free(line);
+  fclose(f);
+
+  if(!*nobs) {
+    fprintf(stderr,"%s: Error: Observed series file '%s' does not contain any count\n",__func__,filename);
+    return -1;
+  }
+  return 0;
+}
+
+void abc_pop_init(abc_population* pop, const uint32_t npars, const uint32_t n)
+{
+  pop->npars=npars;
+  pop->n=n;
+  pop->vals=(double*)malloc(n*npars*sizeof(double));
+  pop->dists=(double*)malloc(n*sizeof(double));
+  pop->weights=(double*)malloc(n*sizeof(double));
+  pop->cumweights=(double*)malloc(n*sizeof(double));
+  pop->sigmas=(double*)malloc(npars*sizeof(double));
+}
+
+void abc_pop_weights(abc_population* pop, abc_population const* prev, param_prior const* priors)
+{
+  const uint32_t npars=pop->npars;
+  double sum=0, kern, u, std;
+  uint32_t i, j, k;
+
+  for(i=0; i<pop->n; ++i) {
+
+    if(prev) {
+      //Normalisation constants of the kernel are identical for all the
+      //particles and cancel out
+      pop->weights[i]=0;
+
+      for(j=0; j<prev->n; ++j) {
+	kern=prev->weights[j];
+
+	for(k=0; k<npars; ++k) {
+
+	  if(prev->sigmas[k]>0) {
+	    u=(pop->vals[i*npars+k]-prev->vals[j*npars+k])/prev->sigmas[k];
+	    kern*=exp(-0.5*u*u);
+
+	  } else if(pop->vals[i*npars+k]!=prev->vals[j*npars+k]) kern=0;
+	}
+	pop->weights[i]+=kern;
+      }
+      pop->weights[i]=(pop->weights[i]>0?prior_density(priors,npars,pop->vals+i*npars)/pop->weights[i]:0);
+
+    } else pop->weights[i]=1;
+    sum+=pop->weights[i];
+  }
+
+  for(i=0; i<pop->n; ++i) {
+    pop->weights[i]=(sum>0?pop->weights[i]/sum:1./pop->n);
+    pop->cumweights[i]=(i?pop->cumweights[i-1]:0)+pop->weights[i];
+  }
+
+  for(k=0; k<npars; ++k) {
+    abc_pop_moments(pop,k,&std);
+    pop->sigmas[k]=M_SQRT2*std;
+  }
+}
+
+int abc_propose(abc_population const* pop, param_prior const* priors, const gsl_rng* r, double* vals)
+{
+  const uint32_t npars=pop->npars;
+  double const* part;
+  double u;
+  uint32_t i, k, lo, hi, mid;
+
+  for(i=0; i<ABC_MAX_PROPOSALS; ++i) {
+    u=gsl_rng_uniform(r)*pop->cumweights[pop->n-1];
+    lo=0;
+    hi=pop->n-1;
+
+    while(lo<hi) {
+      mid=(lo+hi)/2;
+
+      if(pop->cumweights[mid]>u) hi=mid;
+      else lo=mid+1;
+    }
+    part=pop->vals+lo*npars;
+
+    for(k=0; k<npars; ++k) {
+      vals[k]=part[k]+(pop->sigmas[k]>0?gsl_ran_gaussian_ziggurat(r,pop->sigmas[k]):0);
+
+      if(priors[k].step>0) vals[k]=priors[k].step*round(vals[k]/priors[k].step);
+    }
+
+    if(prior_density(priors,npars,vals)>0) return 0;
+  }
+  fprintf(stderr,"%s: Error: No proposal with a non-zero prior density was drawn after %u attempts\n",__func__,ABC_MAX_PROPOSALS);
+  return -1;
+}
+
+double abc_pop_quantile(abc_population const* pop, const double q)
+{
+  double* sorted=(double*)malloc(pop->n*sizeof(double));
+  const double pos=q*(pop->n-1);
+  const uint32_t i=(uint32_t)pos;
+  double ret;
+
+  memcpy(sorted,pop->dists,pop->n*sizeof(double));
+  qsort(sorted,pop->n,sizeof(double),abc_cmp_double);
+  ret=(i+1<pop->n?sorted[i]+(pos-i)*(sorted[i+1]-sorted[i]):sorted[i]);
+  free(sorted);
+  return ret;
+}
+
+double abc_pop_ess(abc_population const* pop)
+{
+  double sum2=0;
+  uint32_t i;
+
+  for(i=0; i<pop->n; ++i) sum2+=pop->weights[i]*pop->weights[i];
+  return 1/sum2;
+}
+
+double abc_pop_moments(abc_population const* pop, const uint32_t k, double* std)
+{
+  double mean=0, var=0, diff;
+  uint32_t i;
+
+  for(i=0; i<pop->n; ++i) mean+=pop->weights[i]*pop->vals[i*pop->npars+k];
+
+  for(i=0; i<pop->n; ++i) {
+    diff=pop->vals[i*pop->npars+k]-mean;
+    var+=pop->weights[i]*diff*diff;
+  }
+  *std=sqrt(var);
+  return mean;
+}
+
+int abc_pop_write(abc_population const* pop, param_prior const* priors, const char* filename)
+{
+  FILE* f=fopen(filename,"w");
+  uint32_t i, k;
+
+  if(!f) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in write mode\n",__func__,filename);
+    return -1;
+  }
+  fprintf(f,"particle");
+
+  for(k=0; k<pop->npars; ++k) fprintf(f,"\t%s",priors[k].par->name);
+  fprintf(f,"\tdistance\tweight\n");
+
+  for(i=0; i<pop->n; ++i) {
+    fprintf(f,"%" PRIu32,i);
+
+    for(k=0; k<pop->npars; ++k) fprintf(f,"\t%.17g",pop->vals[i*pop->npars+k]);
+    fprintf(f,"\t%.17g\t%.17g\n",pop->dists[i],pop->weights[i]);
+  }
+
+  if(fclose(f)) {
+    fprintf(stderr,"%s: Error: Cannot write file '%s'\n",__func__,filename);
+    return -1;
+  }
+  return 0;
+}
+
+void abc_pop_free(abc_population* pop)
+{
+  free(pop->vals);
+  free(pop->dists);
+  free(pop->weights);
+  free(pop->cumweights);
+  free(pop->sigmas);
+}
@@ -0,0 +1,139 @@
+/**
+ * @file abc.h
+ * @brief Approximate Bayesian computation of the sampled parameters.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * An ABC run compares a timeline of each simulated path with an observed
+ * series and accepts the parameter values of the path if their distance
+ * does not exceed a tolerance. In the first generation, the parameter
+ * values are drawn from the priors, such that a single generation performs
+ * rejection ABC. Each following generation (SMC-ABC) uses as tolerance a
+ * quantile of the distances of the previous population, and draws the
+ * parameter values by perturbing the particles of the previous population
+ * using a Gaussian kernel whose variance is twice the weighted variance of
+ * the population. The particles are then weighted by the ratio of their
+ * prior density to their proposal density. The observed series file
+ * contains one count per line for consecutive timeline bins starting at
+ * time 0. Empty lines and text following '#' are ignored.
+ */
+
+#ifndef _ABC_
+#define _ABC_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+
+#include "prior_sampling.h"
+
+#define ABC_MAX_PROPOSALS (10000)	//!< Maximum number of perturbed proposals drawn for a path until one has a non-zero prior density
+
+/**
+ * ABC population of accepted particles.
+ */
+typedef struct {
+  uint32_t npars;	//!< Number of sampled parameters.
+  uint32_t n;		//!< Number of particles.
+  double* vals;		//!< Parameter values of each particle.
+  double* dists;	//!< Distance of each particle to the observed series.
+  double* weights;	//!< Normalised weight of each particle.
+  double* cumweights;	//!< Cumulative normalised weights, used to select the perturbed particles.
+  double* sigmas;	//!< Standard deviation of the perturbation kernel of each parameter.
+} abc_population;
+
+/**
+ * @brief Reads an observed series.
+ *
+ * @param filename: Observed series file name.
+ * @param obs: Returns the allocated observed series.
+ * @param nobs: Returns the number of bins of the observed series.
+ * @return 0 on success, -1 on an error.
+ */
+int abc_read_obs(const char* filename, uint32_t** obs, uint32_t* nobs);
+
+/**
+ * @brief Initialises a population.
+ *
+ * @param pop: Pointer to the population.
+ * @param npars: Number of sampled parameters.
+ * @param n: Number of particles.
+ */
+void abc_pop_init(abc_population* pop, const uint32_t npars, const uint32_t n);
+
+/**
+ * @brief Computes the weights of the particles of a population and the
+ * standard deviations of its perturbation kernel.
+ *
+ * @param pop: Pointer to the population, whose values must be filled.
+ * @param prev: Pointer to the population the particles were proposed from,
+ * or NULL if they were drawn from the priors.
+ * @param priors: Priors.
+ */
+void abc_pop_weights(abc_population* pop, abc_population const* prev, param_prior const* priors);
+
+/**
+ * @brief Draws the values of the sampled parameters for a path by perturbing
+ * a particle of a population.
+ *
+ * @param pop: Pointer to the population.
+ * @param priors: Priors.
+ * @param r: Pointer to the random number generator of the path set.
+ * @param vals: Returns the proposed values, rounded to their quantisation
+ * step.
+ * @return 0 on success, -1 if no proposal with a non-zero prior density
+ * was drawn.
+ */
+int abc_propose(abc_population const* pop, param_prior const* priors, const gsl_rng* r, double* vals);
+
+/**
+ * @brief Returns a quantile of the distances of the particles of a
+ * population.
+ *
+ * @param pop: Pointer to the population.
+ * @param q: Quantile.
+ */
+double abc_pop_quantile(abc_population const* pop, const double q);
+
+/**
+ * @brief Returns the effective sample size of a population.
+ *
+ * @param pop: Pointer to the population.
+ */
+double abc_pop_ess(abc_population const* pop);
+
+/**
+ * @brief Computes the weighted mean and standard deviation of a sampled
+ * parameter over a population.
+ *
+ * @param pop: Pointer to the population.
+ * @param k: Index of the parameter.
+ * @param std: Returns the weighted standard deviation.
+ * @return the weighted mean.
+ */
+double abc_pop_moments(abc_population const* pop, const uint32_t k, double* std);
+
+/**
+ * @brief Writes a population to a file, one particle per line.
+ *
+ * @param pop: Pointer to the population.
+ * @param priors: Priors.
+ * @param filename: Output file name.
+ * @return 0 on success, -1 on an error.
+ */
+int abc_pop_write(abc_population const* pop, param_prior const* priors, const char* filename);
+
+/**
+ * @brief Frees the memory used by a population.
+ *
+ * @param pop: Pointer to the population.
+ */
+void abc_pop_free(abc_population* pop);
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @file adaptive_stopping.c
+ * @brief Adaptive stopping of the simulation on target statistical precision.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "adaptive_stopping.h"
+
+void adaptive_init(adaptive_stopping* as, precision_target const* targets, const uint32_t ntargets, const uint32_t minsets, const uint32_t nsets)
+{
+  as->targets=targets;
+  as->ntargets=ntargets;
+  as->minsets=minsets;
+  as->nsets=nsets;
+  as->batches=(double*)malloc(2*ntargets*nsets*sizeof(double));
+  as->started=(bool*)calloc(nsets,sizeof(bool));
+  as->done=(bool*)calloc(nsets,sizeof(bool));
+  as->sums=(target_sums*)calloc(ntargets,sizeof(target_sums));
+  as->nincluded=0;
+  as->stopset=nsets;
+  pthread_mutex_init(&as->lock,NULL);
+}
+
+void adaptive_free(adaptive_stopping* as)
+{
+  pthread_mutex_destroy(&as->lock);
+  free(as->batches);
+  free(as->started);
+  free(as->done);
+  free(as->sums);
+}
+
+double adaptive_estimate(adaptive_stopping const* as, const uint32_t t, double* se)
+{
+  target_sums const* s=as->sums+t;
+  const uint32_t n=as->nincluded;
+
+  if(!(s->x>0)) {
+    *se=NAN;
+    return NAN;
+  }
+  const double r=s->y/s->x;
+
+  if(n<2) {
+    *se=INFINITY;
+    return r;
+  }
+  const double res2=s->yy-2*r*s->xy+r*r*s->xx;
+  *se=sqrt(n/(n-1.)*(res2>0?res2:0))/s->x;
+  return r;
+}
+
+bool adaptive_targets_met(adaptive_stopping const* as)
+{
+  double r, se;
+  uint32_t t;
+
+  for(t=0; t<as->ntargets; ++t) {
+    r=adaptive_estimate(as,t,&se);
+
+    if(!(se<=(as->targets[t].relative?as->targets[t].value*fabs(r):as->targets[t].value))) return false;
+  }
+  return true;
+}
+
+void adaptive_set_done(adaptive_stopping* as, const uint32_t set, double const* batch, uint32_t* first, uint32_t* last)
+{
+  double const* b;
+  uint32_t t;
+
+  pthread_mutex_lock(&as->lock);
+  *first=*last=as->nincluded;
+
+  if(set>=as->stopset) {
+    pthread_mutex_unlock(&as->lock);
+    return;
+  }
+  memcpy(as->batches+2*as->ntargets*set,batch,2*as->ntargets*sizeof(double));
+  as->done[set]=true;
+
+  //Sets are included in order, such that the stop set only depends on the
+  //batch values
+  while(as->nincluded<as->stopset && as->done[as->nincluded]) {
+    b=as->batches+2*as->ntargets*as->nincluded;
+
+    for(t=0; t<as->ntargets; ++t) {
+      as->sums[t].y+=b[2*t];
+      as->sums[t].x+=b[2*t+1];
+      as->sums[t].yy+=b[2*t]*b[2*t];
+      as->sums[t].xy+=b[2*t]*b[2*t+1];
+      as->sums[t].xx+=b[2*t+1]*b[2*t+1];
+    }
+    ++as->nincluded;
+
+    if(as->nincluded>=as->minsets && adaptive_targets_met(as)) as->stopset=as->nincluded;
+  }
+  *last=as->nincluded;
+  pthread_mutex_unlock(&as->lock);
+}
@@ -0,0 +1,132 @@
+/**
+ * @file adaptive_stopping.h
+ * @brief Adaptive stopping of the simulation on target statistical precision.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * When precision targets are set, the number of paths is a maximum and the
+ * path sets are used as batches of equal size. Each target quantity is a
+ * ratio of sums over the paths, whose standard error is estimated from the
+ * batch sums of the completed sets using the batch means method. Sets are
+ * only included in the results once all the sets with a lower index are
+ * completed, and the targets are checked each time a set is included. The
+ * simulation stops at the first set count for which all the targets are met,
+ * such that the included sets only depend on the path sets and not on the
+ * number of threads. The sets with a higher index that are being simulated
+ * when the simulation stops are discarded.
+ */
+
+#ifndef _ADAPTIVE_STOPPING_
+#define _ADAPTIVE_STOPPING_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#define ADAPTIVE_DEFAULT_NSETS (1000)		//!< Default number of path sets when precision targets are set
+#define ADAPTIVE_DEFAULT_MINSETS (20)		//!< Default minimum number of included path sets before the targets are checked
+
+/**
+ * Quantities for which a precision target can be set.
+ */
+enum ro_target_quantity {ro_target_pe, ro_target_exttime, ro_target_inf, ro_target_newinf, ro_target_newpostest};
+
+/**
+ * Precision target.
+ */
+typedef struct {
+  uint32_t quantity;	//!< Target quantity (value set using ro_target_quantity).
+  double time;		//!< Time of the timeline bin, for timeline quantities.
+  double value;		//!< Target standard error.
+  bool relative;	//!< Whether the target standard error is relative to the estimate.
+} precision_target;
+
+/**
+ * Sums of the batch values of a target over the included sets.
+ */
+typedef struct {
+  double y;		//!< Sum of the numerators.
+  double x;		//!< Sum of the denominators.
+  double yy;		//!< Sum of the squared numerators.
+  double xy;		//!< Sum of the products of the numerators and denominators.
+  double xx;		//!< Sum of the squared denominators.
+} target_sums;
+
+/**
+ * Adaptive stopping state shared by the threads.
+ */
+typedef struct {
+  precision_target const* targets;	//!< Precision targets.
+  uint32_t ntargets;			//!< Number of precision targets.
+  uint32_t minsets;			//!< Minimum number of included sets before the targets are checked.
+  uint32_t nsets;			//!< Total number of path sets.
+  double* batches;			//!< Numerator and denominator of each target, for each completed set.
+  bool* started;			//!< Whether the statistics of each set have been initialised.
+  bool* done;				//!< Whether each set is completed.
+  target_sums* sums;			//!< Sums of the batch values of each target over the included sets.
+  uint32_t nincluded;			//!< Number of included sets, which are the sets with the lowest indices.
+  uint32_t volatile stopset;		//!< Index of the first set that is not simulated, or nsets if the targets are not met.
+  pthread_mutex_t lock;			//!< Lock protecting the completed sets and the sums.
+} adaptive_stopping;
+
+/**
+ * @brief Initialises the adaptive stopping state.
+ *
+ * @param as: Pointer to the adaptive stopping state.
+ * @param targets: Precision targets.
+ * @param ntargets: Number of precision targets.
+ * @param minsets: Minimum number of included sets before the targets are
+ * checked.
+ * @param nsets: Total number of path sets.
+ */
+void adaptive_init(adaptive_stopping* as, precision_target const* targets, const uint32_t ntargets, const uint32_t minsets, const uint32_t nsets);
+
+/**
+ * @brief Frees the memory used by the adaptive stopping state.
+ *
+ * @param as: Pointer to the adaptive stopping state.
+ */
+void adaptive_free(adaptive_stopping* as);
+
+/**
+ * @brief Records the batch values of a completed set and includes the sets
+ * that follow the included sets and are completed.
+ *
+ * The targets are checked after each inclusion once the minimum number of
+ * sets is included, and the stop set is set when they are all met. Sets
+ * completed at or after the stop set are not included.
+ *
+ * @param as: Pointer to the adaptive stopping state.
+ * @param set: Index of the completed set.
+ * @param batch: Numerator and denominator of each target for the set.
+ * @param first: Returns the index of the first newly included set.
+ * @param last: Returns the index following the last newly included set.
+ */
+void adaptive_set_done(adaptive_stopping* as, const uint32_t set, double const* batch, uint32_t* first, uint32_t* last);
+
+/**
+ * @brief Computes the estimate of a target quantity and its standard error
+ * from the included sets.
+ *
+ * The estimate is the ratio of the sums of the numerators and denominators,
+ * and the variance of the ratio is estimated from the residuals of the
+ * batches.
+ *
+ * @param as: Pointer to the adaptive stopping state.
+ * @param t: Index of the target.
+ * @param se: Returns the standard error of the estimate.
+ * @return the estimate.
+ */
+double adaptive_estimate(adaptive_stopping const* as, const uint32_t t, double* se);
+
+/**
+ * @brief Returns whether all the targets are met by the included sets.
+ *
+ * @param as: Pointer to the adaptive stopping state.
+ */
+bool adaptive_targets_met(adaptive_stopping const* as);
+
+#endif
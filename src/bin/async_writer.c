@@ -0,0 +1,154 @@
+/**
+ * @file async_writer.c
+ * @brief Asynchronous buffered file writer.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "async_writer.h"
+
+static double aw_time(void){struct timespec ts; clock_gettime(CLOCK_MONOTONIC,&ts); return ts.tv_sec+1e-9*ts.tv_nsec;}
+
+/**
+ * @brief I/O thread function.
+ *
+ * Writes the queued buffers in submission order until the writer is closing
+ * and the queue is empty.
+ *
+ * @param arg: Pointer to the writer.
+ */
+static void* awriter_thread(void* arg)
+{
+  async_writer* aw=(async_writer*)arg;
+  char* buf;
+  size_t size;
+  size_t written;
+  ssize_t ret;
+  double t0;
+
+  for(;;) {
+    pthread_mutex_lock(&aw->lock);
+
+    while(!aw->nqueued && !aw->closing) pthread_cond_wait(&aw->queued,&aw->lock);
+
+    if(!aw->nqueued) {
+      pthread_mutex_unlock(&aw->lock);
+      break;
+    }
+    buf=aw->qbufs[aw->qfirst];
+    size=aw->qsizes[aw->qfirst];
+    aw->qfirst=(aw->qfirst+1)%aw->nbufs;
+    --aw->nqueued;
+    pthread_mutex_unlock(&aw->lock);
+
+    if(size) {
+      t0=aw_time();
+      written=0;
+
+      while(written<size) {
+
+	if((ret=write(aw->fd, buf+written, size-written))<0) {
+
+	  if(errno==EINTR) continue;
+	  perror(__func__);
+	  exit(1);
+	}
+	written+=ret;
+      }
+      aw->writetime+=aw_time()-t0;
+      aw->nbytes+=size;
+    }
+
+    pthread_mutex_lock(&aw->lock);
+    aw->freebufs[aw->nfree++]=buf;
+    pthread_cond_signal(&aw->freed);
+    pthread_mutex_unlock(&aw->lock);
+  }
+  return NULL;
+}
+
+int awriter_init(async_writer* aw, const int fd, const size_t bufsize, const uint32_t nbufs)
+{
+  uint32_t b;
+
+  aw->fd=fd;
+  aw->bufsize=bufsize;
+  aw->nbufs=nbufs;
+  aw->block=(char*)malloc(bufsize*nbufs);
+
+  if(!aw->block) {
+    fprintf(stderr,"%s: Error: Cannot allocate %" PRIu32 " output buffers of %zu bytes\n",__func__,nbufs,bufsize);
+    return -1;
+  }
+  aw->freebufs=(char**)malloc(nbufs*sizeof(char*));
+  aw->qbufs=(char**)malloc(nbufs*sizeof(char*));
+  aw->qsizes=(size_t*)malloc(nbufs*sizeof(size_t));
+
+  for(b=0; b<nbufs; ++b) aw->freebufs[b]=aw->block+b*bufsize;
+  aw->nfree=nbufs;
+  aw->qfirst=0;
+  aw->nqueued=0;
+  aw->closing=false;
+  const off_t offset=lseek(fd,0,SEEK_CUR);
+  aw->offset=(offset>0?offset:0);
+  aw->nrecs=0;
+  aw->nbytes=0;
+  aw->writetime=0;
+  aw->stalltime=0;
+  pthread_mutex_init(&aw->lock,NULL);
+  pthread_cond_init(&aw->queued,NULL);
+  pthread_cond_init(&aw->freed,NULL);
+
+  if(pthread_create(&aw->thread,NULL,awriter_thread,aw)) {
+    fprintf(stderr,"%s: Error: Cannot create the I/O thread\n",__func__);
+    return -1;
+  }
+  return 0;
+}
+
+char* awriter_get_buffer(async_writer* aw)
+{
+  char* buf;
+
+  pthread_mutex_lock(&aw->lock);
+
+  if(!aw->nfree) {
+    const double t0=aw_time();
+
+    do pthread_cond_wait(&aw->freed,&aw->lock);
+    while(!aw->nfree);
+    aw->stalltime+=aw_time()-t0;
+  }
+  buf=aw->freebufs[--aw->nfree];
+  pthread_mutex_unlock(&aw->lock);
+  return buf;
+}
+
+void awriter_submit(async_writer* aw, char* buf, const size_t size, const uint32_t nrecs, uint64_t* offset, uint64_t* recoffset)
+{
+  pthread_mutex_lock(&aw->lock);
+  *offset=aw->offset;
+  *recoffset=aw->nrecs;
+  aw->offset+=size;
+  aw->nrecs+=nrecs;
+  aw->qbufs[(aw->qfirst+aw->nqueued)%aw->nbufs]=buf;
+  aw->qsizes[(aw->qfirst+aw->nqueued)%aw->nbufs]=size;
+  ++aw->nqueued;
+  pthread_cond_signal(&aw->queued);
+  pthread_mutex_unlock(&aw->lock);
+}
+
+void awriter_close(async_writer* aw)
+{
+  pthread_mutex_lock(&aw->lock);
+  aw->closing=true;
+  pthread_cond_signal(&aw->queued);
+  pthread_mutex_unlock(&aw->lock);
+  pthread_join(aw->thread,NULL);
+  pthread_cond_destroy(&aw->queued);
+  pthread_cond_destroy(&aw->freed);
+  pthread_mutex_destroy(&aw->lock);
+  free(aw->block);
+  free(aw->freebufs);
+  free(aw->qbufs);
+  free(aw->qsizes);
+}
@@ -0,0 +1,109 @@
+/**
+ * @file async_writer.h
+ * @brief Asynchronous buffered file writer.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * A writer owns a pool of memory buffers and a dedicated I/O thread. Compute
+ * threads obtain empty buffers from the pool, fill them and submit them to a
+ * bounded queue. The I/O thread writes the queued buffers to the file in
+ * submission order and returns them to the pool. Compute threads only block
+ * when all the buffers of the pool are filled or being written.
+ */
+
+#ifndef _ASYNC_WRITER_
+#define _ASYNC_WRITER_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+/**
+ * Asynchronous writer.
+ */
+typedef struct {
+  int fd;			//!< Output file descriptor.
+  size_t bufsize;		//!< Size of each buffer.
+  uint32_t nbufs;		//!< Number of buffers in the pool.
+  char* block;			//!< Memory block containing all the buffers.
+  char** freebufs;		//!< Stack of empty buffers.
+  uint32_t nfree;		//!< Number of empty buffers.
+  char** qbufs;			//!< Circular queue of filled buffers.
+  size_t* qsizes;		//!< Number of bytes to write from each queued buffer.
+  uint32_t qfirst;		//!< Index of the first queued buffer.
+  uint32_t nqueued;		//!< Number of queued buffers.
+  bool closing;			//!< Set when no more buffers will be submitted.
+  uint64_t offset;		//!< File offset following the submitted buffers.
+  uint64_t nrecs;		//!< Number of records in the submitted buffers.
+  pthread_mutex_t lock;		//!< Lock protecting the pool and the queue.
+  pthread_cond_t queued;	//!< Signaled when a buffer is queued or when the writer is closing.
+  pthread_cond_t freed;		//!< Signaled when a buffer is returned to the pool.
+  pthread_t thread;		//!< I/O thread.
+  uint64_t nbytes;		//!< Number of written bytes.
+  double writetime;		//!< Time spent by the I/O thread writing, in seconds.
+  double stalltime;		//!< Time spent by compute threads waiting for empty buffers, in seconds.
+} async_writer;
+
+/**
+ * @brief Initialises an asynchronous writer and starts its I/O thread.
+ *
+ * Buffers are written starting from the current offset of the file
+ * descriptor.
+ *
+ * @param aw: Pointer to the writer.
+ * @param fd: Output file descriptor.
+ * @param bufsize: Size of each buffer.
+ * @param nbufs: Number of buffers in the pool.
+ * @return 0 on success, -1 if the buffers cannot be allocated or if the I/O
+ * thread cannot be created.
+ */
+int awriter_init(async_writer* aw, const int fd, const size_t bufsize, const uint32_t nbufs);
+
+/**
+ * @brief Obtains an empty buffer from the pool, waiting if none is
+ * available.
+ *
+ * @param aw: Pointer to the writer.
+ * @return a pointer to a buffer of size bufsize.
+ */
+char* awriter_get_buffer(async_writer* aw);
+
+/**
+ * @brief Submits a filled buffer for writing.
+ *
+ * The buffer must not be accessed after it has been submitted.
+ *
+ * @param aw: Pointer to the writer.
+ * @param buf: Buffer obtained with awriter_get_buffer.
+ * @param size: Number of bytes to write from the buffer.
+ * @param nrecs: Number of records contained in the buffer.
+ * @param offset: File offset where the buffer will be written.
+ * @param recoffset: Number of records submitted before the buffer.
+ */
+void awriter_submit(async_writer* aw, char* buf, const size_t size, const uint32_t nrecs, uint64_t* offset, uint64_t* recoffset);
+
+/**
+ * @brief Writes all the submitted buffers, stops the I/O thread and frees
+ * the memory used by the writer.
+ *
+ * All the buffers obtained from the pool must have been submitted. The file
+ * descriptor is not closed. The statistics of the writer remain available.
+ *
+ * @param aw: Pointer to the writer.
+ */
+void awriter_close(async_writer* aw);
+
+/**
+ * @brief Prints the throughput and stall time statistics of a writer.
+ *
+ * @param aw: Pointer to the writer.
+ * @param name: Output name.
+ */
+inline static void awriter_print_stats(async_writer const* aw, const char* name){printf("%s: %.3f MB written at %.3f MB/s, compute threads stalled for %.3f s\n",name,aw->nbytes*1e-6,(aw->writetime>0?aw->nbytes*1e-6/aw->writetime:0),aw->stalltime);}
+
+#endif
@@ -0,0 +1,503 @@
+/**
+ * @file checkpoint.c
+ * @brief Periodic checkpoint writer and serialisation of the simulation state.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "checkpoint.h"
+#include "main.h"
+
+static double ckpt_time(void){struct timespec ts; clock_gettime(CLOCK_MONOTONIC,&ts); return ts.tv_sec+1e-9*ts.tv_nsec;}
+
+/**
+ * @brief Takes a snapshot of the simulation state and writes it to the
+ * checkpoint file.
+ *
+ * @param ck: Pointer to the checkpointer.
+ * @return 0 on success, -1 on an error.
+ */
+static int ckpt_checkpoint(checkpointer* ck)
+{
+  const double tstart=ckpt_time();
+  ckpt_buffer buf;
+  int ret;
+
+  ckbuf_init(&buf);
+  ckbuf_put(&buf,CKPT_MAGIC,CKPT_MAGIC_SIZE);
+  ret=ck->snapshot(ck->arg,&buf);
+
+  if(!ret) ret=ckpt_write(ck->filename,&buf);
+  ckbuf_free(&buf);
+
+  if(!ret) ++ck->nwritten;
+  ck->writetime+=ckpt_time()-tstart;
+  return ret;
+}
+
+/**
+ * @brief Checkpointer thread function.
+ *
+ * @param arg: Pointer to the checkpointer.
+ */
+static void* ckpt_thread(void* arg)
+{
+  checkpointer* ck=(checkpointer*)arg;
+  double next=ckpt_time()+ck->interval;
+  double wait;
+  struct timespec ts;
+  int sig;
+
+  for(;;) {
+
+    if(ck->interval>0) {
+      wait=next-ckpt_time();
+
+      if(wait<0) wait=0;
+      ts.tv_sec=(time_t)wait;
+      ts.tv_nsec=(long)(1e9*(wait-ts.tv_sec));
+      sig=sigtimedwait(&ck->sigs,NULL,&ts);
+
+    } else sig=sigwaitinfo(&ck->sigs,NULL);
+
+    if(sig<0) {
+
+      if(errno!=EAGAIN) continue;
+
+    } else if(sig==SIGUSR2) {
+
+      if(ck->stopping) return NULL;
+      continue;
+    }
+
+    if(ckpt_checkpoint(ck)) fprintf(stderr,"%s: Error: Cannot write checkpoint '%s'\n",__func__,ck->filename);
+
+    if(sig==SIGTERM) {
+      fprintf(stderr,"%s: Checkpoint written to '%s' on SIGTERM, exiting\n",__func__,ck->filename);
+      exit(128+SIGTERM);
+    }
+
+    if(sig<0) next+=ck->interval;
+  }
+  return NULL;
+}
+
+void ckpt_block_signals(sigset_t* sigs)
+{
+  sigemptyset(sigs);
+  sigaddset(sigs,SIGTERM);
+  sigaddset(sigs,SIGUSR1);
+  sigaddset(sigs,SIGUSR2);
+  pthread_sigmask(SIG_BLOCK,sigs,NULL);
+}
+
+int ckpt_start(checkpointer* ck, const char* filename, const double interval, sigset_t const* sigs, int (*snapshot)(void* arg, ckpt_buffer* buf), void* arg)
+{
+  ck->filename=filename;
+  ck->interval=interval;
+  ck->snapshot=snapshot;
+  ck->arg=arg;
+  ck->sigs=*sigs;
+  ck->stopping=false;
+  ck->nwritten=0;
+  ck->writetime=0;
+
+  if(pthread_create(&ck->thread,NULL,ckpt_thread,ck)) {
+    fprintf(stderr,"%s: Error: Cannot create the checkpointer thread\n",__func__);
+    return -1;
+  }
+  return 0;
+}
+
+void ckpt_stop(checkpointer* ck)
+{
+  ck->stopping=true;
+  pthread_kill(ck->thread,SIGUSR2);
+  pthread_join(ck->thread,NULL);
+}
+
+int ckpt_write(const char* filename, ckpt_buffer const* buf)
+{
+  //Processes writing the same file use different temporary files
+  char* tmpname=(char*)malloc(strlen(filename)+26);
+  sprintf(tmpname,"%s.%ld.tmp",filename,(long)getpid());
+  const int fd=open(tmpname,O_WRONLY|O_CREAT|O_TRUNC,S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+  size_t written=0;
+  ssize_t ret;
+
+  if(fd<0) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in write mode\n",__func__,tmpname);
+    free(tmpname);
+    return -1;
+  }
+
+  while(written<buf->size) {
+
+    if((ret=write(fd,buf->data+written,buf->size-written))<0) {
+
+      if(errno==EINTR) continue;
+      perror(__func__);
+      close(fd);
+      free(tmpname);
+      return -1;
+    }
+    written+=ret;
+  }
+
+  //The new checkpoint must be on disk before it replaces the previous one
+  if(fsync(fd) || close(fd) || rename(tmpname,filename)) {
+    perror(__func__);
+    free(tmpname);
+    return -1;
+  }
+  free(tmpname);
+  return 0;
+}
+
+int ckpt_read(const char* filename, const char* magic, ckpt_buffer* buf)
+{
+  const int fd=open(filename,O_RDONLY);
+  struct stat sb;
+  ssize_t ret;
+
+  ckbuf_init(buf);
+
+  if(fd<0) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in read mode\n",__func__,filename);
+    return -1;
+  }
+
+  if(fstat(fd,&sb)) {
+    perror(__func__);
+    close(fd);
+    return -1;
+  }
+  buf->alloc=sb.st_size;
+  buf->data=(char*)malloc(buf->alloc);
+
+  while(buf->size<buf->alloc) {
+
+    if((ret=read(fd,buf->data+buf->size,buf->alloc-buf->size))<=0) {
+
+      if(ret<0 && errno==EINTR) continue;
+      fprintf(stderr,"%s: Error: Cannot read file '%s'\n",__func__,filename);
+      close(fd);
+      return -1;
+    }
+    buf->size+=ret;
+  }
+  close(fd);
+
+  if(buf->size<CKPT_MAGIC_SIZE || memcmp(buf->data,magic,CKPT_MAGIC_SIZE)) {
+    fprintf(stderr,"%s: Error: '%s' is not a file of the expected type and version\n",__func__,filename);
+    return -1;
+  }
+  buf->pos=CKPT_MAGIC_SIZE;
+  return 0;
+}
+
+uint64_t build_variant(void)
+{
+  uint64_t flags=0;
+
+#ifdef CT_OUTPUT
+  flags|=1;
+#endif
+#ifdef DUAL_PINF
+  flags|=2;
+#endif
+#ifdef SEC_INF_TIMELINES
+  flags|=4;
+#endif
+#ifdef NUMEVENTSSTATS
+  flags|=8;
+#endif
+#ifdef OBSREFF_OUTPUT
+  flags|=16;
+#endif
+  return flags;
+}
+
+void put_stats_config(ckpt_buffer* buf, config_pars const* cp)
+{
+  const uint64_t uvals[]={cp->stream, cp->setsize, (uint64_t)cp->nbinsperunit, cp->outputs, (cp->ntlquantiles>0), cp->tlqprecbits, cp->pathhists, cp->phprecbits, cp->ninfhist, cp->lmax, cp->nimax, cp->npostestmax, cp->npostestmaxnunits, cp->timeordered, ro_acc_nchans, sizeof(set_data), build_variant()};
+
+  ckbuf_put(buf, uvals, sizeof(uvals));
+  ckbuf_put(buf, &cp->phtmin, sizeof(double));
+  //The trailing padding of the simulation parameters is not compared
+  ckbuf_put(buf, &cp->pars, offsetof(model_pars, groupinteractions)+sizeof(bool));
+  ckbuf_put(buf, &cp->npriors, sizeof(uint32_t));
+  uint32_t i;
+
+  for(i=0; i<cp->npriors; ++i) {
+    const uint64_t pvals[2]={cp->priors[i].par->offset, cp->priors[i].dist};
+    const double dvals[3]={cp->priors[i].a, cp->priors[i].b, cp->priors[i].step};
+
+    ckbuf_put(buf, pvals, sizeof(pvals));
+    ckbuf_put(buf, dvals, sizeof(dvals));
+  }
+  ckbuf_put(buf, &cp->nseeds, sizeof(uint32_t));
+
+  for(i=0; i<cp->nseeds; ++i) {
+    const uint32_t svals[3]={cp->seeds[i].generation, cp->seeds[i].phase, cp->seeds[i].test};
+
+    ckbuf_put(buf, &cp->seeds[i].inftime, sizeof(double));
+    ckbuf_put(buf, svals, sizeof(svals));
+  }
+}
+
+/**
+ * @brief Serialises the configuration parameters that determine the content
+ * of a checkpoint.
+ *
+ * A checkpoint can only be resumed with identical serialised parameters.
+ *
+ * @param buf: Pointer to the checkpoint buffer.
+ * @param cr: Pointer to the checkpoint run state.
+ */
+static void ckpt_put_config(ckpt_buffer* buf, ckpt_run const* cr)
+{
+  config_pars const* cp=cr->cp;
+#ifdef CT_OUTPUT
+  const bool ctout=(cp->ctout!=0);
+#else
+  const bool ctout=false;
+#endif
+  const bool pathout=(cp->tlout || ctout || cp->treeout);
+  //Fixed-size sets do not depend on the number of shares
+  const uint64_t uvals[]={cp->npaths, (cp->setsize?0:cr->nshares), cr->nsets, cr->firstset, cr->endset, cr->treesize, (cp->tlout!=0)|(ctout<<1)|((cp->treeout!=0)<<2)|(cp->tlencode<<3)|(cp->outindex<<4)|(cp->outshards<<5), (pathout?cp->nthreads:0), cp->outsel.ext, cp->outsel.maxedout, cp->outsel.minfinalsize, cp->outsel.maxfinalsize, cp->outsel.stride};
+  const double dvals[]={cp->outsel.minpostesttime, cp->outsel.maxpostesttime};
+
+  put_stats_config(buf, cp);
+  ckbuf_put(buf, uvals, sizeof(uvals));
+  ckbuf_put(buf, dvals, sizeof(dvals));
+}
+
+void ckpt_put_set_data(ckpt_buffer* buf, set_data const* sd)
+{
+  config_pars const* cp=sd->cp;
+  const double vals[]={sd->commper_mean,
+#ifdef NUMEVENTSSTATS
+    sd->nevents_mean,
+#endif
+    sd->pe, sd->penz, sd->pm, sd->tenz_mean, sd->tenz_std};
+  uint32_t f;
+
+  ckbuf_put(buf, &sd->tlppnnpers, sizeof(int32_t));
+  ckbuf_put(buf, &sd->tlpptnvpers, sizeof(uint32_t));
+  ckbuf_put(buf, &sd->nnzpaths, sizeof(uint32_t));
+  ckbuf_put(buf, &sd->maxedoutmintimeindex, sizeof(int32_t));
+  ckbuf_put(buf, vals, sizeof(vals));
+
+  for(f=0; f<sd->acc.nfields; ++f) ckbuf_put(buf, tlacc_field(&sd->acc, f), sd->tlpptnvpers*sizeof(uint64_t));
+
+  if(sd->inf_timeline_qsk) {
+    const size_t qsksize=sd->tlpptnvpers*lhist_nbuckets(cp->tlqprecbits)*sizeof(uint32_t);
+
+    ckbuf_put(buf, sd->inf_timeline_qsk, qsksize);
+    ckbuf_put(buf, sd->newinf_timeline_qsk, qsksize);
+    ckbuf_put(buf, sd->newpostest_timeline_qsk, qsksize);
+  }
+
+  if(sd->finalsize_hist) {
+    ckbuf_put(buf, sd->finalsize_hist, lhist_nbuckets(cp->phprecbits)*sizeof(uint32_t));
+    ckbuf_put(buf, sd->peakinf_hist, lhist_nbuckets(cp->phprecbits)*sizeof(uint32_t));
+    ckbuf_put(buf, sd->peaktime_hist, (path_hist_ntbins(cp)+2)*sizeof(uint32_t));
+    ckbuf_put(buf, sd->exttime_hist, (path_hist_ntbins(cp)+2)*sizeof(uint32_t));
+  }
+  ckbuf_put(buf, &sd->ninfbins, sizeof(uint32_t));
+  ckbuf_put(buf, sd->ngeninfs, sd->ninfbins*sizeof(uint64_t));
+}
+
+int ckpt_get_set_data(ckpt_buffer* buf, set_data* sd, config_pars const* cp)
+{
+  int32_t tlppnnpers;
+  uint32_t tlpptnvpers;
+  double vals[6
+#ifdef NUMEVENTSSTATS
+    +1
+#endif
+  ];
+  uint32_t f;
+  int ret;
+
+  if(ckbuf_get(buf, &tlppnnpers, sizeof(int32_t)) || ckbuf_get(buf, &tlpptnvpers, sizeof(uint32_t))) return -1;
+  init_set_data(sd, cp, tlpptnvpers);
+  sd->tlppnnpers=tlppnnpers;
+  ret=(ckbuf_get(buf, &sd->nnzpaths, sizeof(uint32_t)) || ckbuf_get(buf, &sd->maxedoutmintimeindex, sizeof(int32_t)) || ckbuf_get(buf, vals, sizeof(vals)));
+
+  for(f=0; !ret && f<sd->acc.nfields; ++f) ret=ckbuf_get(buf, tlacc_field(&sd->acc, f), tlpptnvpers*sizeof(uint64_t));
+
+  if(!ret && sd->inf_timeline_qsk) {
+    const size_t qsksize=tlpptnvpers*lhist_nbuckets(cp->tlqprecbits)*sizeof(uint32_t);
+
+    ret=(ckbuf_get(buf, sd->inf_timeline_qsk, qsksize) || ckbuf_get(buf, sd->newinf_timeline_qsk, qsksize) || ckbuf_get(buf, sd->newpostest_timeline_qsk, qsksize));
+  }
+
+  if(!ret && sd->finalsize_hist) ret=(ckbuf_get(buf, sd->finalsize_hist, lhist_nbuckets(cp->phprecbits)*sizeof(uint32_t)) || ckbuf_get(buf, sd->peakinf_hist, lhist_nbuckets(cp->phprecbits)*sizeof(uint32_t)) || ckbuf_get(buf, sd->peaktime_hist, (path_hist_ntbins(cp)+2)*sizeof(uint32_t)) || ckbuf_get(buf, sd->exttime_hist, (path_hist_ntbins(cp)+2)*sizeof(uint32_t)));
+
+  if(!ret && !(ret=ckbuf_get(buf, &sd->ninfbins, sizeof(uint32_t))) && sd->ninfbins) {
+    sd->ngeninfs=(uint64_t*)malloc(sd->ninfbins*sizeof(uint64_t));
+    ret=ckbuf_get(buf, sd->ngeninfs, sd->ninfbins*sizeof(uint64_t));
+  }
+
+  if(ret) {
+    free_set_data(sd);
+    return -1;
+  }
+  f=0;
+  sd->commper_mean=vals[f++];
+#ifdef NUMEVENTSSTATS
+  sd->nevents_mean=vals[f++];
+#endif
+  sd->pe=vals[f++];
+  sd->penz=vals[f++];
+  sd->pm=vals[f++];
+  sd->tenz_mean=vals[f++];
+  sd->tenz_std=vals[f];
+  return 0;
+}
+
+/**
+ * @brief Synchronises the shard and index files of a thread to disk.
+ *
+ * @param data: Pointer to the thread data.
+ * @return 0 on success, -1 on an error.
+ */
+static int sync_thread_outputs(thread_data const* data)
+{
+  config_pars const* cp=data->cp;
+
+  if(!cp->outshards) return 0;
+
+  if(cp->tlout && (fsync(data->tlshard) || (data->tlidx.fd>=0 && fsync(data->tlidx.fd)))) return -1;
+#ifdef CT_OUTPUT
+
+  if(cp->ctout && (fsync(data->ctshard) || (data->ctidx.fd>=0 && fsync(data->ctidx.fd)))) return -1;
+#endif
+
+  if(cp->treeout && (fsync(data->treeshard) || (data->treeidx.fd>=0 && fsync(data->treeidx.fd)))) return -1;
+  return 0;
+}
+
+int ckpt_snapshot(void* arg, ckpt_buffer* buf)
+{
+  ckpt_run* cr=(ckpt_run*)arg;
+  config_pars const* cp=cr->cp;
+  const uint32_t end=UINT32_MAX;
+  uint32_t s, t;
+
+  pthread_rwlock_wrlock(&cr->lock);
+  ckpt_put_config(buf, cr);
+  ckbuf_put(buf, cr->setstate, cr->nsets);
+  ckbuf_put(buf, (uint32_t*)cr->nmerges, 2*cr->treesize*sizeof(uint32_t));
+  ckbuf_put(buf, &cp->nthreads, sizeof(uint32_t));
+
+  for(t=0; t<cp->nthreads; ++t) ckbuf_put(buf, &cr->tdata[t].progress, sizeof(thread_progress));
+
+  for(s=0; s<cr->nsets; ++s) if(cr->setstate[s]==ro_set_live) {
+    ckbuf_put(buf, &s, sizeof(uint32_t));
+    ckpt_put_set_data(buf, cr->sdata+s);
+  }
+  ckbuf_put(buf, &end, sizeof(uint32_t));
+  pthread_rwlock_unlock(&cr->lock);
+
+  for(t=0; t<cp->nthreads; ++t) if(sync_thread_outputs(cr->tdata+t)) {
+    perror(__func__);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Truncates a shard file and its index file to their size recorded
+ * in a checkpoint, and moves the shard file offset to its end.
+ *
+ * @param fd: Shard file descriptor.
+ * @param ow: Pointer to the index writer of the shard.
+ * @param offset: Recorded size of the shard file.
+ * @param nrecs: Recorded number of records in the shard file.
+ * @return 0 on success, -1 on an error.
+ */
+static int restore_output(const int fd, oidx_writer* ow, const uint64_t offset, const uint64_t nrecs)
+{
+  const uint64_t idxsize=OIDX_HEADER_SIZE+nrecs*OIDX_ENTRY_SIZE;
+  struct stat sb, isb;
+
+  if(fstat(fd, &sb) || (ow->fd>=0 && fstat(ow->fd, &isb))) {
+    perror(__func__);
+    return -1;
+  }
+
+  if((uint64_t)sb.st_size<offset || (ow->fd>=0 && (uint64_t)isb.st_size<idxsize)) {
+    fprintf(stderr,"%s: Error: Output file is shorter than recorded in the checkpoint\n",__func__);
+    return -1;
+  }
+
+  if(ftruncate(fd, offset) || lseek(fd, offset, SEEK_SET)<0 || (ow->fd>=0 && ftruncate(ow->fd, idxsize))) {
+    perror(__func__);
+    return -1;
+  }
+  ow->offset=offset;
+  ow->nrecs=nrecs;
+  return 0;
+}
+
+int ckpt_load(ckpt_run* cr, ckpt_buffer* buf)
+{
+  config_pars const* cp=cr->cp;
+  ckpt_buffer cfg;
+  thread_progress tp;
+  thread_data* data;
+  uint32_t nthreads;
+  uint32_t s, t;
+  bool same;
+
+  ckbuf_init(&cfg);
+  ckpt_put_config(&cfg, cr);
+  same=ckbuf_match(buf, &cfg);
+  ckbuf_free(&cfg);
+
+  if(!same) {
+    fprintf(stderr,"%s: Error: The checkpoint was written with different parameters\n",__func__);
+    return -1;
+  }
+
+  if(ckbuf_get(buf, cr->setstate, cr->nsets) || ckbuf_get(buf, (uint32_t*)cr->nmerges, 2*cr->treesize*sizeof(uint32_t)) || ckbuf_get(buf, &nthreads, sizeof(uint32_t))) return -1;
+
+  //The thread progress only matters for the path outputs, in which case the
+  //number of threads is part of the compared parameters
+  for(t=0; t<nthreads; ++t) {
+
+    if(ckbuf_get(buf, &tp, sizeof(thread_progress))) return -1;
+
+    if(t>=cp->nthreads) continue;
+    data=cr->tdata+t;
+    data->npaths=tp.npaths;
+    data->nwritten=tp.nwritten;
+
+    if(cp->outshards) {
+
+      if(cp->tlout && restore_output(data->tlshard, &data->tlidx, tp.offsets[ro_pathsel_tlout], tp.nrecs[ro_pathsel_tlout])) return -1;
+#ifdef CT_OUTPUT
+
+      if(cp->ctout && restore_output(data->ctshard, &data->ctidx, tp.offsets[ro_pathsel_ctout], tp.nrecs[ro_pathsel_ctout])) return -1;
+#endif
+
+      if(cp->treeout && restore_output(data->treeshard, &data->treeidx, tp.offsets[ro_pathsel_treeout], tp.nrecs[ro_pathsel_treeout])) return -1;
+    }
+    save_progress(data);
+  }
+
+  for(;;) {
+
+    if(ckbuf_get(buf, &s, sizeof(uint32_t))) return -1;
+
+    if(s==UINT32_MAX) break;
+
+    if(s>=cr->nsets || cr->setstate[s]!=ro_set_live || ckpt_get_set_data(buf, cr->sdata+s, cp)) {
+      fprintf(stderr,"%s: Error: Invalid checkpoint set\n",__func__);
+      return -1;
+    }
+  }
+  return 0;
+}
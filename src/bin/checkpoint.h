@@ -0,0 +1,250 @@
+/**
+ * @file checkpoint.h
+ * @brief Periodic checkpoint writer and serialisation of the simulation state.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * A checkpointer owns a dedicated thread that periodically calls a snapshot
+ * function to serialise the state of the simulation into a memory buffer,
+ * and then writes the buffer to the checkpoint file. The file is written
+ * atomically, by writing a temporary file that is synchronised to disk and
+ * then renamed over the previous checkpoint. A checkpoint is also written
+ * when the process receives SIGUSR1, and before the process exits when it
+ * receives SIGTERM. These signals must be blocked in all the threads of the
+ * process, using ckpt_block_signals before any thread is created.
+ *
+ * The simulation state of a run is serialised using ckpt_snapshot and
+ * restored using ckpt_load. The statistics of completed sets are serialised
+ * using ckpt_put_set_data and ckpt_get_set_data, which are also used by the
+ * accumulator and cache files.
+ */
+
+#ifndef _CHECKPOINT_
+#define _CHECKPOINT_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "config.h"
+
+#define CKPT_MAGIC "ROCKPT01"		//!< Checkpoint file magic, including the format version
+#define CKPT_MAGIC_SIZE (8)		//!< Size of the checkpoint file magic, and of the magic of other files written using ckpt_write
+
+/**
+ * Checkpoint memory buffer.
+ */
+typedef struct {
+  char* data;		//!< Buffer content.
+  size_t size;		//!< Number of bytes in the buffer.
+  size_t alloc;		//!< Allocated size.
+  size_t pos;		//!< Read position.
+} ckpt_buffer;
+
+/**
+ * Checkpointer.
+ */
+typedef struct {
+  const char* filename;				//!< Checkpoint file name.
+  double interval;				//!< Interval between periodic checkpoints, in seconds, or 0 to only write checkpoints on signals.
+  int (*snapshot)(void* arg, ckpt_buffer* buf);	//!< Function serialising the simulation state.
+  void* arg;					//!< Argument of the snapshot function.
+  sigset_t sigs;				//!< Signals handled by the checkpointer thread.
+  pthread_t thread;				//!< Checkpointer thread.
+  bool volatile stopping;			//!< Set when the checkpointer thread must stop.
+  uint32_t nwritten;				//!< Number of written checkpoints.
+  double writetime;				//!< Time spent writing checkpoints, in seconds.
+} checkpointer;
+
+/**
+ * @brief Initialises a checkpoint buffer.
+ *
+ * @param buf: Pointer to the buffer.
+ */
+inline static void ckbuf_init(ckpt_buffer* buf){buf->data=NULL; buf->size=buf->alloc=buf->pos=0;}
+
+/**
+ * @brief Frees the memory used by a checkpoint buffer.
+ *
+ * @param buf: Pointer to the buffer.
+ */
+inline static void ckbuf_free(ckpt_buffer* buf){free(buf->data); ckbuf_init(buf);}
+
+/**
+ * @brief Appends data to a checkpoint buffer.
+ *
+ * @param buf: Pointer to the buffer.
+ * @param ptr: Pointer to the data.
+ * @param size: Size of the data in bytes.
+ */
+inline static void ckbuf_put(ckpt_buffer* buf, const void* ptr, const size_t size)
+{
+  if(buf->size+size>buf->alloc) {
+    buf->alloc=(buf->size+size>2*buf->alloc?buf->size+size:2*buf->alloc);
+    buf->data=(char*)realloc(buf->data,buf->alloc);
+  }
+  memcpy(buf->data+buf->size,ptr,size);
+  buf->size+=size;
+}
+
+/**
+ * @brief Reads data from a checkpoint buffer.
+ *
+ * @param buf: Pointer to the buffer.
+ * @param ptr: Pointer to the output data.
+ * @param size: Size of the data in bytes.
+ * @return 0 on success, -1 if the buffer does not contain enough data.
+ */
+inline static int ckbuf_get(ckpt_buffer* buf, void* ptr, const size_t size)
+{
+  if(buf->pos+size>buf->size) {
+    fprintf(stderr,"%s: Error: Truncated checkpoint\n",__func__);
+    return -1;
+  }
+  memcpy(ptr,buf->data+buf->pos,size);
+  buf->pos+=size;
+  return 0;
+}
+
+/**
+ * @brief Compares the content of a checkpoint buffer at its read position
+ * with the content of a reference buffer, and moves the read position past
+ * the compared data.
+ *
+ * @param buf: Pointer to the buffer.
+ * @param ref: Pointer to the reference buffer.
+ * @return true if the contents are identical, and false otherwise.
+ */
+inline static bool ckbuf_match(ckpt_buffer* buf, ckpt_buffer const* ref)
+{
+  const bool same=(buf->size-buf->pos>=ref->size && !memcmp(buf->data+buf->pos,ref->data,ref->size));
+
+  buf->pos+=ref->size;
+  return same;
+}
+
+/**
+ * @brief Blocks the checkpoint signals in the calling thread.
+ *
+ * Threads created afterwards inherit the signal mask.
+ *
+ * @param sigs: Returns the set of checkpoint signals.
+ */
+void ckpt_block_signals(sigset_t* sigs);
+
+/**
+ * @brief Starts the checkpointer thread.
+ *
+ * @param ck: Pointer to the checkpointer.
+ * @param filename: Checkpoint file name.
+ * @param interval: Interval between periodic checkpoints, in seconds, or 0
+ * to only write checkpoints on signals.
+ * @param sigs: Set of checkpoint signals, as returned by ckpt_block_signals.
+ * @param snapshot: Function serialising the simulation state after the
+ * magic, which returns 0 on success.
+ * @param arg: Argument of the snapshot function.
+ * @return 0 on success, -1 if the thread cannot be created.
+ */
+int ckpt_start(checkpointer* ck, const char* filename, const double interval, sigset_t const* sigs, int (*snapshot)(void* arg, ckpt_buffer* buf), void* arg);
+
+/**
+ * @brief Stops the checkpointer thread without writing a checkpoint.
+ *
+ * @param ck: Pointer to the checkpointer.
+ */
+void ckpt_stop(checkpointer* ck);
+
+/**
+ * @brief Writes a checkpoint buffer atomically to a file.
+ *
+ * @param filename: Checkpoint file name.
+ * @param buf: Pointer to the buffer.
+ * @return 0 on success, -1 on a write error.
+ */
+int ckpt_write(const char* filename, ckpt_buffer const* buf);
+
+/**
+ * @brief Reads a checkpoint file, or another file written using ckpt_write,
+ * into a buffer and verifies its magic.
+ *
+ * @param filename: File name.
+ * @param magic: Expected file magic, of size CKPT_MAGIC_SIZE.
+ * @param buf: Pointer to the buffer, whose read position is set after the
+ * magic.
+ * @return 0 on success, -1 on an error.
+ */
+int ckpt_read(const char* filename, const char* magic, ckpt_buffer* buf);
+
+struct set_data_;
+struct ckpt_run_;
+
+/**
+ * @brief Returns the flags of the build variant, which determine the content
+ * of the statistics of the path sets and of the simulation parameters.
+ */
+uint64_t build_variant(void);
+
+/**
+ * @brief Serialises the configuration parameters that determine the
+ * statistics of the path sets.
+ *
+ * @param buf: Pointer to the checkpoint buffer.
+ * @param cp: Configuration parameters.
+ */
+void put_stats_config(ckpt_buffer* buf, config_pars const* cp);
+
+/**
+ * @brief Serialises the statistics of a set of paths.
+ *
+ * @param buf: Pointer to the checkpoint buffer.
+ * @param sd: Pointer to the set data.
+ */
+void ckpt_put_set_data(ckpt_buffer* buf, struct set_data_ const* sd);
+
+/**
+ * @brief Initialises the statistics of a set of paths from a checkpoint.
+ *
+ * @param buf: Pointer to the checkpoint buffer.
+ * @param sd: Pointer to the set data, which is initialised if the returned
+ * value is 0.
+ * @param cp: Configuration parameters.
+ * @return 0 on success, -1 if the checkpoint is truncated.
+ */
+int ckpt_get_set_data(ckpt_buffer* buf, struct set_data_* sd, config_pars const* cp);
+
+/**
+ * @brief Serialises the simulation state into a checkpoint buffer.
+ *
+ * The threads cannot complete sets while the state is serialised. Only the
+ * statistics of the live sets, which are completed sets that are not merged
+ * into a sibling, are stored. The sets that are being simulated are not
+ * stored and are simulated again on resume from their own RNG stream. The
+ * shard and index files are synchronised to disk once the state is
+ * serialised, such that they contain the records of the stored sets.
+ *
+ * @param arg: Pointer to the checkpoint run state.
+ * @param buf: Pointer to the checkpoint buffer.
+ * @return 0 on success, -1 if the output files cannot be synchronised.
+ */
+int ckpt_snapshot(void* arg, ckpt_buffer* buf);
+
+/**
+ * @brief Restores the simulation state from a checkpoint buffer.
+ *
+ * @param cr: Pointer to the checkpoint run state.
+ * @param buf: Pointer to the checkpoint buffer, whose read position follows
+ * the magic.
+ * @return 0 on success, -1 on an error.
+ */
+int ckpt_load(struct ckpt_run_* cr, ckpt_buffer* buf);
+
+#endif
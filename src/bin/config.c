@@ -6,6 +6,36 @@
 
 #include "config.h"
 
+/**
+ * @brief Parses the value of a precision target and appends the target to
+ * the configuration.
+ *
+ * @param cp: Configuration parameters.
+ * @param quantity: Target quantity.
+ * @param time: Time of the timeline bin, for timeline quantities.
+ * @param str: Target standard error, followed by '%' if it is relative to the
+ * estimate.
+ * @return 0 on success, -1 if the value is invalid.
+ */
+static int add_target(config_pars* cp, const uint32_t quantity, const double time, const char* str)
+{
+  precision_target pt={.quantity=quantity, .time=time, .relative=false};
+  int n=0;
+
+  if(sscanf(str,"%lf%n",&pt.value,&n)!=1 || !(pt.value>0) || (str[n] && (str[n]!='%' || str[n+1]))) {
+    fprintf(stderr,"%s: Error: Invalid precision target '%s'\n",__func__,str);
+    return -1;
+  }
+
+  if(str[n]) {
+    pt.value*=0.01;
+    pt.relative=true;
+  }
+  cp->targets=(precision_target*)realloc(cp->targets,(cp->ntargets+1)*sizeof(precision_target));
+  cp->targets[cp->ntargets++]=pt;
+  return 0;
+}
+
 int config(config_pars* cp, const int nargs, const char* args[])
 {
   int plength=1;
@@ -297,11 +327,16 @@ int config(config_pars* cp, const int nargs, const char* args[])
 	  fprintf(stderr,"%s: Error: Cannot open file '%s' in write mode\n",__func__,pbuf);
 	  return -1;
 	}
+	free(cp->tloutname);
+	cp->tloutname=strdup(pbuf);
 
       } else if(!argsdiffer(pbuf, "tloutbufsize")) {
 	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
 	sscanf(pbuf,"%"PRIu32,&cp->tloutbufsize);
 
+      } else if(!argsdiffer(pbuf, "tlencode")) {
+	cp->tlencode=true;
+
 #ifdef CT_OUTPUT
       } else if(!argsdiffer(pbuf, "ctout")) {
 	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
@@ -310,15 +345,142 @@ int config(config_pars* cp, const int nargs, const char* args[])
 	  fprintf(stderr,"%s: Error: Cannot open file '%s' in write mode\n",__func__,pbuf);
 	  return -1;
 	}
+	free(cp->ctoutname);
+	cp->ctoutname=strdup(pbuf);
 
       } else if(!argsdiffer(pbuf, "ctoutbufsize")) {
 	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
 	sscanf(pbuf,"%"PRIu32,&cp->ctoutbufsize);
 #endif
 
+      } else if(!argsdiffer(pbuf, "treeout")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+
+	if((cp->treeout=open(pbuf,O_RDWR|O_CREAT|O_TRUNC,S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH))<0) {
+	  fprintf(stderr,"%s: Error: Cannot open file '%s' in write mode\n",__func__,pbuf);
+	  return -1;
+	}
+	free(cp->treeoutname);
+	cp->treeoutname=strdup(pbuf);
+
+      } else if(!argsdiffer(pbuf, "treeoutbufsize")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%"PRIu32,&cp->treeoutbufsize);
+
+      } else if(!argsdiffer(pbuf, "outshards")) {
+	cp->outshards=true;
+
+      } else if(!argsdiffer(pbuf, "outindex")) {
+	cp->outindex=true;
+
+      } else if(!argsdiffer(pbuf, "outextinct")) {
+	cp->outsel.ext=ro_pathsel_extinct;
+
+      } else if(!argsdiffer(pbuf, "outnonextinct")) {
+	cp->outsel.ext=ro_pathsel_nonextinct;
+
+      } else if(!argsdiffer(pbuf, "outmaxedout")) {
+	cp->outsel.maxedout=true;
+
+      } else if(!argsdiffer(pbuf, "outminfinalsize")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%"SCNu64,&cp->outsel.minfinalsize);
+
+      } else if(!argsdiffer(pbuf, "outmaxfinalsize")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%"SCNu64,&cp->outsel.maxfinalsize);
+
+      } else if(!argsdiffer(pbuf, "outminpostesttime")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%lf",&cp->outsel.minpostesttime);
+
+      } else if(!argsdiffer(pbuf, "outmaxpostesttime")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%lf",&cp->outsel.maxpostesttime);
+
+      } else if(!argsdiffer(pbuf, "outstride")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%"PRIu32,&cp->outsel.stride);
+
+	if(cp->outsel.stride<1) {
+	  fprintf(stderr,"%s: Error: outstride must be at least 1\n",__func__);
+	  return -1;
+	}
+
+      } else if(!argsdiffer(pbuf, "outsample")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%"PRIu32,&cp->outsel.sample);
+
       } else if(!argsdiffer(pbuf, "ninfhist")) {
 	cp->ninfhist=true;
 
+      } else if(!argsdiffer(pbuf, "outputs")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	char* tok=strtok(pbuf,",");
+	cp->outputs=0;
+
+	while(tok) {
+
+	  if(!argsdiffer(tok, "inf")) cp->outputs|=ro_output_inf;
+
+	  else if(!argsdiffer(tok, "newinf")) cp->outputs|=ro_output_newinf;
+
+	  else if(!argsdiffer(tok, "newpostest")) cp->outputs|=ro_output_newpostest;
+
+	  else if(!argsdiffer(tok, "reff")) cp->outputs|=ro_output_reff;
+
+#ifdef OBSREFF_OUTPUT
+	  else if(!argsdiffer(tok, "reffobs")) cp->outputs|=ro_output_reffobs;
+#endif
+
+	  else if(argsdiffer(tok, "none")) {
+	    fprintf(stderr,"%s: Error: Unknown output '%s'\n",__func__,tok);
+	    return -1;
+	  }
+	  tok=strtok(NULL,",");
+	}
+
+      } else if(!argsdiffer(pbuf, "tlquantiles")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	char* tok=strtok(pbuf,",");
+	cp->ntlquantiles=0;
+
+	while(tok) {
+	  cp->tlquantiles=(double*)realloc(cp->tlquantiles,(cp->ntlquantiles+1)*sizeof(double));
+
+	  if(sscanf(tok,"%lf",cp->tlquantiles+cp->ntlquantiles)!=1 || !(cp->tlquantiles[cp->ntlquantiles]>=0) || !(cp->tlquantiles[cp->ntlquantiles]<=1)) {
+	    fprintf(stderr,"%s: Error: Timeline quantiles must be values in the interval [0,1]\n",__func__);
+	    return -1;
+	  }
+	  ++cp->ntlquantiles;
+	  tok=strtok(NULL,",");
+	}
+
+      } else if(!argsdiffer(pbuf, "tlqprecbits")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%"PRIu32,&cp->tlqprecbits);
+
+	if(cp->tlqprecbits<1 || cp->tlqprecbits>LHIST_MAX_PRECBITS) {
+	  fprintf(stderr,"%s: Error: tlqprecbits must be in the interval [1,%i]\n",__func__,LHIST_MAX_PRECBITS);
+	  return -1;
+	}
+
+      } else if(!argsdiffer(pbuf, "pathhists")) {
+	cp->pathhists=true;
+
+      } else if(!argsdiffer(pbuf, "phprecbits")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%"PRIu32,&cp->phprecbits);
+
+	if(cp->phprecbits<1 || cp->phprecbits>LHIST_MAX_PRECBITS) {
+	  fprintf(stderr,"%s: Error: phprecbits must be in the interval [1,%i]\n",__func__,LHIST_MAX_PRECBITS);
+	  return -1;
+	}
+
+      } else if(!argsdiffer(pbuf, "phtmin")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%lf",&cp->phtmin);
+
       } else if(!argsdiffer(pbuf, "npaths")) {
 	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
 	sscanf(pbuf,"%"PRIu32,&cp->npaths);
@@ -327,6 +489,19 @@ int config(config_pars* cp, const int nargs, const char* args[])
 	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
 	sscanf(pbuf,"%"PRIu32,&cp->lmax);
 
+      } else if(!argsdiffer(pbuf, "timeordered")) {
+	cp->timeordered=true;
+
+      } else if(!argsdiffer(pbuf, "tscheck")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%lf",&cp->tscheck);
+
+      } else if(!argsdiffer(pbuf, "seeds")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	free(cp->seeds);
+
+	if(seeds_read(pbuf,&cp->seeds,&cp->nseeds)) return -1;
+
       } else if(!argsdiffer(pbuf, "nbinsperunit")) {
 	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
 	sscanf(pbuf,"%"PRIi32,&cp->nbinsperunit);
@@ -361,10 +536,174 @@ int config(config_pars* cp, const int nargs, const char* args[])
 	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
 	sscanf(pbuf,"%"PRIu32,&cp->nsetsperthread);
 
+      } else if(!argsdiffer(pbuf, "nsets")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%"PRIu32,&cp->nsets);
+
+      } else if(!argsdiffer(pbuf, "setsize")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%"PRIu32,&cp->setsize);
+
+      } else if(!argsdiffer(pbuf, "accout")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	free(cp->accoutname);
+	cp->accoutname=strdup(pbuf);
+
+      } else if(!argsdiffer(pbuf, "topup")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	free(cp->topupname);
+	cp->topupname=strdup(pbuf);
+
+      } else if(!argsdiffer(pbuf, "shard")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+
+	if(sscanf(pbuf,"%"SCNu32"/%"SCNu32,&cp->shard,&cp->nshards)!=2 || cp->shard>=cp->nshards) {
+	  fprintf(stderr,"%s: Error: shard must be of the form i/N, with 0 <= i < N\n",__func__);
+	  return -1;
+	}
+
+      } else if(!argsdiffer(pbuf, "merge")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	cp->mergenames=(char**)realloc(cp->mergenames,(cp->nmergenames+1)*sizeof(char*));
+	cp->mergenames[cp->nmergenames++]=strdup(pbuf);
+
+      } else if(!argsdiffer(pbuf, "cachedir")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	free(cp->cachedir);
+	cp->cachedir=strdup(pbuf);
+
+      } else if(!argsdiffer(pbuf, "prior")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	cp->priors=(param_prior*)realloc(cp->priors,(cp->npriors+1)*sizeof(param_prior));
+
+	if(prior_parse(cp->priors+cp->npriors,pbuf)) return -1;
+	++cp->npriors;
+
+      } else if(!argsdiffer(pbuf, "priorout")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	free(cp->prioroutname);
+	cp->prioroutname=strdup(pbuf);
+
+      } else if(!argsdiffer(pbuf, "sweep")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	free(cp->sweepname);
+	cp->sweepname=strdup(pbuf);
+
+      } else if(!argsdiffer(pbuf, "sweepout")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	free(cp->sweepoutname);
+	cp->sweepoutname=strdup(pbuf);
+
+      } else if(!argsdiffer(pbuf, "abcobs")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	free(cp->abcobs);
+
+	if(abc_read_obs(pbuf,&cp->abcobs,&cp->abcnobs)) return -1;
+
+      } else if(!argsdiffer(pbuf, "abctl")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+
+	if(!strcmp(pbuf,"inf")) cp->abcchan=std_stats_tl_inf;
+	else if(!strcmp(pbuf,"newinf")) cp->abcchan=std_stats_tl_newinf;
+	else if(!strcmp(pbuf,"newpostest")) cp->abcchan=std_stats_tl_postest;
+	else {
+	  fprintf(stderr,"%s: Error: Unknown ABC timeline '%s'\n",__func__,pbuf);
+	  return -1;
+	}
+
+      } else if(!argsdiffer(pbuf, "abcdist")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+
+	if(!strcmp(pbuf,"l1")) cp->abcdist=std_stats_obs_l1;
+	else if(!strcmp(pbuf,"l2")) cp->abcdist=std_stats_obs_l2;
+	else if(!strcmp(pbuf,"linf")) cp->abcdist=std_stats_obs_linf;
+	else {
+	  fprintf(stderr,"%s: Error: Unknown ABC distance '%s'\n",__func__,pbuf);
+	  return -1;
+	}
+
+      } else if(!argsdiffer(pbuf, "abceps")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%lf",&cp->abceps);
+
+      } else if(!argsdiffer(pbuf, "abcgens")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%"PRIu32,&cp->abcngens);
+
+      } else if(!argsdiffer(pbuf, "abcquantile")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%lf",&cp->abcquantile);
+
+      } else if(!argsdiffer(pbuf, "abcout")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	free(cp->abcoutname);
+	cp->abcoutname=strdup(pbuf);
+
       } else if(!argsdiffer(pbuf, "stream")) {
 	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
 	sscanf(pbuf,"%"PRIu32,&cp->stream);
 
+      } else if(!argsdiffer(pbuf, "targetpe")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+
+	if(add_target(cp,ro_target_pe,NAN,pbuf)) return -1;
+
+      } else if(!argsdiffer(pbuf, "targetexttime")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+
+	if(add_target(cp,ro_target_exttime,NAN,pbuf)) return -1;
+
+      } else if(!argsdiffer(pbuf, "targettl")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	char* tok=strtok(pbuf,",");
+	uint32_t quantity;
+	double time;
+
+	if(tok && !argsdiffer(tok, "inf")) quantity=ro_target_inf;
+
+	else if(tok && !argsdiffer(tok, "newinf")) quantity=ro_target_newinf;
+
+	else if(tok && !argsdiffer(tok, "newpostest")) quantity=ro_target_newpostest;
+
+	else {
+	  fprintf(stderr,"%s: Error: targettl timeline must be one of inf, newinf or newpostest\n",__func__);
+	  return -1;
+	}
+	tok=strtok(NULL,",");
+
+	if(!tok || sscanf(tok,"%lf",&time)!=1 || !(tok=strtok(NULL,","))) {
+	  fprintf(stderr,"%s: Error: targettl requires a timeline, a time and a target value\n",__func__);
+	  return -1;
+	}
+
+	if(add_target(cp,quantity,time,tok)) return -1;
+
+      } else if(!argsdiffer(pbuf, "targetminsets")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%"PRIu32,&cp->targetminsets);
+
+	if(cp->targetminsets<2) {
+	  fprintf(stderr,"%s: Error: targetminsets must be at least 2\n",__func__);
+	  return -1;
+	}
+
+      } else if(!argsdiffer(pbuf, "checkpoint")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	free(cp->ckptname);
+	cp->ckptname=strdup(pbuf);
+
+      } else if(!argsdiffer(pbuf, "checkpointinterval")) {
+	safegetnextparam(fptra,&fptri,true,nargs,args,&parc,pbuf);
+	sscanf(pbuf,"%lf",&cp->ckptinterval);
+
+	if(!(cp->ckptinterval>=0)) {
+	  fprintf(stderr,"%s: Error: checkpointinterval must be non-negative\n",__func__);
+	  return -1;
+	}
+
+      } else if(!argsdiffer(pbuf, "resume")) {
+	cp->resume=true;
+
       } else {
 
 	if(argsdiffer(pbuf, "help")) fprintf(stderr,"%s: Error: Option '%s' is unknown\n",__func__,pbuf);
@@ -489,21 +828,73 @@ void printusage(const char* name)
   printf("\t--nstart VALUE\t\t\tInitial number of individuals (default value of 1).\n");
   printf("\t--pinfpri VALUE\t\t\tProbability that an initial individual be infectious (default value of 1).\n");
   printf("\t--lmax VALUE\t\t\tMaximum number of layers (generations) for the simulation (value of 1 signifies only primary individuals, default value of UINT32_MAX).\n");
+  printf("\t--timeordered\t\t\tSimulate the transmission events of each path of the branching simulation in increasing time order instead of depth-first. The simulated process is identical, but the paths are generated from different random numbers. Only supported for the branching simulation (popsize of 0).\n");
+  printf("\t--tscheck TIME\t\t\tCheck the suspension of the time-ordered simulation. Each path is suspended at the provided time, completed, and then completed again from a copy of its state at the suspension time, which is alternately copied in memory and serialised. The simulation stops with an error if both completions of a path differ. The results are otherwise identical to the results without the check. Requires timeordered.\n");
+  printf("\t--seeds FILENAME\t\tStart each path from the snapshot of the infections that are current at time 0 listed in the provided seed file, instead of from nstart primary individuals, such that the simulation only covers the forecast horizon. Each line of the file contains the space-separated fields INFTIME PHASE TEST [GENERATION] of an infected individual, where INFTIME is its infection time, which cannot be positive, PHASE is its infection phase at time 0 (latent or comm), TEST is its testing status (unknown, negative or positive, for a communicable period that ends with a true positive test) and GENERATION is its optional infection generation (default value of 1). Text following '#' is ignored. The time periods of each individual are sampled conditionally on its infection time, infection phase and testing status, without interruption, and only the transmission events that occur after time 0 are simulated. Implies timeordered, and cannot be used with popsize and the time origin options.\n");
   printf("\t--nbinsperunit VALUE\t\tNumber of timeline bins per unit of time.\n");
   printf("\t--nimax VALUE\t\t\tMaximum number of infectious individuals for a given time integer interval (default value of UINT32_MAX). This option makes a model diverge from a branching process, but does not affect the expected effective reproduction number value.\n");
   printf("\t--npostestmax VALUE\t\tMaximum number of positive test results during an interval of duration npostestmaxunits that starts when the test results are received. (default value of UINT32_MAX). This option makes a model diverge from a branching process, but does not affect the expected effective reproduction number value.\n");
   printf("\t--npostestmaxnunits VALUE\tInterval duration for the maximum number of positive test results (default value of 1).\n");
   printf("\t--tlout FILENAME\t\tOutput timeline information for each simulated path into the provided file in the binary format as described below.\n");
-  printf("\t--tloutbufsize VALUE\t\tPer-thread memory buffer size (in MB) used to accumulate data for timeline output before writing them to disk (default value of 10 MB).\n");
+  printf("\t--tloutbufsize VALUE\t\tSize (in MB) of the memory buffers used to accumulate data for timeline output. Two buffers are allocated per thread, and filled buffers are written to disk by a dedicated I/O thread while compute threads fill the other ones (default value of 10 MB).\n");
+  printf("\t--tlencode\t\t\tWrite the timeline records in the encoded format described below, which is typically an order of magnitude more compact than the raw format. Encoded files can be converted to the raw format with the tloutconvert tool.\n");
+  printf("\t--outshards\t\t\tWrite the timeline, contact tracing and transmission tree outputs as one shard file per thread, without any locking between threads. The shard files are named after the provided output file names, followed by '.' and the thread index. The provided output files then contain a manifest that lists the shard files, with their number of paths and the format header. Each shard is a complete output file in the regular format, and the shards of an output can be merged into a single output file using the tloutmerge tool.\n");
+  printf("\t--outindex\t\t\tWrite a path index sidecar file, named after each timeline, contact tracing, transmission tree or shard output file followed by '.idx', that gives the offset, size, path index, number of time bins, of contact tracing entries or of transmission tree nodes, and extinction and maxed out flags of each path record (see output_index.h for the format). Indexes of existing timeline output files can be built with the tloutindex tool.\n");
+  printf("\t--outextinct\t\t\tOnly write the paths that go extinct to the timeline, contact tracing and transmission tree outputs. The statistics reported on the standard output always include all the simulated paths.\n");
+  printf("\t--outnonextinct\t\t\tOnly write the paths that do not go extinct to the timeline, contact tracing and transmission tree outputs.\n");
+  printf("\t--outmaxedout\t\t\tOnly write the paths that max out an nimax or npostestmax limit to the timeline, contact tracing and transmission tree outputs.\n");
+  printf("\t--outminfinalsize VALUE\t\tOnly write the paths whose final size (total number of new infections) is at least VALUE to the timeline, contact tracing and transmission tree outputs.\n");
+  printf("\t--outmaxfinalsize VALUE\t\tOnly write the paths whose final size is at most VALUE to the timeline, contact tracing and transmission tree outputs.\n");
+  printf("\t--outminpostesttime VALUE\tOnly write the paths whose first positive test results are received at a time of at least VALUE to the timeline, contact tracing and transmission tree outputs. The time of the first positive test results is the start time of the first time bin with new positive test results, and paths without positive test results are not written. Requires tdeltat.\n");
+  printf("\t--outmaxpostesttime VALUE\tOnly write the paths whose first positive test results are received at a time of at most VALUE to the timeline, contact tracing and transmission tree outputs. Requires tdeltat.\n");
+  printf("\t--outstride VALUE\t\tOnly write the paths whose index is a multiple of VALUE to the timeline, contact tracing and transmission tree outputs (default value of 1).\n");
+  printf("\t--outsample VALUE\t\tOnly write a uniform sample of VALUE paths, among the paths that are selected by the above options, to the timeline, contact tracing and transmission tree outputs. Each path is sampled using a pseudo-random key that only depends on its index and on the RNG stream, such that the sample does not depend on the number of threads. The sampled records are kept in memory until the end of the simulation and are written sorted by path index. Cannot be used with outshards (default value of 0, for no sampling).\n");
 #ifdef CT_OUTPUT
   printf("\t--ctout FILENAME\t\tOutput contact tracing information for each simulated path into the provided file.\n");
-  printf("\t--ctoutbufsize VALUE\t\tPer-thread memory buffer size (in MB) used to accumulate data for contact tracing output before writing them to disk (default value of 10 MB).\n");
+  printf("\t--ctoutbufsize VALUE\t\tSize (in MB) of the memory buffers used to accumulate data for contact tracing output. Two buffers are allocated per thread, and filled buffers are written to disk by a dedicated I/O thread while compute threads fill the other ones (default value of 10 MB).\n");
 #endif
+  printf("\t--treeout FILENAME\t\tOutput the transmission tree of each simulated path into the provided file in the binary format as described below. The same paths as for the timeline output are written, and records can be matched to timeline records through the path indices of the index sidecar files (see --outindex). Only supported for the branching simulation (popsize of 0).\n");
+  printf("\t--treeoutbufsize VALUE\t\tSize (in MB) of the memory buffers used to accumulate data for transmission tree output. Two buffers are allocated per thread, and filled buffers are written to disk by a dedicated I/O thread while compute threads fill the other ones (default value of 10 MB).\n");
   printf("\t--ninfhist\t\t\tCompute a histogram of the number of infected individuals for each infectious individual.\n");
+#ifdef OBSREFF_OUTPUT
+  printf("\t--outputs LIST\t\t\tComma-separated list of the timelines to be computed and reported, among inf (current infections), newinf (new infections), newpostest (new positive tests), reff (effective reproduction number, including the mean R and communicable period) and reffobs (observed effective reproduction number), or none. The statistics for timelines that are not listed are not computed, unless they are required by other options (default value of inf,newinf,newpostest,reff,reffobs).\n");
+#else
+  printf("\t--outputs LIST\t\t\tComma-separated list of the timelines to be computed and reported, among inf (current infections), newinf (new infections), newpostest (new positive tests) and reff (effective reproduction number, including the mean R and communicable period), or none. The statistics for timelines that are not listed are not computed, unless they are required by other options (default value of inf,newinf,newpostest,reff).\n");
+#endif
+  printf("\t--tlquantiles LIST\t\tComma-separated list of cumulative probabilities (e.g. 0.05,0.5,0.95) for which the quantiles of the current infection, new infection and new positive test timelines are reported for each time bin. Quantiles are computed from mergeable log-bucketed histograms that are updated at the end of each path.\n");
+  printf("\t--tlqprecbits VALUE\t\tNumber of precision bits for the timeline quantile histograms. Counts smaller than 2^VALUE are recorded exactly and the relative error on larger counts does not exceed 2^-VALUE (default value of %i, maximum value of %i).\n",LHIST_DEFAULT_PRECBITS,LHIST_MAX_PRECBITS);
+  printf("\t--pathhists\t\t\tCompute histograms of the final size (total number of new infections), of the peak number of current infections, of the time of this peak and of the extinction time for each path.\n");
+  printf("\t--phprecbits VALUE\t\tNumber of precision bits for the log-bucketed final size and peak histograms (default value of %i, maximum value of %i).\n",LHIST_DEFAULT_PRECBITS,LHIST_MAX_PRECBITS);
+  printf("\t--phtmin VALUE\t\t\tLower edge of the peak time and extinction time histograms, whose bins have a width of 1/nbinsperunit and extend up to tmax (default value of 0 for time_rel_pri_created and time_rel_pri_flat_comm, and of -tmax otherwise).\n");
   printf("\t--npaths VALUE\t\t\tNumber of generated simulation paths (default value of 10000).\n");
   printf("\t--nthreads VALUE\t\tNumber of threads used to perform the simulation (default value of 1).\n");
-  printf("\t--nsetsperthread VALUE\t\tNumber of path sets used for each thread (default value of 100 when nthreads>1, and of 1 otherwise). Using a value of 1 guarantees the same stream of random numbers from one run to another, while using a larger value increases performance by assigning sets to available processing resources. In either case, the RNG stream algorithm is used to guarantee non-overlapping seed streams between threads.\n");
+  printf("\t--nsetsperthread VALUE\t\tNumber of shares of paths per thread used to form path sets (default value of 100 when nthreads>1, and of 1 otherwise). Each path set contains a fraction 1/(nthreads*nsetsperthread) of the remaining paths, such that large sets are simulated first and single paths are simulated at the end, and sets are assigned to threads as they become available. Each set uses its own RNG stream, the RNG stream algorithm guaranteeing non-overlapping seed streams between sets, and the set statistics are merged by the threads in a fixed order that only depends on the sets. The results are thus reproducible from one run to another for a given total number of shares.\n");
+  printf("\t--nsets VALUE\t\t\tTotal number of shares of paths used to form path sets. Overrides nthreads*nsetsperthread when non-zero, such that the results, including the path outputs, do not depend on the number of threads. Without it, the number of shares, and thus the results, depend on nthreads (default value of 0).\n");
+  printf("\t--setsize VALUE\t\t\tNumber of paths of each path set. Overrides nsets and nsetsperthread when non-zero, the last set containing the remaining paths. Set i then contains the paths starting at index i*setsize and uses the RNG stream of index stream*%" PRIu32 "+i, such that the sets and their statistics do not depend on the total number of paths. At most %" PRIu32 " sets can then be used (default value of 0).\n",FIXED_SETS_STREAM_STRIDE,FIXED_SETS_STREAM_STRIDE);
+  printf("\t--accout FILENAME\t\tWrite the merged statistics of the path sets to the provided accumulator file at the end of the simulation, such that the result can be extended with more paths using topup. Requires setsize, and a total number of paths that is a multiple of setsize.\n");
+  printf("\t--topup FILENAME\t\tExtend the result stored in the provided accumulator file, written by accout using the same parameters, with npaths new paths. The new paths use the sets and RNG streams that follow the ones of the accumulator file, and the reported results are identical to the ones of a single simulation of the combined number of paths. Requires setsize, and can be combined with accout to write the extended result.\n");
+  printf("\t--shard I/N\t\t\tOnly simulate the I-th of N contiguous shards of the path sets (0 <= I < N), and write the statistics of the shard to the partial accumulator file provided with accout. The reported results are the ones of the paths of the shard. Requires setsize and accout, and at least N path sets.\n");
+  printf("\t--merge FILENAME\t\tMerge the provided partial accumulator file instead of simulating paths. Can be used multiple times. The files must be written by accout using the same parameters, and their path sets must cover the npaths paths exactly once. The reported results are then identical to the ones of a single simulation of npaths paths. Requires setsize, can be combined with accout, and cannot be used with the timeline, contact tracing and transmission tree outputs.\n");
+  printf("\t--cachedir DIRNAME\t\tCache the results in the provided directory. The results are stored in accumulator files, keyed by a hash of the solved simulation parameters, of the options that determine the statistics, of the build variant, of the RNG stream and of setsize, and named after the key and the number of path sets. A cached result for npaths paths is reported without simulating any path, and the largest cached result for fewer paths is otherwise extended with new paths as a top-up run. The new result is then added to the cache. Requires setsize and a number of paths that is a multiple of setsize, and cannot be used with accout, topup, shard, merge and the timeline, contact tracing and transmission tree outputs.\n");
+  printf("\t--prior NAME,DIST,A,B[,STEP]\tDraw the value of the NAME numerical simulation parameter for each path from the DIST prior distribution, which is uniform (between A and B), loguniform (between A and B), lognormal (with location A and scale B of the logarithm), gamma (with shape A and scale B) or beta (with parameters A and B). Can be repeated for different parameters, and cannot be used for tdeltat and for integer parameters. The values are drawn from the RNG stream of the path set, such that the results do not depend on the number of threads, and the reported results are the ones of the mixture of the prior draws. Each drawn value is rounded to the nearest multiple of STEP if it is provided and non-zero. The other parameters are solved for each path, as for the command line values, and when all the priors have a quantisation step, each thread caches the solved parameters of up to %i grid points.\n",3*PRIOR_CACHE_SIZE/4);
+  printf("\t--priorout FILENAME\t\tWrite the sampled parameters and the outcome of each simulated path to the provided file, as tab-separated columns with a header line, sorted by path index. Each row contains the path index, the value of the sampled parameters, whether the path went extinct, whether it reached the maximum defined by nimax/npostestmax, its extinction time, its final size (total number of new infections) and its peak number of current infections. The rows are kept in memory until the end of the simulation. Requires prior, and cannot be used with checkpoint.\n");
+  printf("\t--sweep FILENAME\t\tSimulate each parameter point listed in the provided sweep file, within a single process whose threads simulate the path sets of all the points. Each line of the file contains space-separated assignments of the form NAME=VALUE[,VALUE...], where NAME is the option name of a numerical simulation parameter, and defines the grid formed by all the combinations of the listed values. The parameters that are not assigned keep their value from the command line, and text following '#' is ignored. The points use the same path sets and RNG streams, such that the results of each point are identical to the ones of a separate simulation with the same parameters. Requires sweepout, and cannot be used with prior, abcobs, accout, topup, shard, merge, cachedir, checkpoint, the precision targets and the timeline, contact tracing and transmission tree outputs.\n");
+  printf("\t--sweepout FILENAME\t\tWrite the results of the sweep points to the provided file, as tab-separated columns with a header line. Each row contains the point index, the value of the swept parameters, the number of paths, the probability of non outgoing outbreak, the probability of extinction of outbreaks with a non-zero number of infections, the probability of reaching the maximum number of infectious individuals, the mean and standard deviation of the extinction time, and, when the reff output is computed, the mean effective reproduction number and the mean communal period, with the statistical errors of the probabilities and means.\n");
+  printf("\t--abcobs FILENAME\t\tPerform approximate Bayesian computation (ABC) of the parameters sampled using prior, by comparing a timeline of each path with the observed series in the provided file, which contains one count per line for consecutive timeline bins starting at time 0. Text following '#' is ignored. The parameter values of a path are accepted if the distance between its timeline and the observed series does not exceed the tolerance of the current generation. Paths are rejected early, without simulating further infections, as soon as the distance computed from the excess of the timeline over the observed series exceeds the tolerance. Each generation simulates npaths paths, and the accepted values, weighted means and standard deviations of each generation are printed. Requires prior, and cannot be used with priorout, sweep, setsize, accout, topup, shard, merge, cachedir, checkpoint, the precision targets, nimax, npostestmax, a time relative to the first positive test results and the timeline, contact tracing and transmission tree outputs.\n");
+  printf("\t--abctl TIMELINE\t\tTimeline compared with the observed series: inf (current infections), newinf (new infections) or newpostest (new positive test results, the default, which requires tdeltat).\n");
+  printf("\t--abcdist DISTANCE\t\tDistance between the timeline and the observed series: l1 (sum of absolute differences), l2 (Euclidean distance, the default) or linf (maximum absolute difference).\n");
+  printf("\t--abceps VALUE\t\tTolerance of the first ABC generation (default infinite, in which case no path is rejected early).\n");
+  printf("\t--abcgens N\t\tNumber of ABC generations (default 1). The first generation draws the parameters from the priors (rejection ABC). Each following generation (SMC-ABC) draws them by perturbing the accepted values of the previous generation, using a Gaussian kernel whose variance is twice their weighted variance, and weights the accepted values by the ratio of their prior density to their proposal density.\n");
+  printf("\t--abcquantile Q\t\tQuantile of the distances of the accepted values of a generation used as the tolerance of the next generation (default 0.5).\n");
+  printf("\t--abcout FILENAME\t\tWrite the accepted values of the last ABC generation to the provided file, as tab-separated columns with a header line. Each row contains the particle index, the value of the sampled parameters, the distance to the observed series and the normalised weight.\n");
   printf("\t--stream VALUE\t\t\tSelect an RNG stream. Use to set the initial seed of the random number generator (default value of 0).\n");
+  printf("\t--targetpe VALUE[%%]\t\tStop the simulation once the standard error of the probability of non outgoing outbreak is below the provided value, or below the provided percentage of the estimate if the value is followed by '%%'. npaths is then the maximum number of paths. When any precision target is set, the paths are divided into nsets path sets of equal size (1000 sets if nsets is 0), which are used as batches to estimate the standard errors with the batch means method. Sets are included in order once all the sets with a lower index are completed, and the targets are checked each time a set is included, such that the number of used paths does not depend on the number of threads. The number of used paths and the achieved precision are reported. Cannot be used with the timeline, contact tracing and transmission tree outputs.\n");
+  printf("\t--targetexttime VALUE[%%]\tStop the simulation once the standard error of the mean extinction time is below the provided value, or below the provided percentage of the estimate (see targetpe).\n");
+  printf("\t--targettl TL,TIME,VALUE[%%]\tStop the simulation once the standard error of the mean of the TL timeline (inf, newinf or newpostest) for all paths, for the bin containing TIME, is below the provided value, or below the provided percentage of the estimate (see targetpe). The timeline must be part of the computed outputs. Can be repeated.\n");
+  printf("\t--targetminsets VALUE\t\tMinimum number of included path sets before the precision targets are checked (default value of %i).\n",ADAPTIVE_DEFAULT_MINSETS);
+  printf("\t--checkpoint FILENAME\t\tPeriodically write the state of the simulation to the provided checkpoint file, which is replaced atomically. A checkpoint is also written when the process receives SIGUSR1, and before the process exits when it receives SIGTERM. The checkpoint contains the merged statistics of the completed path sets, and the path sets that are being simulated are simulated again on resume, from their own RNG stream. The results of a resumed simulation are thus identical to the results of an uninterrupted one. The timeline, contact tracing and transmission tree outputs require outshards, whose shard files are truncated on resume to the records of the completed path sets. Cannot be used with the precision targets.\n");
+  printf("\t--checkpointinterval VALUE\tInterval between periodic checkpoints, in seconds, or 0 to only write checkpoints on signals (default value of 3600).\n");
+  printf("\t--resume\t\t\tResume the simulation from the checkpoint file if it exists, instead of starting from scratch. The simulation parameters, including the number of path sets, and the number of threads when the timeline, contact tracing or transmission tree outputs are used, must be identical to the ones of the interrupted simulation.\n");
   printf("\t--help\t\t\t\tPrint this usage information and exit.\n");
   printf("\n\tEach option can be used as shown above from the command line. Dash(es) for option names are optional. For configuration files, '=', ':' or spaces as defined by isspace() can be used to separate option names from arguments. Characters following '#' on one line are considered to be comments.\n");
   printf("\tOptions can be used multiple times and configuration files can be read from configuration files.\n"); 
@@ -513,11 +904,14 @@ void printusage(const char* name)
   printf("\n\tFile header:\n");
   printf("\t\t-Unsigned 32 bit value: tmax, the number of time bins starting from t=0.\n");
   printf("\t\t-8 bit field:\n");
-  printf("\t\t\tBits 0 to 2: A value from the three lower significant bits is used to indicate the model of the time origin. A value of 1 for primary individual creation time (time_rel_pri_created), 2 for primary individual entering the simulation at a random time during his communicable period (time_rel_pri_flat_comm), 3 for time primary individual becomes infectious (time_rel_pri_infectious), 4 for end of communicable period for primary individual (time_rel_pri_end_comm), 5 for test results for primary individual (time_rel_pri_test_results).\n");
+  printf("\t\t\tBits 0 to 2: A value from the three lower significant bits is used to indicate the model of the time origin. A value of 1 for primary individual creation time (time_rel_pri_created), 2 for primary individual entering the simulation at a random time during his communicable period (time_rel_pri_flat_comm), 3 for time primary individual becomes infectious (time_rel_pri_infectious), 4 for end of communicable period for primary individual (time_rel_pri_end_comm), 5 for test results for primary individual (time_rel_pri_test_results), 7 for the time of the snapshot of current infections (seeds).\n");
   printf("\t\t\tBit 3: Indicates if a timeline is included for positive test results.\n");
 #ifdef SEC_INF_TIMELINES
   printf("\t\t\tBit 4: Indicates that second series of timelines is included for the second category of infection.\n");
 #endif
+  printf("\t\t\tBit 5: Indicates that the simulation path records are encoded.\n");
+  printf("\t\t\tBit 6: Indicates that only the paths selected by the output selection options are written.\n");
+  printf("\t\t-Unsigned 64 bit value: Field is written only if bit 6 is set. Value is the number of simulated paths that are not written.\n");
 
   printf("\n\tSimulation path records:\n");
   printf("\t\t-Unsigned 32 bit value: The number of written successive time bins.\n");
@@ -532,4 +926,22 @@ void printusage(const char* name)
   printf("\t\t-Unsigned 32 bit value, for each time bin, chronologically written: Number of new infections for the second category of infection.\n");
   printf("\t\t-Unsigned 32 bit value, for each time bin, chronologically written (written only if indicated in the file header): Number of new positive test results for the second category of infection.\n");
 #endif
+
+  printf("\n\tEncoded simulation path records:\n");
+  printf("\t\tThe fields are the same as for the raw records, but each one is stored as an unsigned LEB128 varint (7 bits per byte, least significant group first, with the most significant bit of a byte set when more bytes follow). The two signed fields are zig-zag mapped ((v<<1)^(v>>31)) first.\n");
+  printf("\t\tEach timeline is stored as a sequence of varint tokens describing the differences between successive bins, starting from a value of 0 before the first bin. A token with its least significant bit set describes a run of (token>>1)+1 zero differences, and a token with its least significant bit cleared describes a single difference whose zig-zag mapped value is token>>1.\n");
+
+  printf("\n\nBINARY TRANSMISSION TREE OUTPUT FILE:\n");
+  printf("\n\tThe file does not have a header. Each simulation path record contains one node per infectious individual, in the order the individuals are created, such that a parent node always precedes its children. All times are in minutes, relative to the time origin of the timeline output, and varints are encoded as for the encoded timeline records.\n");
+  printf("\n\tSimulation path records:\n");
+  printf("\t\t-Unsigned 32 bit little endian value: Size of the rest of the record in bytes.\n");
+  printf("\t\t-Varint: Number of nodes.\n");
+  printf("\t\t-Varint, for each node: Distance between the node index and the index of its parent, or 0 for primary individuals.\n");
+  printf("\t\t-Zig-zag mapped varint, for each node: Difference between the generation of the node and the generation of the previous node (or the generation itself for the first node, primary individuals being of generation 1).\n");
+  printf("\t\t-Zig-zag mapped varint, for each node: Difference between the infection time and the infection time of the parent (or 0 for primary individuals).\n");
+  printf("\t\t-Varint, for each node: Latent period, as the difference between the end of the latent period and the infection time.\n");
+  printf("\t\t-Varint, for each node: Communicable period, as the difference between the end of the communicable period and the end of the latent period.\n");
+  printf("\t\t-Varint, for each node: Communicable period type flags (1: main, 2: alternate, 4: interrupted, 8: true positive test).\n");
+  printf("\t\t-Varint, for each node: Index of the parent's transmission event that generated the infection, among the parent's events with infections (0 for primary individuals).\n");
+  printf("\t\t-Varint, for each node: Number of infections generated by the individual, including the infections that occur after tmax.\n");
 }
@@ -17,6 +17,21 @@
 #include "args.h"
 #include "simulation.h"
 #include "model_parameters.h"
+#include "log_histogram.h"
+#include "linear_histogram.h"
+#include "path_selection.h"
+#include "adaptive_stopping.h"
+#include "prior_sampling.h"
+#include "standard_summary_stats.h"
+#include "abc.h"
+#include "seeds.h"
+
+#define FIXED_SETS_STREAM_STRIDE (UINT32_C(1)<<20)	//!< Number of RNG streams reserved for each stream index when path sets have a fixed size
+
+/**
+ * Summary statistics output sections.
+ */
+enum ro_output_flags {ro_output_inf=1, ro_output_newinf=2, ro_output_newpostest=4, ro_output_reff=8, ro_output_reffobs=16, ro_output_all=31};
 
 /**
  * @brief Struct used to store configuration parmeters.
@@ -24,22 +39,71 @@
 typedef struct
 {
 model_pars pars; 		//!< Simulation parameters
+model_pars basepars;		//!< Simulation parameters from the command line, before they are solved.
 bool ninfhist;			//!< Request or the generation of a histogram of number of infections.
+uint32_t outputs;		//!< Requested timeline outputs (value set using ro_output_flags). Statistics for unrequested outputs are not computed.
+double* tlquantiles;		//!< Cumulative probabilities of the timeline quantiles to be reported.
+uint32_t ntlquantiles;		//!< Number of timeline quantiles to be reported. Timeline quantile sketches are not computed if 0.
+uint32_t tlqprecbits;		//!< Number of precision bits for the timeline quantile sketches.
+bool pathhists;			//!< Request for the generation of histograms of per-path final size, peak prevalence, peak time and extinction time.
+uint32_t phprecbits;		//!< Number of precision bits for the final size and peak prevalence histograms.
+double phtmin;			//!< Lower edge of the peak time and extinction time histograms.
 uint32_t npaths;		//!< Number of simulation paths.
 uint32_t lmax;			//!< Maximum number of layers for the simulation. lmax=1 means only primary infectious individuals.
+bool timeordered;		//!< Use the time-ordered branching simulation.
+double tscheck;			//!< Time at which each time-ordered path is suspended to check that it resumes identically, or NaN.
+ts_seed* seeds;			//!< Snapshot of current infections the paths start from, or NULL to start from primary individuals.
+uint32_t nseeds;		//!< Number of individuals in the snapshot of current infections.
 int32_t nbinsperunit;		//!< Number of timeline bins per unit of time.
 uint32_t nimax;			//!< Maximum number of infectious individuals for a given time integet interval.
 uint32_t npostestmax;		//!< Maximum number of positive test results during an interval of duration npostestmaxnunits for each individual that starts when the test results are received.
 uint32_t npostestmaxnunits;      //!< Interval duration for the maximum number of positive test results
 uint32_t nthreads;		//!< Number of threads used to perform the simulation.
-uint32_t nsetsperthread;	//!< Number of path sets used for each thread.
+uint32_t nsetsperthread;	//!< Number of shares of paths per thread used to form path sets.
+uint32_t nsets;			//!< Total number of shares of paths used to form path sets. nthreads*nsetsperthread shares are used if 0.
+uint32_t setsize;		//!< Number of paths of each path set, or 0 to form the path sets from shares of paths.
+char* accoutname;		//!< Accumulator file name written at the end of the simulation, or NULL.
+char* topupname;		//!< Accumulator file name of the result extended by the simulation, or NULL.
+uint32_t shard;			//!< Index of the shard of path sets simulated by the process.
+uint32_t nshards;		//!< Number of shards the path sets are partitioned into, or 0 to simulate all the path sets.
+char** mergenames;		//!< Names of the partial accumulator files merged instead of simulating paths.
+uint32_t nmergenames;		//!< Number of partial accumulator files to merge.
+char* cachedir;			//!< Result cache directory, or NULL if results are not cached.
+char* sweepname;		//!< Sweep file name, or NULL to simulate a single parameter point.
+char* sweepoutname;		//!< Sweep result file name.
+param_prior* priors;		//!< Prior distributions of the parameters sampled for each path.
+uint32_t npriors;		//!< Number of sampled parameters.
+char* prioroutname;		//!< File name used to record the sampled parameters and the outcome of each path, or NULL.
+uint32_t* abcobs;		//!< Observed series for ABC, or NULL if ABC is not performed.
+uint32_t abcnobs;		//!< Number of timeline bins of the observed series.
+uint32_t abcchan;		//!< Timeline channel compared with the observed series (std_stats_tl_inf, std_stats_tl_newinf or std_stats_tl_postest).
+uint32_t abcdist;		//!< Distance between the timeline and the observed series (value set using std_stats_obs_dists).
+double abceps;			//!< Tolerance of the first ABC generation.
+uint32_t abcngens;		//!< Number of ABC generations.
+double abcquantile;		//!< Quantile of the distances of a generation used as the tolerance of the next generation.
+char* abcoutname;		//!< File name used to record the final ABC population, or NULL.
 uint32_t stream;		//!< RNG stream index.
+precision_target* targets;	//!< Precision targets. npaths is the maximum number of paths if any is set.
+uint32_t ntargets;		//!< Number of precision targets.
+uint32_t targetminsets;		//!< Minimum number of path sets before the precision targets are checked.
+char* ckptname;			//!< Checkpoint file name, or NULL if checkpoints are not written.
+double ckptinterval;		//!< Interval between periodic checkpoints, in seconds, or 0 to only write checkpoints on signals.
+bool resume;			//!< Resume the simulation from the checkpoint file if it exists.
 uint32_t tloutbufsize;		//!< Per-thread memory buffer size (in MB) used to accumulate data for timeline output before writing them to disk.
 int tlout;			//!< File descriptor used to record timeline data for each simulated path.
+char* tloutname;		//!< File name used to record timeline data for each simulated path.
+bool tlencode;			//!< Write the timeline records in the encoded format.
 #ifdef CT_OUTPUT
 uint32_t ctoutbufsize;		//!< Per-thread memory buffer size (in MB) used to accumulate data for contact tracing output before writing them to disk.
 int ctout;			//!< File descriptor used to CT data for each simulated path.
+char* ctoutname;		//!< File name used to record CT data for each simulated path.
 #endif
+uint32_t treeoutbufsize;	//!< Per-thread memory buffer size (in MB) used to accumulate data for transmission tree output before writing them to disk.
+int treeout;			//!< File descriptor used to record the transmission tree of each simulated path.
+char* treeoutname;		//!< File name used to record the transmission tree of each simulated path.
+bool outshards;			//!< Write the outputs as one shard file per thread, described by a manifest.
+bool outindex;			//!< Write a path index sidecar file for each output file.
+path_selection outsel;		//!< Selection of the paths written to the timeline, contact tracing and transmission tree outputs.
 int oout;			//!< File descriptor for the standard output.
 int eout;			//!< File descriptor for the standard error.
 } config_pars;
@@ -9,664 +9,1460 @@
 #include <math.h>
 
 #include "main.h"
+#include "rngstream_gsl.h"
 
 int main(const int nargs, const char* args[])
 {
-  config_pars cp={.ninfhist=false, .npaths=10000, .lmax=UINT32_MAX, .nbinsperunit=1, .nimax=UINT32_MAX, .npostestmax=UINT32_MAX, .npostestmaxnunits=1, .nthreads=1, .stream=0, .tloutbufsize=10, .tlout=0, 
+  config_pars cp={.ninfhist=false, .outputs=ro_output_all, .tlquantiles=NULL, .ntlquantiles=0, .tlqprecbits=LHIST_DEFAULT_PRECBITS, .pathhists=false, .phprecbits=LHIST_DEFAULT_PRECBITS, .phtmin=NAN, .npaths=10000, .lmax=UINT32_MAX, .timeordered=false, .tscheck=NAN, .seeds=NULL, .nseeds=0, .nbinsperunit=1, .nimax=UINT32_MAX, .npostestmax=UINT32_MAX, .npostestmaxnunits=1, .nthreads=1, .nsets=0, .stream=0, .targets=NULL, .ntargets=0, .targetminsets=ADAPTIVE_DEFAULT_MINSETS, .setsize=0, .accoutname=NULL, .topupname=NULL, .shard=0, .nshards=0, .mergenames=NULL, .nmergenames=0, .cachedir=NULL, .sweepname=NULL, .sweepoutname=NULL, .priors=NULL, .npriors=0, .prioroutname=NULL, .abcobs=NULL, .abcnobs=0, .abcchan=std_stats_tl_postest, .abcdist=std_stats_obs_l2, .abceps=INFINITY, .abcngens=1, .abcquantile=0.5, .abcoutname=NULL, .ckptname=NULL, .ckptinterval=3600, .resume=false, .tloutbufsize=10, .tlout=0, .tloutname=NULL, 
 #ifdef CT_OUTPUT
     .ctoutbufsize=10, 
     .ctout=0, 
+    .ctoutname=NULL, 
 #endif
-    .oout=STDOUT_FILENO, .eout=STDERR_FILENO};
+    .treeoutbufsize=10, .treeout=0, .treeoutname=NULL, .tlencode=false, .outshards=false, .outindex=false, .oout=STDOUT_FILENO, .eout=STDERR_FILENO};
   cp.nsetsperthread=(cp.nthreads>1?100:1);
-  pthread_mutex_t tlflock;
+  async_writer tlaw;
 #ifdef CT_OUTPUT
-  pthread_mutex_t ctflock;
+  async_writer ctaw;
 #endif
+  async_writer treeaw;
 
   sim_pars_init(&cp.pars);
+  pathsel_init(&cp.outsel);
 
   if(config(&cp, nargs-1, args+1)) return 1;
 
+  //The snapshot of current infections defines the time origin
+  if(cp.seeds) {
+
+    if(cp.pars.popsize>0 || cp.pars.timetype!=ro_time_pri_created) {
+      fprintf(stderr,"%s: Error: seeds is only supported for the branching simulation and cannot be used with the time origin options\n",args[0]);
+      return 1;
+    }
+    cp.pars.timetype=ro_time_snapshot;
+    cp.timeordered=true;
+  }
+  //The parameters of each sweep point and of each prior draw are solved
+  //from the command line ones
+  cp.basepars=cp.pars;
+
   if(model_solve_pars(&cp.pars)) return 1;
 
   gsl_rng_env_setup();
 
-  rng_skipstreams(cp.nthreads*cp.stream);
-
   if(model_pars_check(&cp.pars)) {
     fprintf(stderr,"%s: Error: While verifying the validity of the simulation parameters.\n",args[0]);
     return 1;
   }
 
-  if(cp.tlout) {
-    pthread_mutex_init(&tlflock, NULL);
-    uint32_t ubuf=htole32(cp.nbinsperunit*cp.pars.tmax);
+  if(pathsel_postest(&cp.outsel) && isnan(cp.pars.tdeltat)) {
+    fprintf(stderr,"%s: Error: outminpostesttime and outmaxpostesttime require tdeltat\n",args[0]);
+    return 1;
+  }
+
+  if(cp.outsel.sample && cp.outshards) {
+    fprintf(stderr,"%s: Error: outsample cannot be used with outshards\n",args[0]);
+    return 1;
+  }
+
+  //The parent event indices of the transmission tree nodes rely on the
+  //depth-first order of the branching simulation
+  if(cp.treeout && cp.pars.popsize>0) {
+    fprintf(stderr,"%s: Error: treeout is only supported for the branching simulation\n",args[0]);
+    return 1;
+  }
+
+  if(cp.timeordered && cp.pars.popsize>0) {
+    fprintf(stderr,"%s: Error: timeordered is only supported for the branching simulation\n",args[0]);
+    return 1;
+  }
+
+  if(!isnan(cp.tscheck) && !cp.timeordered) {
+    fprintf(stderr,"%s: Error: tscheck requires timeordered\n",args[0]);
+    return 1;
+  }
+
+  //The output path selection only applies to the timeline, contact tracing
+  //and transmission tree outputs
+#ifdef CT_OUTPUT
+  if(!cp.tlout && !cp.ctout && !cp.treeout) pathsel_init(&cp.outsel);
+#else
+  if(!cp.tlout && !cp.treeout) pathsel_init(&cp.outsel);
+#endif
+
+  if(isnan(cp.pars.tdeltat)) cp.outputs&=~(ro_output_newpostest|ro_output_reffobs);
+#ifndef OBSREFF_OUTPUT
+  cp.outputs&=~ro_output_reffobs;
+#endif
+
+  if(cp.ntargets) {
+    static const uint32_t tloutputs[3]={ro_output_inf, ro_output_newinf, ro_output_newpostest};
+
+#ifdef CT_OUTPUT
+    if(cp.tlout || cp.ctout || cp.treeout) {
+#else
+    if(cp.tlout || cp.treeout) {
+#endif
+      fprintf(stderr,"%s: Error: Precision targets cannot be used with the timeline, contact tracing and transmission tree outputs\n",args[0]);
+      return 1;
+    }
+
+    uint32_t i;
+
+    for(i=0; i<cp.ntargets; ++i) if(cp.targets[i].quantity>=ro_target_inf && !(cp.outputs&tloutputs[cp.targets[i].quantity-ro_target_inf])) {
+      fprintf(stderr,"%s: Error: The timeline of a targettl precision target is not part of the computed outputs\n",args[0]);
+      return 1;
+    }
+  }
+
+  if(cp.ckptname) {
+
+    if(cp.ntargets) {
+      fprintf(stderr,"%s: Error: checkpoint cannot be used with precision targets\n",args[0]);
+      return 1;
+    }
+
+#ifdef CT_OUTPUT
+    if((cp.tlout || cp.ctout || cp.treeout) && !cp.outshards) {
+#else
+    if((cp.tlout || cp.treeout) && !cp.outshards) {
+#endif
+      fprintf(stderr,"%s: Error: checkpoint requires outshards with the timeline, contact tracing and transmission tree outputs\n",args[0]);
+      return 1;
+    }
+
+  } else if(cp.resume) {
+    fprintf(stderr,"%s: Error: resume requires checkpoint\n",args[0]);
+    return 1;
+  }
+
+  if(cp.setsize) {
+
+    if(cp.ntargets) {
+      fprintf(stderr,"%s: Error: setsize cannot be used with precision targets\n",args[0]);
+      return 1;
+    }
+
+  } else if(cp.accoutname || cp.topupname || cp.nshards || cp.nmergenames || cp.cachedir) {
+    fprintf(stderr,"%s: Error: accout, topup, shard, merge and cachedir require setsize\n",args[0]);
+    return 1;
+  }
+
+  if(cp.nshards) {
+
+    if(!cp.accoutname) {
+      fprintf(stderr,"%s: Error: shard requires accout\n",args[0]);
+      return 1;
+    }
+
+    if(cp.topupname || cp.nmergenames) {
+      fprintf(stderr,"%s: Error: shard cannot be used with topup and merge\n",args[0]);
+      return 1;
+    }
+  }
+
+  if(cp.nmergenames) {
+
+    if(cp.topupname || cp.ckptname) {
+      fprintf(stderr,"%s: Error: merge cannot be used with topup and checkpoint\n",args[0]);
+      return 1;
+    }
+
+#ifdef CT_OUTPUT
+    if(cp.tlout || cp.ctout || cp.treeout) {
+#else
+    if(cp.tlout || cp.treeout) {
+#endif
+      fprintf(stderr,"%s: Error: merge cannot be used with the timeline, contact tracing and transmission tree outputs\n",args[0]);
+      return 1;
+    }
+  }
+
+  if(cp.cachedir) {
+
+    if(cp.accoutname || cp.topupname || cp.nshards || cp.nmergenames) {
+      fprintf(stderr,"%s: Error: cachedir cannot be used with accout, topup, shard and merge\n",args[0]);
+      return 1;
+    }
+
+#ifdef CT_OUTPUT
+    if(cp.tlout || cp.ctout || cp.treeout) {
+#else
+    if(cp.tlout || cp.treeout) {
+#endif
+      fprintf(stderr,"%s: Error: cachedir cannot be used with the timeline, contact tracing and transmission tree outputs\n",args[0]);
+      return 1;
+    }
+
+    if(cp.npaths%cp.setsize) {
+      fprintf(stderr,"%s: Error: cachedir requires a number of paths that is a multiple of setsize\n",args[0]);
+      return 1;
+    }
+  }
+
+  if(cp.sweepname) {
+
+    if(!cp.sweepoutname) {
+      fprintf(stderr,"%s: Error: sweep requires sweepout\n",args[0]);
+      return 1;
+    }
+
+    if(cp.npriors || cp.abcobs || cp.accoutname || cp.topupname || cp.nshards || cp.nmergenames || cp.cachedir || cp.ckptname || cp.ntargets) {
+      fprintf(stderr,"%s: Error: sweep cannot be used with prior, abcobs, accout, topup, shard, merge, cachedir, checkpoint and precision targets\n",args[0]);
+      return 1;
+    }
+
+#ifdef CT_OUTPUT
+    if(cp.tlout || cp.ctout || cp.treeout) {
+#else
+    if(cp.tlout || cp.treeout) {
+#endif
+      fprintf(stderr,"%s: Error: sweep cannot be used with the timeline, contact tracing and transmission tree outputs\n",args[0]);
+      return 1;
+    }
+    const int ret=sweep_run(&cp,args[0]);
+
+    free(cp.tlquantiles);
+    free(cp.sweepname);
+    free(cp.sweepoutname);
+    fflush(stdout);
+    fflush(stderr);
+    close(cp.oout);
+    close(cp.eout);
+    return ret;
+
+  } else if(cp.sweepoutname) {
+    fprintf(stderr,"%s: Error: sweepout requires sweep\n",args[0]);
+    return 1;
+  }
+
+  if(cp.abcobs) {
+
+    if(!cp.npriors) {
+      fprintf(stderr,"%s: Error: abcobs requires prior\n",args[0]);
+      return 1;
+    }
+
+    if(cp.prioroutname || cp.setsize || cp.accoutname || cp.topupname || cp.nshards || cp.nmergenames || cp.cachedir || cp.ckptname || cp.ntargets) {
+      fprintf(stderr,"%s: Error: abcobs cannot be used with priorout, setsize, accout, topup, shard, merge, cachedir, checkpoint and precision targets\n",args[0]);
+      return 1;
+    }
+
+#ifdef CT_OUTPUT
+    if(cp.tlout || cp.ctout || cp.treeout) {
+#else
+    if(cp.tlout || cp.treeout) {
+#endif
+      fprintf(stderr,"%s: Error: abcobs cannot be used with the timeline, contact tracing and transmission tree outputs\n",args[0]);
+      return 1;
+    }
+
+    //Early rejection relies on timelines that can only increase during a path
+    if(cp.nimax<UINT32_MAX || cp.npostestmax<UINT32_MAX || cp.pars.timetype==ro_time_first_pos_test_results) {
+      fprintf(stderr,"%s: Error: abcobs cannot be used with nimax, npostestmax and a time relative to the first positive test results\n",args[0]);
+      return 1;
+    }
+
+    if(cp.abcchan==std_stats_tl_postest && isnan(cp.pars.tdeltat)) {
+      fprintf(stderr,"%s: Error: The newpostest ABC timeline requires tdeltat\n",args[0]);
+      return 1;
+    }
+
+    if(cp.abcnobs>cp.nbinsperunit*cp.pars.tmax) {
+      fprintf(stderr,"%s: Error: The observed series cannot be longer than the %" PRIu32 " timeline bins\n",args[0],(uint32_t)(cp.nbinsperunit*cp.pars.tmax));
+      return 1;
+    }
+
+    if(!cp.abcngens || !(cp.abceps>=0) || !(cp.abcquantile>0 && cp.abcquantile<=1)) {
+      fprintf(stderr,"%s: Error: abcgens must be positive, abceps must be non-negative and abcquantile must be in the interval (0,1]\n",args[0]);
+      return 1;
+    }
+    const int ret=abc_run(&cp,args[0]);
+
+    free(cp.tlquantiles);
+    free(cp.priors);
+    free(cp.abcobs);
+    free(cp.abcoutname);
+    fflush(stdout);
+    fflush(stderr);
+    close(cp.oout);
+    close(cp.eout);
+    return ret;
+
+  } else if(cp.abcoutname) {
+    fprintf(stderr,"%s: Error: abcout requires abcobs\n",args[0]);
+    return 1;
+  }
+
+  if(cp.prioroutname) {
+
+    if(!cp.npriors) {
+      fprintf(stderr,"%s: Error: priorout requires prior\n",args[0]);
+      return 1;
+    }
+
+    //The records of the completed path sets are not checkpointed
+    if(cp.ckptname) {
+      fprintf(stderr,"%s: Error: priorout cannot be used with checkpoint\n",args[0]);
+      return 1;
+    }
+  }
+  sigset_t cksigs;
+
+  //The checkpoint signals must be blocked before any thread is created
+  if(cp.ckptname) ckpt_block_signals(&cksigs);
+  const bool resuming=(cp.resume && access(cp.ckptname,F_OK)==0);
+
+  if(isnan(cp.phtmin)) cp.phtmin=(cp.pars.timetype==ro_time_pri_created || cp.pars.timetype==ro_time_pri_flat_comm?0:-cp.pars.tmax);
+
+  ckpt_buffer accbuf;
+  uint32_t accfirst=0, accend=0;
+
+  ckbuf_init(&accbuf);
+
+  //A cached result is extended as a top-up run, and the new result is
+  //written to the cache as an accumulator file
+  if(cp.cachedir) {
+    const uint32_t ntotsets=cp.npaths/cp.setsize;
+    uint32_t ncachedsets;
+
+    if(rcache_open(cp.cachedir)) return 1;
+    put_stats_config(&accbuf,&cp);
+    const uint64_t key=rcache_key(&accbuf);
+    ckbuf_free(&accbuf);
+
+    if((ncachedsets=rcache_lookup(cp.cachedir,key,ntotsets))) {
+      cp.topupname=rcache_entry_name(cp.cachedir,key,ncachedsets);
+      cp.npaths-=ncachedsets*cp.setsize;
+    }
+
+    if(ncachedsets<ntotsets) cp.accoutname=rcache_entry_name(cp.cachedir,key,ntotsets);
+  }
+
+  //The number of paths of a top-up run is the number of new paths
+  if(cp.topupname) {
+
+    if(acc_read(cp.topupname,&cp,&accbuf,&accfirst,&accend)) return 1;
+
+    if(accfirst) {
+      fprintf(stderr,"%s: Error: The path sets of accumulator file '%s' do not start at the first set\n",args[0],cp.topupname);
+      return 1;
+    }
+
+    if((uint64_t)accend*cp.setsize+cp.npaths>UINT32_MAX) {
+      fprintf(stderr,"%s: Error: The total number of paths of the top-up run exceeds %" PRIu32 "\n",args[0],UINT32_MAX);
+      return 1;
+    }
+    cp.npaths+=accend*cp.setsize;
+  }
+
+  if(cp.setsize) {
+
+    if(fixed_path_sets(cp.npaths,cp.setsize,NULL)>FIXED_SETS_STREAM_STRIDE) {
+      fprintf(stderr,"%s: Error: The number of path sets cannot exceed %" PRIu32 "\n",args[0],FIXED_SETS_STREAM_STRIDE);
+      return 1;
+    }
+
+    //Only complete sets can be extended by a later top-up run
+    if(cp.accoutname && cp.npaths%cp.setsize) {
+      fprintf(stderr,"%s: Error: accout requires a total number of paths that is a multiple of setsize\n",args[0]);
+      return 1;
+    }
+
+    if(fixed_path_sets(cp.npaths,cp.setsize,NULL)<cp.nshards) {
+      fprintf(stderr,"%s: Error: shard requires at least as many path sets as shards\n",args[0]);
+      return 1;
+    }
+  }
+
+  thread_data* tdata=(thread_data*)malloc(cp.nthreads*sizeof(thread_data));
+  char** tlshardnames=NULL;
+#ifdef CT_OUTPUT
+  char** ctshardnames=NULL;
+#endif
+  char** treeshardnames=NULL;
+  const uint32_t tlnpers=cp.nbinsperunit*cp.pars.tmax;
+#ifdef SEC_INF_TIMELINES
+  const uint8_t tlflags=cp.pars.timetype|((!isnan(cp.pars.tdeltat))<<3)|TLO_FLAG_SECINF|(cp.tlencode?TLO_FLAG_ENCODED:0)|(pathsel_active(&cp.outsel)?TLO_FLAG_SELECTED:0);
+#else
+  const uint8_t tlflags=cp.pars.timetype|((!isnan(cp.pars.tdeltat))<<3)|(cp.tlencode?TLO_FLAG_ENCODED:0)|(pathsel_active(&cp.outsel)?TLO_FLAG_SELECTED:0);
+#endif
+  int tlidx=-1;
+  int t;
+
+  if(cp.tlout) {
+
+    if(cp.outshards) {
+      tlshardnames=(char**)malloc(cp.nthreads*sizeof(char*));
+
+      for(t=cp.nthreads-1; t>=0; --t) {
+
+	if((tdata[t].tlshard=open_shard(cp.tloutname,t,resuming,tlshardnames+t))<0 || (!resuming && tlo_write_header(tdata[t].tlshard,tlnpers,tlflags))) return 1;
+
+	if(cp.outindex && (tlidx=open_index(tlshardnames[t],OIDX_KIND_TLOUT,resuming))<0) return 1;
+	oidx_writer_init(&tdata[t].tlidx,tlidx,tlo_header_size(tlflags));
+      }
+
+    } else {
+
+      if(tlo_write_header(cp.tlout,tlnpers,tlflags)) return 1;
+
+      //Each compute thread can fill a buffer while another one is being written
+      if(awriter_init(&tlaw,cp.tlout,cp.tloutbufsize*INT64_C(1024*1024),2*cp.nthreads)) return 1;
+
+      if(cp.outindex && (tlidx=open_index(cp.tloutname,OIDX_KIND_TLOUT,false))<0) return 1;
+
+      for(t=cp.nthreads-1; t>=0; --t) oidx_writer_init(&tdata[t].tlidx,tlidx,0);
+    }
+  }
+
+#ifdef CT_OUTPUT
+  int ctidx=-1;
+
+  if(cp.ctout) {
+
+    if(cp.outshards) {
+      ctshardnames=(char**)malloc(cp.nthreads*sizeof(char*));
+
+      for(t=cp.nthreads-1; t>=0; --t) {
+
+	if((tdata[t].ctshard=open_shard(cp.ctoutname,t,resuming,ctshardnames+t))<0) return 1;
+
+	if(cp.outindex && (ctidx=open_index(ctshardnames[t],OIDX_KIND_CTOUT,resuming))<0) return 1;
+	oidx_writer_init(&tdata[t].ctidx,ctidx,0);
+      }
+
+    } else {
+
+      if(awriter_init(&ctaw,cp.ctout,cp.ctoutbufsize*INT64_C(1024*1024),2*cp.nthreads)) return 1;
+
+      if(cp.outindex && (ctidx=open_index(cp.ctoutname,OIDX_KIND_CTOUT,false))<0) return 1;
+
+      for(t=cp.nthreads-1; t>=0; --t) oidx_writer_init(&tdata[t].ctidx,ctidx,0);
+    }
+  }
+#endif
+
+  int treeidx=-1;
+
+  if(cp.treeout) {
+
+    if(cp.outshards) {
+      treeshardnames=(char**)malloc(cp.nthreads*sizeof(char*));
+
+      for(t=cp.nthreads-1; t>=0; --t) {
+
+	if((tdata[t].treeshard=open_shard(cp.treeoutname,t,resuming,treeshardnames+t))<0) return 1;
+
+	if(cp.outindex && (treeidx=open_index(treeshardnames[t],OIDX_KIND_TREEOUT,resuming))<0) return 1;
+	oidx_writer_init(&tdata[t].treeidx,treeidx,0);
+      }
+
+    } else {
+
+      if(awriter_init(&treeaw,cp.treeout,cp.treeoutbufsize*INT64_C(1024*1024),2*cp.nthreads)) return 1;
+
+      if(cp.outindex && (treeidx=open_index(cp.treeoutname,OIDX_KIND_TREEOUT,false))<0) return 1;
+
+      for(t=cp.nthreads-1; t>=0; --t) oidx_writer_init(&tdata[t].treeidx,treeidx,0);
+    }
+  }
+
+  int j;
+  const uint32_t nshares=(cp.nsets?cp.nsets:(cp.ntargets?ADAPTIVE_DEFAULT_NSETS:cp.nthreads*cp.nsetsperthread));
+  //Precision targets use sets of equal size as batches
+  const uint32_t nsets=(cp.setsize?fixed_path_sets(cp.npaths,cp.setsize,NULL):(cp.ntargets?(nshares<cp.npaths?nshares:cp.npaths):guided_path_sets(cp.npaths,nshares,NULL)));
+  //The sets stored in an accumulator file must be complete subtrees of the
+  //set merging tree
+  const uint32_t treesize=(cp.accoutname?pow2_ceil(nsets):nsets);
+  //Sets loaded from accumulator files are not simulated
+  const uint32_t firstset=(cp.nmergenames?nsets:(cp.nshards?(uint64_t)cp.shard*nsets/cp.nshards:accend));
+  const uint32_t endset=(cp.nmergenames?nsets:(cp.nshards?(uint64_t)(cp.shard+1)*nsets/cp.nshards:nsets));
+  uint32_t* setfirstpath=(uint32_t*)malloc((nsets+1)*sizeof(uint32_t));
+  const uint32_t npers=cp.nbinsperunit*cp.pars.tmax;
+  volatile uint32_t set=firstset+cp.nthreads;
+  set_data* sdata=(set_data*)malloc(nsets*sizeof(set_data));
+  //The set tree has fewer than 2*treesize merging nodes
+  volatile uint32_t* nmerges=(volatile uint32_t*)malloc(2*treesize*sizeof(uint32_t));
+  rng_stream* streams=(rng_stream*)malloc(nsets*sizeof(rng_stream));
+  double tstart=0, tjoin=0, tidle=0;
+
+  adaptive_stopping as;
+  const uint32_t maxnpaths=cp.npaths;
+
+  if(cp.setsize) fixed_path_sets(cp.npaths,cp.setsize,setfirstpath);
+
+  else if(cp.ntargets) {
+    equal_path_sets(cp.npaths,nsets,setfirstpath);
+    adaptive_init(&as,cp.targets,cp.ntargets,cp.targetminsets,nsets);
+
+  } else guided_path_sets(cp.npaths,nshares,setfirstpath);
+  const uint32_t firstpath=setfirstpath[firstset];
+  const uint32_t endpath=setfirstpath[endset];
+  double* priorrecs=(cp.prioroutname?(double*)malloc((uint64_t)(endpath-firstpath)*(cp.npriors+PRIOR_REC_NOUTCOMES)*sizeof(double)):NULL);
+  memset((uint32_t*)nmerges,0,2*treesize*sizeof(uint32_t));
+  init_set_streams(&cp,nsets,streams);
+
+  ckpt_run cr;
+  checkpointer ck;
+  uint32_t nresumed=0;
+
+  if(cp.ckptname) {
+    cr.cp=&cp;
+    cr.nshares=nshares;
+    cr.nsets=nsets;
+    cr.firstset=firstset;
+    cr.endset=endset;
+    cr.treesize=treesize;
+    cr.setstate=(uint8_t*)calloc(nsets,sizeof(uint8_t));
+    cr.sdata=sdata;
+    cr.nmerges=nmerges;
+    cr.tdata=tdata;
+    pthread_rwlock_init(&cr.lock,NULL);
+  }
+
+  for(t=cp.nthreads-1; t>=0; --t){
+    tdata[t].cp=&cp;
+    tdata[t].setfirstpath=setfirstpath;
+    tdata[t].id=t;
+    tdata[t].nsets=nsets;
+    tdata[t].firstset=firstset;
+    tdata[t].endset=endset;
+    tdata[t].treesize=treesize;
+    tdata[t].nbinsperunit=cp.nbinsperunit;
+    tdata[t].npers=npers;
+    tdata[t].set=&set;
+    tdata[t].sdata=sdata;
+    tdata[t].nmerges=nmerges;
+    tdata[t].streams=streams;
+    //tdata[t].r = gsl_rng_alloc(gsl_rng_taus2);
+    tdata[t].r = gsl_rng_alloc(rngstream_gsl);
+    //rng_writestatefull((rng_stream*)tdata[t].r->state);
+    tdata[t].tlaw = (cp.tlout && !cp.outshards?&tlaw:NULL);
+#ifdef CT_OUTPUT
+    tdata[t].ctaw = (cp.ctout && !cp.outshards?&ctaw:NULL);
+#endif
+    tdata[t].treeaw = (cp.treeout && !cp.outshards?&treeaw:NULL);
+    tdata[t].npaths = 0;
+    tdata[t].nwritten = 0;
+    reservoir_init(&tdata[t].sample,cp.outsel.sample);
+    tdata[t].as = (cp.ntargets?&as:NULL);
+    tdata[t].setstate = (cp.ckptname?cr.setstate:NULL);
+    tdata[t].cklock = &cr.lock;
+    tdata[t].priorrecs = priorrecs;
+    tdata[t].npriorsolves = 0;
+    tdata[t].abcpop = NULL;
+    tdata[t].abcdists = NULL;
+    tdata[t].nabcrejected = 0;
+
+    //The progress of the threads includes the index writers of all outputs
+    if(!cp.tlout) oidx_writer_init(&tdata[t].tlidx,-1,0);
+#ifdef CT_OUTPUT
+    if(!cp.ctout) oidx_writer_init(&tdata[t].ctidx,-1,0);
+#else
+    oidx_writer_init(&tdata[t].ctidx,-1,0);
+#endif
+    if(!cp.treeout) oidx_writer_init(&tdata[t].treeidx,-1,0);
+    save_progress(tdata+t);
+  }
+
+  //A checkpoint includes the statistics loaded from the accumulator file
+  if(cp.topupname && !resuming) {
+
+    if(acc_load(&accbuf,&cp,sdata,0,firstset)) {
+      fprintf(stderr,"%s: Error: Cannot load accumulator file '%s'\n",args[0],cp.topupname);
+      return 1;
+    }
+
+    if(cp.ckptname) {
+      memset(cr.setstate,ro_set_merged,firstset*sizeof(uint8_t));
+
+      for(j=0; j<firstset; j+=UINT32_C(1)<<set_block_level(j,firstset)) cr.setstate[j]=ro_set_live;
+    }
+    reduce_blocks(tdata,0,firstset);
+  }
+  ckbuf_free(&accbuf);
+
+  //The partial accumulator files must cover each set exactly once
+  if(cp.nmergenames) {
+    uint8_t* loaded=(uint8_t*)calloc(nsets,sizeof(uint8_t));
+    uint32_t first, end, s;
+
+    for(j=0; j<cp.nmergenames; ++j) {
+
+      if(acc_read(cp.mergenames[j],&cp,&accbuf,&first,&end)) return 1;
+
+      if(end>nsets) {
+	fprintf(stderr,"%s: Error: The path sets of accumulator file '%s' exceed the %" PRIu32 " path sets of the simulation\n",args[0],cp.mergenames[j],nsets);
+	return 1;
+      }
+
+      for(s=first; s<end; ++s) if(loaded[s]++) {
+	fprintf(stderr,"%s: Error: Path set %" PRIu32 " of accumulator file '%s' is also stored in another file\n",args[0],s,cp.mergenames[j]);
+	return 1;
+      }
+
+      if(acc_load(&accbuf,&cp,sdata,first,end)) {
+	fprintf(stderr,"%s: Error: Cannot load accumulator file '%s'\n",args[0],cp.mergenames[j]);
+	return 1;
+      }
+      ckbuf_free(&accbuf);
+      reduce_blocks(tdata,first,end);
+    }
+
+    for(s=0; s<nsets; ++s) if(!loaded[s]) {
+      fprintf(stderr,"%s: Error: Path set %" PRIu32 " is not stored in any accumulator file\n",args[0],s);
+      return 1;
+    }
+    free(loaded);
+  }
+
+  if(resuming) {
+    ckpt_buffer buf;
+    int ret=ckpt_read(cp.ckptname,CKPT_MAGIC,&buf);
+
+    if(!ret) ret=ckpt_load(&cr,&buf);
+    ckbuf_free(&buf);
+
+    if(ret) {
+      fprintf(stderr,"%s: Error: Cannot resume from checkpoint '%s'\n",args[0],cp.ckptname);
+      return 1;
+    }
+
+    for(j=nsets-1; j>=0; --j) if(cr.setstate[j]) ++nresumed;
+  }
+
+  if(cp.ckptname && ckpt_start(&ck,cp.ckptname,cp.ckptinterval,&cksigs,ckpt_snapshot,&cr)) return 1;
+
+  if(cp.nthreads>1) {
+    pthread_t* threads=(pthread_t*)malloc(cp.nthreads*sizeof(pthread_t));
+
+    tstart=monotonic_time();
+
+    for(t=cp.nthreads-1; t>=0; --t) pthread_create(threads+t,NULL,simthread,tdata+t);
+
+    //The set statistics are merged by the threads themselves
+    for(t=0; t<cp.nthreads; ++t) pthread_join(threads[t],NULL);
+    tjoin=monotonic_time();
+    free(threads);
+
+    //Time spent by the threads waiting for the last one to complete
+    for(t=cp.nthreads-1; t>=0; --t) tidle+=tjoin-tdata[t].tend;
+
+  } else simthread(tdata);
+
+  if(cp.ckptname) {
+    ckpt_stop(&ck);
+    pthread_rwlock_destroy(&cr.lock);
+    free(cr.setstate);
+  }
+
+  for(t=cp.nthreads-1; t>=0; --t) gsl_rng_free(tdata[t].r);
+
+  //The sets that are not included are replaced by empty sets to complete
+  //the merging tree
+  if(cp.ntargets) {
+
+    for(j=as.nincluded; j<nsets; ++j) {
+
+      if(as.started[j]) free_set_data(sdata+j);
+      init_set_data(sdata+j,&cp,npers);
+      reduce_set(tdata,j);
+    }
+    cp.npaths=setfirstpath[as.nincluded];
+  }
+
+  //The accumulators are saved before the statistics are merged into the
+  //tree of a single run with the same number of sets
+  if(cp.accoutname) {
+
+    if(acc_write(cp.accoutname,&cp,sdata,(cp.nshards?firstset:0),endset)) {
+      fprintf(stderr,"%s: Error: Cannot write accumulator file '%s'\n",args[0],cp.accoutname);
+      return 1;
+    }
+
+    //The reported statistics of a shard only include its own paths
+    if(cp.nshards) {
+      uint32_t s;
+
+      if(firstset) sdata[0]=sdata[firstset];
+
+      for(s=firstset+(UINT32_C(1)<<set_block_level(firstset,endset)); s<endset; s+=UINT32_C(1)<<set_block_level(s,endset)) merge_set_data(sdata,sdata+s);
+      cp.npaths=endpath-firstpath;
+
+    } else if(treesize!=nsets) {
+      tdata[0].treesize=nsets;
+      tdata[0].setstate=NULL;
+      memset((uint32_t*)nmerges,0,2*nsets*sizeof(uint32_t));
+      reduce_blocks(tdata,0,nsets);
+    }
+  }
+
+  //With precision targets, only the paths of the included sets are recorded
+  if(cp.prioroutname) {
+
+    if(write_prior_records(cp.prioroutname,&cp,priorrecs,firstpath,(cp.ntargets?cp.npaths:endpath))) return 1;
+    free(priorrecs);
+  }
+
+  //The thread samples are merged into the sample of the first thread
+  if(cp.outsel.sample) {
+
+    for(t=cp.nthreads-1; t>0; --t) reservoir_merge(&tdata[0].sample,&tdata[t].sample);
+    reservoir_sort(&tdata[0].sample);
+    tdata[0].nwritten=tdata[0].sample.npaths;
+  }
+  uint64_t nwritten=0, npriorsolves=0;
+
+  for(t=cp.nthreads-1; t>=0; --t) {
+    nwritten+=tdata[t].nwritten;
+    npriorsolves+=tdata[t].npriorsolves;
+  }
+
+  if(cp.tlout) {
+
+    if(cp.outshards) {
+
+      for(t=cp.nthreads-1; t>=0; --t) {
+
+	if((tlflags&TLO_FLAG_SELECTED) && tlo_write_nskipped(tdata[t].tlshard,tdata[t].npaths-tdata[t].nwritten)) return 1;
+	close(tdata[t].tlshard);
+
+	if(tdata[t].tlidx.fd>=0) close(tdata[t].tlidx.fd);
+      }
+
+      if(write_shard_manifest(cp.tlout,"tlout",true,tlnpers,tlflags,tdata,cp.nthreads,tlshardnames)) return 1;
+
+      for(t=cp.nthreads-1; t>=0; --t) free(tlshardnames[t]);
+      free(tlshardnames);
+
+    } else {
+      awriter_close(&tlaw);
+
+      if(cp.outsel.sample && write_sample(cp.tlout,tlidx,&tdata[0].sample,ro_pathsel_tlout)) return 1;
+
+      if((tlflags&TLO_FLAG_SELECTED) && tlo_write_nskipped(cp.tlout,endpath-firstpath-nwritten)) return 1;
+
+      if(tlidx>=0) close(tlidx);
+    }
+    close(cp.tlout);
+  }
+
+#ifdef CT_OUTPUT
+  if(cp.ctout) {
+
+    if(cp.outshards) {
+
+      for(t=cp.nthreads-1; t>=0; --t) {
+	close(tdata[t].ctshard);
+
+	if(tdata[t].ctidx.fd>=0) close(tdata[t].ctidx.fd);
+      }
+
+      if(write_shard_manifest(cp.ctout,"ctout",false,0,0,tdata,cp.nthreads,ctshardnames)) return 1;
+
+      for(t=cp.nthreads-1; t>=0; --t) free(ctshardnames[t]);
+      free(ctshardnames);
+
+    } else {
+      awriter_close(&ctaw);
+
+      if(cp.outsel.sample && write_sample(cp.ctout,ctidx,&tdata[0].sample,ro_pathsel_ctout)) return 1;
+
+      if(ctidx>=0) close(ctidx);
+    }
+    close(cp.ctout);
+  }
+#endif
+
+  if(cp.treeout) {
+
+    if(cp.outshards) {
+
+      for(t=cp.nthreads-1; t>=0; --t) {
+	close(tdata[t].treeshard);
+
+	if(tdata[t].treeidx.fd>=0) close(tdata[t].treeidx.fd);
+      }
+
+      if(write_shard_manifest(cp.treeout,"treeout",false,0,0,tdata,cp.nthreads,treeshardnames)) return 1;
+
+      for(t=cp.nthreads-1; t>=0; --t) free(treeshardnames[t]);
+      free(treeshardnames);
+
+    } else {
+      awriter_close(&treeaw);
+
+      if(cp.outsel.sample && write_sample(cp.treeout,treeidx,&tdata[0].sample,ro_pathsel_treeout)) return 1;
+
+      if(treeidx>=0) close(treeidx);
+    }
+    close(cp.treeout);
+  }
+
+  for(t=cp.nthreads-1; t>=0; --t) reservoir_free(&tdata[t].sample);
+  free(tdata);
+  free(streams);
+  free(setfirstpath);
+  free((uint32_t*)nmerges);
+  set_data* const sd=sdata;
+
+
+  //printf("R sum is %f\n",tdata[0].r_mean);
+  //printf("Total number of infectious is %f\n",ninf);
+//#ifdef NUMEVENTSSTATS
+//  const double ninf_per_event_mean=tdata[0].r_mean/tdata[0].nevents_mean;
+//#endif
+  const double nnoe=cp.npaths-sd->pe;
+
+  const uint32_t nbins=sd->tlpptnvpers;
+  const double npaths[3]={sd->pe, nnoe, cp.npaths};
+  double* tls=(double*)malloc(ro_acc_nchans*6*nbins*sizeof(double));
+  double reff_mean[3], reff_std[3];
+  uint64_t reff_n[3];
+  #ifdef OBSREFF_OUTPUT
+  double reffobs_mean[3], reffobs_std[3];
+  uint64_t reffobs_n[3];
+  #endif
+
+  for(t=0; t<ro_acc_reff; ++t) if(sd->accfield[t]>=0) acc_count_stats(sd,t,npaths,tls+t*6*nbins);
+
+  if(cp.outputs&ro_output_reff) {
+    acc_ratio_stats(sd,ro_acc_reff,tls+ro_acc_reff*6*nbins,reff_mean,reff_std,reff_n);
+
+    printf("r_mean %22.15e %" PRIu64 "\n",reff_mean[2],reff_n[2]);
+
+    for(j=0; j<3; ++j) ratio_mean_std(reff_mean[j],reff_std[j],reff_n[j],reff_mean+j,reff_std+j);
+
+    sd->commper_mean/=reff_n[2];
+#ifdef NUMEVENTSSTATS
+    sd->nevents_mean/=reff_n[2];
+#endif
+  }
+#ifdef OBSREFF_OUTPUT
+  if(cp.outputs&ro_output_reffobs) {
+    acc_ratio_stats(sd,ro_acc_reffobs,tls+ro_acc_reffobs*6*nbins,reffobs_mean,reffobs_std,reffobs_n);
+
+    printf("robs_mean %22.15e %" PRIu64 "\n",reffobs_mean[2],reffobs_n[2]);
+
+    for(j=0; j<3; ++j) ratio_mean_std(reffobs_mean[j],reffobs_std[j],reffobs_n[j],reffobs_mean+j,reffobs_std+j);
+  }
+#endif
+
+  sd->pe/=cp.npaths;
+  sd->tenz_mean/=sd->penz;
+  sd->tenz_std=sqrt(sd->penz/(sd->penz-1.)*(sd->tenz_std/sd->penz-sd->tenz_mean*sd->tenz_mean));
+  sd->penz/=sd->nnzpaths;
+  sd->pm/=cp.npaths;
+
+  printf("\nComputed simulation results:\n");
+
+  if(cp.outputs&ro_output_reff) printf("Mean R:\n\t    Extinct: %22.15e +/- %22.15e\n\tNon-extinct: %22.15e +/- %22.15e\n\t      Total: %22.15e +/- %22.15e\n",reff_mean[0],reff_std[0]/sqrt(reff_n[0]),reff_mean[1],reff_std[1]/sqrt(reff_n[1]),reff_mean[2],reff_std[2]/sqrt(reff_n[2]));
+#ifdef OBSREFF_OUTPUT
+  if(cp.outputs&ro_output_reffobs) printf("Mean observed R:\n\t    Extinct: %22.15e +/- %22.15e\n\tNon-extinct: %22.15e +/- %22.15e\n\t      Total: %22.15e +/- %22.15e\n",reffobs_mean[0],reffobs_std[0]/sqrt(reffobs_n[0]),reffobs_mean[1],reffobs_std[1]/sqrt(reffobs_n[1]),reffobs_mean[2],reffobs_std[2]/sqrt(reffobs_n[2]));
+#endif
+
+  if(cp.outputs&ro_output_reff) {
+    printf("Communicable period is %22.15e\n",sd->commper_mean);
+#ifdef NUMEVENTSSTATS
+    printf("Number of events per infectious individual is %22.15e\n",sd->nevents_mean);
+    //printf("Number of infections per event is %22.15e\n",ninf_per_event_mean);
+#endif
+  }
+  printf("Probability of extinction and its statistical uncertainty: %22.15e +/- %22.15e%s\n",sd->penz,sqrt(sd->penz*(1.-sd->penz)/(sd->nnzpaths-1.)),(sd->maxedoutmintimeindex<INT32_MAX?" (max reached, could be biased if simulation cut)":""));
+  printf("Probability of non outgoing outbreak and its statistical uncertainty: %22.15e +/- %22.15e%s\n",sd->pe,sqrt(sd->pe*(1.-sd->pe)/(cp.npaths-1.)),(sd->maxedoutmintimeindex<INT32_MAX?" (max reached, could be biased if simulation cut)":""));
+  printf("Probability of reaching maximum as defined by nimax/npostestmax and its statistical uncertainty: %22.15e +/- %22.15e\n",sd->pm,sqrt(sd->pm*(1.-sd->pm)/(cp.npaths-1.)));
+  printf("Probability of reaching maximum as defined by nimax/npostestmax and its statistical uncertainty: %22.15e +/- %22.15e\n",sd->pm,sqrt(sd->pm*(1.-sd->pm)/(cp.npaths-1.)));
+  printf("Extinction time, if it occurs is %22.15e +/- %22.15e%s\n",sd->tenz_mean,sd->tenz_std,(sd->maxedoutmintimeindex<INT32_MAX?" (max reached, could be biased if simulation cut)":""));
+
+  if(cp.ntargets) {
+    const char* tnames[5]={"Probability of non outgoing outbreak", "Extinction time", "Current infection timeline", "New infections timeline", "New positive test timeline"};
+    precision_target const* pt;
+    double est, se;
+
+    printf("Precision targets %s after %" PRIu32 " paths in %" PRIu32 " path sets (maximum of %" PRIu32 " paths):\n",(adaptive_targets_met(&as)?"met":"not met"),cp.npaths,as.nincluded,maxnpaths);
+
+    for(j=0; j<cp.ntargets; ++j) {
+      pt=cp.targets+j;
+      est=adaptive_estimate(&as,j,&se);
+
+      if(pt->quantity>=ro_target_inf) printf("\t%s at t=%g: %22.15e +/- %22.15e (target of %g%s)\n",tnames[pt->quantity],pt->time,est,se,(pt->relative?100*pt->value:pt->value),(pt->relative?"%":""));
+      else printf("\t%s: %22.15e +/- %22.15e (target of %g%s)\n",tnames[pt->quantity],est,se,(pt->relative?100*pt->value:pt->value),(pt->relative?"%":""));
+    }
+    adaptive_free(&as);
+  }
+
+  if(cp.tlout && !cp.outshards) awriter_print_stats(&tlaw,"Timeline output");
+#ifdef CT_OUTPUT
+  if(cp.ctout && !cp.outshards) awriter_print_stats(&ctaw,"Contact tracing output");
+#endif
+  if(cp.treeout && !cp.outshards) awriter_print_stats(&treeaw,"Transmission tree output");
+
+  //No path is simulated when the result is merged or fully loaded from the
+  //cache, such that the threads have no meaningful idle time
+  if(cp.nthreads>1 && endpath>firstpath) printf("Scheduler idle time for %" PRIu32 " threads and %" PRIu32 " path sets is %.3f s (%.2f%% of the thread time)\n",cp.nthreads,nsets,tidle,100*tidle/(cp.nthreads*(tjoin-tstart)));
+
+  if(cp.ckptname) {
+
+    if(resuming) printf("Resumed from checkpoint '%s' with %" PRIu32 " of %" PRIu32 " path sets completed\n",cp.ckptname,nresumed,nsets);
+    printf("%" PRIu32 " checkpoints written to '%s' in %.3f s\n",ck.nwritten,cp.ckptname,ck.writetime);
+  }
+
+  if(cp.npriors) printf("Simulation parameters drawn from %" PRIu32 " priors for each path and solved %" PRIu64 " times\n",cp.npriors,npriorsolves);
+
+  if(cp.cachedir) printf("Result cache '%s': %" PRIu32 " cached paths used and %" PRIu32 " new paths simulated%s\n",cp.cachedir,firstpath,cp.npaths-firstpath,(cp.accoutname?", result added to the cache":""));
+
+  else if(cp.topupname) printf("Extended the %" PRIu32 " paths of '%s' with %" PRIu32 " new paths\n",firstpath,cp.topupname,cp.npaths-firstpath);
+
+  if(cp.nmergenames) printf("Merged the accumulators of %" PRIu32 " files for %" PRIu32 " paths\n",cp.nmergenames,cp.npaths);
+
+  if(cp.nshards) printf("Accumulators of shard %" PRIu32 "/%" PRIu32 " for paths %" PRIu32 " to %" PRIu32 " written to '%s'\n",cp.shard,cp.nshards,firstpath,endpath-1,cp.accoutname);
+
+  else if(cp.accoutname && !cp.cachedir) printf("Accumulators for %" PRIu32 " paths written to '%s'\n",cp.npaths,cp.accoutname);
+
+  const int32_t shift=sd->tlppnnpers;
+  const char* tltitles[ro_acc_nchans]={"Current infection (non-isolated infected individuals) timeline", "New infections (new infected individuals) timeline", "New positive test timeline",
+#ifdef SEC_INF_TIMELINES
+    "Current infection (non-isolated infected individuals) timeline for the second infection category", "New infections (new infected individuals) timeline for the second infection category", "New positive test timeline for the second infection category",
+#endif
+    "Reff timeline",
+#ifdef OBSREFF_OUTPUT
+    "Observable Reff timeline",
+#endif
+  };
+
+  for(t=0; t<ro_acc_nchans; ++t) if(sd->accfield[t]>=0) print_timeline(tltitles[t],tls+t*6*nbins,nbins,shift,cp.nbinsperunit,sd->maxedoutmintimeindex);
+  free(tls);
+
+  if(cp.ntlquantiles) {
+    print_timeline_quantiles(tltitles[ro_acc_inf],sd->inf_timeline_qsk,sd->tlpptnvpers,shift,cp.nbinsperunit,sd->maxedoutmintimeindex,cp.tlquantiles,cp.ntlquantiles,cp.tlqprecbits,cp.npaths);
+    print_timeline_quantiles(tltitles[ro_acc_newinf],sd->newinf_timeline_qsk,sd->tlpptnvpers,shift,cp.nbinsperunit,sd->maxedoutmintimeindex,cp.tlquantiles,cp.ntlquantiles,cp.tlqprecbits,cp.npaths);
+
+    if(!isnan(cp.pars.tdeltat)) print_timeline_quantiles(tltitles[ro_acc_newpostest],sd->newpostest_timeline_qsk,sd->tlpptnvpers,shift,cp.nbinsperunit,sd->maxedoutmintimeindex,cp.tlquantiles,cp.ntlquantiles,cp.tlqprecbits,cp.npaths);
+  }
+
+  if(cp.ninfhist) {
+    uint32_t b;
+
+    printf("\nDistribution of number of generated infections per infectious individual:\n");
+    printf(" n inf\t               count\n");
+    
+    for(b=0; b<sd->ninfbins; ++b) if(sd->ngeninfs[b] > 0) printf("%6" PRIu32 "\t%20" PRIu64 "\n",b,sd->ngeninfs[b]);
+  }
+
+  if(cp.pathhists) {
+    const uint32_t ntbins=path_hist_ntbins(&cp);
+    uint32_t b;
+
+    print_lhist_distribution("Distribution of the final size (total number of new infections) per path",sd->finalsize_hist,cp.phprecbits);
+    print_lhist_distribution("Distribution of the peak number of current infections (non-isolated infected individuals) per path",sd->peakinf_hist,cp.phprecbits);
+
+    printf("\nDistribution of the time of the peak number of current infections, for paths with infections:\n");
+    printf("      lower\t      upper\t               count\n");
+
+    for(b=0; b<ntbins+2; ++b) if(sd->peaktime_hist[b] > 0) printf("%11.2f\t%11.2f\t%20" PRIu32 "\n",linhist_lower(b,cp.phtmin,cp.nbinsperunit),linhist_upper(b,cp.phtmin,cp.nbinsperunit,ntbins),sd->peaktime_hist[b]);
+
+    printf("\nDistribution of the extinction time, for paths with extinction:\n");
+    printf("      lower\t      upper\t               count%s\n",(sd->maxedoutmintimeindex<INT32_MAX?" (max reached, could be biased if simulation cut)":""));
+
+    for(b=0; b<ntbins+2; ++b) if(sd->exttime_hist[b] > 0) printf("%11.2f\t%11.2f\t%20" PRIu32 "\n",linhist_lower(b,cp.phtmin,cp.nbinsperunit),linhist_upper(b,cp.phtmin,cp.nbinsperunit,ntbins),sd->exttime_hist[b]);
+
+  }
+
+  free_set_data(sd);
+  free(sdata);
+  free(cp.tlquantiles);
+  free(cp.targets);
+  free(cp.tloutname);
+#ifdef CT_OUTPUT
+  free(cp.ctoutname);
+#endif
+  free(cp.treeoutname);
+  free(cp.ckptname);
+  free(cp.accoutname);
+  free(cp.topupname);
+
+  for(j=cp.nmergenames-1; j>=0; --j) free(cp.mergenames[j]);
+  free(cp.mergenames);
+  free(cp.cachedir);
+  free(cp.priors);
+  free(cp.prioroutname);
+  free(cp.abcobs);
+  free(cp.abcoutname);
+  free(cp.seeds);
+
+  fflush(stdout);
+  fflush(stderr);
+  close(cp.oout);
+  close(cp.eout);
+
+  return 0;
+}
+
+void* sweepthread(void* arg)
+{
+  sweep_worker* w=(sweep_worker*)arg;
+  thread_data* data=&w->tdata;
+  sweep_point* pt;
+  config_pars const* stcp=NULL;
+  sim_state st;
+  uint32_t p;
+
+  for(p=0; p<w->npoints; ++p) {
+    pt=w->points+p;
+    data->cp=&pt->cp;
+    data->npers=pt->cp.nbinsperunit*pt->cp.pars.tmax;
+    data->set=&pt->set;
+    data->sdata=pt->sdata;
+    data->nmerges=pt->nmerges;
+
+    //The simulation state is only rebuilt when its allocations depend on
+    //the parameters of the point
+    if(stcp && sim_state_compatible(stcp, &pt->cp)) st.set_pars_func(&st.sv, &pt->cp.pars);
+
+    else {
+
+      if(stcp) sim_state_free(&st, stcp);
+      sim_state_init(&st, data);
+    }
+    stcp=&pt->cp;
+    simulate_sets(data, &st);
+  }
+
+  if(stcp) sim_state_free(&st, stcp);
+  return NULL;
+}
+
+int sweep_run(config_pars const* cp, const char* name)
+{
+  sweep_spec ss;
+
+  if(sweep_read(&ss,cp->sweepname)) return 1;
+  const uint32_t nshares=(cp->nsets?cp->nsets:cp->nthreads*cp->nsetsperthread);
+  const uint32_t nsets=(cp->setsize?fixed_path_sets(cp->npaths,cp->setsize,NULL):guided_path_sets(cp->npaths,nshares,NULL));
+
+  if(cp->setsize && nsets>FIXED_SETS_STREAM_STRIDE) {
+    fprintf(stderr,"%s: Error: The number of path sets cannot exceed %" PRIu32 "\n",name,FIXED_SETS_STREAM_STRIDE);
+    sweep_free(&ss);
+    return 1;
+  }
+  FILE* out=fopen(cp->sweepoutname,"w");
+
+  if(!out) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in write mode\n",name,cp->sweepoutname);
+    sweep_free(&ss);
+    return 1;
+  }
+  sweep_point* points=(sweep_point*)malloc(ss.npoints*sizeof(sweep_point));
+  config_pars* pcp;
+  uint32_t p;
+  int t;
+
+  //The parameters of all the points are solved before any path is simulated
+  for(p=0; p<ss.npoints; ++p) {
+    pcp=&points[p].cp;
+    *pcp=*cp;
+    pcp->pars=cp->basepars;
+    sweep_apply(&ss,p,&pcp->pars);
+    printf("\nSweep point %" PRIu32 ":\n",p);
+
+    if(model_solve_pars(&pcp->pars) || model_pars_check(&pcp->pars)) {
+      fprintf(stderr,"%s: Error: While verifying the validity of the simulation parameters of sweep point %" PRIu32 ".\n",name,p);
+
+      for(t=p-1; t>=0; --t) {
+	free(points[t].sdata);
+	free((uint32_t*)points[t].nmerges);
+      }
+      free(points);
+      fclose(out);
+      sweep_free(&ss);
+      return 1;
+    }
+
+    if(isnan(pcp->phtmin)) pcp->phtmin=(pcp->pars.timetype==ro_time_pri_created || pcp->pars.timetype==ro_time_pri_flat_comm?0:-pcp->pars.tmax);
+    points[p].sdata=(set_data*)malloc(nsets*sizeof(set_data));
+    points[p].nmerges=(volatile uint32_t*)calloc(2*nsets,sizeof(uint32_t));
+    points[p].set=cp->nthreads;
+  }
+
+  //All the points use the same path sets and RNG streams
+  uint32_t* setfirstpath=(uint32_t*)malloc((nsets+1)*sizeof(uint32_t));
+  rng_stream* streams=(rng_stream*)malloc(nsets*sizeof(rng_stream));
+  sweep_worker* workers=(sweep_worker*)malloc(cp->nthreads*sizeof(sweep_worker));
+  thread_data* td;
+  double tstart=0, tjoin=0, tidle=0;
+
+  if(cp->setsize) fixed_path_sets(cp->npaths,cp->setsize,setfirstpath);
+  else guided_path_sets(cp->npaths,nshares,setfirstpath);
+  init_set_streams(cp,nsets,streams);
+
+  for(t=cp->nthreads-1; t>=0; --t) {
+    td=&workers[t].tdata;
+    td->setfirstpath=setfirstpath;
+    td->id=t;
+    td->nsets=nsets;
+    td->firstset=0;
+    td->endset=nsets;
+    td->treesize=nsets;
+    td->nbinsperunit=cp->nbinsperunit;
+    td->streams=streams;
+    td->r=gsl_rng_alloc(rngstream_gsl);
+    td->tlaw=td->ctaw=td->treeaw=NULL;
+    td->npaths=0;
+    td->nwritten=0;
+    reservoir_init(&td->sample,0);
+    td->as=NULL;
+    td->setstate=NULL;
+    td->cklock=NULL;
+    td->priorrecs=NULL;
+    td->npriorsolves=0;
+    td->abcpop=NULL;
+    td->abcdists=NULL;
+    td->nabcrejected=0;
+    oidx_writer_init(&td->tlidx,-1,0);
+    oidx_writer_init(&td->ctidx,-1,0);
+    oidx_writer_init(&td->treeidx,-1,0);
+    workers[t].points=points;
+    workers[t].npoints=ss.npoints;
+  }
+
+  if(cp->nthreads>1) {
+    pthread_t* threads=(pthread_t*)malloc(cp->nthreads*sizeof(pthread_t));
+
+    tstart=monotonic_time();
+
+    for(t=cp->nthreads-1; t>=0; --t) pthread_create(threads+t,NULL,sweepthread,workers+t);
+
+    for(t=0; t<cp->nthreads; ++t) pthread_join(threads[t],NULL);
+    tjoin=monotonic_time();
+    free(threads);
+
+    for(t=cp->nthreads-1; t>=0; --t) tidle+=tjoin-workers[t].tdata.tend;
 
-    if(write(cp.tlout,&ubuf,4)!=4) {
-      perror("tlout");
-      return 1;
-    }
-#ifdef SEC_INF_TIMELINES
-    ubuf=cp.pars.timetype|((!isnan(cp.pars.tdeltat))<<3)|16;
-#else
-    ubuf=cp.pars.timetype|((!isnan(cp.pars.tdeltat))<<3);
-#endif
+  } else sweepthread(workers);
 
-    if(write(cp.tlout,&ubuf,1)!=1) {
-      perror("tlout");
-      return 1;
+  for(t=cp->nthreads-1; t>=0; --t) {
+    gsl_rng_free(workers[t].tdata.r);
+    reservoir_free(&workers[t].tdata.sample);
+  }
+  free(workers);
+  free(streams);
+  free(setfirstpath);
+
+  const bool reff=(cp->outputs&ro_output_reff);
+  set_data* sd;
+  double* tls;
+  double reff_mean[3], reff_std[3];
+  uint64_t reff_n[3];
+  double pe, penz, pm, tenz_mean, tenz_std;
+
+  fprintf(out,"point");
+
+  for(p=0; p<ss.npars; ++p) fprintf(out,"\t%s",ss.pars[p]->name);
+  fprintf(out,"\tnpaths\tpe\tpe_err\tpext\tpext_err\tpmax\tpmax_err\ttext_mean\ttext_std%s\n",(reff?"\treff_mean\treff_err\tcommper":""));
+
+  for(p=0; p<ss.npoints; ++p) {
+    pcp=&points[p].cp;
+    sd=points[p].sdata;
+    pe=sd->pe/pcp->npaths;
+    tenz_mean=sd->tenz_mean/sd->penz;
+    tenz_std=sqrt(sd->penz/(sd->penz-1.)*(sd->tenz_std/sd->penz-tenz_mean*tenz_mean));
+    penz=sd->penz/sd->nnzpaths;
+    pm=sd->pm/pcp->npaths;
+    fprintf(out,"%" PRIu32,p);
+
+    for(t=0; t<ss.npars; ++t) fprintf(out,"\t%.17g",sweep_value(ss.pars[t],&pcp->pars));
+    fprintf(out,"\t%" PRIu32 "\t%.15e\t%.15e\t%.15e\t%.15e\t%.15e\t%.15e\t%.15e\t%.15e",pcp->npaths,pe,sqrt(pe*(1.-pe)/(pcp->npaths-1.)),penz,sqrt(penz*(1.-penz)/(sd->nnzpaths-1.)),pm,sqrt(pm*(1.-pm)/(pcp->npaths-1.)),tenz_mean,tenz_std);
+
+    if(reff) {
+      tls=(double*)malloc(6*sd->tlpptnvpers*sizeof(double));
+      acc_ratio_stats(sd,ro_acc_reff,tls,reff_mean,reff_std,reff_n);
+      free(tls);
+      ratio_mean_std(reff_mean[2],reff_std[2],reff_n[2],reff_mean+2,reff_std+2);
+      fprintf(out,"\t%.15e\t%.15e\t%.15e",reff_mean[2],reff_std[2]/sqrt(reff_n[2]),sd->commper_mean/reff_n[2]);
     }
+    fprintf(out,"\n");
+    free_set_data(sd);
+    free(sd);
+    free((uint32_t*)points[p].nmerges);
   }
+  free(points);
 
-#ifdef CT_OUTPUT
-  if(cp.ctout) {
-    pthread_mutex_init(&ctflock, NULL);
+  if(fclose(out)) {
+    fprintf(stderr,"%s: Error: Cannot write file '%s'\n",name,cp->sweepoutname);
+    sweep_free(&ss);
+    return 1;
   }
-#endif
+  printf("\nResults of %" PRIu32 " sweep points of %" PRIu32 " paths written to '%s'\n",ss.npoints,cp->npaths,cp->sweepoutname);
 
-  thread_data* tdata=(thread_data*)malloc(cp.nthreads*sizeof(thread_data));
-  int j;
-  const uint32_t nsets=cp.nthreads*cp.nsetsperthread;
-  const double npathsperset=((double)cp.npaths)/nsets;
-  const uint32_t npers=cp.nbinsperunit*cp.pars.tmax;
-  volatile uint32_t set=cp.nthreads;
+  if(cp->nthreads>1) printf("Scheduler idle time for %" PRIu32 " threads and %" PRIu32 " sweep points of %" PRIu32 " path sets is %.3f s (%.2f%% of the thread time)\n",cp->nthreads,ss.npoints,nsets,tidle,100*tidle/(cp->nthreads*(tjoin-tstart)));
+  sweep_free(&ss);
+  return 0;
+}
+
+int abc_run(config_pars const* cp, const char* name)
+{
+  const uint32_t nshares=(cp->nsets?cp->nsets:cp->nthreads*cp->nsetsperthread);
+  const uint32_t nsets=guided_path_sets(cp->npaths,nshares,NULL);
+  const uint32_t nrec=cp->npriors+PRIOR_REC_NOUTCOMES;
+  uint32_t* setfirstpath=(uint32_t*)malloc((nsets+1)*sizeof(uint32_t));
+  //Each generation uses its own RNG streams
+  rng_stream* streams=(rng_stream*)malloc((uint64_t)cp->abcngens*nsets*sizeof(rng_stream));
+  set_data* sdata=(set_data*)malloc(nsets*sizeof(set_data));
+  volatile uint32_t* nmerges=(volatile uint32_t*)malloc(2*nsets*sizeof(uint32_t));
+  volatile uint32_t set;
+  double* recs=(double*)malloc((uint64_t)cp->npaths*nrec*sizeof(double));
+  double* dists=(double*)malloc(cp->npaths*sizeof(double));
+  thread_data* tdata=(thread_data*)malloc(cp->nthreads*sizeof(thread_data));
+  thread_data* td;
+  abc_population pops[2];
+  abc_population* pop;
+  abc_population* prev=NULL;
+  double eps=cp->abceps, mean, std;
+  uint64_t nrejected, nsolves=0;
+  uint32_t g, i, n, k;
+  int64_t j;
   int t;
-  int tmaxnpers=0;
+  int ret=0;
+
+  guided_path_sets(cp->npaths,nshares,setfirstpath);
+  rng_skipstreams((uint64_t)cp->abcngens*nsets*cp->stream);
+
+  for(j=(int64_t)cp->abcngens*nsets-1; j>=0; --j) rng_init(streams+j);
+
+  for(t=cp->nthreads-1; t>=0; --t) {
+    td=tdata+t;
+    td->cp=cp;
+    td->setfirstpath=setfirstpath;
+    td->id=t;
+    td->nsets=nsets;
+    td->firstset=0;
+    td->endset=nsets;
+    td->treesize=nsets;
+    td->nbinsperunit=cp->nbinsperunit;
+    td->npers=cp->nbinsperunit*cp->pars.tmax;
+    td->set=&set;
+    td->sdata=sdata;
+    td->nmerges=nmerges;
+    td->r=gsl_rng_alloc(rngstream_gsl);
+    td->tlaw=td->ctaw=td->treeaw=NULL;
+    td->npaths=0;
+    td->nwritten=0;
+    reservoir_init(&td->sample,0);
+    td->as=NULL;
+    td->setstate=NULL;
+    td->cklock=NULL;
+    td->priorrecs=recs;
+    td->npriorsolves=0;
+    td->abcdists=dists;
+    oidx_writer_init(&td->tlidx,-1,0);
+    oidx_writer_init(&td->ctidx,-1,0);
+    oidx_writer_init(&td->treeidx,-1,0);
+  }
 
-  if(cp.nthreads>1) {
-    pthread_t* threads=(pthread_t*)malloc(cp.nthreads*sizeof(pthread_t));
+  for(g=0; g<cp->abcngens; ++g) {
 
-    for(t=cp.nthreads-1; t>=0; --t){
-      tdata[t].cp=&cp;
-      tdata[t].npathsperset=npathsperset;
-      tdata[t].id=t;
-      tdata[t].nsets=nsets;
-      tdata[t].nbinsperunit=cp.nbinsperunit;
-      tdata[t].npers=npers;
-      tdata[t].set=&set;
-      //tdata[t].r = gsl_rng_alloc(gsl_rng_taus2);
-      tdata[t].r = gsl_rng_alloc(rngstream_gsl);
-      //rng_writestatefull((rng_stream*)tdata[t].r->state);
-      tdata[t].tlflock = &tlflock;
-#ifdef CT_OUTPUT
-      tdata[t].ctflock = &ctflock;
-#endif
-      pthread_create(threads+t,NULL,simthread,tdata+t);
+    //The tolerance of a generation is a quantile of the distances of the
+    //previous population
+    if(prev) eps=abc_pop_quantile(prev,cp->abcquantile);
+    set=cp->nthreads;
+    memset((uint32_t*)nmerges,0,2*nsets*sizeof(uint32_t));
+
+    for(t=cp->nthreads-1; t>=0; --t) {
+      tdata[t].streams=streams+(uint64_t)g*nsets;
+      tdata[t].abcpop=prev;
+      tdata[t].abceps=eps;
+      tdata[t].nabcrejected=0;
     }
 
-    pthread_join(threads[0],NULL);
-    gsl_rng_free(tdata[0].r);
-    int tp;
-    uint32_t maxper;
-    int32_t ndiff, pdiff;
+    if(cp->nthreads>1) {
+      pthread_t* threads=(pthread_t*)malloc(cp->nthreads*sizeof(pthread_t));
 
-    for(t=1; t<cp.nthreads; ++t) {
-      pthread_join(threads[t],NULL);
-      gsl_rng_free(tdata[t].r);
-      tdata[0].commper_mean+=tdata[t].commper_mean;
-#ifdef NUMEVENTSSTATS
-      tdata[0].nevents_mean+=tdata[t].nevents_mean;
-#endif
-      tdata[0].nnzpaths+=tdata[t].nnzpaths;
-      tdata[0].pe+=tdata[t].pe;
-      tdata[0].penz+=tdata[t].penz;
-      tdata[0].pm+=tdata[t].pm;
-      tdata[0].tenz_mean+=tdata[t].tenz_mean;
-      tdata[0].tenz_std+=tdata[t].tenz_std;
-
-      ndiff=tdata[t].tlppnnpers-tdata[tmaxnpers].tlppnnpers;
-      pdiff=(int32_t)tdata[t].tlpptnvpers-tdata[tmaxnpers].tlpptnvpers-ndiff;
-      //printf("Thread %i: nnpers: %i, tnvpers: %u\n",t,tdata[t].tlppnnpers,tdata[t].tlpptnvpers);
-      //printf("Thread %i: nnpers: %i, tnvpers: %u\n",tmaxnpers,tdata[tmaxnpers].tlppnnpers,tdata[tmaxnpers].tlpptnvpers);
-      //printf("ndiff: %i, pdiff: %i\n",ndiff,pdiff);
-
-      if(ndiff>0) {
-	tp=tmaxnpers;
-	//printf("tmaxnpers: %i -> %i\n",tmaxnpers,t);
-	tmaxnpers=t;
-
-	if(pdiff<0) {
-	  realloc_thread_timelines(tdata+t,ndiff,0);
-	}
-	ndiff*=-1;
+      for(t=cp->nthreads-1; t>=0; --t) pthread_create(threads+t,NULL,simthread,tdata+t);
 
-      } else {
-	tp=t;
+      for(t=0; t<cp->nthreads; ++t) pthread_join(threads[t],NULL);
+      free(threads);
 
-	if(pdiff>0) realloc_thread_timelines(tdata+tmaxnpers,0,pdiff);
-      }
+    } else simthread(tdata);
+    free_set_data(sdata);
+    nrejected=0;
 
-      maxper=tdata[tp].tlpptnvpers-ndiff;
-      //printf("Storing from %i to %i\n",-ndiff,maxper-1);
-
-      for(j=-ndiff; j<maxper; ++j) {
-        tdata[tmaxnpers].inf_timeline_mean_ext[j]+=tdata[tp].inf_timeline_mean_ext[j+ndiff];
-        tdata[tmaxnpers].inf_timeline_std_ext[j]+=tdata[tp].inf_timeline_std_ext[j+ndiff];
-        tdata[tmaxnpers].newinf_timeline_mean_ext[j]+=tdata[tp].newinf_timeline_mean_ext[j+ndiff];
-        tdata[tmaxnpers].newinf_timeline_std_ext[j]+=tdata[tp].newinf_timeline_std_ext[j+ndiff];
-        tdata[tmaxnpers].newpostest_timeline_mean_ext[j]+=tdata[tp].newpostest_timeline_mean_ext[j+ndiff];
-        tdata[tmaxnpers].newpostest_timeline_std_ext[j]+=tdata[tp].newpostest_timeline_std_ext[j+ndiff];
-        #ifdef SEC_INF_TIMELINES
-        tdata[tmaxnpers].secinf_timeline_mean_ext[j]+=tdata[tp].secinf_timeline_mean_ext[j+ndiff];
-        tdata[tmaxnpers].secinf_timeline_std_ext[j]+=tdata[tp].secinf_timeline_std_ext[j+ndiff];
-        tdata[tmaxnpers].newsecinf_timeline_mean_ext[j]+=tdata[tp].newsecinf_timeline_mean_ext[j+ndiff];
-        tdata[tmaxnpers].newsecinf_timeline_std_ext[j]+=tdata[tp].newsecinf_timeline_std_ext[j+ndiff];
-        tdata[tmaxnpers].newsecpostest_timeline_mean_ext[j]+=tdata[tp].newsecpostest_timeline_mean_ext[j+ndiff];
-        tdata[tmaxnpers].newsecpostest_timeline_std_ext[j]+=tdata[tp].newsecpostest_timeline_std_ext[j+ndiff];
-        #endif
-        tdata[tmaxnpers].reff_timeline_mean_ext[j]+=tdata[tp].reff_timeline_mean_ext[j+ndiff];
-        tdata[tmaxnpers].reff_timeline_std_ext[j]+=tdata[tp].reff_timeline_std_ext[j+ndiff];
-        tdata[tmaxnpers].reff_timeline_n_ext[j]+=tdata[tp].reff_timeline_n_ext[j+ndiff];
-	#ifdef OBSREFF_OUTPUT
-        tdata[tmaxnpers].reffobs_timeline_mean_ext[j]+=tdata[tp].reffobs_timeline_mean_ext[j+ndiff];
-        tdata[tmaxnpers].reffobs_timeline_std_ext[j]+=tdata[tp].reffobs_timeline_std_ext[j+ndiff];
-        tdata[tmaxnpers].reffobs_timeline_n_ext[j]+=tdata[tp].reffobs_timeline_n_ext[j+ndiff];
-        #endif
-
-        tdata[tmaxnpers].inf_timeline_mean_noext[j]+=tdata[tp].inf_timeline_mean_noext[j+ndiff];
-        tdata[tmaxnpers].inf_timeline_std_noext[j]+=tdata[tp].inf_timeline_std_noext[j+ndiff];
-        tdata[tmaxnpers].newinf_timeline_mean_noext[j]+=tdata[tp].newinf_timeline_mean_noext[j+ndiff];
-        tdata[tmaxnpers].newinf_timeline_std_noext[j]+=tdata[tp].newinf_timeline_std_noext[j+ndiff];
-        tdata[tmaxnpers].newpostest_timeline_mean_noext[j]+=tdata[tp].newpostest_timeline_mean_noext[j+ndiff];
-        tdata[tmaxnpers].newpostest_timeline_std_noext[j]+=tdata[tp].newpostest_timeline_std_noext[j+ndiff];
-        #ifdef SEC_INF_TIMELINES
-        tdata[tmaxnpers].secinf_timeline_mean_noext[j]+=tdata[tp].secinf_timeline_mean_noext[j+ndiff];
-        tdata[tmaxnpers].secinf_timeline_std_noext[j]+=tdata[tp].secinf_timeline_std_noext[j+ndiff];
-        tdata[tmaxnpers].newsecinf_timeline_mean_noext[j]+=tdata[tp].newsecinf_timeline_mean_noext[j+ndiff];
-        tdata[tmaxnpers].newsecinf_timeline_std_noext[j]+=tdata[tp].newsecinf_timeline_std_noext[j+ndiff];
-        tdata[tmaxnpers].newsecpostest_timeline_mean_noext[j]+=tdata[tp].newsecpostest_timeline_mean_noext[j+ndiff];
-        tdata[tmaxnpers].newsecpostest_timeline_std_noext[j]+=tdata[tp].newsecpostest_timeline_std_noext[j+ndiff];
-        #endif
-        tdata[tmaxnpers].reff_timeline_mean_noext[j]+=tdata[tp].reff_timeline_mean_noext[j+ndiff];
-        tdata[tmaxnpers].reff_timeline_std_noext[j]+=tdata[tp].reff_timeline_std_noext[j+ndiff];
-        tdata[tmaxnpers].reff_timeline_n_noext[j]+=tdata[tp].reff_timeline_n_noext[j+ndiff];
-	#ifdef OBSREFF_OUTPUT
-        tdata[tmaxnpers].reffobs_timeline_mean_noext[j]+=tdata[tp].reffobs_timeline_mean_noext[j+ndiff];
-        tdata[tmaxnpers].reffobs_timeline_std_noext[j]+=tdata[tp].reffobs_timeline_std_noext[j+ndiff];
-        tdata[tmaxnpers].reffobs_timeline_n_noext[j]+=tdata[tp].reffobs_timeline_n_noext[j+ndiff];
-        #endif
-      }
-      free(tdata[tp].inf_timeline_mean_ext);
-      free(tdata[tp].inf_timeline_std_ext);
-      free(tdata[tp].inf_timeline_mean_noext);
-      free(tdata[tp].inf_timeline_std_noext);
-      free(tdata[tp].newinf_timeline_mean_ext);
-      free(tdata[tp].newinf_timeline_std_ext);
-      free(tdata[tp].newinf_timeline_mean_noext);
-      free(tdata[tp].newinf_timeline_std_noext);
-      free(tdata[tp].newpostest_timeline_mean_ext);
-      free(tdata[tp].newpostest_timeline_std_ext);
-      free(tdata[tp].newpostest_timeline_mean_noext);
-      free(tdata[tp].newpostest_timeline_std_noext);
-      #ifdef SEC_INF_TIMELINES
-      free(tdata[tp].secinf_timeline_mean_ext);
-      free(tdata[tp].secinf_timeline_std_ext);
-      free(tdata[tp].secinf_timeline_mean_noext);
-      free(tdata[tp].secinf_timeline_std_noext);
-      free(tdata[tp].newsecinf_timeline_mean_ext);
-      free(tdata[tp].newsecinf_timeline_std_ext);
-      free(tdata[tp].newsecinf_timeline_mean_noext);
-      free(tdata[tp].newsecinf_timeline_std_noext);
-      free(tdata[tp].newsecpostest_timeline_mean_ext);
-      free(tdata[tp].newsecpostest_timeline_std_ext);
-      free(tdata[tp].newsecpostest_timeline_mean_noext);
-      free(tdata[tp].newsecpostest_timeline_std_noext);
-      #endif
-      free(tdata[tp].reff_timeline_mean_ext);
-      free(tdata[tp].reff_timeline_std_ext);
-      free(tdata[tp].reff_timeline_n_ext);
-      free(tdata[tp].reff_timeline_mean_noext);
-      free(tdata[tp].reff_timeline_std_noext);
-      free(tdata[tp].reff_timeline_n_noext);
-      #ifdef OBSREFF_OUTPUT
-      free(tdata[tp].reffobs_timeline_mean_ext);
-      free(tdata[tp].reffobs_timeline_std_ext);
-      free(tdata[tp].reffobs_timeline_n_ext);
-      free(tdata[tp].reffobs_timeline_mean_noext);
-      free(tdata[tp].reffobs_timeline_std_noext);
-      free(tdata[tp].reffobs_timeline_n_noext);
-      #endif
+    for(t=cp->nthreads-1; t>=0; --t) nrejected+=tdata[t].nabcrejected;
 
-      if(tdata[t].maxedoutmintimeindex < tdata[0].maxedoutmintimeindex) tdata[0].maxedoutmintimeindex = tdata[t].maxedoutmintimeindex;
+    //Accepted paths are stored in path order, such that the population does
+    //not depend on the number of threads
+    for(n=0, i=0; i<cp->npaths; ++i) n+=(dists[i]<=eps);
+
+    if(!n) {
+      fprintf(stderr,"%s: Error: No path was accepted in ABC generation %" PRIu32 " with tolerance %.6g\n",name,g,eps);
+      ret=1;
+      break;
     }
-    free(threads);
+    pop=pops+(g&1);
+    abc_pop_init(pop,cp->npriors,n);
 
-  } else {
-    tdata[0].cp=&cp;
-    tdata[0].npathsperset=npathsperset;
-    tdata[0].id=0;
-    tdata[0].nsets=nsets;
-    tdata[0].nbinsperunit=cp.nbinsperunit;
-    tdata[0].npers=npers;
-    tdata[0].set=&set;
-    //tdata[0].r = gsl_rng_alloc(gsl_rng_taus2);
-    tdata[0].r = gsl_rng_alloc(rngstream_gsl);
-    //rng_writestatefull((rng_stream*)tdata[0].r->state);
-    tdata[0].tlflock = &tlflock;
-#ifdef CT_OUTPUT
-    tdata[0].ctflock = &ctflock;
-#endif
-    simthread(tdata);
-    gsl_rng_free(tdata[0].r);
-  }
+    for(n=0, i=0; i<cp->npaths; ++i) if(dists[i]<=eps) {
+      memcpy(pop->vals+(uint64_t)n*cp->npriors,recs+(uint64_t)i*nrec,cp->npriors*sizeof(double));
+      pop->dists[n]=dists[i];
+      ++n;
+    }
+    abc_pop_weights(pop,prev,cp->priors);
+    printf("\nABC generation %" PRIu32 ": tolerance %.6g, %" PRIu32 " of %" PRIu32 " paths accepted, %" PRIu64 " paths rejected early, effective sample size %.1f\n",g,eps,n,cp->npaths,nrejected,abc_pop_ess(pop));
 
-  if(cp.tlout) {
-    close(cp.tlout);
-    pthread_mutex_destroy(&tlflock);
-  }
+    for(k=0; k<cp->npriors; ++k) {
+      mean=abc_pop_moments(pop,k,&std);
+      printf("%s: weighted mean %.6g, weighted standard deviation %.6g\n",cp->priors[k].par->name,mean,std);
+    }
 
-#ifdef CT_OUTPUT
-  if(cp.ctout) {
-    close(cp.ctout);
-    pthread_mutex_destroy(&ctflock);
+    if(prev) abc_pop_free(prev);
+    prev=pop;
   }
-#endif
 
-  //printf("R sum is %f\n",tdata[0].r_mean);
-  //printf("Total number of infectious is %f\n",ninf);
-//#ifdef NUMEVENTSSTATS
-//  const double ninf_per_event_mean=tdata[0].r_mean/tdata[0].nevents_mean;
-//#endif
-  const double nnoe=cp.npaths-tdata[0].pe;
-
-  double inf_timeline_mean[tdata[tmaxnpers].tlpptnvpers];
-  double inf_timeline_std[tdata[tmaxnpers].tlpptnvpers];
-  double newinf_timeline_mean[tdata[tmaxnpers].tlpptnvpers];
-  double newinf_timeline_std[tdata[tmaxnpers].tlpptnvpers];
-  double newpostest_timeline_mean[tdata[tmaxnpers].tlpptnvpers];
-  double newpostest_timeline_std[tdata[tmaxnpers].tlpptnvpers];
-  #ifdef SEC_INF_TIMELINES
-  double secinf_timeline_mean[tdata[tmaxnpers].tlpptnvpers];
-  double secinf_timeline_std[tdata[tmaxnpers].tlpptnvpers];
-  double newsecinf_timeline_mean[tdata[tmaxnpers].tlpptnvpers];
-  double newsecinf_timeline_std[tdata[tmaxnpers].tlpptnvpers];
-  double newsecpostest_timeline_mean[tdata[tmaxnpers].tlpptnvpers];
-  double newsecpostest_timeline_std[tdata[tmaxnpers].tlpptnvpers];
-  #endif
-  double reff_timeline_mean[tdata[tmaxnpers].tlpptnvpers];
-  double reff_timeline_std[tdata[tmaxnpers].tlpptnvpers];
-  uint64_t reff_timeline_n[tdata[tmaxnpers].tlpptnvpers];
-  double reff_mean_ext=0, reff_mean_noext=0, reff_mean;
-  double reff_std_ext=0, reff_std_noext=0, reff_std;
-  uint64_t reff_ext_n=0, reff_noext_n=0, reff_n;
-  #ifdef OBSREFF_OUTPUT
-  double reffobs_timeline_mean[tdata[tmaxnpers].tlpptnvpers];
-  double reffobs_timeline_std[tdata[tmaxnpers].tlpptnvpers];
-  uint64_t reffobs_timeline_n[tdata[tmaxnpers].tlpptnvpers];
-  double reffobs_mean_ext=0, reffobs_mean_noext=0, reffobs_mean=0;
-  double reffobs_std_ext=0, reffobs_std_noext=0, reffobs_std=0;
-  uint64_t reffobs_ext_n=0, reffobs_noext_n=0, reffobs_n=0;
-  #endif
+  for(t=cp->nthreads-1; t>=0; --t) {
+    nsolves+=tdata[t].npriorsolves;
+    gsl_rng_free(tdata[t].r);
+    reservoir_free(&tdata[t].sample);
+  }
+  free(tdata);
+  free(dists);
+  free(recs);
+  free((uint32_t*)nmerges);
+  free(sdata);
+  free(streams);
+  free(setfirstpath);
 
-  for(j=tdata[tmaxnpers].tlpptnvpers-1; j>=0; --j) {
-    inf_timeline_mean[j]=tdata[tmaxnpers].inf_timeline_mean_ext[j]+tdata[tmaxnpers].inf_timeline_mean_noext[j];
-    inf_timeline_std[j]=tdata[tmaxnpers].inf_timeline_std_ext[j]+tdata[tmaxnpers].inf_timeline_std_noext[j];
-    newinf_timeline_mean[j]=tdata[tmaxnpers].newinf_timeline_mean_ext[j]+tdata[tmaxnpers].newinf_timeline_mean_noext[j];
-    newinf_timeline_std[j]=tdata[tmaxnpers].newinf_timeline_std_ext[j]+tdata[tmaxnpers].newinf_timeline_std_noext[j];
-    newpostest_timeline_mean[j]=tdata[tmaxnpers].newpostest_timeline_mean_ext[j]+tdata[tmaxnpers].newpostest_timeline_mean_noext[j];
-    newpostest_timeline_std[j]=tdata[tmaxnpers].newpostest_timeline_std_ext[j]+tdata[tmaxnpers].newpostest_timeline_std_noext[j];
-    #ifdef SEC_INF_TIMELINES
-    secinf_timeline_mean[j]=tdata[tmaxnpers].secinf_timeline_mean_ext[j]+tdata[tmaxnpers].secinf_timeline_mean_noext[j];
-    secinf_timeline_std[j]=tdata[tmaxnpers].secinf_timeline_std_ext[j]+tdata[tmaxnpers].secinf_timeline_std_noext[j];
-    newsecinf_timeline_mean[j]=tdata[tmaxnpers].newsecinf_timeline_mean_ext[j]+tdata[tmaxnpers].newsecinf_timeline_mean_noext[j];
-    newsecinf_timeline_std[j]=tdata[tmaxnpers].newsecinf_timeline_std_ext[j]+tdata[tmaxnpers].newsecinf_timeline_std_noext[j];
-    newsecpostest_timeline_mean[j]=tdata[tmaxnpers].newsecpostest_timeline_mean_ext[j]+tdata[tmaxnpers].newsecpostest_timeline_mean_noext[j];
-    newsecpostest_timeline_std[j]=tdata[tmaxnpers].newsecpostest_timeline_std_ext[j]+tdata[tmaxnpers].newsecpostest_timeline_std_noext[j];
-    #endif
-    reff_timeline_mean[j]=tdata[tmaxnpers].reff_timeline_mean_ext[j]+tdata[tmaxnpers].reff_timeline_mean_noext[j];
-    reff_timeline_std[j]=tdata[tmaxnpers].reff_timeline_std_ext[j]+tdata[tmaxnpers].reff_timeline_std_noext[j];
-    reff_timeline_n[j]=tdata[tmaxnpers].reff_timeline_n_ext[j]+tdata[tmaxnpers].reff_timeline_n_noext[j];
-    reff_ext_n+=tdata[tmaxnpers].reff_timeline_n_ext[j];
-    reff_noext_n+=tdata[tmaxnpers].reff_timeline_n_noext[j];
-    reff_mean_ext+=tdata[tmaxnpers].reff_timeline_mean_ext[j];
-    reff_mean_noext+=tdata[tmaxnpers].reff_timeline_mean_noext[j];
-    reff_std_ext+=tdata[tmaxnpers].reff_timeline_std_ext[j];
-    reff_std_noext+=tdata[tmaxnpers].reff_timeline_std_noext[j];
-    #ifdef OBSREFF_OUTPUT
-    reffobs_timeline_mean[j]=tdata[tmaxnpers].reffobs_timeline_mean_ext[j]+tdata[tmaxnpers].reffobs_timeline_mean_noext[j];
-    reffobs_timeline_std[j]=tdata[tmaxnpers].reffobs_timeline_std_ext[j]+tdata[tmaxnpers].reffobs_timeline_std_noext[j];
-    reffobs_timeline_n[j]=tdata[tmaxnpers].reffobs_timeline_n_ext[j]+tdata[tmaxnpers].reffobs_timeline_n_noext[j];
-    reffobs_ext_n+=tdata[tmaxnpers].reffobs_timeline_n_ext[j];
-    reffobs_noext_n+=tdata[tmaxnpers].reffobs_timeline_n_noext[j];
-    reffobs_mean_ext+=tdata[tmaxnpers].reffobs_timeline_mean_ext[j];
-    reffobs_mean_noext+=tdata[tmaxnpers].reffobs_timeline_mean_noext[j];
-    reffobs_std_ext+=tdata[tmaxnpers].reffobs_timeline_std_ext[j];
-    reffobs_std_noext+=tdata[tmaxnpers].reffobs_timeline_std_noext[j];
-    #endif
-
-    inf_timeline_mean[j]/=cp.npaths;
-    inf_timeline_std[j]=sqrt(cp.npaths/(cp.npaths-1.)*(inf_timeline_std[j]/cp.npaths-inf_timeline_mean[j]*inf_timeline_mean[j]));
-    newinf_timeline_mean[j]/=cp.npaths;
-    newinf_timeline_std[j]=sqrt(cp.npaths/(cp.npaths-1.)*(newinf_timeline_std[j]/cp.npaths-newinf_timeline_mean[j]*newinf_timeline_mean[j]));
-    newpostest_timeline_mean[j]/=cp.npaths;
-    newpostest_timeline_std[j]=sqrt(cp.npaths/(cp.npaths-1.)*(newpostest_timeline_std[j]/cp.npaths-newpostest_timeline_mean[j]*newpostest_timeline_mean[j]));
-    #ifdef SEC_INF_TIMELINES
-    secinf_timeline_mean[j]/=cp.npaths;
-    secinf_timeline_std[j]=sqrt(cp.npaths/(cp.npaths-1.)*(secinf_timeline_std[j]/cp.npaths-secinf_timeline_mean[j]*secinf_timeline_mean[j]));
-    newsecinf_timeline_mean[j]/=cp.npaths;
-    newsecinf_timeline_std[j]=sqrt(cp.npaths/(cp.npaths-1.)*(newsecinf_timeline_std[j]/cp.npaths-newsecinf_timeline_mean[j]*newsecinf_timeline_mean[j]));
-    newsecpostest_timeline_mean[j]/=cp.npaths;
-    newsecpostest_timeline_std[j]=sqrt(cp.npaths/(cp.npaths-1.)*(newsecpostest_timeline_std[j]/cp.npaths-newsecpostest_timeline_mean[j]*newsecpostest_timeline_mean[j]));
-    #endif
-    reff_timeline_mean[j]=(reff_timeline_n[j]?reff_timeline_mean[j]/reff_timeline_n[j]:NAN);
-    reff_timeline_std[j]=(reff_timeline_n[j]>1?sqrt(reff_timeline_n[j]/(reff_timeline_n[j]-1.)*(reff_timeline_std[j]/reff_timeline_n[j]-reff_timeline_mean[j]*reff_timeline_mean[j])):(reff_timeline_n[j]?INFINITY:NAN));
-    #ifdef OBSREFF_OUTPUT
-    reffobs_timeline_mean[j]=(reffobs_timeline_n[j]?reffobs_timeline_mean[j]/reffobs_timeline_n[j]:NAN);
-    reffobs_timeline_std[j]=(reffobs_timeline_n[j]>1?sqrt(reffobs_timeline_n[j]/(reffobs_timeline_n[j]-1.)*(reffobs_timeline_std[j]/reffobs_timeline_n[j]-reffobs_timeline_mean[j]*reffobs_timeline_mean[j])):(reffobs_timeline_n[j]?INFINITY:NAN));
-    #endif
-
-    tdata[tmaxnpers].inf_timeline_mean_ext[j]/=tdata[0].pe;
-    tdata[tmaxnpers].inf_timeline_std_ext[j]=sqrt(tdata[0].pe/(tdata[0].pe-1.)*(tdata[tmaxnpers].inf_timeline_std_ext[j]/tdata[0].pe-tdata[tmaxnpers].inf_timeline_mean_ext[j]*tdata[tmaxnpers].inf_timeline_mean_ext[j]));
-    tdata[tmaxnpers].newinf_timeline_mean_ext[j]/=tdata[0].pe;
-    tdata[tmaxnpers].newinf_timeline_std_ext[j]=sqrt(tdata[0].pe/(tdata[0].pe-1.)*(tdata[tmaxnpers].newinf_timeline_std_ext[j]/tdata[0].pe-tdata[tmaxnpers].newinf_timeline_mean_ext[j]*tdata[tmaxnpers].newinf_timeline_mean_ext[j]));
-    tdata[tmaxnpers].newpostest_timeline_mean_ext[j]/=tdata[0].pe;
-    tdata[tmaxnpers].newpostest_timeline_std_ext[j]=sqrt(tdata[0].pe/(tdata[0].pe-1.)*(tdata[tmaxnpers].newpostest_timeline_std_ext[j]/tdata[0].pe-tdata[tmaxnpers].newpostest_timeline_mean_ext[j]*tdata[tmaxnpers].newpostest_timeline_mean_ext[j]));
-    #ifdef SEC_INF_TIMELINES
-    tdata[tmaxnpers].secinf_timeline_mean_ext[j]/=tdata[0].pe;
-    tdata[tmaxnpers].secinf_timeline_std_ext[j]=sqrt(tdata[0].pe/(tdata[0].pe-1.)*(tdata[tmaxnpers].secinf_timeline_std_ext[j]/tdata[0].pe-tdata[tmaxnpers].secinf_timeline_mean_ext[j]*tdata[tmaxnpers].secinf_timeline_mean_ext[j]));
-    tdata[tmaxnpers].newsecinf_timeline_mean_ext[j]/=tdata[0].pe;
-    tdata[tmaxnpers].newsecinf_timeline_std_ext[j]=sqrt(tdata[0].pe/(tdata[0].pe-1.)*(tdata[tmaxnpers].newsecinf_timeline_std_ext[j]/tdata[0].pe-tdata[tmaxnpers].newsecinf_timeline_mean_ext[j]*tdata[tmaxnpers].newsecinf_timeline_mean_ext[j]));
-    tdata[tmaxnpers].newsecpostest_timeline_mean_ext[j]/=tdata[0].pe;
-    tdata[tmaxnpers].newsecpostest_timeline_std_ext[j]=sqrt(tdata[0].pe/(tdata[0].pe-1.)*(tdata[tmaxnpers].newsecpostest_timeline_std_ext[j]/tdata[0].pe-tdata[tmaxnpers].newsecpostest_timeline_mean_ext[j]*tdata[tmaxnpers].newsecpostest_timeline_mean_ext[j]));
-    #endif
-    tdata[tmaxnpers].reff_timeline_mean_ext[j]=(tdata[tmaxnpers].reff_timeline_n_ext[j]?tdata[tmaxnpers].reff_timeline_mean_ext[j]/tdata[tmaxnpers].reff_timeline_n_ext[j]:NAN);
-    tdata[tmaxnpers].reff_timeline_std_ext[j]=(tdata[tmaxnpers].reff_timeline_n_ext[j]>1?sqrt(tdata[tmaxnpers].reff_timeline_n_ext[j]/(tdata[tmaxnpers].reff_timeline_n_ext[j]-1.)*(tdata[tmaxnpers].reff_timeline_std_ext[j]/tdata[tmaxnpers].reff_timeline_n_ext[j]-tdata[tmaxnpers].reff_timeline_mean_ext[j]*tdata[tmaxnpers].reff_timeline_mean_ext[j])):(tdata[tmaxnpers].reff_timeline_n_ext[j]?INFINITY:NAN));
-    #ifdef OBSREFF_OUTPUT
-    tdata[tmaxnpers].reffobs_timeline_mean_ext[j]=(tdata[tmaxnpers].reffobs_timeline_n_ext[j]?tdata[tmaxnpers].reffobs_timeline_mean_ext[j]/tdata[tmaxnpers].reffobs_timeline_n_ext[j]:NAN);
-    tdata[tmaxnpers].reffobs_timeline_std_ext[j]=(tdata[tmaxnpers].reffobs_timeline_n_ext[j]>1?sqrt(tdata[tmaxnpers].reffobs_timeline_n_ext[j]/(tdata[tmaxnpers].reffobs_timeline_n_ext[j]-1.)*(tdata[tmaxnpers].reffobs_timeline_std_ext[j]/tdata[tmaxnpers].reffobs_timeline_n_ext[j]-tdata[tmaxnpers].reffobs_timeline_mean_ext[j]*tdata[tmaxnpers].reffobs_timeline_mean_ext[j])):(tdata[tmaxnpers].reffobs_timeline_n_ext[j]?INFINITY:NAN));
-    #endif
-
-    tdata[tmaxnpers].inf_timeline_mean_noext[j]/=nnoe;
-    tdata[tmaxnpers].inf_timeline_std_noext[j]=sqrt(nnoe/(nnoe-1.)*(tdata[tmaxnpers].inf_timeline_std_noext[j]/nnoe-tdata[tmaxnpers].inf_timeline_mean_noext[j]*tdata[tmaxnpers].inf_timeline_mean_noext[j]));
-    tdata[tmaxnpers].newinf_timeline_mean_noext[j]/=nnoe;
-    tdata[tmaxnpers].newinf_timeline_std_noext[j]=sqrt(nnoe/(nnoe-1.)*(tdata[tmaxnpers].newinf_timeline_std_noext[j]/nnoe-tdata[tmaxnpers].newinf_timeline_mean_noext[j]*tdata[tmaxnpers].newinf_timeline_mean_noext[j]));
-    tdata[tmaxnpers].newpostest_timeline_mean_noext[j]/=nnoe;
-    tdata[tmaxnpers].newpostest_timeline_std_noext[j]=sqrt(nnoe/(nnoe-1.)*(tdata[tmaxnpers].newpostest_timeline_std_noext[j]/nnoe-tdata[tmaxnpers].newpostest_timeline_mean_noext[j]*tdata[tmaxnpers].newpostest_timeline_mean_noext[j]));
-    #ifdef SEC_INF_TIMELINES
-    tdata[tmaxnpers].secinf_timeline_mean_noext[j]/=nnoe;
-    tdata[tmaxnpers].secinf_timeline_std_noext[j]=sqrt(nnoe/(nnoe-1.)*(tdata[tmaxnpers].secinf_timeline_std_noext[j]/nnoe-tdata[tmaxnpers].secinf_timeline_mean_noext[j]*tdata[tmaxnpers].secinf_timeline_mean_noext[j]));
-    tdata[tmaxnpers].newsecinf_timeline_mean_noext[j]/=nnoe;
-    tdata[tmaxnpers].newsecinf_timeline_std_noext[j]=sqrt(nnoe/(nnoe-1.)*(tdata[tmaxnpers].newsecinf_timeline_std_noext[j]/nnoe-tdata[tmaxnpers].newsecinf_timeline_mean_noext[j]*tdata[tmaxnpers].newsecinf_timeline_mean_noext[j]));
-    tdata[tmaxnpers].newsecpostest_timeline_mean_noext[j]/=nnoe;
-    tdata[tmaxnpers].newsecpostest_timeline_std_noext[j]=sqrt(nnoe/(nnoe-1.)*(tdata[tmaxnpers].newsecpostest_timeline_std_noext[j]/nnoe-tdata[tmaxnpers].newsecpostest_timeline_mean_noext[j]*tdata[tmaxnpers].newsecpostest_timeline_mean_noext[j]));
-    #endif
-    tdata[tmaxnpers].reff_timeline_mean_noext[j]=(tdata[tmaxnpers].reff_timeline_n_noext[j]?tdata[tmaxnpers].reff_timeline_mean_noext[j]/tdata[tmaxnpers].reff_timeline_n_noext[j]:NAN);
-    tdata[tmaxnpers].reff_timeline_std_noext[j]=(tdata[tmaxnpers].reff_timeline_n_noext[j]>1?sqrt(tdata[tmaxnpers].reff_timeline_n_noext[j]/(tdata[tmaxnpers].reff_timeline_n_noext[j]-1.)*(tdata[tmaxnpers].reff_timeline_std_noext[j]/tdata[tmaxnpers].reff_timeline_n_noext[j]-tdata[tmaxnpers].reff_timeline_mean_noext[j]*tdata[tmaxnpers].reff_timeline_mean_noext[j])):(tdata[tmaxnpers].reff_timeline_n_noext[j]?INFINITY:NAN));
-    #ifdef OBSREFF_OUTPUT
-    tdata[tmaxnpers].reffobs_timeline_mean_noext[j]=(tdata[tmaxnpers].reffobs_timeline_n_noext[j]?tdata[tmaxnpers].reffobs_timeline_mean_noext[j]/tdata[tmaxnpers].reffobs_timeline_n_noext[j]:NAN);
-    tdata[tmaxnpers].reffobs_timeline_std_noext[j]=(tdata[tmaxnpers].reffobs_timeline_n_noext[j]>1?sqrt(tdata[tmaxnpers].reffobs_timeline_n_noext[j]/(tdata[tmaxnpers].reffobs_timeline_n_noext[j]-1.)*(tdata[tmaxnpers].reffobs_timeline_std_noext[j]/tdata[tmaxnpers].reffobs_timeline_n_noext[j]-tdata[tmaxnpers].reffobs_timeline_mean_noext[j]*tdata[tmaxnpers].reffobs_timeline_mean_noext[j])):(tdata[tmaxnpers].reffobs_timeline_n_noext[j]?INFINITY:NAN));
-    #endif
-  }
-
-  reff_mean=reff_mean_ext+reff_mean_noext;
-  reff_std=reff_std_ext+reff_std_noext;
-  reff_n=reff_ext_n+reff_noext_n;
-
-  printf("r_mean %22.15e %" PRIu64 "\n",reff_mean,reff_n);
-
-  reff_mean_ext=(reff_ext_n?reff_mean_ext/reff_ext_n:NAN);
-  reff_std_ext=(reff_ext_n>1?sqrt(reff_ext_n/(reff_ext_n-1.)*(reff_std_ext/reff_ext_n-reff_mean_ext*reff_mean_ext)):(reff_ext_n?INFINITY:NAN));
-  reff_mean_noext=(reff_noext_n?reff_mean_noext/reff_noext_n:NAN);
-  reff_std_noext=(reff_noext_n>1?sqrt(reff_noext_n/(reff_noext_n-1.)*(reff_std_noext/reff_noext_n-reff_mean_noext*reff_mean_noext)):(reff_noext_n?INFINITY:NAN));
-  reff_mean=(reff_n?reff_mean/reff_n:NAN);
-  reff_std=(reff_n>1?sqrt(reff_n/(reff_n-1.)*(reff_std/reff_n-reff_mean*reff_mean)):(reff_n?INFINITY:NAN));
-#ifdef OBSREFF_OUTPUT
-  if(!isnan(cp.pars.tdeltat)) {
-    reffobs_mean=reffobs_mean_ext+reffobs_mean_noext;
-    reffobs_std=reffobs_std_ext+reffobs_std_noext;
-    reffobs_n=reffobs_ext_n+reffobs_noext_n;
+  if(!ret) {
+    printf("\nSimulation parameters drawn for %" PRIu32 " ABC generations of %" PRIu32 " paths and solved %" PRIu64 " times\n",cp->abcngens,cp->npaths,nsolves);
 
-    printf("robs_mean %22.15e %" PRIu64 "\n",reffobs_mean,reffobs_n);
+    if(cp->abcoutname) {
 
-    reffobs_mean_ext=(reffobs_ext_n?reffobs_mean_ext/reffobs_ext_n:NAN);
-    reffobs_std_ext=(reffobs_ext_n>1?sqrt(reffobs_ext_n/(reffobs_ext_n-1.)*(reffobs_std_ext/reffobs_ext_n-reffobs_mean_ext*reffobs_mean_ext)):(reffobs_ext_n?INFINITY:NAN));
-    reffobs_mean_noext=(reffobs_noext_n?reffobs_mean_noext/reffobs_noext_n:NAN);
-    reffobs_std_noext=(reffobs_noext_n>1?sqrt(reffobs_noext_n/(reffobs_noext_n-1.)*(reffobs_std_noext/reffobs_noext_n-reffobs_mean_noext*reffobs_mean_noext)):(reffobs_noext_n?INFINITY:NAN));
-    reffobs_mean=(reffobs_n?reffobs_mean/reffobs_n:NAN);
-    reffobs_std=(reffobs_n>1?sqrt(reffobs_n/(reffobs_n-1.)*(reffobs_std/reffobs_n-reffobs_mean*reffobs_mean)):(reffobs_n?INFINITY:NAN));
+      if(abc_pop_write(prev,cp->priors,cp->abcoutname)) ret=1;
+      else printf("Final ABC population of %" PRIu32 " particles written to '%s'\n",prev->n,cp->abcoutname);
+    }
   }
-#endif
 
-  tdata[0].commper_mean/=reff_n;
-#ifdef NUMEVENTSSTATS
-  tdata[0].nevents_mean/=reff_n;
-#endif
-  tdata[0].pe/=cp.npaths;
-  tdata[0].tenz_mean/=tdata[0].penz;
-  tdata[0].tenz_std=sqrt(tdata[0].penz/(tdata[0].penz-1.)*(tdata[0].tenz_std/tdata[0].penz-tdata[0].tenz_mean*tdata[0].tenz_mean));
-  tdata[0].penz/=tdata[0].nnzpaths;
-  tdata[0].pm/=cp.npaths;
+  if(prev) abc_pop_free(prev);
+  return ret;
+}
 
-  printf("\nComputed simulation results:\n");
-  printf("Mean R:\n\t    Extinct: %22.15e +/- %22.15e\n\tNon-extinct: %22.15e +/- %22.15e\n\t      Total: %22.15e +/- %22.15e\n",reff_mean_ext,reff_std_ext/sqrt(reff_ext_n),reff_mean_noext,reff_std_noext/sqrt(reff_noext_n),reff_mean,reff_std/sqrt(reff_n));
-#ifdef OBSREFF_OUTPUT
-  if(!isnan(cp.pars.tdeltat)) printf("Mean observed R:\n\t    Extinct: %22.15e +/- %22.15e\n\tNon-extinct: %22.15e +/- %22.15e\n\t      Total: %22.15e +/- %22.15e\n",reffobs_mean_ext,reffobs_std_ext/sqrt(reffobs_ext_n),reffobs_mean_noext,reffobs_std_noext/sqrt(reffobs_noext_n),reffobs_mean,reffobs_std/sqrt(reffobs_n));
-#endif
-  printf("Communicable period is %22.15e\n",tdata[0].commper_mean);
-#ifdef NUMEVENTSSTATS
-  printf("Number of events per infectious individual is %22.15e\n",tdata[0].nevents_mean);
-  //printf("Number of infections per event is %22.15e\n",ninf_per_event_mean);
-#endif
-  printf("Probability of extinction and its statistical uncertainty: %22.15e +/- %22.15e%s\n",tdata[0].penz,sqrt(tdata[0].penz*(1.-tdata[0].penz)/(tdata[0].nnzpaths-1.)),(tdata[0].maxedoutmintimeindex<INT32_MAX?" (max reached, could be biased if simulation cut)":""));
-  printf("Probability of non outgoing outbreak and its statistical uncertainty: %22.15e +/- %22.15e%s\n",tdata[0].pe,sqrt(tdata[0].pe*(1.-tdata[0].pe)/(cp.npaths-1.)),(tdata[0].maxedoutmintimeindex<INT32_MAX?" (max reached, could be biased if simulation cut)":""));
-  printf("Probability of reaching maximum as defined by nimax/npostestmax and its statistical uncertainty: %22.15e +/- %22.15e\n",tdata[0].pm,sqrt(tdata[0].pm*(1.-tdata[0].pm)/(cp.npaths-1.)));
-  printf("Probability of reaching maximum as defined by nimax/npostestmax and its statistical uncertainty: %22.15e +/- %22.15e\n",tdata[0].pm,sqrt(tdata[0].pm*(1.-tdata[0].pm)/(cp.npaths-1.)));
-  printf("Extinction time, if it occurs is %22.15e +/- %22.15e%s\n",tdata[0].tenz_mean,tdata[0].tenz_std,(tdata[0].maxedoutmintimeindex<INT32_MAX?" (max reached, could be biased if simulation cut)":""));
+void* simthread(void* arg)
+{
+  thread_data* data=(thread_data*)arg;
+  sim_state st;
 
-  int shift=tdata[tmaxnpers].tlppnnpers;
-  printf("\nCurrent infection (non-isolated infected individuals) timeline, for paths with extinction vs no extinction vs overall is:\n");
-  for(j=0; j<tdata[tmaxnpers].tlpptnvpers; ++j) printf("%6.2f: %22.15e +/- %22.15e\t%22.15e +/- %22.15e\t%22.15e +/- %22.15e%s\n",(j-shift)/(double)cp.nbinsperunit,tdata[tmaxnpers].inf_timeline_mean_ext[j],tdata[tmaxnpers].inf_timeline_std_ext[j],tdata[tmaxnpers].inf_timeline_mean_noext[j],tdata[tmaxnpers].inf_timeline_std_noext[j],inf_timeline_mean[j],inf_timeline_std[j],(j-shift<tdata[0].maxedoutmintimeindex?"":" (max reached, biased if simulation cut)"));
+  sim_state_init(&st, data);
+  simulate_sets(data, &st);
+  sim_state_free(&st, data->cp);
+  return NULL;
+}
 
-  printf("\nNew infections (new infected individuals) timeline, for paths with extinction vs no extinction vs overall is:\n");
-  for(j=0; j<tdata[tmaxnpers].tlpptnvpers; ++j) printf("%6.2f: %22.15e +/- %22.15e\t%22.15e +/- %22.15e\t%22.15e +/- %22.15e%s\n",(j-shift)/(double)cp.nbinsperunit,tdata[tmaxnpers].newinf_timeline_mean_ext[j],tdata[tmaxnpers].newinf_timeline_std_ext[j],tdata[tmaxnpers].newinf_timeline_mean_noext[j],tdata[tmaxnpers].newinf_timeline_std_noext[j],newinf_timeline_mean[j],newinf_timeline_std[j],(j-shift<tdata[0].maxedoutmintimeindex?"":" (max reached, biased if simulation cut)"));
+/**
+ * @brief Initialises summary statistics for a simulation state.
+ *
+ * The summary statistics are assigned to the simulation.
+ *
+ * @param sv: Pointer to the simulation variables.
+ * @param stats: Pointer to the summary statistics.
+ * @param data: Pointer to the thread data.
+ * @param tlchans: Filled per-path timeline channels.
+ */
+static void sim_state_stats_init(sim_vars* sv, std_summary_stats* stats, thread_data const* data, const uint32_t tlchans)
+{
+  config_pars const* cp=data->cp;
 
-  if(!isnan(cp.pars.tdeltat)) {
-    printf("\nNew positive test timeline, for paths with extinction vs no extinction vs overall is:\n");
-    for(j=0; j<tdata[tmaxnpers].tlpptnvpers; ++j) printf("%6.2f: %22.15e +/- %22.15e\t%22.15e +/- %22.15e\t%22.15e +/- %22.15e%s\n",(j-shift)/(double)cp.nbinsperunit,tdata[tmaxnpers].newpostest_timeline_mean_ext[j],tdata[tmaxnpers].newpostest_timeline_std_ext[j],tdata[tmaxnpers].newpostest_timeline_mean_noext[j],tdata[tmaxnpers].newpostest_timeline_std_noext[j],newpostest_timeline_mean[j],newpostest_timeline_std[j],(j-shift<tdata[0].maxedoutmintimeindex?"":" (max reached, biased if simulation cut)"));
+  sim_set_proc_data(sv, stats);
+  std_stats_init(sv, cp->nbinsperunit, cp->ninfhist, tlchans);
+  stats->lmax=cp->lmax;
+  stats->nimax=cp->nimax;
+  stats->npostestmax=cp->npostestmax;
+  stats->npostestmaxnunits=cp->npostestmaxnunits;
+
+  if(cp->abcobs) {
+    stats->obs=cp->abcobs;
+    stats->nobs=cp->abcnobs;
+    stats->obschan=cp->abcchan;
+    stats->obsdist=cp->abcdist;
+    stats->obsmaxdist=data->abceps;
   }
 
-#ifdef SEC_INF_TIMELINES
-  printf("\nCurrent infection (non-isolated infected individuals) timeline for the second infection category, for paths with extinction vs no extinction vs overall is:\n");
-  for(j=0; j<tdata[tmaxnpers].tlpptnvpers; ++j) printf("%6.2f: %22.15e +/- %22.15e\t%22.15e +/- %22.15e\t%22.15e +/- %22.15e%s\n",(j-shift)/(double)cp.nbinsperunit,tdata[tmaxnpers].secinf_timeline_mean_ext[j],tdata[tmaxnpers].secinf_timeline_std_ext[j],tdata[tmaxnpers].secinf_timeline_mean_noext[j],tdata[tmaxnpers].secinf_timeline_std_noext[j],secinf_timeline_mean[j],secinf_timeline_std[j],(j-shift<tdata[0].maxedoutmintimeindex?"":" (max reached, biased if simulation cut)"));
+  if(cp->treeout) std_stats_record_tree(stats);
+}
 
-  printf("\nNew infections (new infected individuals) timeline for the second infection category, for paths with extinction vs no extinction vs overall is:\n");
-  for(j=0; j<tdata[tmaxnpers].tlpptnvpers; ++j) printf("%6.2f: %22.15e +/- %22.15e\t%22.15e +/- %22.15e\t%22.15e +/- %22.15e%s\n",(j-shift)/(double)cp.nbinsperunit,tdata[tmaxnpers].newsecinf_timeline_mean_ext[j],tdata[tmaxnpers].newsecinf_timeline_std_ext[j],tdata[tmaxnpers].newsecinf_timeline_mean_noext[j],tdata[tmaxnpers].newsecinf_timeline_std_noext[j],newsecinf_timeline_mean[j],newsecinf_timeline_std[j],(j-shift<tdata[0].maxedoutmintimeindex?"":" (max reached, biased if simulation cut)"));
+void sim_state_init(sim_state* st, thread_data const* data)
+{
+  config_pars const* cp=data->cp;
+  sim_vars* const sv=&st->sv;
+  std_summary_stats* const stats=&st->stats;
 
-  if(!isnan(cp.pars.tdeltat)) {
-    printf("\nNew positive test timeline for the second infection category, for paths with extinction vs no extinction vs overall is:\n");
-    for(j=0; j<tdata[tmaxnpers].tlpptnvpers; ++j) printf("%6.2f: %22.15e +/- %22.15e\t%22.15e +/- %22.15e\t%22.15e +/- %22.15e%s\n",(j-shift)/(double)cp.nbinsperunit,tdata[tmaxnpers].newsecpostest_timeline_mean_ext[j],tdata[tmaxnpers].newsecpostest_timeline_std_ext[j],tdata[tmaxnpers].newsecpostest_timeline_mean_noext[j],tdata[tmaxnpers].newsecpostest_timeline_std_noext[j],newsecpostest_timeline_mean[j],newsecpostest_timeline_std[j],(j-shift<tdata[0].maxedoutmintimeindex?"":" (max reached, biased if simulation cut)"));
-  }
-#endif
+  sim_init(sv,&cp->pars,data->r);
+  sim_set_proc_data(sv, stats);
+  sim_set_ii_alloc_proc_func(sv, std_stats_ii_alloc);
 
-  printf("\nReff timeline, for paths with extinction vs no extinction vs overall is:\n");
-  for(j=0; j<tdata[tmaxnpers].tlpptnvpers; ++j) printf("%6.2f: %22.15e +/- %22.15e\t%22.15e +/- %22.15e\t%22.15e +/- %22.15e%s\n",(j-shift)/(double)cp.nbinsperunit,tdata[tmaxnpers].reff_timeline_mean_ext[j],tdata[tmaxnpers].reff_timeline_std_ext[j],tdata[tmaxnpers].reff_timeline_mean_noext[j],tdata[tmaxnpers].reff_timeline_std_noext[j],reff_timeline_mean[j],reff_timeline_std[j],(j-shift<tdata[0].maxedoutmintimeindex?"":" (max reached, biased if simulation cut)"));
+  if(cp->pars.popsize>0) {
+    finitepopsim_init(sv);
+    st->simfunc=finitepopsim;
+    st->set_pars_func=finitepopsim_set_pars;
 
-  #ifdef OBSREFF_OUTPUT
-  if(!isnan(cp.pars.tdeltat)) {
-    printf("\nObservable Reff timeline, for paths with extinction vs no extinction vs overall is:\n");
-    for(j=0; j<tdata[tmaxnpers].tlpptnvpers; ++j) printf("%6.2f: %22.15e +/- %22.15e\t%22.15e +/- %22.15e\t%22.15e +/- %22.15e%s\n",(j-shift)/(double)cp.nbinsperunit,tdata[tmaxnpers].reffobs_timeline_mean_ext[j],tdata[tmaxnpers].reffobs_timeline_std_ext[j],tdata[tmaxnpers].reffobs_timeline_mean_noext[j],tdata[tmaxnpers].reffobs_timeline_std_noext[j],reffobs_timeline_mean[j],reffobs_timeline_std[j],(j-shift<tdata[0].maxedoutmintimeindex?"":" (max reached, biased if simulation cut)"));
+  } else if(cp->timeordered) {
+    timesim_init(sv, sizeof(std_stats_inf_data));
+    timesim_set_seeds(sv, cp->seeds, cp->nseeds);
+    st->simfunc=timesim;
+    st->set_pars_func=branchsim_set_pars;
+
+  } else {
+    branchsim_init(sv);
+    st->simfunc=branchsim;
+    st->set_pars_func=branchsim_set_pars;
   }
-  #endif
 
-  if(cp.ninfhist) {
-    uint32_t maxninfnbins=tdata[cp.nthreads-1].ninfbins;
-    uint32_t b;
-    int tmaxninfnbins=cp.nthreads-1;
-    int tp;
+  //Only fill the per-path timelines that are needed by the requested outputs
+  const bool alltls=(cp->tlout || cp->ntlquantiles || cp->pathhists || data->priorrecs);
+  uint32_t tlchans=0;
 
-    for(t=cp.nthreads-2; t>=0; --t) {
+  if(alltls || (cp->outputs&ro_output_inf) || cp->pars.timetype==ro_time_first_pos_test_results) tlchans|=std_stats_tl_inf;
 
-      if(tdata[t].ninfbins > maxninfnbins) {
-	maxninfnbins=tdata[t].ninfbins;
-	tp=tmaxninfnbins;
-	tmaxninfnbins=t;
+  if(alltls || (cp->outputs&ro_output_newinf) || cp->nimax<UINT32_MAX || pathsel_finalsize(&cp->outsel)) tlchans|=std_stats_tl_newinf;
 
-      } else tp=t;
+  if(((cp->tlout || cp->ntlquantiles) && !isnan(cp->pars.tdeltat)) || (cp->outputs&ro_output_newpostest) || cp->npostestmax<UINT32_MAX || cp->pars.pathtype!=ro_all_paths || pathsel_postest(&cp->outsel)) tlchans|=std_stats_tl_postest;
 
-      for(b=0; b<tdata[tp].ninfbins; ++b) tdata[tmaxninfnbins].ngeninfs[b]+=tdata[tp].ngeninfs[b];
-      free(tdata[tp].ngeninfs);
-    }
+  if(cp->outputs&(ro_output_reff|ro_output_reffobs)) tlchans|=std_stats_tl_ext;
 
-    printf("\nDistribution of number of generated infections per infectious individual:\n");
-    printf(" n inf\t               count\n");
-    
-    for(b=0; b<maxninfnbins; ++b) if(tdata[tmaxninfnbins].ngeninfs[b] > 0) printf("%6" PRIu32 "\t%20" PRIu64 "\n",b,tdata[tmaxninfnbins].ngeninfs[b]);
-    free(tdata[tmaxninfnbins].ngeninfs);
-  }
-
-  free(tdata[tmaxnpers].inf_timeline_mean_ext);
-  free(tdata[tmaxnpers].inf_timeline_std_ext);
-  free(tdata[tmaxnpers].inf_timeline_mean_noext);
-  free(tdata[tmaxnpers].inf_timeline_std_noext);
-  free(tdata[tmaxnpers].newinf_timeline_mean_ext);
-  free(tdata[tmaxnpers].newinf_timeline_std_ext);
-  free(tdata[tmaxnpers].newinf_timeline_mean_noext);
-  free(tdata[tmaxnpers].newinf_timeline_std_noext);
-  free(tdata[tmaxnpers].newpostest_timeline_mean_ext);
-  free(tdata[tmaxnpers].newpostest_timeline_std_ext);
-  free(tdata[tmaxnpers].newpostest_timeline_mean_noext);
-  free(tdata[tmaxnpers].newpostest_timeline_std_noext);
-  #ifdef SEC_INF_TIMELINES
-  free(tdata[tmaxnpers].secinf_timeline_mean_ext);
-  free(tdata[tmaxnpers].secinf_timeline_std_ext);
-  free(tdata[tmaxnpers].secinf_timeline_mean_noext);
-  free(tdata[tmaxnpers].secinf_timeline_std_noext);
-  free(tdata[tmaxnpers].newsecinf_timeline_mean_ext);
-  free(tdata[tmaxnpers].newsecinf_timeline_std_ext);
-  free(tdata[tmaxnpers].newsecinf_timeline_mean_noext);
-  free(tdata[tmaxnpers].newsecinf_timeline_std_noext);
-  free(tdata[tmaxnpers].newsecpostest_timeline_mean_ext);
-  free(tdata[tmaxnpers].newsecpostest_timeline_std_ext);
-  free(tdata[tmaxnpers].newsecpostest_timeline_mean_noext);
-  free(tdata[tmaxnpers].newsecpostest_timeline_std_noext);
-  #endif
-  free(tdata[tmaxnpers].reff_timeline_mean_ext);
-  free(tdata[tmaxnpers].reff_timeline_std_ext);
-  free(tdata[tmaxnpers].reff_timeline_n_ext);
-  free(tdata[tmaxnpers].reff_timeline_mean_noext);
-  free(tdata[tmaxnpers].reff_timeline_std_noext);
-  free(tdata[tmaxnpers].reff_timeline_n_noext);
-  #ifdef OBSREFF_OUTPUT
-  free(tdata[tmaxnpers].reffobs_timeline_mean_ext);
-  free(tdata[tmaxnpers].reffobs_timeline_std_ext);
-  free(tdata[tmaxnpers].reffobs_timeline_n_ext);
-  free(tdata[tmaxnpers].reffobs_timeline_mean_noext);
-  free(tdata[tmaxnpers].reffobs_timeline_std_noext);
-  free(tdata[tmaxnpers].reffobs_timeline_n_noext);
-  #endif
-  free(tdata);
+  if(cp->abcobs) tlchans|=cp->abcchan;
 
-  fflush(stdout);
-  fflush(stderr);
-  close(cp.oout);
-  close(cp.eout);
+  sim_state_stats_init(sv, stats, data, tlchans);
+  st->tlchans=tlchans;
 
-  return 0;
+  if(!isnan(cp->tscheck)) {
+    st->tscheck=(ts_check*)malloc(sizeof(ts_check));
+    ts_check_init(st->tscheck, cp->tscheck, sizeof(std_stats_inf_data));
+    sim_state_stats_init(sv, &st->tscheck->stats, data, tlchans);
+    sim_set_proc_data(sv, stats);
+
+  } else st->tscheck=NULL;
+
+  if(std_stats_set_proc_funcs(sv)) exit(1);
 }
 
-void* simthread(void* arg)
+void sim_state_free(sim_state* st, config_pars const* cp)
 {
-  thread_data* data=(thread_data*)arg;
-  config_pars const* cp=data->cp;
-  data->nnzpaths=0;
-  data->tlppnnpers=0;
-  data->tlpptnvpers=data->npers;
-  data->commper_mean=0;
-#ifdef NUMEVENTSSTATS
-  data->nevents_mean=0;
-#endif
-  data->pe=0;
-  data->penz=0;
-  data->pm=0;
-  data->tenz_mean=0;
-  data->tenz_std=0;
-  data->maxedoutmintimeindex=INT32_MAX;
-
-  data->inf_timeline_mean_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->inf_timeline_std_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->inf_timeline_mean_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->inf_timeline_std_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newinf_timeline_mean_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newinf_timeline_std_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newinf_timeline_mean_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newinf_timeline_std_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newpostest_timeline_mean_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newpostest_timeline_std_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newpostest_timeline_mean_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newpostest_timeline_std_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  #ifdef SEC_INF_TIMELINES
-  data->secinf_timeline_mean_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->secinf_timeline_std_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->secinf_timeline_mean_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->secinf_timeline_std_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newsecinf_timeline_mean_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newsecinf_timeline_std_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newsecinf_timeline_mean_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newsecinf_timeline_std_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newsecpostest_timeline_mean_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newsecpostest_timeline_std_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newsecpostest_timeline_mean_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->newsecpostest_timeline_std_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  #endif
-  data->reff_timeline_mean_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->reff_timeline_std_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->reff_timeline_n_ext=(uint64_t*)malloc(data->tlpptnvpers*sizeof(uint64_t));
-  data->reff_timeline_mean_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->reff_timeline_std_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->reff_timeline_n_noext=(uint64_t*)malloc(data->tlpptnvpers*sizeof(uint64_t));
-  #ifdef OBSREFF_OUTPUT
-  data->reffobs_timeline_mean_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->reffobs_timeline_std_ext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->reffobs_timeline_n_ext=(uint64_t*)malloc(data->tlpptnvpers*sizeof(uint64_t));
-  data->reffobs_timeline_mean_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->reffobs_timeline_std_noext=(double*)malloc(data->tlpptnvpers*sizeof(double));
-  data->reffobs_timeline_n_noext=(uint64_t*)malloc(data->tlpptnvpers*sizeof(uint64_t));
-  #endif
+  std_stats_free(&st->stats);
 
-  memset(data->inf_timeline_mean_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->inf_timeline_std_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->inf_timeline_mean_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->inf_timeline_std_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newinf_timeline_mean_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newinf_timeline_std_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newinf_timeline_mean_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newinf_timeline_std_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newpostest_timeline_mean_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newpostest_timeline_std_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newpostest_timeline_mean_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newpostest_timeline_std_noext, 0, data->tlpptnvpers*sizeof(double));
-  #ifdef SEC_INF_TIMELINES
-  memset(data->secinf_timeline_mean_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->secinf_timeline_std_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->secinf_timeline_mean_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->secinf_timeline_std_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newsecinf_timeline_mean_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newsecinf_timeline_std_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newsecinf_timeline_mean_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newsecinf_timeline_std_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newsecpostest_timeline_mean_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newsecpostest_timeline_std_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newsecpostest_timeline_mean_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->newsecpostest_timeline_std_noext, 0, data->tlpptnvpers*sizeof(double));
-  #endif
-  memset(data->reff_timeline_mean_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->reff_timeline_std_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->reff_timeline_n_ext, 0, data->tlpptnvpers*sizeof(uint64_t));
-  memset(data->reff_timeline_mean_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->reff_timeline_std_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->reff_timeline_n_noext, 0, data->tlpptnvpers*sizeof(uint64_t));
-  #ifdef OBSREFF_OUTPUT
-  memset(data->reffobs_timeline_mean_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->reffobs_timeline_std_ext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->reffobs_timeline_n_ext, 0, data->tlpptnvpers*sizeof(uint64_t));
-  memset(data->reffobs_timeline_mean_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->reffobs_timeline_std_noext, 0, data->tlpptnvpers*sizeof(double));
-  memset(data->reffobs_timeline_n_noext, 0, data->tlpptnvpers*sizeof(uint64_t));
-  #endif
+  if(st->tscheck) {
+    ts_check_free(st->tscheck);
+    free(st->tscheck);
+  }
+
+  if(cp->pars.popsize>0) finitepopsim_free(&st->sv);
+  else if(cp->timeordered) timesim_free(&st->sv);
+  else branchsim_free(&st->sv);
+}
 
-  data->ninfbins=0;
-  data->ngeninfs=NULL;
+void simulate_sets(thread_data* data, sim_state* st)
+{
+  config_pars const* cp=data->cp;
+  sim_vars* const sv=&st->sv;
+  std_summary_stats* const stats=&st->stats;
+  const uint32_t tlchans=st->tlchans;
 
   char* tloutbuf=NULL;
   const ssize_t tlobasize=cp->tloutbufsize*INT64_C(1024*1024);
@@ -674,7 +1470,7 @@ void* simthread(void* arg)
   ssize_t (*buf_write_func)(std_summary_stats const* stats, char* buf)=NULL;
 
   if(cp->tlout) {
-    tloutbuf=(char*)malloc(tlobasize);
+    tloutbuf=(data->tlaw?awriter_get_buffer(data->tlaw):(char*)malloc(tlobasize));
 
     if(!tloutbuf) {
       fprintf(stderr,"%s: Error: Cannot allocate memory buffer of size %" PRIu32 " MB for timeline file output buffer\n",__func__,cp->tloutbufsize);
@@ -683,13 +1479,13 @@ void* simthread(void* arg)
 
     if(cp->pars.timetype!=ro_time_pri_created && cp->pars.timetype!=ro_time_pri_flat_comm) {
 
-      if(isnan(cp->pars.tdeltat)) buf_write_func=tlo_write_reltime_path;
-      else buf_write_func=tlo_write_reltime_postest_path;
+      if(isnan(cp->pars.tdeltat)) buf_write_func=(cp->tlencode?tlo_write_enc_reltime_path:tlo_write_reltime_path);
+      else buf_write_func=(cp->tlencode?tlo_write_enc_reltime_postest_path:tlo_write_reltime_postest_path);
 
     } else {
 
-      if(isnan(cp->pars.tdeltat)) buf_write_func=tlo_write_reg_path;
-      else buf_write_func=tlo_write_reg_postest_path;
+      if(isnan(cp->pars.tdeltat)) buf_write_func=(cp->tlencode?tlo_write_enc_reg_path:tlo_write_reg_path);
+      else buf_write_func=(cp->tlencode?tlo_write_enc_reg_postest_path:tlo_write_reg_postest_path);
     }
   }
 
@@ -699,7 +1495,7 @@ void* simthread(void* arg)
   char* ctoutbuf=NULL;
 
   if(cp->ctout) {
-    ctoutbuf=(char*)malloc(ctobasize);
+    ctoutbuf=(data->ctaw?awriter_get_buffer(data->ctaw):(char*)malloc(ctobasize));
 
     if(!ctoutbuf) {
       fprintf(stderr,"%s: Error: Cannot allocate memory buffer of size %" PRIu32 " MB for contact tracing output buffer\n",__func__,cp->ctoutbufsize);
@@ -708,80 +1504,32 @@ void* simthread(void* arg)
   }
 #endif
 
-  sim_vars sv;
-  //branchsim_init(&sv,.lambda=0.5,.p=0.8,.tmax=6);
-
-  sim_init(&sv,&cp->pars,data->r);
-
-  //printf("Min is %lu, max is %lu\n",gsl_rng_min(r),gsl_rng_max(r));
+  const ssize_t treeobasize=cp->treeoutbufsize*INT64_C(1024*1024);
+  ssize_t treeobsize=0;
+  char* treeoutbuf=NULL;
 
-  //uint32_t nr=0;
+  if(cp->treeout) {
+    treeoutbuf=(data->treeaw?awriter_get_buffer(data->treeaw):(char*)malloc(treeobasize));
 
-  std_summary_stats stats;
-
-  sim_set_proc_data(&sv, &stats);
-  sim_set_path_init_proc_func(&sv, std_stats_path_init);
-  sim_set_path_end_proc_func(&sv, std_stats_path_end);
-
-  if(cp->pars.timetype==ro_time_pri_created || cp->pars.timetype==ro_time_pri_flat_comm || cp->pars.timetype==ro_time_first_pos_test_results) sim_set_pri_init_proc_func(&sv, std_stats_pri_init);
-  else sim_set_pri_init_proc_func(&sv, std_stats_pri_init_rel);
-
-  if( cp->pars.timetype==ro_time_first_pos_test_results) {
-    sim_set_new_inf_proc_func(&sv, std_stats_new_inf_first_pos_test_results);
-
-    if(cp->ninfhist) {
-      sim_set_end_inf_proc_func(&sv, std_stats_end_inf_rec_ninfs);
-      sim_set_new_inf_proc_noevent_func(&sv, std_stats_noevent_new_inf_rec_ninfs_first_pos_test_results);
-
-    } else {
-      sim_set_end_inf_proc_func(&sv, std_stats_end_inf);
-      sim_set_new_inf_proc_noevent_func(&sv, std_stats_noevent_new_inf_first_pos_test_results);
-    }
-
-  } else {
-    sim_set_new_inf_proc_func(&sv, std_stats_new_inf);
-
-    if(cp->ninfhist) {
-      sim_set_end_inf_proc_func(&sv, std_stats_end_inf_rec_ninfs);
-      sim_set_new_inf_proc_noevent_func(&sv, std_stats_noevent_new_inf_rec_ninfs);
-
-    } else {
-      sim_set_end_inf_proc_func(&sv, std_stats_end_inf);
-      sim_set_new_inf_proc_noevent_func(&sv, std_stats_noevent_new_inf);
+    if(!treeoutbuf) {
+      fprintf(stderr,"%s: Error: Cannot allocate memory buffer of size %" PRIu32 " MB for transmission tree output buffer\n",__func__,cp->treeoutbufsize);
+      exit(1);
     }
   }
 
-  sim_set_ii_alloc_proc_func(&sv, std_stats_ii_alloc);
-
-  if(cp->nimax == UINT32_MAX) {
-
-    if(cp->npostestmax == UINT32_MAX) sim_set_new_event_proc_func(&sv, std_stats_new_event);
-    else sim_set_new_event_proc_func(&sv, std_stats_new_event_npostestmax);
-
-  } else sim_set_new_event_proc_func(&sv, std_stats_new_event_nimax);
+  //The parameters drawn from the priors are solved once per grid point
+  prior_cache pc;
+  double* pvals=NULL;
+  model_pars const* ppars;
 
-  int (*simfunc)(sim_vars*);
-
-  if(cp->pars.popsize>0) {
-    finitepopsim_init(&sv);
-    simfunc=finitepopsim;
-
-  } else {
-    branchsim_init(&sv);
-    simfunc=branchsim;
+  if(cp->npriors) {
+    prior_cache_init(&pc, cp->priors, cp->npriors);
+    pvals=(double*)malloc(cp->npriors*sizeof(double));
   }
 
-  if(cp->ninfhist) std_stats_init(&sv, cp->nbinsperunit, true);
-
-  else std_stats_init(&sv, cp->nbinsperunit, false);
-
-  stats.lmax=cp->lmax;
-  stats.nimax=cp->nimax;
-  stats.npostestmax=cp->npostestmax;
-  stats.npostestmaxnunits=cp->npostestmaxnunits;
   int i,j,k;
-  uint32_t curset=data->id;
-  uint32_t initpath;
+  uint32_t curset;
+  set_data* sd;
   uint32_t npaths;
   uint32_t* abs_inf_timeline;
   uint32_t* abs_newinf_timeline;
@@ -793,43 +1541,112 @@ void* simthread(void* arg)
   #endif
   ext_timeline_info* abs_ext_timeline;
   int32_t dshift;
+  int noext;
   ssize_t maxwrite;
+  ssize_t recsize;
+  uint32_t pathflags;
+  uint64_t path;
+  uint64_t key=0;
+  bool pathout;
+  const bool sample=(cp->outsel.sample>0);
+  const bool outsel=pathsel_active(&cp->outsel);
+  char const* srecs[ro_pathsel_noutputs]={NULL};
+  uint32_t ssizes[ro_pathsel_noutputs]={0};
+  uint32_t scounts[ro_pathsel_noutputs]={0};
 #ifdef SEC_INF_TIMELINES
-  const ssize_t binsize=2*(2+(!isnan(cp->pars.tdeltat)))*sizeof(uint32_t);
+  const ssize_t binsize=2*(2+(!isnan(cp->pars.tdeltat)))*(cp->tlencode?TLO_VARINT_MAXSIZE:sizeof(uint32_t));
 #else
-  const ssize_t binsize=(2+(!isnan(cp->pars.tdeltat)))*sizeof(uint32_t);
+  const ssize_t binsize=(2+(!isnan(cp->pars.tdeltat)))*(cp->tlencode?TLO_VARINT_MAXSIZE:sizeof(uint32_t));
 #endif
+  const ssize_t rechdrsize=(cp->tlencode?4*TLO_VARINT_MAXSIZE:16);
   ext_timeline_info* eti;
-
-  do {
-
-    //printf("%22.15e\t%22.15e\n",curset*data->npathsperset,(curset+1)*data->npathsperset);
-    initpath=round(curset*data->npathsperset);
-    npaths=round((curset+1)*data->npathsperset)-initpath;
+  const uint32_t nqbuckets=(cp->ntlquantiles?lhist_nbuckets(cp->tlqprecbits):0);
+  const uint32_t phntbins=(cp->pathhists?path_hist_ntbins(cp):0);
+  uint64_t finalsize;
+  uint32_t peakinf;
+  int32_t peakbin;
+  double* prec;
+
+  //Each set uses its own RNG stream and its own statistics, such that the
+  //results do not depend on the thread the set is assigned to
+  for(curset=data->firstset+data->id; curset<data->endset && (!data->as || curset<data->as->stopset); curset=__sync_fetch_and_add(data->set,1)) {
+
+    //Sets completed before the checkpoint are not simulated again
+    if(data->setstate && data->setstate[curset]) continue;
+    sd=data->sdata+curset;
+    init_set_data(sd, cp, data->npers);
+
+    if(data->as) data->as->started[curset]=true;
+    *(rng_stream*)data->r->state=data->streams[curset];
+
+    npaths=data->setfirstpath[curset+1]-data->setfirstpath[curset];
     //printf("npaths %u\n",npaths);
 
+    data->npaths+=npaths;
+
     for(i=npaths-1; i>=0; --i) {
-      simfunc(&sv);
 
-      eti=stats.ext_timeline-stats.tlshift;
-      data->commper_mean+=eti->commpersum;
+      //Sets at or after the stop set are discarded
+      if(data->as && curset>=data->as->stopset) break;
+      path=data->setfirstpath[curset]+npaths-1-i;
+
+      //Parameters are drawn from the stream of the set, before the path
+      if(cp->npriors) {
+
+	if(!data->abcpop) prior_draw(cp->priors, cp->npriors, data->r, pvals);
+
+	else if(abc_propose(data->abcpop, cp->priors, data->r, pvals)) {
+	  fprintf(stderr,"%s: Error: Cannot propose simulation parameters for path %" PRIu64 "\n",__func__,path);
+	  exit(1);
+	}
+
+	if(!(ppars=prior_cache_solve(&pc, cp->priors, &cp->basepars, pvals))) {
+	  fprintf(stderr,"%s: Error: Invalid simulation parameters drawn from the priors for path %" PRIu64 "\n",__func__,path);
+	  exit(1);
+	}
+	st->set_pars_func(sv, ppars);
+      }
+
+      if(st->tscheck?ts_check_path(sv, st->tscheck):st->simfunc(sv)) {
+	fprintf(stderr,"%s: Error: Cannot simulate path %" PRIu64 "\n",__func__,path);
+	exit(1);
+      }
+
+      if(data->abcdists) {
+	data->abcdists[path-data->setfirstpath[data->firstset]]=(stats->rejected?INFINITY:std_stats_obs_distance(stats,false));
+	data->nabcrejected+=stats->rejected;
+      }
+
+      if(cp->outputs&ro_output_reff) {
+	eti=stats->ext_timeline-stats->tlshift;
+	sd->commper_mean+=eti->commpersum;
 #ifdef NUMEVENTSSTATS
-      data->nevents_mean+=stats.ext_timeline->neventssum;
+	sd->nevents_mean+=stats->ext_timeline->neventssum;
 #endif
-      //nr+=stats.n_ended_infections;
-      abs_inf_timeline=stats.pp_inf_timeline-stats.tlppnnpers;
-      abs_newinf_timeline=stats.pp_newinf_timeline-stats.tlppnnpers;
-      abs_newpostest_timeline=stats.pp_newpostest_timeline-stats.tlppnnpers;
+      }
+      //nr+=stats->n_ended_infections;
+      abs_inf_timeline=(tlchans&std_stats_tl_inf?stats->pp_inf_timeline-stats->tlppnnpers:NULL);
+      abs_newinf_timeline=(tlchans&std_stats_tl_newinf?stats->pp_newinf_timeline-stats->tlppnnpers:NULL);
+      abs_newpostest_timeline=(tlchans&std_stats_tl_postest?stats->pp_newpostest_timeline-stats->tlppnnpers:NULL);
       #ifdef SEC_INF_TIMELINES
-      abs_secinf_timeline=stats.pp_secinf_timeline-stats.tlppnnpers;
-      abs_newsecinf_timeline=stats.pp_newsecinf_timeline-stats.tlppnnpers;
-      abs_newsecpostest_timeline=stats.pp_newsecpostest_timeline-stats.tlppnnpers;
+      abs_secinf_timeline=(tlchans&std_stats_tl_inf?stats->pp_secinf_timeline-stats->tlppnnpers:NULL);
+      abs_newsecinf_timeline=(tlchans&std_stats_tl_newinf?stats->pp_newsecinf_timeline-stats->tlppnnpers:NULL);
+      abs_newsecpostest_timeline=(tlchans&std_stats_tl_postest?stats->pp_newsecpostest_timeline-stats->tlppnnpers:NULL);
       #endif
-      abs_ext_timeline=stats.pp_ext_timeline-stats.tlppnnpers;
-      dshift=stats.tlshifta-stats.tlshift;
+      abs_ext_timeline=(stats->tlchans&std_stats_tl_ext?stats->pp_ext_timeline-stats->tlppnnpers:NULL);
+      dshift=stats->tlshifta-stats->tlshift;
+      pathflags=(stats->extinction?OIDX_FLAG_EXTINCT:0)|(stats->maxedoutmintimeindex<INT32_MAX?OIDX_FLAG_MAXEDOUT:0);
+      pathout=(!outsel || pathsel_select(&cp->outsel, stats, path));
+
+      //Sampled records are written at the start of the buffer, which is
+      //never flushed, and copied to the reservoir
+      if(pathout && sample) {
+	key=pathsel_key(path, cp->stream);
+	pathout=reservoir_accepts(&data->sample, key);
+      }
 
-      if(cp->tlout) {
-	maxwrite=16+binsize*stats.tlpptnvpers;
+      if(cp->tlout && pathout) {
+	maxwrite=rechdrsize+binsize*stats->tlpptnvpers;
 
 	if(tlobsize+maxwrite > tlobasize) {
 
@@ -837,24 +1654,29 @@ void* simthread(void* arg)
 	    fprintf(stderr,"%s: Error: Timeline output from a single path cannot exceed the allocated per-thread memory buffer size!\n",__func__);
 	    exit(1);
 	  }
-	  pthread_mutex_lock(data->tlflock);
 	  //printf("Writing %" PRIi64 " bytes\n",(int64_t)tlobsize);
-
-	  if(write(cp->tlout, tloutbuf, tlobsize)!=tlobsize) {
-	    perror(__func__);
-	    exit(1);
-	  }
-	  pthread_mutex_unlock(data->tlflock);
+	  tloutbuf=flush_output_buffer(data->tlaw, data->tlshard, tloutbuf, tlobsize, &data->tlidx);
 	  tlobsize=0;
 	}
-	tlobsize+=buf_write_func(&stats, tloutbuf+tlobsize);
+	recsize=buf_write_func(stats, tloutbuf+tlobsize);
+
+	if(sample) {
+	  srecs[ro_pathsel_tlout]=tloutbuf;
+	  ssizes[ro_pathsel_tlout]=recsize;
+	  scounts[ro_pathsel_tlout]=tlo_record_nbins((uint8_t*)tloutbuf,cp->tlencode);
+
+	} else {
+
+	  if(data->tlidx.fd>=0) oidx_add(&data->tlidx, tlobsize, path, recsize, tlo_record_nbins((uint8_t*)tloutbuf+tlobsize,cp->tlencode), pathflags);
+	  tlobsize+=recsize;
+	}
       }
 
 #ifdef CT_OUTPUT
-      if(cp->ctout) {
-	qsort(stats.ctentries, stats.nctentries, sizeof(ctposinf*), ctcompar);
-	//printf("Entries: %u, tnctevents: %li\n",stats.nctentries,stats.tnctevents);
-	maxwrite=stats.nctentries*20;
+      if(cp->ctout && pathout) {
+	std_stats_sort_ct_entries(stats);
+	//printf("Entries: %u, tnctevents: %li\n",stats->nctentries,stats->tnctevents);
+	maxwrite=stats->nctentries*20;
 	//printf("Maxwrite: %li\n",maxwrite);
 
 	if(ctobsize+maxwrite > ctobasize) {
@@ -863,156 +1685,232 @@ void* simthread(void* arg)
 	    fprintf(stderr,"%s: Error: Contact tracing output from a single path cannot exceed the allocated per-thread memory buffer size!\n",__func__);
 	    exit(1);
 	  }
-	  pthread_mutex_lock(data->ctflock);
 	  //printf("Writing %" PRIi64 " bytes\n",(int64_t)ctobsize);
+	  ctoutbuf=flush_output_buffer(data->ctaw, data->ctshard, ctoutbuf, ctobsize, &data->ctidx);
+	  ctobsize=0;
+	}
+	recsize=ct_write_func(stats, ctoutbuf+ctobsize);
+
+	if(sample) {
+	  srecs[ro_pathsel_ctout]=ctoutbuf;
+	  ssizes[ro_pathsel_ctout]=recsize;
+	  scounts[ro_pathsel_ctout]=recsize/20;
+
+	} else {
+
+	  if(data->ctidx.fd>=0) oidx_add(&data->ctidx, ctobsize, path, recsize, recsize/20, pathflags);
+	  ctobsize+=recsize;
+	}
+      }
+#endif
 
-	  if(write(cp->ctout, ctoutbuf, ctobsize)!=ctobsize) {
-	    perror(__func__);
+      if(cp->treeout && pathout) {
+	maxwrite=TREE_RECORD_HEADER_SIZE+TREE_NODE_MAXSIZE*stats->ntreenodes;
+
+	if(treeobsize+maxwrite > treeobasize) {
+
+	  if(maxwrite > treeobasize) {
+	    fprintf(stderr,"%s: Error: Transmission tree output from a single path cannot exceed the allocated per-thread memory buffer size!\n",__func__);
 	    exit(1);
 	  }
-	  pthread_mutex_unlock(data->ctflock);
-	  ctobsize=0;
+	  treeoutbuf=flush_output_buffer(data->treeaw, data->treeshard, treeoutbuf, treeobsize, &data->treeidx);
+	  treeobsize=0;
+	}
+	recsize=tree_write_func(stats, treeoutbuf+treeobsize, (cp->pars.timetype==ro_time_first_pos_test_results?stats->first_pos_test_results_time:0));
+
+	if(sample) {
+	  srecs[ro_pathsel_treeout]=treeoutbuf;
+	  ssizes[ro_pathsel_treeout]=recsize;
+	  scounts[ro_pathsel_treeout]=stats->ntreenodes;
+
+	} else {
+
+	  if(data->treeidx.fd>=0) oidx_add(&data->treeidx, treeobsize, path, recsize, stats->ntreenodes, pathflags);
+	  treeobsize+=recsize;
 	}
-	ctobsize+=ct_write_func(&stats, ctoutbuf+ctobsize);
       }
-#endif
 
-      int32_t ndiff=stats.tlppnnpers-data->tlppnnpers;
-      int32_t pdiff=(int32_t)stats.tlpptnvpers-data->tlpptnvpers-ndiff;
+      if(pathout) {
+
+	if(sample) reservoir_add(&data->sample, key, path, pathflags, srecs, ssizes, scounts);
+	else ++data->nwritten;
+      }
+
+      int32_t ndiff=stats->tlppnnpers-sd->tlppnnpers;
+      int32_t pdiff=(int32_t)stats->tlpptnvpers-sd->tlpptnvpers-ndiff;
       dshift=(ndiff<0?-ndiff:0);
 
       if(ndiff<0) ndiff=0;
       if(pdiff<0) pdiff=0;
 
-      realloc_thread_timelines(data, ndiff, pdiff);
+      realloc_set_timelines(sd, ndiff, pdiff);
 
-      if(stats.ninfbins > data->ninfbins) {
-	data->ngeninfs=(uint64_t*)realloc(data->ngeninfs,stats.ninfbins*sizeof(uint64_t));
-	memset(data->ngeninfs+data->ninfbins,0,(stats.ninfbins-data->ninfbins)*sizeof(uint64_t));
-	data->ninfbins=stats.ninfbins;
+      if(stats->ninfbins > sd->ninfbins) {
+	sd->ngeninfs=(uint64_t*)realloc(sd->ngeninfs,stats->ninfbins*sizeof(uint64_t));
+	memset(sd->ngeninfs+sd->ninfbins,0,(stats->ninfbins-sd->ninfbins)*sizeof(uint64_t));
+	sd->ninfbins=stats->ninfbins;
       }
 
-      data->pm+=(stats.maxedoutmintimeindex<INT32_MAX);
+      sd->pm+=(stats->maxedoutmintimeindex<INT32_MAX);
 
-      if(stats.extinction) {
-	data->pe+=stats.extinction;
+      if(stats->extinction) {
+	sd->pe+=stats->extinction;
 
-	if(isinf(stats.extinction_time)!=-1) {
-	  data->penz++;
-	  data->nnzpaths++;
-	  data->tenz_mean+=stats.extinction_time;
-	  data->tenz_std+=stats.extinction_time*stats.extinction_time;
+	if(isinf(stats->extinction_time)!=-1) {
+	  sd->penz++;
+	  sd->nnzpaths++;
+	  sd->tenz_mean+=stats->extinction_time;
+	  sd->tenz_std+=stats->extinction_time*stats->extinction_time;
 	}
 
-	for(j=stats.tlpptnvpers-1; j>=0; --j) {
-	  k=dshift+j;
-	  //printf("data->inf_timeline_mean_ext[%i]+=abs_inf_timeline[%i] (%u)\n",k,j,abs_inf_timeline[j]);
-	  data->inf_timeline_mean_ext[k]+=abs_inf_timeline[j];
-	  data->inf_timeline_std_ext[k]+=(double)abs_inf_timeline[j]*abs_inf_timeline[j];
-	  data->newinf_timeline_mean_ext[k]+=abs_newinf_timeline[j];
-	  data->newinf_timeline_std_ext[k]+=(double)abs_newinf_timeline[j]*abs_newinf_timeline[j];
-	  data->newpostest_timeline_mean_ext[k]+=abs_newpostest_timeline[j];
-	  data->newpostest_timeline_std_ext[k]+=(double)abs_newpostest_timeline[j]*abs_newpostest_timeline[j];
-          #ifdef SEC_INF_TIMELINES
-       	  data->secinf_timeline_mean_ext[k]+=abs_secinf_timeline[j];
-	  data->secinf_timeline_std_ext[k]+=(double)abs_secinf_timeline[j]*abs_secinf_timeline[j];
-	  data->newsecinf_timeline_mean_ext[k]+=abs_newsecinf_timeline[j];
-	  data->newsecinf_timeline_std_ext[k]+=(double)abs_newsecinf_timeline[j]*abs_newsecinf_timeline[j];
-	  data->newsecpostest_timeline_mean_ext[k]+=abs_newsecpostest_timeline[j];
-	  data->newsecpostest_timeline_std_ext[k]+=(double)abs_newsecpostest_timeline[j]*abs_newsecpostest_timeline[j];
-          #endif
-
-	  if(abs_ext_timeline[j].n) {
-	    data->reff_timeline_mean_ext[k]+=abs_ext_timeline[j].rsum;
-	    data->reff_timeline_std_ext[k]+=abs_ext_timeline[j].r2sum;
-	    data->reff_timeline_n_ext[k]+=abs_ext_timeline[j].n;
-	  }
+      } else {
+	sd->nnzpaths++;
 
-	  #ifdef OBSREFF_OUTPUT
-	  if(abs_ext_timeline[j].nobs) {
-	    data->reffobs_timeline_mean_ext[k]+=abs_ext_timeline[j].robssum;
-	    data->reffobs_timeline_std_ext[k]+=abs_ext_timeline[j].robs2sum;
-	    data->reffobs_timeline_n_ext[k]+=abs_ext_timeline[j].nobs;
-	  }
-          #endif
+	if(stats->maxedoutmintimeindex < sd->maxedoutmintimeindex) sd->maxedoutmintimeindex=stats->maxedoutmintimeindex;
+      }
+
+      noext=!stats->extinction;
+
+      if(cp->outputs&ro_output_inf) {
+	acc_add_counts(sd,ro_acc_inf,noext,dshift,abs_inf_timeline,stats->tlpptnvpers);
+#ifdef SEC_INF_TIMELINES
+	acc_add_counts(sd,ro_acc_secinf,noext,dshift,abs_secinf_timeline,stats->tlpptnvpers);
+#endif
+      }
+
+      if(cp->outputs&ro_output_newinf) {
+	acc_add_counts(sd,ro_acc_newinf,noext,dshift,abs_newinf_timeline,stats->tlpptnvpers);
+#ifdef SEC_INF_TIMELINES
+	acc_add_counts(sd,ro_acc_newsecinf,noext,dshift,abs_newsecinf_timeline,stats->tlpptnvpers);
+#endif
+      }
+
+      if(cp->outputs&ro_output_newpostest) {
+	acc_add_counts(sd,ro_acc_newpostest,noext,dshift,abs_newpostest_timeline,stats->tlpptnvpers);
+#ifdef SEC_INF_TIMELINES
+	acc_add_counts(sd,ro_acc_newsecpostest,noext,dshift,abs_newsecpostest_timeline,stats->tlpptnvpers);
+#endif
+      }
+
+      if(cp->outputs&ro_output_reff) acc_add_reff(sd,noext,dshift,abs_ext_timeline,stats->tlpptnvpers);
+#ifdef OBSREFF_OUTPUT
+
+      if(cp->outputs&ro_output_reffobs) acc_add_reffobs(sd,noext,dshift,abs_ext_timeline,stats->tlpptnvpers);
+#endif
+
+      if(nqbuckets) {
+
+	for(j=stats->tlpptnvpers-1; j>=0; --j) {
+	  k=(dshift+j)*nqbuckets;
+
+	  if(abs_inf_timeline[j]) ++sd->inf_timeline_qsk[k+lhist_index(abs_inf_timeline[j],cp->tlqprecbits)];
+
+	  if(abs_newinf_timeline[j]) ++sd->newinf_timeline_qsk[k+lhist_index(abs_newinf_timeline[j],cp->tlqprecbits)];
+
+	  if(abs_newpostest_timeline && abs_newpostest_timeline[j]) ++sd->newpostest_timeline_qsk[k+lhist_index(abs_newpostest_timeline[j],cp->tlqprecbits)];
 	}
+      }
 
-      } else {
-	data->nnzpaths++;
-
-	if(stats.maxedoutmintimeindex < data->maxedoutmintimeindex) data->maxedoutmintimeindex=stats.maxedoutmintimeindex;
-
-	for(j=stats.tlpptnvpers-1; j>=0; --j) {
-	  k=dshift+j;
-	  //printf("data->inf_timeline_mean_ext[%i]+=abs_inf_timeline[%i] (%u)\n",k,j,abs_inf_timeline[j]);
-	  data->inf_timeline_mean_noext[k]+=abs_inf_timeline[j];
-	  data->inf_timeline_std_noext[k]+=(double)abs_inf_timeline[j]*abs_inf_timeline[j];
-	  data->newinf_timeline_mean_noext[k]+=abs_newinf_timeline[j];
-	  data->newinf_timeline_std_noext[k]+=(double)abs_newinf_timeline[j]*abs_newinf_timeline[j];
-	  data->newpostest_timeline_mean_noext[k]+=abs_newpostest_timeline[j];
-	  data->newpostest_timeline_std_noext[k]+=(double)abs_newpostest_timeline[j]*abs_newpostest_timeline[j];
-          #ifdef SEC_INF_TIMELINES
-	  data->secinf_timeline_mean_noext[k]+=abs_secinf_timeline[j];
-	  data->secinf_timeline_std_noext[k]+=(double)abs_secinf_timeline[j]*abs_secinf_timeline[j];
-	  data->newsecinf_timeline_mean_noext[k]+=abs_newsecinf_timeline[j];
-	  data->newsecinf_timeline_std_noext[k]+=(double)abs_newsecinf_timeline[j]*abs_newsecinf_timeline[j];
-	  data->newsecpostest_timeline_mean_noext[k]+=abs_newsecpostest_timeline[j];
-	  data->newsecpostest_timeline_std_noext[k]+=(double)abs_newsecpostest_timeline[j]*abs_newsecpostest_timeline[j];
-          #endif
-
-	  if(abs_ext_timeline[j].n) {
-	    data->reff_timeline_mean_noext[k]+=abs_ext_timeline[j].rsum;
-	    data->reff_timeline_std_noext[k]+=abs_ext_timeline[j].r2sum;
-	    data->reff_timeline_n_noext[k]+=abs_ext_timeline[j].n;
-	  }
+      if(cp->pathhists || data->priorrecs) {
+	finalsize=0;
+	peakinf=0;
+	peakbin=0;
 
-	  #ifdef OBSREFF_OUTPUT
-	  if(abs_ext_timeline[j].nobs) {
-	    data->reffobs_timeline_mean_noext[k]+=abs_ext_timeline[j].robssum;
-	    data->reffobs_timeline_std_noext[k]+=abs_ext_timeline[j].robs2sum;
-	    data->reffobs_timeline_n_noext[k]+=abs_ext_timeline[j].nobs;
+	for(j=0; j<stats->tlpptnvpers; ++j) {
+	  finalsize+=abs_newinf_timeline[j];
+
+	  if(abs_inf_timeline[j] > peakinf) {
+	    peakinf=abs_inf_timeline[j];
+	    peakbin=j;
 	  }
-          #endif
+	}
+
+	if(data->priorrecs) {
+	  prec=data->priorrecs+(path-data->setfirstpath[data->firstset])*(cp->npriors+PRIOR_REC_NOUTCOMES);
+	  memcpy(prec, pvals, cp->npriors*sizeof(double));
+	  prec+=cp->npriors;
+	  prec[0]=stats->extinction;
+	  prec[1]=(stats->maxedoutmintimeindex<INT32_MAX);
+	  prec[2]=(stats->extinction && isinf(stats->extinction_time)!=-1?stats->extinction_time:NAN);
+	  prec[3]=finalsize;
+	  prec[4]=peakinf;
+	}
+
+	if(cp->pathhists) {
+	  ++sd->finalsize_hist[lhist_index(finalsize<UINT32_MAX?finalsize:UINT32_MAX,cp->phprecbits)];
+	  ++sd->peakinf_hist[lhist_index(peakinf,cp->phprecbits)];
+
+	  //Bin centres are used to avoid rounding issues at the bin edges
+	  if(peakinf) ++sd->peaktime_hist[linhist_index((peakbin-stats->tlppnnpers+0.5)/cp->nbinsperunit,cp->phtmin,cp->nbinsperunit,phntbins)];
+
+	  if(stats->extinction && isinf(stats->extinction_time)!=-1) ++sd->exttime_hist[linhist_index(stats->extinction_time,cp->phtmin,cp->nbinsperunit,phntbins)];
 	}
       }
 
-      for(j=stats.ninfbins-1; j>=0; --j) {
-	data->ngeninfs[j]+=eti->ngeninfs[j];
+      if(cp->ninfhist) {
+	eti=stats->ext_timeline-stats->tlshift;
+
+	for(j=stats->ninfbins-1; j>=0; --j) {
+	  sd->ngeninfs[j]+=eti->ngeninfs[j];
+	}
       }
     }
-    curset=__sync_fetch_and_add(data->set,1);
 
-  } while(curset<data->nsets);
+    //Checkpointed shard sizes only include the records of completed sets
+    if(data->setstate) {
+
+      if(cp->tlout) {
+	submit_output_buffer(data->tlaw, data->tlshard, tloutbuf, tlobsize, &data->tlidx);
+	tlobsize=0;
+      }
+#ifdef CT_OUTPUT
+
+      if(cp->ctout) {
+	submit_output_buffer(data->ctaw, data->ctshard, ctoutbuf, ctobsize, &data->ctidx);
+	ctobsize=0;
+      }
+#endif
+
+      if(cp->treeout) {
+	submit_output_buffer(data->treeaw, data->treeshard, treeoutbuf, treeobsize, &data->treeidx);
+	treeobsize=0;
+      }
+    }
+    complete_set(data, curset);
+  }
+  data->tend=monotonic_time();
 
   if(cp->tlout) {
-    pthread_mutex_lock(data->tlflock);
     //printf("Writing %" PRIi64 " bytes\n",(int64_t)tlobsize);
 
-    if(write(cp->tlout, tloutbuf, tlobsize)!=tlobsize) {
-      perror(__func__);
-      exit(1);
-    }
-    pthread_mutex_unlock(data->tlflock);
-    free(tloutbuf);
+    submit_output_buffer(data->tlaw, data->tlshard, tloutbuf, tlobsize, &data->tlidx);
+
+    if(!data->tlaw) free(tloutbuf);
+    oidx_writer_free(&data->tlidx);
   }
 
 #ifdef CT_OUTPUT
   if(cp->ctout) {
-    pthread_mutex_lock(data->ctflock);
     //printf("Writing %" PRIi64 " bytes\n",(int64_t)ctobsize);
 
-    if(write(cp->ctout, ctoutbuf, ctobsize)!=ctobsize) {
-      perror(__func__);
-      exit(1);
-    }
-    pthread_mutex_unlock(data->ctflock);
-    free(ctoutbuf);
+    submit_output_buffer(data->ctaw, data->ctshard, ctoutbuf, ctobsize, &data->ctidx);
+
+    if(!data->ctaw) free(ctoutbuf);
+    oidx_writer_free(&data->ctidx);
   }
 #endif
 
-  std_stats_free(&stats);
-  if(cp->pars.popsize>0) finitepopsim_free(&sv);
-  else branchsim_free(&sv);
+  if(cp->treeout) {
+    submit_output_buffer(data->treeaw, data->treeshard, treeoutbuf, treeobsize, &data->treeidx);
+
+    if(!data->treeaw) free(treeoutbuf);
+    oidx_writer_free(&data->treeidx);
+  }
+
+  if(cp->npriors) {
+    data->npriorsolves+=pc.nsolved;
+    prior_cache_free(&pc);
+    free(pvals);
+  }
 
-  return NULL;
 }
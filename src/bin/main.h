@@ -6,9 +6,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
 #include <unistd.h>
 
 #include <math.h>
+#include <time.h>
 
 #include <endian.h>
 
@@ -18,406 +21,1154 @@
 
 #include <gsl/gsl_rng.h>
 
-#include "rngstream_gsl.h"
+#include "rngstream.h"
 
 #include "config.h"
+#include "async_writer.h"
 #include "model_parameters.h"
 #include "infindividual.h"
 #include "branchsim.h"
+#include "timesim.h"
+#include "tscheck.h"
 #include "finitepopsim.h"
 #include "standard_summary_stats.h"
+#include "timeline_accumulator.h"
+#include "summary_output.h"
+#include "output_manifest.h"
+#include "tlout_codec.h"
+#include "output_index.h"
+#include "checkpoint.h"
+#include "result_cache.h"
+#include "sweep.h"
+#include "result_files.h"
+
+#define TREE_RECORD_HEADER_SIZE (4+TLO_VARINT_MAXSIZE)	//!< Maximum size of the header of a transmission tree output record
+#define TREE_NODE_MAXSIZE (51)	//!< Maximum encoded size of a transmission tree node
 
 /**
  * @brief Main function.
  */
 int main(const int nargs, const char* args[]);
 
+/**
+ * Accumulated timeline channels.
+ */
+enum ro_acc_chans {ro_acc_inf, ro_acc_newinf, ro_acc_newpostest,
+#ifdef SEC_INF_TIMELINES
+  ro_acc_secinf, ro_acc_newsecinf, ro_acc_newsecpostest,
+#endif
+  ro_acc_reff,
+#ifdef OBSREFF_OUTPUT
+  ro_acc_reffobs,
+#endif
+  ro_acc_nchans
+};
+
+/**
+ * Accumulated quantities for each timeline channel, for paths with
+ * extinction and then for paths without extinction. Only the Reff channels
+ * accumulate the number of infectious individuals.
+ */
+enum ro_acc_fields {ro_acc_sum, ro_acc_sum2lo, ro_acc_sum2hi, ro_acc_n};
+
+/**
+ * Statistics accumulated over a set of paths, or over merged sets of paths.
+ */
+typedef struct set_data_ {
+  config_pars const* cp;		//!< Configuration parameters.
+  uint32_t nnzpaths;			//!< Number of paths without extinction at time zero.
+  int32_t tlppnnpers;			//!< Number of timeline bins before time zero.
+  uint32_t tlpptnvpers;			//!< Total number of timeline bins.
+  double commper_mean;			//!< Sum of the communicable periods.
+#ifdef NUMEVENTSSTATS
+  double nevents_mean;			//!< Sum of the number of events.
+#endif
+  double pe;				//!< Number of paths with extinction.
+  double penz;				//!< Number of paths with extinction after time zero.
+  double pm;				//!< Number of paths that reached the maximum.
+  double tenz_mean;			//!< Sum of the extinction times after time zero.
+  double tenz_std;			//!< Sum of the squared extinction times after time zero.
+  tlaccumulator acc;			//!< Timeline accumulator.
+  int32_t accfield[ro_acc_nchans];	//!< First accumulator field of each timeline channel, or -1 if the channel is not accumulated.
+  uint32_t* inf_timeline_qsk;		//!< Current infection timeline quantile sketches.
+  uint32_t* newinf_timeline_qsk;	//!< New infection timeline quantile sketches.
+  uint32_t* newpostest_timeline_qsk;	//!< New positive test timeline quantile sketches.
+  uint32_t* finalsize_hist;		//!< Final size histogram.
+  uint32_t* peakinf_hist;		//!< Peak number of current infections histogram.
+  uint32_t* peaktime_hist;		//!< Peak time histogram.
+  uint32_t* exttime_hist;		//!< Extinction time histogram.
+  uint64_t* ngeninfs;			//!< Histogram of the number of generated infections.
+  uint32_t ninfbins;			//!< Number of bins of the ngeninfs histogram.
+  int32_t maxedoutmintimeindex;		//!< Earliest bin index where the maximum was reached.
+} set_data;
+
+/**
+ * Checkpoint states of the path sets.
+ */
+enum ro_ckpt_set_state {ro_set_pending, ro_set_live, ro_set_merged};
+
+/**
+ * Progress of a thread at the end of its last completed set.
+ */
+typedef struct {
+  uint64_t npaths;			//!< Number of paths simulated by the thread.
+  uint64_t nwritten;			//!< Number of paths written by the thread.
+  uint64_t offsets[ro_pathsel_noutputs];	//!< Size of the shard file of each output.
+  uint64_t nrecs[ro_pathsel_noutputs];	//!< Number of records in the shard file of each output.
+} thread_progress;
+
 typedef struct {
   config_pars const* cp;
-  double npathsperset;
+  uint32_t const* setfirstpath;	//!< Index of the first path of each set, followed by the total number of paths.
   uint32_t id;
   uint32_t nsets;
+  uint32_t firstset;		//!< Index of the first simulated set. The statistics of the previous sets are loaded from an accumulator file.
+  uint32_t endset;		//!< Index following the last simulated set.
+  uint32_t treesize;		//!< Number of leaves of the set merging tree, which is not smaller than nsets.
   int32_t nbinsperunit;
-  uint32_t nnzpaths;
   uint32_t npers;
-  int32_t tlppnnpers;
-  uint32_t tlpptnvpers;
   uint32_t volatile* set;
-  double commper_mean;
-#ifdef NUMEVENTSSTATS
-  double nevents_mean;
-#endif
-  double pe;
-  double penz;
-  double pm;
-  double tenz_mean;
-  double tenz_std;
-  double* inf_timeline_mean_ext;
-  double* inf_timeline_std_ext;
-  double* inf_timeline_mean_noext;
-  double* inf_timeline_std_noext;
-  double* newinf_timeline_mean_ext;
-  double* newinf_timeline_std_ext;
-  double* newinf_timeline_mean_noext;
-  double* newinf_timeline_std_noext;
-  double* newpostest_timeline_mean_ext;
-  double* newpostest_timeline_std_ext;
-  double* newpostest_timeline_mean_noext;
-  double* newpostest_timeline_std_noext;
-  #ifdef SEC_INF_TIMELINES
-  double* secinf_timeline_mean_ext;
-  double* secinf_timeline_std_ext;
-  double* secinf_timeline_mean_noext;
-  double* secinf_timeline_std_noext;
-  double* newsecinf_timeline_mean_ext;
-  double* newsecinf_timeline_std_ext;
-  double* newsecinf_timeline_mean_noext;
-  double* newsecinf_timeline_std_noext;
-  double* newsecpostest_timeline_mean_ext;
-  double* newsecpostest_timeline_std_ext;
-  double* newsecpostest_timeline_mean_noext;
-  double* newsecpostest_timeline_std_noext;
-  #endif
-  double* reff_timeline_mean_ext;
-  double* reff_timeline_std_ext;
-  uint64_t* reff_timeline_n_ext;
-  double* reff_timeline_mean_noext;
-  double* reff_timeline_std_noext;
-  uint64_t* reff_timeline_n_noext;
-  #ifdef OBSREFF_OUTPUT
-  double* reffobs_timeline_mean_ext;
-  double* reffobs_timeline_std_ext;
-  uint64_t* reffobs_timeline_n_ext;
-  double* reffobs_timeline_mean_noext;
-  double* reffobs_timeline_std_noext;
-  uint64_t* reffobs_timeline_n_noext;
-  #endif
-  uint64_t* ngeninfs;
-  uint32_t ninfbins;
-  int32_t maxedoutmintimeindex;
+  set_data* sdata;		//!< Statistics of each set of paths. Merged statistics are stored in the slot of their first set.
+  uint32_t volatile* nmerges;	//!< Number of completed children for each merging node of the set tree.
+  rng_stream const* streams;	//!< RNG stream state of each set of paths.
   gsl_rng* r;
-  pthread_mutex_t* tlflock;
-  pthread_mutex_t* ctflock;
+  double tend;			//!< Time at which the thread completed its last set.
+  async_writer* tlaw;		//!< Timeline output writer, or NULL if the thread writes its own shard.
+  async_writer* ctaw;		//!< Contact tracing output writer, or NULL if the thread writes its own shard.
+  async_writer* treeaw;		//!< Transmission tree output writer, or NULL if the thread writes its own shard.
+  int tlshard;			//!< Timeline output shard file descriptor.
+  int ctshard;			//!< Contact tracing output shard file descriptor.
+  int treeshard;		//!< Transmission tree output shard file descriptor.
+  oidx_writer tlidx;		//!< Timeline output index writer.
+  oidx_writer ctidx;		//!< Contact tracing output index writer.
+  oidx_writer treeidx;		//!< Transmission tree output index writer.
+  uint64_t npaths;		//!< Number of paths simulated by the thread.
+  uint64_t nwritten;		//!< Number of paths written by the thread.
+  path_reservoir sample;	//!< Reservoir of the paths sampled by the thread.
+  adaptive_stopping* as;	//!< Adaptive stopping state, or NULL if no precision target is set.
+  uint8_t* setstate;		//!< Checkpoint state of each set (value set using ro_ckpt_set_state), or NULL if checkpoints are not written.
+  pthread_rwlock_t* cklock;	//!< Lock held in read mode while completed sets are merged, and in write mode by checkpoint snapshots.
+  thread_progress progress;	//!< Progress of the thread at the end of its last completed set.
+  double* priorrecs;		//!< Sampled parameters and outcome of each simulated path, or NULL if they are not recorded.
+  uint64_t npriorsolves;	//!< Number of times the simulation parameters were solved for values drawn from the priors.
+  abc_population const* abcpop;	//!< ABC population the sampled parameters are proposed from, or NULL if they are drawn from the priors.
+  double abceps;		//!< Tolerance of the current ABC generation.
+  double* abcdists;		//!< Distance of each simulated path to the observed series, or NULL if ABC is not performed. Rejected paths have an infinite distance.
+  uint64_t nabcrejected;	//!< Number of paths rejected early by the thread.
 } thread_data;
 
+/**
+ * Simulation state used to write checkpoints.
+ */
+typedef struct ckpt_run_ {
+  config_pars const* cp;	//!< Configuration parameters.
+  uint32_t nshares;		//!< Number of shares of paths used to form the path sets.
+  uint32_t nsets;		//!< Number of path sets.
+  uint32_t firstset;		//!< Index of the first simulated set.
+  uint32_t endset;		//!< Index following the last simulated set.
+  uint32_t treesize;		//!< Number of leaves of the set merging tree.
+  uint8_t* setstate;		//!< Checkpoint state of each set (value set using ro_ckpt_set_state).
+  set_data* sdata;		//!< Statistics of each set of paths.
+  uint32_t volatile* nmerges;	//!< Number of completed children for each merging node of the set tree.
+  thread_data* tdata;		//!< Thread data.
+  pthread_rwlock_t lock;	//!< Lock held in read mode while completed sets are merged, and in write mode by checkpoint snapshots.
+} ckpt_run;
+
+/**
+ * State of a parameter sweep point.
+ */
+typedef struct {
+  config_pars cp;		//!< Configuration parameters of the point.
+  set_data* sdata;		//!< Statistics of each set of paths.
+  uint32_t volatile* nmerges;	//!< Number of completed children for each merging node of the set tree.
+  uint32_t volatile set;	//!< Index of the next set to be simulated.
+} sweep_point;
+
+/**
+ * Parameter sweep worker.
+ */
+typedef struct {
+  thread_data tdata;		//!< Thread data, which is pointed to the state of each point in turn.
+  sweep_point* points;		//!< Sweep points.
+  uint32_t npoints;		//!< Number of sweep points.
+} sweep_worker;
+
+/**
+ * Simulation state of a thread.
+ */
+typedef struct {
+  sim_vars sv;					//!< Simulation variables.
+  std_summary_stats stats;			//!< Summary statistics of the current path.
+  int (*simfunc)(sim_vars*);			//!< Path simulation function.
+  void (*set_pars_func)(sim_vars*, model_pars const*);	//!< Function changing the model parameters of the simulation.
+  uint32_t tlchans;				//!< Filled per-path timeline channels.
+  ts_check* tscheck;				//!< Suspension self-check state, or NULL if the suspension is not checked.
+} sim_state;
+
+/**
+ * @brief Simulation thread function.
+ *
+ * @param arg: Pointer to the thread data.
+ */
 void* simthread(void* arg);
 
-inline static void realloc_thread_timelines(thread_data* data, const int32_t ndiff, const int32_t pdiff)
+/**
+ * @brief Initialises the simulation state of a thread.
+ *
+ * @param st: Pointer to the simulation state, which must not be moved
+ * afterwards.
+ * @param data: Pointer to the thread data.
+ */
+void sim_state_init(sim_state* st, thread_data const* data);
+
+/**
+ * @brief Frees the simulation state of a thread.
+ *
+ * @param st: Pointer to the simulation state.
+ * @param cp: Pointer to the configuration parameters used to initialise the
+ * state.
+ */
+void sim_state_free(sim_state* st, config_pars const* cp);
+
+/**
+ * @brief Returns whether a simulation state can be reused for other
+ * configuration parameters by only changing its model parameters.
+ *
+ * The timelines and the simulation engine are allocated for the maximum
+ * time, the number of bins per unit of time and the population size, and
+ * the filled timeline channels depend on whether the testing delay is
+ * defined.
+ *
+ * @param cp: Pointer to the configuration parameters used to initialise the
+ * state.
+ * @param newcp: Pointer to the other configuration parameters.
+ */
+inline static bool sim_state_compatible(config_pars const* cp, config_pars const* newcp){return (newcp->pars.tmax==cp->pars.tmax && newcp->nbinsperunit==cp->nbinsperunit && newcp->pars.popsize==cp->pars.popsize && isnan(newcp->pars.tdeltat)==isnan(cp->pars.tdeltat));}
+
+/**
+ * @brief Simulates the path sets assigned to a thread.
+ *
+ * @param data: Pointer to the thread data.
+ * @param st: Pointer to the simulation state of the thread, initialised
+ * for the model parameters of data->cp.
+ */
+void simulate_sets(thread_data* data, sim_state* st);
+
+/**
+ * @brief Parameter sweep thread function.
+ *
+ * The worker simulates the available path sets of each point in turn, and
+ * moves to the next point as soon as all the sets of the current point are
+ * assigned, such that the threads only wait for each other at the end of
+ * the sweep. The simulation state of the worker is initialised once and
+ * only its model parameters are changed between points, unless the point
+ * is not compatible with the state (see sim_state_compatible).
+ *
+ * @param arg: Pointer to the sweep worker.
+ */
+void* sweepthread(void* arg);
+
+/**
+ * @brief Simulates the points of a parameter sweep and writes their
+ * results.
+ *
+ * @param cp: Pointer to the configuration parameters.
+ * @param name: Executable name, for error messages.
+ * @return 0 on success, 1 on an error.
+ */
+int sweep_run(config_pars const* cp, const char* name);
+
+/**
+ * @brief Performs the ABC generations and writes the final population.
+ *
+ * @param cp: Pointer to the configuration parameters.
+ * @param name: Executable name, for error messages.
+ * @return 0 on success, 1 on an error.
+ */
+int abc_run(config_pars const* cp, const char* name);
+
+/**
+ * @brief Returns the current value of the monotonic clock, in seconds.
+ */
+inline static double monotonic_time(void){struct timespec ts; clock_gettime(CLOCK_MONOTONIC,&ts); return ts.tv_sec+1e-9*ts.tv_nsec;}
+
+/**
+ * @brief Computes a guided partition of the paths into sets.
+ *
+ * Each set contains a fraction 1/nshares of the remaining paths, rounded up,
+ * such that large sets are simulated first and single paths are simulated at
+ * the end. Threads thus complete their work at nearly the same time even when
+ * the cost of paths is heavy-tailed. The partition only depends on npaths and
+ * nshares.
+ *
+ * @param npaths: Total number of paths.
+ * @param nshares: Number of shares the remaining paths are divided into.
+ * @param setfirstpath: If not NULL, receives the index of the first path of
+ * each set, followed by npaths.
+ * @return the number of sets.
+ */
+inline static uint32_t guided_path_sets(const uint32_t npaths, const uint32_t nshares, uint32_t* setfirstpath)
+{
+  uint32_t nsets=0;
+  uint32_t path=0;
+
+  while(path<npaths) {
+
+    if(setfirstpath) setfirstpath[nsets]=path;
+    path+=((uint64_t)npaths-path+nshares-1)/nshares;
+    ++nsets;
+  }
+
+  if(setfirstpath) setfirstpath[nsets]=npaths;
+  return nsets;
+}
+
+/**
+ * @brief Computes a partition of the paths into sets of a fixed size.
+ *
+ * The last set contains the remaining paths. The first paths of each set do
+ * not depend on npaths.
+ *
+ * @param npaths: Total number of paths.
+ * @param setsize: Number of paths of each set.
+ * @param setfirstpath: If not NULL, receives the index of the first path of
+ * each set, followed by npaths.
+ * @return the number of sets.
+ */
+inline static uint32_t fixed_path_sets(const uint32_t npaths, const uint32_t setsize, uint32_t* setfirstpath)
+{
+  const uint32_t nsets=((uint64_t)npaths+setsize-1)/setsize;
+  uint32_t s;
+
+  if(setfirstpath) {
+
+    for(s=0; s<nsets; ++s) setfirstpath[s]=s*setsize;
+    setfirstpath[nsets]=npaths;
+  }
+  return nsets;
+}
+
+/**
+ * @brief Computes a partition of the paths into sets of equal size.
+ *
+ * The sizes of the sets differ by at most one path.
+ *
+ * @param npaths: Total number of paths.
+ * @param nsets: Number of sets, which must not be larger than npaths.
+ * @param setfirstpath: Receives the index of the first path of each set,
+ * followed by npaths.
+ */
+inline static void equal_path_sets(const uint32_t npaths, const uint32_t nsets, uint32_t* setfirstpath)
+{
+  uint32_t s;
+
+  for(s=0; s<=nsets; ++s) setfirstpath[s]=(uint64_t)s*npaths/nsets;
+}
+
+/**
+ * @brief Initialises the RNG stream of each set of paths.
+ *
+ * The stream of a fixed-size set only depends on its index, such that a
+ * top-up run continues with the next unused streams.
+ *
+ * @param cp: Pointer to the configuration parameters.
+ * @param nsets: Number of path sets.
+ * @param streams: Output RNG stream of each set.
+ */
+inline static void init_set_streams(config_pars const* cp, const uint32_t nsets, rng_stream* streams)
+{
+  int j;
+
+  if(cp->setsize) {
+    rng_skipstreams((uint64_t)FIXED_SETS_STREAM_STRIDE*cp->stream);
+
+    for(j=0; j<nsets; ++j) rng_init(streams+j);
+
+  } else {
+    rng_skipstreams(nsets*cp->stream);
+
+    for(j=nsets-1; j>=0; --j) rng_init(streams+j);
+  }
+}
+
+/**
+ * @brief Returns the number of regular bins of the peak time and extinction
+ * time histograms.
+ *
+ * @param cp: Configuration parameters.
+ * @return the number of regular bins.
+ */
+inline static uint32_t path_hist_ntbins(config_pars const* cp){return ceil((cp->pars.tmax-cp->phtmin)*cp->nbinsperunit);}
+
+/**
+ * @brief Returns the number of accumulated fields of a timeline channel,
+ * for paths with extinction or for paths without extinction.
+ *
+ * @param chan: Timeline channel.
+ * @return the number of fields.
+ */
+inline static uint32_t acc_nfields(const enum ro_acc_chans chan){return (chan>=ro_acc_reff?ro_acc_n+1:ro_acc_n);}
+
+/**
+ * @brief Initialises the statistics of a set of paths.
+ *
+ * Accumulator fields are only assigned for the timeline channels of the
+ * requested outputs.
+ *
+ * @param sd: Pointer to the set data.
+ * @param cp: Configuration parameters.
+ * @param npers: Initial number of timeline bins.
+ */
+inline static void init_set_data(set_data* sd, config_pars const* cp, const uint32_t npers)
+{
+  static const uint32_t chanoutputs[ro_acc_nchans]={ro_output_inf, ro_output_newinf, ro_output_newpostest,
+#ifdef SEC_INF_TIMELINES
+    ro_output_inf, ro_output_newinf, ro_output_newpostest,
+#endif
+    ro_output_reff,
+#ifdef OBSREFF_OUTPUT
+    ro_output_reffobs,
+#endif
+  };
+  uint32_t nfields=0;
+  int c;
+
+  sd->cp=cp;
+  sd->nnzpaths=0;
+  sd->tlppnnpers=0;
+  sd->tlpptnvpers=npers;
+  sd->commper_mean=0;
+#ifdef NUMEVENTSSTATS
+  sd->nevents_mean=0;
+#endif
+  sd->pe=0;
+  sd->penz=0;
+  sd->pm=0;
+  sd->tenz_mean=0;
+  sd->tenz_std=0;
+  sd->maxedoutmintimeindex=INT32_MAX;
+
+  for(c=0; c<ro_acc_nchans; ++c) {
+
+    if(cp->outputs&chanoutputs[c]) {
+      sd->accfield[c]=nfields;
+      nfields+=2*acc_nfields(c);
+
+    } else sd->accfield[c]=-1;
+  }
+  tlacc_init(&sd->acc,nfields,npers);
+
+  if(cp->ntlquantiles) {
+    const uint32_t nqbuckets=lhist_nbuckets(cp->tlqprecbits);
+    sd->inf_timeline_qsk=(uint32_t*)calloc(npers*nqbuckets,sizeof(uint32_t));
+    sd->newinf_timeline_qsk=(uint32_t*)calloc(npers*nqbuckets,sizeof(uint32_t));
+    sd->newpostest_timeline_qsk=(uint32_t*)calloc(npers*nqbuckets,sizeof(uint32_t));
+
+  } else sd->inf_timeline_qsk=sd->newinf_timeline_qsk=sd->newpostest_timeline_qsk=NULL;
+
+  if(cp->pathhists) {
+    sd->finalsize_hist=(uint32_t*)calloc(lhist_nbuckets(cp->phprecbits),sizeof(uint32_t));
+    sd->peakinf_hist=(uint32_t*)calloc(lhist_nbuckets(cp->phprecbits),sizeof(uint32_t));
+    sd->peaktime_hist=(uint32_t*)calloc(path_hist_ntbins(cp)+2,sizeof(uint32_t));
+    sd->exttime_hist=(uint32_t*)calloc(path_hist_ntbins(cp)+2,sizeof(uint32_t));
+
+  } else sd->finalsize_hist=sd->peakinf_hist=sd->peaktime_hist=sd->exttime_hist=NULL;
+
+  sd->ninfbins=0;
+  sd->ngeninfs=NULL;
+}
+
+/**
+ * @brief Frees the memory used by the statistics of a set of paths.
+ *
+ * @param sd: Pointer to the set data.
+ */
+inline static void free_set_data(set_data* sd)
+{
+  tlacc_free(&sd->acc);
+  free(sd->inf_timeline_qsk);
+  free(sd->newinf_timeline_qsk);
+  free(sd->newpostest_timeline_qsk);
+  free(sd->finalsize_hist);
+  free(sd->peakinf_hist);
+  free(sd->peaktime_hist);
+  free(sd->exttime_hist);
+  free(sd->ngeninfs);
+}
+
+/**
+ * @brief Returns a pointer to the first bin of an accumulated field.
+ *
+ * @param sd: Pointer to the set data.
+ * @param chan: Timeline channel.
+ * @param noext: 0 for paths with extinction, 1 for paths without extinction.
+ * @param field: Accumulated field.
+ * @return the pointer to the first bin of the field.
+ */
+inline static uint64_t* acc_field(set_data const* sd, const enum ro_acc_chans chan, const int noext, const enum ro_acc_fields field){return tlacc_field(&sd->acc,sd->accfield[chan]+noext*acc_nfields(chan)+field);}
+
+/**
+ * @brief Accumulates a per-path count timeline.
+ *
+ * @param sd: Pointer to the set data.
+ * @param chan: Timeline channel.
+ * @param noext: 0 for a path with extinction, 1 for a path without extinction.
+ * @param shift: Index of the accumulator bin corresponding to the first path bin.
+ * @param counts: Path timeline.
+ * @param n: Number of path bins.
+ */
+inline static void acc_add_counts(set_data* sd, const enum ro_acc_chans chan, const int noext, const int32_t shift, uint32_t const* counts, const uint32_t n)
+{
+  tlacc_add_counts(acc_field(sd,chan,noext,ro_acc_sum)+shift,acc_field(sd,chan,noext,ro_acc_sum2lo)+shift,acc_field(sd,chan,noext,ro_acc_sum2hi)+shift,counts,n);
+}
+
+/**
+ * @brief Accumulates the Reff information from a per-path extended timeline.
+ *
+ * @param sd: Pointer to the set data.
+ * @param noext: 0 for a path with extinction, 1 for a path without extinction.
+ * @param shift: Index of the accumulator bin corresponding to the first path bin.
+ * @param eti: Path extended timeline.
+ * @param n: Number of path bins.
+ */
+inline static void acc_add_reff(set_data* sd, const int noext, const int32_t shift, ext_timeline_info const* eti, const uint32_t n)
+{
+  uint64_t* restrict sum=acc_field(sd,ro_acc_reff,noext,ro_acc_sum)+shift;
+  uint64_t* restrict sum2lo=acc_field(sd,ro_acc_reff,noext,ro_acc_sum2lo)+shift;
+  uint64_t* restrict sum2hi=acc_field(sd,ro_acc_reff,noext,ro_acc_sum2hi)+shift;
+  uint64_t* restrict nn=acc_field(sd,ro_acc_reff,noext,ro_acc_n)+shift;
+  uint32_t j;
+
+  for(j=0; j<n; ++j) {
+    sum[j]+=eti[j].rsum;
+    sum2lo[j]+=(uint32_t)eti[j].r2sum;
+    sum2hi[j]+=eti[j].r2sum>>32;
+    nn[j]+=eti[j].n;
+  }
+}
+
+#ifdef OBSREFF_OUTPUT
+/**
+ * @brief Accumulates the observable Reff information from a per-path extended
+ * timeline.
+ *
+ * @param sd: Pointer to the set data.
+ * @param noext: 0 for a path with extinction, 1 for a path without extinction.
+ * @param shift: Index of the accumulator bin corresponding to the first path bin.
+ * @param eti: Path extended timeline.
+ * @param n: Number of path bins.
+ */
+inline static void acc_add_reffobs(set_data* sd, const int noext, const int32_t shift, ext_timeline_info const* eti, const uint32_t n)
+{
+  uint64_t* restrict sum=acc_field(sd,ro_acc_reffobs,noext,ro_acc_sum)+shift;
+  uint64_t* restrict sum2lo=acc_field(sd,ro_acc_reffobs,noext,ro_acc_sum2lo)+shift;
+  uint64_t* restrict sum2hi=acc_field(sd,ro_acc_reffobs,noext,ro_acc_sum2hi)+shift;
+  uint64_t* restrict nn=acc_field(sd,ro_acc_reffobs,noext,ro_acc_n)+shift;
+  uint32_t j;
+
+  for(j=0; j<n; ++j) {
+    sum[j]+=eti[j].robssum;
+    sum2lo[j]+=(uint32_t)eti[j].robs2sum;
+    sum2hi[j]+=eti[j].robs2sum>>32;
+    nn[j]+=eti[j].nobs;
+  }
+}
+#endif
+
+/**
+ * @brief Computes the timeline statistics of an accumulated count channel.
+ *
+ * The statistics are stored as six consecutive timelines: the mean and the
+ * standard deviation for paths with extinction, for paths without extinction
+ * and for all paths.
+ *
+ * @param sd: Pointer to the set data containing the merged accumulator.
+ * @param chan: Timeline channel.
+ * @param npaths: Number of paths with extinction, without extinction and in total.
+ * @param tls: Output timeline statistics.
+ */
+inline static void acc_count_stats(set_data const* sd, const enum ro_acc_chans chan, double const* npaths, double* tls)
+{
+  const uint32_t nbins=sd->acc.nbins;
+  uint64_t const* sum[2]={acc_field(sd,chan,0,ro_acc_sum),acc_field(sd,chan,1,ro_acc_sum)};
+  uint64_t const* sum2lo[2]={acc_field(sd,chan,0,ro_acc_sum2lo),acc_field(sd,chan,1,ro_acc_sum2lo)};
+  uint64_t const* sum2hi[2]={acc_field(sd,chan,0,ro_acc_sum2hi),acc_field(sd,chan,1,ro_acc_sum2hi)};
+  uint32_t j;
+  int e;
+
+  for(j=0; j<nbins; ++j) {
+
+    for(e=0; e<2; ++e) count_mean_std(sum[e][j],tlacc_sum2(sum2lo[e][j],sum2hi[e][j]),npaths[e],tls+2*e*nbins+j,tls+(2*e+1)*nbins+j);
+    count_mean_std(sum[0][j]+sum[1][j],tlacc_sum2(sum2lo[0][j]+sum2lo[1][j],sum2hi[0][j]+sum2hi[1][j]),npaths[2],tls+4*nbins+j,tls+5*nbins+j);
+  }
+}
+
+/**
+ * @brief Computes the timeline statistics of an accumulated Reff channel.
+ *
+ * The statistics are stored as for acc_count_stats. The sums over all
+ * timeline bins are also computed, for paths with extinction, for paths
+ * without extinction and for all paths.
+ *
+ * @param sd: Pointer to the set data containing the merged accumulator.
+ * @param chan: Timeline channel.
+ * @param tls: Output timeline statistics.
+ * @param tsum: Output sums of the values over all bins.
+ * @param tsum2: Output sums of the squared values over all bins.
+ * @param tn: Output numbers of entries over all bins.
+ */
+inline static void acc_ratio_stats(set_data const* sd, const enum ro_acc_chans chan, double* tls, double* tsum, double* tsum2, uint64_t* tn)
+{
+  const uint32_t nbins=sd->acc.nbins;
+  uint64_t const* sum[2]={acc_field(sd,chan,0,ro_acc_sum),acc_field(sd,chan,1,ro_acc_sum)};
+  uint64_t const* sum2lo[2]={acc_field(sd,chan,0,ro_acc_sum2lo),acc_field(sd,chan,1,ro_acc_sum2lo)};
+  uint64_t const* sum2hi[2]={acc_field(sd,chan,0,ro_acc_sum2hi),acc_field(sd,chan,1,ro_acc_sum2hi)};
+  uint64_t const* n[2]={acc_field(sd,chan,0,ro_acc_n),acc_field(sd,chan,1,ro_acc_n)};
+  uint64_t ts[3]={0,0,0}, ts2lo[3]={0,0,0}, ts2hi[3]={0,0,0};
+  uint32_t j;
+  int e;
+
+  tn[0]=tn[1]=tn[2]=0;
+
+  for(j=0; j<nbins; ++j) {
+
+    for(e=0; e<2; ++e) {
+      ratio_mean_std(sum[e][j],tlacc_sum2(sum2lo[e][j],sum2hi[e][j]),n[e][j],tls+2*e*nbins+j,tls+(2*e+1)*nbins+j);
+      ts[e]+=sum[e][j];
+      ts2lo[e]+=sum2lo[e][j];
+      ts2hi[e]+=sum2hi[e][j];
+      tn[e]+=n[e][j];
+    }
+    ratio_mean_std(sum[0][j]+sum[1][j],tlacc_sum2(sum2lo[0][j]+sum2lo[1][j],sum2hi[0][j]+sum2hi[1][j]),n[0][j]+n[1][j],tls+4*nbins+j,tls+5*nbins+j);
+  }
+  ts[2]=ts[0]+ts[1];
+  ts2lo[2]=ts2lo[0]+ts2lo[1];
+  ts2hi[2]=ts2hi[0]+ts2hi[1];
+  tn[2]=tn[0]+tn[1];
+
+  for(e=0; e<3; ++e) {
+    tsum[e]=ts[e];
+    tsum2[e]=tlacc_sum2(ts2lo[e],ts2hi[e]);
+  }
+}
+
+/**
+ * @brief Extends a set accumulation array on both ends.
+ *
+ * The new elements are zeroed. Nothing is done if the array is not allocated.
+ *
+ * @param array: Pointer to the array.
+ * @param elsize: Size of an array element.
+ * @param size: Current number of elements.
+ * @param ndiff: Number of elements to add at the beginning of the array.
+ * @param pdiff: Number of elements to add at the end of the array.
+ */
+inline static void realloc_set_timeline(void** array, const size_t elsize, const uint32_t size, const int32_t ndiff, const int32_t pdiff)
+{
+  if(!*array) return;
+  char* newarray=(char*)malloc((size+ndiff+pdiff)*elsize);
+  memset(newarray,0,ndiff*elsize);
+  memcpy(newarray+ndiff*elsize,*array,size*elsize);
+  memset(newarray+(ndiff+size)*elsize,0,pdiff*elsize);
+  free(*array);
+  *array=newarray;
+}
+
+/**
+ * @brief Extends the set accumulation timelines.
+ *
+ * @param sd: Pointer to the set data.
+ * @param ndiff: Number of bins to add before the first bin.
+ * @param pdiff: Number of bins to add after the last bin.
+ */
+inline static void realloc_set_timelines(set_data* sd, const int32_t ndiff, const int32_t pdiff)
 {
   if(pdiff > 0 || ndiff > 0) {
-    double* newarray;
-    uint64_t* newuarray;
-    const ssize_t newsize=data->tlpptnvpers+pdiff+ndiff;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->inf_timeline_mean_ext,data->tlpptnvpers*sizeof(double));
-    free(data->inf_timeline_mean_ext);
-    data->inf_timeline_mean_ext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->inf_timeline_std_ext,data->tlpptnvpers*sizeof(double));
-    free(data->inf_timeline_std_ext);
-    data->inf_timeline_std_ext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newinf_timeline_mean_ext,data->tlpptnvpers*sizeof(double));
-    free(data->newinf_timeline_mean_ext);
-    data->newinf_timeline_mean_ext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newinf_timeline_std_ext,data->tlpptnvpers*sizeof(double));
-    free(data->newinf_timeline_std_ext);
-    data->newinf_timeline_std_ext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newpostest_timeline_mean_ext,data->tlpptnvpers*sizeof(double));
-    free(data->newpostest_timeline_mean_ext);
-    data->newpostest_timeline_mean_ext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newpostest_timeline_std_ext,data->tlpptnvpers*sizeof(double));
-    free(data->newpostest_timeline_std_ext);
-    data->newpostest_timeline_std_ext=newarray;
-
-    #ifdef SEC_INF_TIMELINES
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->secinf_timeline_std_ext,data->tlpptnvpers*sizeof(double));
-    free(data->secinf_timeline_std_ext);
-    data->secinf_timeline_std_ext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newsecinf_timeline_mean_ext,data->tlpptnvpers*sizeof(double));
-    free(data->newsecinf_timeline_mean_ext);
-    data->newsecinf_timeline_mean_ext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newsecinf_timeline_std_ext,data->tlpptnvpers*sizeof(double));
-    free(data->newsecinf_timeline_std_ext);
-    data->newsecinf_timeline_std_ext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newsecpostest_timeline_mean_ext,data->tlpptnvpers*sizeof(double));
-    free(data->newsecpostest_timeline_mean_ext);
-    data->newsecpostest_timeline_mean_ext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newsecpostest_timeline_std_ext,data->tlpptnvpers*sizeof(double));
-    free(data->newsecpostest_timeline_std_ext);
-    data->newsecpostest_timeline_std_ext=newarray;
-    #endif
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->reff_timeline_mean_ext,data->tlpptnvpers*sizeof(double));
-    free(data->reff_timeline_mean_ext);
-    data->reff_timeline_mean_ext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->reff_timeline_std_ext,data->tlpptnvpers*sizeof(double));
-    free(data->reff_timeline_std_ext);
-    data->reff_timeline_std_ext=newarray;
-
-    newuarray=(uint64_t*)malloc(newsize*sizeof(uint64_t));
-    memcpy(newuarray+ndiff,data->reff_timeline_n_ext,data->tlpptnvpers*sizeof(uint64_t));
-    free(data->reff_timeline_n_ext);
-    data->reff_timeline_n_ext=newuarray;
-
-    #ifdef OBSREFF_OUTPUT
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->reffobs_timeline_mean_ext,data->tlpptnvpers*sizeof(double));
-    free(data->reffobs_timeline_mean_ext);
-    data->reffobs_timeline_mean_ext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->reffobs_timeline_std_ext,data->tlpptnvpers*sizeof(double));
-    free(data->reffobs_timeline_std_ext);
-    data->reffobs_timeline_std_ext=newarray;
-
-    newuarray=(uint64_t*)malloc(newsize*sizeof(uint64_t));
-    memcpy(newuarray+ndiff,data->reffobs_timeline_n_ext,data->tlpptnvpers*sizeof(uint64_t));
-    free(data->reffobs_timeline_n_ext);
-    data->reffobs_timeline_n_ext=newuarray;
-    #endif
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->inf_timeline_mean_noext,data->tlpptnvpers*sizeof(double));
-    free(data->inf_timeline_mean_noext);
-    data->inf_timeline_mean_noext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->inf_timeline_std_noext,data->tlpptnvpers*sizeof(double));
-    free(data->inf_timeline_std_noext);
-    data->inf_timeline_std_noext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newinf_timeline_mean_noext,data->tlpptnvpers*sizeof(double));
-    free(data->newinf_timeline_mean_noext);
-    data->newinf_timeline_mean_noext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newinf_timeline_std_noext,data->tlpptnvpers*sizeof(double));
-    free(data->newinf_timeline_std_noext);
-    data->newinf_timeline_std_noext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newpostest_timeline_mean_noext,data->tlpptnvpers*sizeof(double));
-    free(data->newpostest_timeline_mean_noext);
-    data->newpostest_timeline_mean_noext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newpostest_timeline_std_noext,data->tlpptnvpers*sizeof(double));
-    free(data->newpostest_timeline_std_noext);
-    data->newpostest_timeline_std_noext=newarray;
-
-    #ifdef SEC_INF_TIMELINES
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->secinf_timeline_mean_noext,data->tlpptnvpers*sizeof(double));
-    free(data->secinf_timeline_mean_noext);
-    data->secinf_timeline_mean_noext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->secinf_timeline_std_noext,data->tlpptnvpers*sizeof(double));
-    free(data->secinf_timeline_std_noext);
-    data->secinf_timeline_std_noext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newsecinf_timeline_mean_noext,data->tlpptnvpers*sizeof(double));
-    free(data->newsecinf_timeline_mean_noext);
-    data->newsecinf_timeline_mean_noext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newsecinf_timeline_std_noext,data->tlpptnvpers*sizeof(double));
-    free(data->newsecinf_timeline_std_noext);
-    data->newsecinf_timeline_std_noext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newsecpostest_timeline_mean_noext,data->tlpptnvpers*sizeof(double));
-    free(data->newsecpostest_timeline_mean_noext);
-    data->newsecpostest_timeline_mean_noext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->newsecpostest_timeline_std_noext,data->tlpptnvpers*sizeof(double));
-    free(data->newsecpostest_timeline_std_noext);
-    data->newsecpostest_timeline_std_noext=newarray;
-    #endif
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->reff_timeline_mean_noext,data->tlpptnvpers*sizeof(double));
-    free(data->reff_timeline_mean_noext);
-    data->reff_timeline_mean_noext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->reff_timeline_std_noext,data->tlpptnvpers*sizeof(double));
-    free(data->reff_timeline_std_noext);
-    data->reff_timeline_std_noext=newarray;
-
-    newuarray=(uint64_t*)malloc(newsize*sizeof(uint64_t));
-    memcpy(newuarray+ndiff,data->reff_timeline_n_noext,data->tlpptnvpers*sizeof(uint64_t));
-    free(data->reff_timeline_n_noext);
-    data->reff_timeline_n_noext=newuarray;
-
-    #ifdef OBSREFF_OUTPUT
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->reffobs_timeline_mean_noext,data->tlpptnvpers*sizeof(double));
-    free(data->reffobs_timeline_mean_noext);
-    data->reffobs_timeline_mean_noext=newarray;
-
-    newarray=(double*)malloc(newsize*sizeof(double));
-    memcpy(newarray+ndiff,data->reffobs_timeline_std_noext,data->tlpptnvpers*sizeof(double));
-    free(data->reffobs_timeline_std_noext);
-    data->reffobs_timeline_std_noext=newarray;
-
-    newuarray=(uint64_t*)malloc(newsize*sizeof(uint64_t));
-    memcpy(newuarray+ndiff,data->reffobs_timeline_n_noext,data->tlpptnvpers*sizeof(uint64_t));
-    free(data->reffobs_timeline_n_noext);
-    data->reffobs_timeline_n_noext=newuarray;
-    #endif
-
-    if(ndiff) {
-      memset(data->inf_timeline_mean_ext,0,ndiff*sizeof(double));
-      memset(data->inf_timeline_std_ext,0,ndiff*sizeof(double));
-
-      memset(data->newinf_timeline_mean_ext,0,ndiff*sizeof(double));
-      memset(data->newinf_timeline_std_ext,0,ndiff*sizeof(double));
-
-      memset(data->newpostest_timeline_mean_ext,0,ndiff*sizeof(double));
-      memset(data->newpostest_timeline_std_ext,0,ndiff*sizeof(double));
-
-      #ifdef SEC_INF_TIMELINES
-      memset(data->secinf_timeline_mean_ext,0,ndiff*sizeof(double));
-      memset(data->secinf_timeline_std_ext,0,ndiff*sizeof(double));
-
-      memset(data->newsecinf_timeline_mean_ext,0,ndiff*sizeof(double));
-      memset(data->newsecinf_timeline_std_ext,0,ndiff*sizeof(double));
-
-      memset(data->newsecpostest_timeline_mean_ext,0,ndiff*sizeof(double));
-      memset(data->newsecpostest_timeline_std_ext,0,ndiff*sizeof(double));
-      #endif
-
-      memset(data->reff_timeline_mean_ext,0,ndiff*sizeof(double));
-      memset(data->reff_timeline_std_ext,0,ndiff*sizeof(double));
-      memset(data->reff_timeline_n_ext,0,ndiff*sizeof(uint64_t));
-
-      #ifdef OBSREFF_OUTPUT
-      memset(data->reffobs_timeline_mean_ext,0,ndiff*sizeof(double));
-      memset(data->reffobs_timeline_std_ext,0,ndiff*sizeof(double));
-      memset(data->reffobs_timeline_n_ext,0,ndiff*sizeof(uint64_t));
-      #endif
-
-      memset(data->inf_timeline_mean_noext,0,ndiff*sizeof(double));
-      memset(data->inf_timeline_std_noext,0,ndiff*sizeof(double));
-
-      memset(data->newinf_timeline_mean_noext,0,ndiff*sizeof(double));
-      memset(data->newinf_timeline_std_noext,0,ndiff*sizeof(double));
-
-      memset(data->newpostest_timeline_mean_noext,0,ndiff*sizeof(double));
-      memset(data->newpostest_timeline_std_noext,0,ndiff*sizeof(double));
-
-      #ifdef SEC_INF_TIMELINES
-      memset(data->secinf_timeline_mean_noext,0,ndiff*sizeof(double));
-      memset(data->secinf_timeline_std_noext,0,ndiff*sizeof(double));
-
-      memset(data->newsecinf_timeline_mean_noext,0,ndiff*sizeof(double));
-      memset(data->newsecinf_timeline_std_noext,0,ndiff*sizeof(double));
-
-      memset(data->newsecpostest_timeline_mean_noext,0,ndiff*sizeof(double));
-      memset(data->newsecpostest_timeline_std_noext,0,ndiff*sizeof(double));
-      #endif
-
-      memset(data->reff_timeline_mean_noext,0,ndiff*sizeof(double));
-      memset(data->reff_timeline_std_noext,0,ndiff*sizeof(double));
-      memset(data->reff_timeline_n_noext,0,ndiff*sizeof(uint64_t));
-
-      #ifdef OBSREFF_OUTPUT
-      memset(data->reffobs_timeline_mean_noext,0,ndiff*sizeof(double));
-      memset(data->reffobs_timeline_std_noext,0,ndiff*sizeof(double));
-      memset(data->reffobs_timeline_n_noext,0,ndiff*sizeof(uint64_t));
-      #endif
+    const ssize_t newsize=sd->tlpptnvpers+pdiff+ndiff;
+
+    tlacc_extend(&sd->acc,ndiff,pdiff);
+
+    if(sd->inf_timeline_qsk) {
+      const size_t qsksize=lhist_nbuckets(sd->cp->tlqprecbits)*sizeof(uint32_t);
+
+      realloc_set_timeline((void**)&sd->inf_timeline_qsk,qsksize,sd->tlpptnvpers,ndiff,pdiff);
+      realloc_set_timeline((void**)&sd->newinf_timeline_qsk,qsksize,sd->tlpptnvpers,ndiff,pdiff);
+      realloc_set_timeline((void**)&sd->newpostest_timeline_qsk,qsksize,sd->tlpptnvpers,ndiff,pdiff);
+    }
+    sd->tlppnnpers+=ndiff;
+    sd->tlpptnvpers=newsize;
+  }
+}
+
+/**
+ * @brief Adds the statistics of a set of paths to the statistics of another
+ * set, and frees the memory used by the source set.
+ *
+ * @param dst: Pointer to the destination set data.
+ * @param src: Pointer to the source set data.
+ */
+inline static void merge_set_data(set_data* dst, set_data* src)
+{
+  config_pars const* cp=dst->cp;
+  int32_t ndiff=src->tlppnnpers-dst->tlppnnpers;
+  int32_t pdiff=(int32_t)src->tlpptnvpers-dst->tlpptnvpers-ndiff;
+  int32_t j;
+
+  dst->commper_mean+=src->commper_mean;
+#ifdef NUMEVENTSSTATS
+  dst->nevents_mean+=src->nevents_mean;
+#endif
+  dst->nnzpaths+=src->nnzpaths;
+  dst->pe+=src->pe;
+  dst->penz+=src->penz;
+  dst->pm+=src->pm;
+  dst->tenz_mean+=src->tenz_mean;
+  dst->tenz_std+=src->tenz_std;
+
+  if(cp->pathhists) {
+    const uint32_t nlbuckets=lhist_nbuckets(cp->phprecbits);
+    const uint32_t ntbins=path_hist_ntbins(cp)+2;
+
+    for(j=nlbuckets-1; j>=0; --j) {
+      dst->finalsize_hist[j]+=src->finalsize_hist[j];
+      dst->peakinf_hist[j]+=src->peakinf_hist[j];
+    }
+
+    for(j=ntbins-1; j>=0; --j) {
+      dst->peaktime_hist[j]+=src->peaktime_hist[j];
+      dst->exttime_hist[j]+=src->exttime_hist[j];
+    }
+  }
+
+  realloc_set_timelines(dst,(ndiff>0?ndiff:0),(pdiff>0?pdiff:0));
+  const int32_t shift=dst->tlppnnpers-src->tlppnnpers;
+  tlacc_merge(&dst->acc,&src->acc,shift);
+
+  if(cp->ntlquantiles) {
+    const uint32_t nqbuckets=lhist_nbuckets(cp->tlqprecbits);
+    const uint32_t qshift=shift*nqbuckets;
+
+    for(j=src->tlpptnvpers*nqbuckets-1; j>=0; --j) {
+      dst->inf_timeline_qsk[qshift+j]+=src->inf_timeline_qsk[j];
+      dst->newinf_timeline_qsk[qshift+j]+=src->newinf_timeline_qsk[j];
+      dst->newpostest_timeline_qsk[qshift+j]+=src->newpostest_timeline_qsk[j];
+    }
+  }
+
+  if(src->ninfbins > dst->ninfbins) {
+    dst->ngeninfs=(uint64_t*)realloc(dst->ngeninfs,src->ninfbins*sizeof(uint64_t));
+    memset(dst->ngeninfs+dst->ninfbins,0,(src->ninfbins-dst->ninfbins)*sizeof(uint64_t));
+    dst->ninfbins=src->ninfbins;
+  }
+
+  for(j=src->ninfbins-1; j>=0; --j) dst->ngeninfs[j]+=src->ngeninfs[j];
+
+  if(src->maxedoutmintimeindex < dst->maxedoutmintimeindex) dst->maxedoutmintimeindex=src->maxedoutmintimeindex;
+  free_set_data(src);
+}
+
+/**
+ * @brief Merges the statistics of a completed node of the set merging tree
+ * up the tree.
+ *
+ * The tree is a binary tree over the set indices. At each level of the tree,
+ * node i merges nodes 2i and 2i+1 of the level below, the statistics of node
+ * 2i+1 being always added to the ones of node 2i, and the merged statistics
+ * are stored in the slot of the first set of the node. The merge is performed
+ * by the thread that completes the second of the two nodes, and a node without
+ * a sibling moves up unchanged. Since the tree and the order of the additions
+ * only depend on the number of sets, the statistics merged in the slot of set
+ * 0 do not depend on the number of threads nor on the assignment of sets to
+ * threads. The tree is built over treesize leaves, and the statistics of the
+ * nodes whose sets are all completed do not depend on treesize. When treesize
+ * is a power of two, nodes are only merged once all their sets are completed.
+ *
+ * @param data: Pointer to the thread data.
+ * @param node: Index of the completed node within its level.
+ * @param level: Level of the completed node, 0 being the level of the sets.
+ */
+inline static void reduce_node(thread_data* data, uint32_t node, const uint32_t level)
+{
+  uint32_t nnodes=data->treesize;
+  uint32_t ncounters=0;
+  uint32_t l=0;
+
+  for(; l<level; ++l) {
+    ncounters+=(nnodes+1)>>1;
+    nnodes=(nnodes+1)>>1;
+  }
+
+  for(; nnodes>1; ++l) {
+
+    if(node!=nnodes-1 || (node&1)) {
+
+      //Only the second completed child performs the merge
+      if(__sync_fetch_and_add(data->nmerges+ncounters+(node>>1),1)==0) return;
+      merge_set_data(data->sdata+((node&~1)<<l),data->sdata+((node|1)<<l));
+
+      if(data->setstate) data->setstate[(node|1)<<l]=ro_set_merged;
+    }
+    ncounters+=(nnodes+1)>>1;
+    nnodes=(nnodes+1)>>1;
+    node>>=1;
+  }
+}
+
+/**
+ * @brief Merges the statistics of a completed set of paths up the set
+ * merging tree.
+ *
+ * @param data: Pointer to the thread data.
+ * @param set: Index of the completed set.
+ */
+inline static void reduce_set(thread_data* data, const uint32_t set){reduce_node(data, set, 0);}
+
+/**
+ * @brief Returns the level of the largest node of the set merging tree that
+ * starts at a given set and ends before a given set.
+ *
+ * The nodes returned for successive positions decompose a range of sets into
+ * complete subtrees, whose statistics do not depend on the number of leaves
+ * of the tree.
+ *
+ * @param set: Index of the first set of the node, which must be smaller than
+ * end.
+ * @param end: Index following the last set of the range.
+ * @return the level of the node.
+ */
+inline static uint32_t set_block_level(const uint32_t set, const uint32_t end)
+{
+  uint32_t l=0;
+
+  while(l<31 && !((set>>l)&1) && (uint64_t)set+(UINT64_C(2)<<l)<=end) ++l;
+  return l;
+}
+
+/**
+ * @brief Merges the complete subtrees of a range of sets up the set merging
+ * tree, as if their sets had just been completed.
+ *
+ * @param data: Pointer to the thread data.
+ * @param first: Index of the first set of the range.
+ * @param end: Index following the last set of the range.
+ */
+inline static void reduce_blocks(thread_data* data, const uint32_t first, const uint32_t end)
+{
+  uint32_t s, l;
+
+  for(s=first; s<end; s+=UINT32_C(1)<<l) {
+    l=set_block_level(s, end);
+    reduce_node(data, s>>l, l);
+  }
+}
+
+/**
+ * @brief Returns the smallest power of two that is not smaller than a value.
+ *
+ * @param n: Value.
+ * @return the power of two.
+ */
+inline static uint32_t pow2_ceil(const uint32_t n)
+{
+  uint32_t p=1;
+
+  while(p<n) p<<=1;
+  return p;
+}
+
+/**
+ * @brief Computes the batch values of the precision targets for a completed
+ * set of paths.
+ *
+ * @param sd: Pointer to the set data.
+ * @param npaths: Number of paths in the set.
+ * @param batch: Output numerator and denominator of each target.
+ */
+inline static void adaptive_batch(set_data const* sd, const uint32_t npaths, double* batch)
+{
+  static const enum ro_acc_chans tlchans[3]={ro_acc_inf, ro_acc_newinf, ro_acc_newpostest};
+  config_pars const* cp=sd->cp;
+  precision_target const* pt;
+  int32_t j;
+  uint32_t t;
+
+  for(t=0; t<cp->ntargets; ++t) {
+    pt=cp->targets+t;
+
+    switch(pt->quantity) {
+      case ro_target_pe:
+	batch[2*t]=sd->pe;
+	batch[2*t+1]=npaths;
+	break;
+
+      case ro_target_exttime:
+	batch[2*t]=sd->tenz_mean;
+	batch[2*t+1]=sd->penz;
+	break;
+
+      default:
+	j=(int32_t)floor(pt->time*cp->nbinsperunit)+sd->tlppnnpers;
+	batch[2*t]=(j>=0 && j<(int32_t)sd->tlpptnvpers?acc_field(sd,tlchans[pt->quantity-ro_target_inf],0,ro_acc_sum)[j]+acc_field(sd,tlchans[pt->quantity-ro_target_inf],1,ro_acc_sum)[j]:0);
+	batch[2*t+1]=npaths;
     }
+  }
+}
+
+/**
+ * @brief Saves the progress of a thread.
+ *
+ * The output buffers of the thread must have been written, such that the
+ * shard files only contain the records of the completed sets.
+ *
+ * @param data: Pointer to the thread data.
+ */
+inline static void save_progress(thread_data* data)
+{
+  oidx_writer const* ows[ro_pathsel_noutputs]={&data->tlidx, &data->ctidx, &data->treeidx};
+  uint32_t o;
+
+  data->progress.npaths=data->npaths;
+  data->progress.nwritten=data->nwritten;
+
+  for(o=0; o<ro_pathsel_noutputs; ++o) {
+    data->progress.offsets[o]=ows[o]->offset;
+    data->progress.nrecs[o]=ows[o]->nrecs;
+  }
+}
+
+/**
+ * @brief Merges the statistics of a completed set of paths.
+ *
+ * When checkpoints are written, the set state is updated and the progress
+ * of the thread is saved. When precision targets are set, the set is only
+ * merged once it is included, together with the following completed sets.
+ *
+ * @param data: Pointer to the thread data.
+ * @param set: Index of the completed set.
+ */
+inline static void complete_set(thread_data* data, const uint32_t set)
+{
+  if(data->setstate) {
+    pthread_rwlock_rdlock(data->cklock);
+    data->setstate[set]=ro_set_live;
+    reduce_set(data, set);
+    save_progress(data);
+    pthread_rwlock_unlock(data->cklock);
+    return;
+  }
+
+  if(!data->as) {
+    reduce_set(data, set);
+    return;
+  }
+  double batch[2*data->as->ntargets];
+  uint32_t first, last;
+
+  adaptive_batch(data->sdata+set, data->setfirstpath[set+1]-data->setfirstpath[set], batch);
+  adaptive_set_done(data->as, set, batch, &first, &last);
+
+  for(; first<last; ++first) reduce_set(data, first);
+}
 
-    if(pdiff) {
-      memset(data->inf_timeline_mean_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->inf_timeline_std_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
+/**
+ * @brief Writes the header of a timeline output file.
+ *
+ * If the TLO_FLAG_SELECTED flag is set, the number of skipped paths is
+ * initially written as 0 and must be set using tlo_write_nskipped once the
+ * simulation is completed.
+ *
+ * @param fd: Output file descriptor.
+ * @param npers: Number of timeline bins per unit of time.
+ * @param flags: Header flags.
+ * @return 0 on success, -1 on a write error.
+ */
+inline static int tlo_write_header(const int fd, const uint32_t npers, const uint8_t flags)
+{
+  const uint32_t ubuf=htole32(npers);
+  const uint64_t nskipped=0;
 
-      memset(data->newinf_timeline_mean_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->newinf_timeline_std_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
+  if(write(fd,&ubuf,4)!=4 || write(fd,&flags,1)!=1 || ((flags&TLO_FLAG_SELECTED) && write(fd,&nskipped,8)!=8)) {
+    perror("tlout");
+    return -1;
+  }
+  return 0;
+}
 
-      memset(data->newpostest_timeline_mean_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->newpostest_timeline_std_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
+/**
+ * @brief Sets the number of skipped paths in the header of a timeline output
+ * file.
+ *
+ * @param fd: Output file descriptor.
+ * @param nskipped: Number of simulated paths that are not written.
+ * @return 0 on success, -1 on a write error.
+ */
+inline static int tlo_write_nskipped(const int fd, const uint64_t nskipped)
+{
+  const uint64_t ubuf=htole64(nskipped);
 
-      #ifdef SEC_INF_TIMELINES
-      memset(data->secinf_timeline_mean_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->secinf_timeline_std_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
+  if(pwrite(fd,&ubuf,8,TLO_HEADER_SIZE)!=8) {
+    perror("tlout");
+    return -1;
+  }
+  return 0;
+}
 
-      memset(data->newsecinf_timeline_mean_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->newsecinf_timeline_std_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
+/**
+ * @brief Opens the output shard file of a thread.
+ *
+ * @param name: Output file name.
+ * @param t: Thread index.
+ * @param resume: Whether an existing shard file is kept, to be truncated
+ * to its size recorded in a checkpoint.
+ * @param shardname: Allocated shard file name.
+ * @return the shard file descriptor, or -1 if the file cannot be opened.
+ */
+inline static int open_shard(const char* name, const uint32_t t, const bool resume, char** shardname)
+{
+  int fd;
 
-      memset(data->newsecpostest_timeline_mean_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->newsecpostest_timeline_std_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      #endif
+  *shardname=(char*)malloc(strlen(name)+12);
+  sprintf(*shardname,"%s.%" PRIu32,name,t);
 
-      memset(data->reff_timeline_mean_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->reff_timeline_std_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->reff_timeline_n_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(uint64_t));
+  if((fd=open(*shardname,O_RDWR|O_CREAT|(resume?0:O_TRUNC),S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH))<0) fprintf(stderr,"%s: Error: Cannot open file '%s' in write mode\n",__func__,*shardname);
+  return fd;
+}
 
-      #ifdef OBSREFF_OUTPUT
-      memset(data->reffobs_timeline_mean_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->reffobs_timeline_std_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->reffobs_timeline_n_ext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(uint64_t));
-      #endif
+/**
+ * @brief Writes the manifest of a sharded output.
+ *
+ * The manifest lists the shard file names relative to the directory of the
+ * manifest.
+ *
+ * @param fd: Manifest file descriptor.
+ * @param format: Output format name.
+ * @param hasheader: Whether the shards start with a file header.
+ * @param npers: Number of timeline bins per unit of time stored in the header.
+ * @param flags: Header flags.
+ * @param tdata: Thread data, for the number of paths written to each shard.
+ * @param nshards: Number of shards.
+ * @param shardnames: Shard file names.
+ * @return 0 on success, -1 on a write error.
+ */
+inline static int write_shard_manifest(const int fd, const char* format, const bool hasheader, const uint32_t npers, const uint8_t flags, thread_data const* tdata, const uint32_t nshards, char* const* shardnames)
+{
+  char const** files=(char const**)malloc(nshards*sizeof(char*));
+  uint64_t* npaths=(uint64_t*)malloc(nshards*sizeof(uint64_t));
+  char const* slash;
+  uint32_t t;
+
+  for(t=0; t<nshards; ++t) {
+    slash=strrchr(shardnames[t],'/');
+    files[t]=(slash?slash+1:shardnames[t]);
+    npaths[t]=tdata[t].nwritten;
+  }
+  const int ret=manifest_write(fd,format,hasheader,npers,flags,nshards,files,npaths);
 
-      memset(data->inf_timeline_mean_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->inf_timeline_std_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
+  if(ret) perror(format);
+  free(files);
+  free(npaths);
+  return ret;
+}
 
-      memset(data->newinf_timeline_mean_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->newinf_timeline_std_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
+/**
+ * @brief Opens the index file of an output file and writes its header.
+ *
+ * @param name: Output file name.
+ * @param kind: Output kind.
+ * @param resume: Whether an existing index file is kept, to be truncated to
+ * its size recorded in a checkpoint, in which case the header is not written.
+ * @return the index file descriptor, or -1 if the file cannot be opened or
+ * written.
+ */
+inline static int open_index(const char* name, const uint32_t kind, const bool resume)
+{
+  char* idxname=oidx_filename(name);
+  int fd;
 
-      memset(data->newpostest_timeline_mean_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->newpostest_timeline_std_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
+  if((fd=open(idxname,O_RDWR|O_CREAT|(resume?0:O_TRUNC),S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH))<0) fprintf(stderr,"%s: Error: Cannot open file '%s' in write mode\n",__func__,idxname);
 
-      #ifdef SEC_INF_TIMELINES
-      memset(data->secinf_timeline_mean_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->secinf_timeline_std_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
+  else if(!resume && oidx_write_header(fd,kind)) {
+    close(fd);
+    fd=-1;
+  }
+  free(idxname);
+  return fd;
+}
 
-      memset(data->newsecinf_timeline_mean_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->newsecinf_timeline_std_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
+/**
+ * @brief Writes a filled output buffer and the index entries of its
+ * records.
+ *
+ * The buffer is submitted to the asynchronous writer if one is provided, and
+ * is otherwise written directly to the thread shard file.
+ *
+ * @param aw: Pointer to the asynchronous writer, or NULL.
+ * @param fd: Shard file descriptor, used if aw is NULL.
+ * @param buf: Filled buffer.
+ * @param size: Number of bytes to write.
+ * @param ow: Pointer to the index writer.
+ */
+inline static void submit_output_buffer(async_writer* aw, const int fd, char* buf, const ssize_t size, oidx_writer* ow)
+{
+  uint64_t offset;
+  uint64_t recoffset;
 
-      memset(data->newsecpostest_timeline_mean_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->newsecpostest_timeline_std_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      #endif
+  if(aw) awriter_submit(aw, buf, size, ow->nentries, &offset, &recoffset);
 
-      memset(data->reff_timeline_mean_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->reff_timeline_std_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->reff_timeline_n_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(uint64_t));
+  else {
 
-      #ifdef OBSREFF_OUTPUT
-      memset(data->reffobs_timeline_mean_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->reffobs_timeline_std_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(double));
-      memset(data->reffobs_timeline_n_noext+ndiff+data->tlpptnvpers,0,pdiff*sizeof(uint64_t));
-      #endif
+    if(write(fd, buf, size)!=size) {
+      perror(__func__);
+      exit(1);
     }
-    data->tlppnnpers+=ndiff;
-    data->tlpptnvpers=newsize;
+    offset=ow->offset;
+    recoffset=ow->nrecs;
+    ow->offset+=size;
+    ow->nrecs+=ow->nentries;
   }
+
+  if(oidx_flush(ow, offset, recoffset)) exit(1);
+}
+
+/**
+ * @brief Appends the records of the sampled paths to an output file and
+ * indexes them.
+ *
+ * @param fd: Output file descriptor, whose offset is at the end of the file.
+ * @param idxfd: Index file descriptor, or -1 if the output is not indexed.
+ * @param pr: Pointer to the merged and sorted reservoir.
+ * @param output: Written output (ro_pathsel_output).
+ * @return 0 on success, -1 on an error.
+ */
+inline static int write_sample(const int fd, const int idxfd, path_reservoir const* pr, const uint32_t output)
+{
+  oidx_writer ow;
+  const off_t offset=lseek(fd, 0, SEEK_CUR);
+
+  if(offset<0) {
+    perror(__func__);
+    return -1;
+  }
+  oidx_writer_init(&ow, idxfd, offset);
+  const int ret=reservoir_write(fd, &ow, pr, output);
+  oidx_writer_free(&ow);
+  return ret;
+}
+
+/**
+ * @brief Writes a filled output buffer and returns the buffer to fill next.
+ *
+ * @param aw: Pointer to the asynchronous writer, or NULL.
+ * @param fd: Shard file descriptor, used if aw is NULL.
+ * @param buf: Filled buffer.
+ * @param size: Number of bytes to write.
+ * @param ow: Pointer to the index writer.
+ * @return the buffer to fill next.
+ */
+inline static char* flush_output_buffer(async_writer* aw, const int fd, char* buf, const ssize_t size, oidx_writer* ow)
+{
+  submit_output_buffer(aw, fd, buf, size, ow);
+  return (aw?awriter_get_buffer(aw):buf);
 }
 
 inline static ssize_t tlo_write_reg_path(std_summary_stats const* stats, char* buf)
@@ -656,42 +1407,147 @@ inline static ssize_t tlo_write_reltime_postest_path(std_summary_stats const* st
 #endif
 }
 
-#ifdef CT_OUTPUT
-inline static int ctcompar(const void* first, const void* second){return ((*(ctposinf**)first)->postesttime<(*(ctposinf**)second)->postesttime?-1:((*(ctposinf**)first)->postesttime>(*(ctposinf**)second)->postesttime?1:0));}
+/**
+ * @brief Writes the timelines of a path to a memory buffer in the encoded
+ * format.
+ *
+ * The time bins that are written are the same as for the raw format
+ * writers.
+ *
+ * @param stats: Pointer to the standard summary statistics.
+ * @param buf: Output memory buffer.
+ * @param reltime: Whether the time mode is not the primary individual
+ * creation time.
+ * @param postest: Whether positive test timelines are written.
+ * @return the number of written bytes.
+ */
+inline static ssize_t tlo_write_encoded_path(std_summary_stats const* stats, char* buf, const bool reltime, const bool postest)
+{
+  int32_t bmin=(reltime?-stats->tlppnnpers:0);
+  int32_t bmax=bmin+stats->tlpptnvpers-1;
+
+  for(; bmax>bmin; --bmax) if(stats->pp_inf_timeline[bmax] || (postest && stats->pp_newpostest_timeline[bmax])) break;
+
+  if(reltime) while(!stats->pp_inf_timeline[bmin]) ++bmin;
+
+  const uint32_t nbins=bmax-bmin+1;
+  uint8_t* ebuf=tlo_encode_record_header((uint8_t*)buf,reltime,nbins,-bmin,stats->maxedoutmintimeindex,(int32_t)(stats->extinction?(isinf(stats->extinction_time)==-1?-INT32_MAX:floor(stats->extinction_time)):INT32_MAX));
+
+  ebuf=tlo_encode_timeline(ebuf,stats->pp_inf_timeline+bmin,nbins);
+  ebuf=tlo_encode_timeline(ebuf,stats->pp_newinf_timeline+bmin,nbins);
+
+  if(postest) ebuf=tlo_encode_timeline(ebuf,stats->pp_newpostest_timeline+bmin,nbins);
+#ifdef SEC_INF_TIMELINES
+  ebuf=tlo_encode_timeline(ebuf,stats->pp_secinf_timeline+bmin,nbins);
+  ebuf=tlo_encode_timeline(ebuf,stats->pp_newsecinf_timeline+bmin,nbins);
+
+  if(postest) ebuf=tlo_encode_timeline(ebuf,stats->pp_newsecpostest_timeline+bmin,nbins);
+#endif
+  return ebuf-(uint8_t*)buf;
+}
+
+inline static ssize_t tlo_write_enc_reg_path(std_summary_stats const* stats, char* buf){return tlo_write_encoded_path(stats,buf,false,false);}
+inline static ssize_t tlo_write_enc_reg_postest_path(std_summary_stats const* stats, char* buf){return tlo_write_encoded_path(stats,buf,false,true);}
+inline static ssize_t tlo_write_enc_reltime_path(std_summary_stats const* stats, char* buf){return tlo_write_encoded_path(stats,buf,true,false);}
+inline static ssize_t tlo_write_enc_reltime_postest_path(std_summary_stats const* stats, char* buf){return tlo_write_encoded_path(stats,buf,true,true);}
 
+#ifdef CT_OUTPUT
+/**
+ * @brief Writes the contact tracing entries of a path to a memory buffer.
+ *
+ * The entries must have been sorted by positive test time using
+ * std_stats_sort_ct_entries. When the path maxed out, only the entries up
+ * to the maxed out time index, which form a prefix of the sorted entries,
+ * are written.
+ *
+ * @param stats: Pointer to the standard summary statistics.
+ * @param buf: Output memory buffer.
+ * @return Number of written bytes.
+ */
 inline static ssize_t ct_write_func(std_summary_stats const* stats, char* buf)
 {
-  uint32_t i;
-  char* buf0=buf;
+  uint32_t n=stats->nctentries;
 
   //printf("Extinction: %u, nctentries: %u\n",stats->extinction,stats->nctentries);
 
-  if(stats->maxedoutmintimeindex==INT32_MAX) {
+  if(stats->maxedoutmintimeindex!=INT32_MAX) {
 
-    for(i=0; i<stats->nctentries; ++i) {
-      *((uint32_t*)(buf))=htole32(stats->ctentries[i]->postesttime);
-      *((uint32_t*)(buf+4))=htole32(stats->ctentries[i]->presymtime);
-      *((int32_t*)(buf+8))=htole32(stats->ctentries[i]->id);
-      *((int32_t*)(buf+12))=htole32(stats->ctentries[i]->pid);
-      *((uint32_t*)(buf+16))=htole32(stats->ctentries[i]->ntracedcts);
-      buf+=20;
-    }
-
-  } else {
+    for(n=0; n<stats->nctentries; ++n) if(floor(stats->ctentries[n].postesttime/1440.) > stats->maxedoutmintimeindex) break;
+  }
 
-    for(i=0; i<stats->nctentries; ++i) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  memcpy(buf, stats->ctentries, n*sizeof(ctposinf));
+#else
+  uint32_t i;
 
-      if(floor(stats->ctentries[i]->postesttime/1440.) <= stats->maxedoutmintimeindex) {
-	*((uint32_t*)(buf))=htole32(stats->ctentries[i]->postesttime);
-	*((uint32_t*)(buf+4))=htole32(stats->ctentries[i]->presymtime);
-	*((int32_t*)(buf+8))=htole32(stats->ctentries[i]->id);
-	*((int32_t*)(buf+12))=htole32(stats->ctentries[i]->pid);
-	*((uint32_t*)(buf+16))=htole32(stats->ctentries[i]->ntracedcts);
-	buf+=20;
-      }
-    }
+  for(i=0; i<n; ++i) {
+    *((uint32_t*)(buf+20*i))=htole32(stats->ctentries[i].postesttime);
+    *((uint32_t*)(buf+20*i+4))=htole32(stats->ctentries[i].presymtime);
+    *((int32_t*)(buf+20*i+8))=htole32(stats->ctentries[i].id);
+    *((int32_t*)(buf+20*i+12))=htole32(stats->ctentries[i].pid);
+    *((uint32_t*)(buf+20*i+16))=htole32(stats->ctentries[i].ntracedcts);
   }
-  return buf-buf0;
+#endif
+  return n*20;
 }
 #endif
 
+/**
+ * @brief Returns a time in minutes, rounded to the nearest minute.
+ */
+inline static int64_t tree_minutes(const double time){return llround(time*1440);}
+
+/**
+ * @brief Writes the transmission tree of a path to a memory buffer.
+ *
+ * The record starts with its size in bytes, excluding the size itself, as an
+ * unsigned 32 bit little endian integer, followed by the number of nodes. The
+ * nodes are then stored one column after the other, each value being
+ * encoded as a varint (see tlout_codec.h). The columns are the distance
+ * between the node index and the index of its parent (0 for primary
+ * individuals), the zig-zag mapped difference between the generation and the
+ * generation of the previous node, the zig-zag mapped difference between the
+ * infection time and the infection time of the parent (or the time origin
+ * for primary individuals), the latent period, the communicable period, the
+ * communicable period type flags, the index of the parent's transmission
+ * event, among the parent's events with infections, and the number of
+ * infections generated by the individual. Times are rounded to the minute
+ * before computing the differences, such that the period endpoints are
+ * recovered exactly by cumulative sums.
+ *
+ * @param stats: Pointer to the standard summary statistics.
+ * @param buf: Output memory buffer.
+ * @param origin: Time origin of the path.
+ * @return the number of written bytes.
+ */
+inline static ssize_t tree_write_func(std_summary_stats const* stats, char* buf, const double origin)
+{
+  tree_node const* const nodes=stats->treenodes;
+  const uint32_t n=stats->ntreenodes;
+  uint8_t* ebuf=tlo_put_varint((uint8_t*)buf+4,n);
+  uint32_t i;
+  uint32_t prevgen=0;
+
+  for(i=0; i<n; ++i) ebuf=tlo_put_varint(ebuf,(nodes[i].parent==UINT32_MAX?0:i-nodes[i].parent));
+
+  for(i=0; i<n; ++i) {
+    ebuf=tlo_put_varint(ebuf,tlo_zigzag((int64_t)nodes[i].generation-prevgen));
+    prevgen=nodes[i].generation;
+  }
+
+  for(i=0; i<n; ++i) ebuf=tlo_put_varint(ebuf,tlo_zigzag(tree_minutes(nodes[i].inftime-origin)-(nodes[i].parent==UINT32_MAX?0:tree_minutes(nodes[nodes[i].parent].inftime-origin))));
+
+  for(i=0; i<n; ++i) ebuf=tlo_put_varint(ebuf,tree_minutes(nodes[i].end_latent_period-origin)-tree_minutes(nodes[i].inftime-origin));
+
+  for(i=0; i<n; ++i) ebuf=tlo_put_varint(ebuf,tree_minutes(nodes[i].end_comm_period-origin)-tree_minutes(nodes[i].end_latent_period-origin));
+
+  for(i=0; i<n; ++i) ebuf=tlo_put_varint(ebuf,nodes[i].commpertype);
+
+  for(i=0; i<n; ++i) ebuf=tlo_put_varint(ebuf,nodes[i].event);
+
+  for(i=0; i<n; ++i) ebuf=tlo_put_varint(ebuf,nodes[i].ninf);
+  const uint32_t size=htole32((uint32_t)(ebuf-(uint8_t*)buf-4));
+  memcpy(buf,&size,4);
+  return ebuf-(uint8_t*)buf;
+}
+
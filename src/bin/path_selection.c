@@ -0,0 +1,127 @@
+/**
+ * @file path_selection.c
+ * @brief Selection of the paths written to the timeline, contact tracing and
+ * transmission tree outputs.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "path_selection.h"
+
+static int sp_cmp_path(const void* a, const void* b){const uint64_t pa=((sampled_path const*)a)->path, pb=((sampled_path const*)b)->path; return (pa>pb)-(pa<pb);}
+
+/**
+ * @brief Frees the output records of a sampled path.
+ *
+ * @param sp: Pointer to the sampled path.
+ */
+static void sampled_path_free(sampled_path* sp)
+{
+  uint32_t o;
+
+  for(o=0; o<ro_pathsel_noutputs; ++o) free(sp->recs[o]);
+}
+
+void reservoir_free(path_reservoir* pr)
+{
+  uint32_t i;
+
+  for(i=0; i<pr->npaths; ++i) sampled_path_free(pr->paths+i);
+  free(pr->paths);
+  pr->paths=NULL;
+  pr->npaths=0;
+}
+
+/**
+ * @brief Inserts a sampled path in a reservoir.
+ *
+ * The path must be accepted by the reservoir. If the reservoir is full, the
+ * path with the largest key is evicted.
+ *
+ * @param pr: Pointer to the reservoir.
+ * @param sp: Pointer to the sampled path, whose records are moved to the
+ * reservoir.
+ */
+static void reservoir_insert(path_reservoir* pr, sampled_path const* sp)
+{
+  uint32_t i, c;
+
+  if(pr->npaths<pr->size) {
+    //Sift up from the new leaf
+    i=pr->npaths++;
+
+    for(; i>0 && pr->paths[(i-1)>>1].key<sp->key; i=(i-1)>>1) pr->paths[i]=pr->paths[(i-1)>>1];
+
+  } else {
+    //Replace the path with the largest key and sift down from the root
+    sampled_path_free(pr->paths);
+    i=0;
+
+    for(;;) {
+      c=2*i+1;
+
+      if(c>=pr->npaths) break;
+
+      if(c+1<pr->npaths && pr->paths[c+1].key>pr->paths[c].key) ++c;
+
+      if(pr->paths[c].key<=sp->key) break;
+      pr->paths[i]=pr->paths[c];
+      i=c;
+    }
+  }
+  pr->paths[i]=*sp;
+}
+
+void reservoir_add(path_reservoir* pr, const uint64_t key, const uint64_t path, const uint32_t flags, char const* const* recs, uint32_t const* sizes, uint32_t const* counts)
+{
+  sampled_path sp={.key=key, .path=path, .flags=flags};
+  uint32_t o;
+
+  for(o=0; o<ro_pathsel_noutputs; ++o) {
+    sp.sizes[o]=sizes[o];
+    sp.counts[o]=counts[o];
+
+    if(recs[o]) {
+      sp.recs[o]=(char*)malloc(sizes[o]);
+      memcpy(sp.recs[o],recs[o],sizes[o]);
+
+    } else sp.recs[o]=NULL;
+  }
+  reservoir_insert(pr,&sp);
+}
+
+void reservoir_merge(path_reservoir* dst, path_reservoir* src)
+{
+  uint32_t i;
+
+  for(i=0; i<src->npaths; ++i) {
+
+    if(reservoir_accepts(dst,src->paths[i].key)) reservoir_insert(dst,src->paths+i);
+    else sampled_path_free(src->paths+i);
+  }
+  src->npaths=0;
+}
+
+void reservoir_sort(path_reservoir* pr)
+{
+  qsort(pr->paths,pr->npaths,sizeof(sampled_path),sp_cmp_path);
+}
+
+int reservoir_write(const int fd, oidx_writer* ow, path_reservoir const* pr, const uint32_t output)
+{
+  sampled_path const* sp;
+  uint64_t offset=0;
+  uint32_t i;
+
+  for(i=0; i<pr->npaths; ++i) {
+    sp=pr->paths+i;
+
+    if(write(fd, sp->recs[output], sp->sizes[output])!=(ssize_t)sp->sizes[output]) {
+      perror(__func__);
+      return -1;
+    }
+
+    if(ow->fd>=0) oidx_add(ow, offset, sp->path, sp->sizes[output], sp->counts[output], sp->flags);
+    offset+=sp->sizes[output];
+  }
+  return oidx_flush(ow, ow->offset, ow->nrecs);
+}
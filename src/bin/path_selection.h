@@ -0,0 +1,250 @@
+/**
+ * @file path_selection.h
+ * @brief Selection of the paths written to the timeline, contact tracing and
+ * transmission tree outputs.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * A path is written if it satisfies all the selection predicates and if its
+ * index is a multiple of the stride. If a sample size K is set, a uniform
+ * sample of K of the selected paths is written instead. Each path is given a
+ * pseudo-random key that only depends on its index and on the RNG stream, and
+ * each thread keeps a reservoir of the paths with the K smallest keys it has
+ * simulated. The reservoirs are merged at the end of the simulation, such
+ * that the sample does not depend on the number of threads.
+ */
+
+#ifndef _PATH_SELECTION_
+#define _PATH_SELECTION_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "standard_summary_stats.h"
+#include "output_index.h"
+
+/**
+ * Extinction states of selected paths.
+ */
+enum ro_pathsel_ext {ro_pathsel_extinct=1, ro_pathsel_nonextinct=2, ro_pathsel_anyext=3};
+
+/**
+ * Outputs of the sampled paths.
+ */
+enum ro_pathsel_output {ro_pathsel_tlout, ro_pathsel_ctout, ro_pathsel_treeout, ro_pathsel_noutputs};
+
+/**
+ * Output path selection parameters.
+ */
+typedef struct {
+  uint32_t ext;			//!< Extinction states of the selected paths (value set using ro_pathsel_ext).
+  bool maxedout;		//!< Only select paths that max out an nimax or npostestmax limit.
+  uint64_t minfinalsize;	//!< Minimum final size (total number of new infections) of the selected paths.
+  uint64_t maxfinalsize;	//!< Maximum final size of the selected paths.
+  double minpostesttime;	//!< Minimum time of the first positive test results of the selected paths.
+  double maxpostesttime;	//!< Maximum time of the first positive test results of the selected paths.
+  uint32_t stride;		//!< Only paths whose index is a multiple of the stride are selected.
+  uint32_t sample;		//!< Size of the uniform sample of selected paths that is written, or 0 to write all selected paths.
+} path_selection;
+
+/**
+ * Output records of a sampled path.
+ */
+typedef struct {
+  uint64_t key;		//!< Sampling key.
+  uint64_t path;	//!< Path index.
+  uint32_t flags;	//!< Index entry flags.
+  char* recs[ro_pathsel_noutputs];	//!< Record of each output (ro_pathsel_output), or NULL.
+  uint32_t sizes[ro_pathsel_noutputs];	//!< Size of the record of each output.
+  uint32_t counts[ro_pathsel_noutputs];	//!< Number of time bins or of entries of the record of each output.
+} sampled_path;
+
+/**
+ * Reservoir of sampled paths, stored as a max-heap on the sampling keys.
+ */
+typedef struct {
+  sampled_path* paths;	//!< Sampled paths.
+  uint32_t npaths;	//!< Number of sampled paths.
+  uint32_t size;	//!< Maximum number of sampled paths.
+} path_reservoir;
+
+/**
+ * @brief Initialises output path selection parameters such that all paths
+ * are selected.
+ *
+ * @param ps: Pointer to the selection parameters.
+ */
+inline static void pathsel_init(path_selection* ps)
+{
+  ps->ext=ro_pathsel_anyext;
+  ps->maxedout=false;
+  ps->minfinalsize=0;
+  ps->maxfinalsize=UINT64_MAX;
+  ps->minpostesttime=-INFINITY;
+  ps->maxpostesttime=INFINITY;
+  ps->stride=1;
+  ps->sample=0;
+}
+
+/**
+ * @brief Returns whether paths are selected based on their final size.
+ */
+inline static bool pathsel_finalsize(path_selection const* ps){return ps->minfinalsize>0 || ps->maxfinalsize<UINT64_MAX;}
+
+/**
+ * @brief Returns whether paths are selected based on the time of their first
+ * positive test results.
+ */
+inline static bool pathsel_postest(path_selection const* ps){return ps->minpostesttime>-INFINITY || ps->maxpostesttime<INFINITY;}
+
+/**
+ * @brief Returns whether some paths might not be written.
+ */
+inline static bool pathsel_active(path_selection const* ps){return ps->ext!=ro_pathsel_anyext || ps->maxedout || pathsel_finalsize(ps) || pathsel_postest(ps) || ps->stride>1 || ps->sample;}
+
+/**
+ * @brief Returns whether a simulated path satisfies the selection predicates
+ * and the stride.
+ *
+ * The final size is computed from the new infection timeline, and the time
+ * of the first positive test results is the start time of the first bin of
+ * the new positive test timeline with a non-zero count. Paths without
+ * positive test results are not selected when a positive test time range is
+ * set.
+ *
+ * @param ps: Pointer to the selection parameters.
+ * @param stats: Pointer to the summary statistics of the path.
+ * @param path: Path index.
+ * @return true if the path is selected.
+ */
+inline static bool pathsel_select(path_selection const* ps, std_summary_stats const* stats, const uint64_t path)
+{
+  if(path%ps->stride) return false;
+
+  if(!(ps->ext&(stats->extinction?ro_pathsel_extinct:ro_pathsel_nonextinct))) return false;
+
+  if(ps->maxedout && stats->maxedoutmintimeindex==INT32_MAX) return false;
+  const int32_t bmin=-stats->tlppnnpers;
+  const int32_t bmax=bmin+(int32_t)stats->tlpptnvpers;
+  int32_t b;
+
+  if(pathsel_finalsize(ps)) {
+    uint64_t finalsize=0;
+
+    for(b=bmin; b<bmax; ++b) finalsize+=stats->pp_newinf_timeline[b];
+
+    if(finalsize<ps->minfinalsize || finalsize>ps->maxfinalsize) return false;
+  }
+
+  if(pathsel_postest(ps)) {
+
+    for(b=bmin; b<bmax; ++b) if(stats->pp_newpostest_timeline[b]) break;
+
+    if(b==bmax || b<ps->minpostesttime*stats->nbinsperunit || b>ps->maxpostesttime*stats->nbinsperunit) return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Returns the sampling key of a path.
+ *
+ * The key is a mix of the path index and of the RNG stream, using the
+ * SplitMix64 finaliser.
+ *
+ * @param path: Path index.
+ * @param stream: RNG stream index.
+ * @return the key.
+ */
+inline static uint64_t pathsel_key(const uint64_t path, const uint32_t stream)
+{
+  uint64_t z=path+((uint64_t)stream<<40)+UINT64_C(0x9E3779B97F4A7C15);
+  z=(z^(z>>30))*UINT64_C(0xBF58476D1CE4E5B9);
+  z=(z^(z>>27))*UINT64_C(0x94D049BB133111EB);
+  return z^(z>>31);
+}
+
+/**
+ * @brief Initialises a path reservoir.
+ *
+ * @param pr: Pointer to the reservoir.
+ * @param size: Maximum number of sampled paths.
+ */
+inline static void reservoir_init(path_reservoir* pr, const uint32_t size)
+{
+  pr->paths=(size?(sampled_path*)malloc(size*sizeof(sampled_path)):NULL);
+  pr->npaths=0;
+  pr->size=size;
+}
+
+/**
+ * @brief Frees the memory used by a path reservoir and by its sampled paths.
+ *
+ * @param pr: Pointer to the reservoir.
+ */
+void reservoir_free(path_reservoir* pr);
+
+/**
+ * @brief Returns whether a path with the given key would be added to a
+ * reservoir.
+ *
+ * @param pr: Pointer to the reservoir.
+ * @param key: Sampling key of the path.
+ */
+inline static bool reservoir_accepts(path_reservoir const* pr, const uint64_t key){return pr->npaths<pr->size || key<pr->paths[0].key;}
+
+/**
+ * @brief Adds a path to a reservoir.
+ *
+ * The path must be accepted by the reservoir. If the reservoir is full, the
+ * path with the largest key is evicted. Copies of the output records are
+ * stored.
+ *
+ * @param pr: Pointer to the reservoir.
+ * @param key: Sampling key of the path.
+ * @param path: Path index.
+ * @param flags: Index entry flags of the path.
+ * @param recs: Record of each output (ro_pathsel_output), or NULL.
+ * @param sizes: Size of the record of each output.
+ * @param counts: Number of time bins or of entries of the record of each
+ * output.
+ */
+void reservoir_add(path_reservoir* pr, const uint64_t key, const uint64_t path, const uint32_t flags, char const* const* recs, uint32_t const* sizes, uint32_t const* counts);
+
+/**
+ * @brief Merges a path reservoir into another one.
+ *
+ * The paths of the source reservoir are moved to the destination reservoir
+ * if they are accepted, and freed otherwise.
+ *
+ * @param dst: Pointer to the destination reservoir.
+ * @param src: Pointer to the source reservoir, which is emptied.
+ */
+void reservoir_merge(path_reservoir* dst, path_reservoir* src);
+
+/**
+ * @brief Sorts the paths of a reservoir by path index.
+ *
+ * No path can be added to the reservoir afterwards.
+ *
+ * @param pr: Pointer to the reservoir.
+ */
+void reservoir_sort(path_reservoir* pr);
+
+/**
+ * @brief Writes the records of sampled paths to an output file and its
+ * index.
+ *
+ * @param fd: Output file descriptor.
+ * @param ow: Pointer to the index writer of the output, whose offset is the
+ * file offset of the first record.
+ * @param pr: Pointer to the sorted reservoir.
+ * @param output: Written output (ro_pathsel_output).
+ * @return 0 on success, -1 on a write error.
+ */
+int reservoir_write(const int fd, oidx_writer* ow, path_reservoir const* pr, const uint32_t output);
+
+#endif
@@ -0,0 +1,169 @@
+/**
+ * @file prior_sampling.c
+ * @brief Per-path sampling of simulation parameters from prior distributions.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "prior_sampling.h"
+
+int prior_parse(param_prior* pr, const char* spec)
+{
+  static const char* dists[]={"uniform", "loguniform", "lognormal", "gamma", "beta"};
+  const char* comma=strchr(spec,',');
+  const char* dend;
+  char* end;
+  uint8_t d;
+
+  //tdeltat determines which timelines are computed
+  if(!comma || !(pr->par=sweep_find_par(spec,comma-spec)) || pr->par->type!=ro_sweep_double || !strcmp(pr->par->name,"tdeltat")) {
+    fprintf(stderr,"%s: Error: '%s' does not start with the name of a parameter that can be sampled\n",__func__,spec);
+    return -1;
+  }
+  spec=comma+1;
+
+  if(!(dend=strchr(spec,','))) dend=spec+strlen(spec);
+
+  for(d=0; d<sizeof(dists)/sizeof(char*); ++d) if(strlen(dists[d])==dend-spec && !strncmp(dists[d],spec,dend-spec)) break;
+
+  if(d==sizeof(dists)/sizeof(char*)) {
+    fprintf(stderr,"%s: Error: Unknown prior distribution in '%s'\n",__func__,spec);
+    return -1;
+  }
+  pr->dist=d;
+  pr->a=pr->b=NAN;
+  pr->step=0;
+  end=(char*)dend;
+
+  if(*end) {
+    pr->a=strtod(end+1,&end);
+
+    if(*end==',') {
+      pr->b=strtod(end+1,&end);
+
+      if(*end==',') pr->step=strtod(end+1,&end);
+    }
+  }
+
+  if(*end || isnan(pr->b)) {
+    fprintf(stderr,"%s: Error: The prior of parameter '%s' must be of the form NAME,DIST,A,B[,STEP]\n",__func__,pr->par->name);
+    return -1;
+  }
+
+  if(!isfinite(pr->a) || !isfinite(pr->b) || !(pr->step>=0) || !isfinite(pr->step)
+      || (pr->dist==ro_prior_uniform && !(pr->a<pr->b))
+      || (pr->dist==ro_prior_loguniform && !(pr->a>0 && pr->a<pr->b))
+      || (pr->dist==ro_prior_lognormal && !(pr->b>0))
+      || (pr->dist>=ro_prior_gamma && !(pr->a>0 && pr->b>0))) {
+    fprintf(stderr,"%s: Error: Invalid distribution parameters for the prior of parameter '%s'\n",__func__,pr->par->name);
+    return -1;
+  }
+  return 0;
+}
+
+void prior_draw(param_prior const* priors, const uint32_t npriors, const gsl_rng* r, double* vals)
+{
+  param_prior const* pr;
+  uint32_t i;
+
+  for(i=0; i<npriors; ++i) {
+    pr=priors+i;
+
+    if(pr->dist==ro_prior_uniform) vals[i]=pr->a+(pr->b-pr->a)*gsl_rng_uniform(r);
+    else if(pr->dist==ro_prior_loguniform) vals[i]=pr->a*exp(log(pr->b/pr->a)*gsl_rng_uniform(r));
+    else if(pr->dist==ro_prior_lognormal) vals[i]=gsl_ran_lognormal(r,pr->a,pr->b);
+    else if(pr->dist==ro_prior_gamma) vals[i]=gsl_ran_gamma(r,pr->a,pr->b);
+    else vals[i]=gsl_ran_beta(r,pr->a,pr->b);
+
+    if(pr->step>0) vals[i]=pr->step*round(vals[i]/pr->step);
+  }
+}
+
+double prior_density(param_prior const* priors, const uint32_t npriors, double const* vals)
+{
+  param_prior const* pr;
+  double dens=1;
+  uint32_t i;
+
+  for(i=0; i<npriors; ++i) {
+    pr=priors+i;
+
+    if(pr->dist==ro_prior_uniform || pr->dist==ro_prior_loguniform) {
+
+      if(vals[i]<pr->a || vals[i]>pr->b) return 0;
+      dens*=(pr->dist==ro_prior_uniform?1/(pr->b-pr->a):1/(vals[i]*log(pr->b/pr->a)));
+
+    } else if(!(vals[i]>0) || (pr->dist==ro_prior_beta && !(vals[i]<1))) return 0;
+    else if(pr->dist==ro_prior_lognormal) dens*=gsl_ran_lognormal_pdf(vals[i],pr->a,pr->b);
+    else if(pr->dist==ro_prior_gamma) dens*=gsl_ran_gamma_pdf(vals[i],pr->a,pr->b);
+    else dens*=gsl_ran_beta_pdf(vals[i],pr->a,pr->b);
+  }
+  return dens;
+}
+
+void prior_cache_init(prior_cache* pc, param_prior const* priors, const uint32_t npriors)
+{
+  uint32_t i;
+
+  pc->npriors=npriors;
+  pc->enabled=true;
+
+  for(i=0; i<npriors; ++i) if(!(priors[i].step>0)) pc->enabled=false;
+
+  if(pc->enabled) {
+    pc->keys=(int64_t*)malloc(PRIOR_CACHE_SIZE*npriors*sizeof(int64_t));
+    pc->used=(bool*)calloc(PRIOR_CACHE_SIZE,sizeof(bool));
+    pc->pars=(model_pars*)malloc((PRIOR_CACHE_SIZE+1)*sizeof(model_pars));
+
+  } else {
+    pc->keys=NULL;
+    pc->used=NULL;
+    pc->pars=(model_pars*)malloc(sizeof(model_pars));
+  }
+  pc->nused=0;
+  pc->nsolved=0;
+}
+
+model_pars const* prior_cache_solve(prior_cache* pc, param_prior const* priors, model_pars const* basepars, double const* vals)
+{
+  const uint32_t n=pc->npriors;
+  int64_t key[n];
+  uint64_t hash=UINT64_C(0xcbf29ce484222325);
+  uint32_t slot=0;
+  uint32_t i;
+
+  if(pc->enabled) {
+
+    for(i=0; i<n; ++i) {
+      key[i]=llround(vals[i]/priors[i].step);
+      //FNV-1a over the grid indices
+      hash=(hash^(uint64_t)key[i])*UINT64_C(0x100000001b3);
+    }
+
+    for(slot=hash&(PRIOR_CACHE_SIZE-1); pc->used[slot]; slot=(slot+1)&(PRIOR_CACHE_SIZE-1)) if(!memcmp(pc->keys+slot*n,key,n*sizeof(int64_t))) return pc->pars+slot;
+
+    //Grid points are no longer cached once the cache is full
+    if(4*(pc->nused+1)>3*PRIOR_CACHE_SIZE) slot=PRIOR_CACHE_SIZE;
+  }
+  model_pars* pars=pc->pars+slot;
+
+  *pars=*basepars;
+
+  for(i=0; i<n; ++i) *(double*)((char*)pars+priors[i].par->offset)=vals[i];
+  ++pc->nsolved;
+
+  if(model_solve_pars_verbose(pars,false) || model_pars_check(pars)) return NULL;
+
+  if(pc->enabled && slot<PRIOR_CACHE_SIZE) {
+    memcpy(pc->keys+slot*n,key,n*sizeof(int64_t));
+    pc->used[slot]=true;
+    ++pc->nused;
+  }
+  return pars;
+}
+
+void prior_cache_free(prior_cache* pc)
+{
+  free(pc->keys);
+  free(pc->used);
+  free(pc->pars);
+}
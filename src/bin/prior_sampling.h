@@ -0,0 +1,128 @@
+/**
+ * @file prior_sampling.h
+ * @brief Per-path sampling of simulation parameters from prior distributions.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * When priors are set, the values of the corresponding simulation parameters
+ * are drawn for each path from the RNG stream of its path set, before the
+ * path is simulated, such that the draws do not depend on the number of
+ * threads. Each drawn value can be rounded to a multiple of a quantisation
+ * step. The other simulation parameters are then solved from the command
+ * line parameters and the drawn values. When all the priors are quantised,
+ * each thread caches the solved parameters of the visited points of the
+ * quantisation grid.
+ */
+
+#ifndef _PRIOR_SAMPLING_
+#define _PRIOR_SAMPLING_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+
+#include "model_parameters.h"
+#include "sweep.h"
+
+#define PRIOR_CACHE_SIZE (4096)		//!< Number of slots of the per-thread cache of solved simulation parameters, which must be a power of 2. At most 3/4 of the slots are used.
+
+/**
+ * Prior distributions.
+ */
+enum ro_prior_dist {ro_prior_uniform, ro_prior_loguniform, ro_prior_lognormal, ro_prior_gamma, ro_prior_beta};
+
+/**
+ * Prior distribution of a simulation parameter.
+ */
+typedef struct {
+  sweep_par const* par;	//!< Sampled parameter.
+  uint8_t dist;		//!< Distribution (value set using ro_prior_dist).
+  double a;		//!< First distribution parameter.
+  double b;		//!< Second distribution parameter.
+  double step;		//!< Quantisation step of the drawn values, or 0 if they are not quantised.
+} param_prior;
+
+/**
+ * Cache of the solved simulation parameters of the points of the
+ * quantisation grid.
+ */
+typedef struct {
+  uint32_t npriors;	//!< Number of priors.
+  bool enabled;		//!< Whether the solved parameters are cached, which requires all the priors to be quantised.
+  int64_t* keys;	//!< Grid indices of the drawn values of each slot.
+  bool* used;		//!< Whether each slot is used.
+  model_pars* pars;	//!< Solved simulation parameters of each slot, followed by the parameters of the last uncached draw.
+  uint32_t nused;	//!< Number of used slots.
+  uint64_t nsolved;	//!< Number of times the simulation parameters were solved.
+} prior_cache;
+
+/**
+ * @brief Parses a prior specification of the form NAME,DIST,A,B[,STEP].
+ *
+ * @param pr: Pointer to the parsed prior.
+ * @param spec: Prior specification.
+ * @return 0 on success, -1 on an error.
+ */
+int prior_parse(param_prior* pr, const char* spec);
+
+/**
+ * @brief Draws the values of the sampled parameters for a path.
+ *
+ * @param priors: Priors.
+ * @param npriors: Number of priors.
+ * @param r: Pointer to the random number generator of the path set.
+ * @param vals: Returns the drawn values, rounded to their quantisation step.
+ */
+void prior_draw(param_prior const* priors, const uint32_t npriors, const gsl_rng* r, double* vals);
+
+/**
+ * @brief Evaluates the joint prior density of values of the sampled
+ * parameters.
+ *
+ * @param priors: Priors.
+ * @param npriors: Number of priors.
+ * @param vals: Values of the sampled parameters.
+ * @return the product of the prior densities, which is 0 outside of the
+ * support of the priors.
+ */
+double prior_density(param_prior const* priors, const uint32_t npriors, double const* vals);
+
+/**
+ * @brief Initialises a cache of solved simulation parameters.
+ *
+ * @param pc: Pointer to the cache.
+ * @param priors: Priors.
+ * @param npriors: Number of priors.
+ */
+void prior_cache_init(prior_cache* pc, param_prior const* priors, const uint32_t npriors);
+
+/**
+ * @brief Returns the simulation parameters solved for drawn values.
+ *
+ * The parameters are taken from the cache if the grid point of the values
+ * was already solved, and they are otherwise solved without being printed
+ * and added to the cache if it is not full.
+ *
+ * @param pc: Pointer to the cache.
+ * @param priors: Priors.
+ * @param basepars: Simulation parameters from the command line, before they
+ * are solved.
+ * @param vals: Drawn values.
+ * @return a pointer to the solved parameters, which remains valid until the
+ * next call, or NULL if the parameters cannot be solved or are invalid.
+ */
+model_pars const* prior_cache_solve(prior_cache* pc, param_prior const* priors, model_pars const* basepars, double const* vals);
+
+/**
+ * @brief Frees the memory used by a cache of solved simulation parameters.
+ *
+ * @param pc: Pointer to the cache.
+ */
+void prior_cache_free(prior_cache* pc);
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file result_cache.c
+ * @brief On-disk cache of simulation results.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "result_cache.h"
+
+uint64_t rcache_key(ckpt_buffer const* buf)
+{
+  uint64_t h=UINT64_C(0xcbf29ce484222325);
+  size_t i;
+
+  for(i=0; i<buf->size; ++i) {
+    h^=(uint8_t)buf->data[i];
+    h*=UINT64_C(0x100000001b3);
+  }
+  return h;
+}
+
+int rcache_open(const char* dir)
+{
+  struct stat sb;
+
+  if(mkdir(dir,S_IRWXU|S_IRGRP|S_IXGRP|S_IROTH|S_IXOTH) && errno!=EEXIST) {
+    fprintf(stderr,"%s: Error: Cannot create cache directory '%s'\n",__func__,dir);
+    return -1;
+  }
+
+  if(stat(dir,&sb) || !S_ISDIR(sb.st_mode)) {
+    fprintf(stderr,"%s: Error: '%s' is not a directory\n",__func__,dir);
+    return -1;
+  }
+  return 0;
+}
+
+uint32_t rcache_lookup(const char* dir, const uint64_t key, const uint32_t maxnsets)
+{
+  DIR* d=opendir(dir);
+  struct dirent* de;
+  uint64_t k;
+  uint32_t n, best=0;
+  int len;
+
+  if(!d) return 0;
+
+  while((de=readdir(d))) {
+    len=0;
+
+    //Temporary files of entries being written do not match
+    if(sscanf(de->d_name,"%16" SCNx64 "-%" SCNu32 ".acc%n",&k,&n,&len)==2 && len && !de->d_name[len] && k==key && n<=maxnsets && n>best) best=n;
+  }
+  closedir(d);
+  return best;
+}
+
+char* rcache_entry_name(const char* dir, const uint64_t key, const uint32_t nsets)
+{
+  char* name=(char*)malloc(strlen(dir)+34);
+
+  sprintf(name,"%s/%016" PRIx64 "-%" PRIu32 ".acc",dir,key,nsets);
+  return name;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file result_cache.h
+ * @brief On-disk cache of simulation results.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * The cache is a directory of accumulator files. The name of each file is
+ * formed from a key and from the number of path sets of the stored result.
+ * The key is a hash of the serialised parameters that determine the
+ * statistics of the path sets, which include the solved simulation
+ * parameters, the RNG stream, the path set size and the build variant. A
+ * result for a given number of sets is obtained by reading the entry with
+ * the same number of sets, or by extending the largest entry with fewer sets
+ * with a top-up run. Since accumulator files also store the serialised
+ * parameters, a hash collision is detected when an entry is read.
+ */
+
+#ifndef _RESULT_CACHE_
+#define _RESULT_CACHE_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "checkpoint.h"
+
+/**
+ * @brief Computes the cache key of serialised parameters.
+ *
+ * The key is the 64-bit FNV-1a hash of the buffer content.
+ *
+ * @param buf: Pointer to the buffer containing the serialised parameters.
+ * @return the cache key.
+ */
+uint64_t rcache_key(ckpt_buffer const* buf);
+
+/**
+ * @brief Creates the cache directory if it does not exist.
+ *
+ * @param dir: Cache directory.
+ * @return 0 on success, -1 on an error.
+ */
+int rcache_open(const char* dir);
+
+/**
+ * @brief Finds the cache entry of a key with the largest number of path sets
+ * that does not exceed a given number.
+ *
+ * @param dir: Cache directory.
+ * @param key: Cache key.
+ * @param maxnsets: Maximum number of path sets.
+ * @return the number of path sets of the entry, or 0 if there is none.
+ */
+uint32_t rcache_lookup(const char* dir, const uint64_t key, const uint32_t maxnsets);
+
+/**
+ * @brief Returns the file name of a cache entry.
+ *
+ * @param dir: Cache directory.
+ * @param key: Cache key.
+ * @param nsets: Number of path sets of the entry.
+ * @return the file name, which must be freed by the caller.
+ */
+char* rcache_entry_name(const char* dir, const uint64_t key, const uint32_t nsets);
+
+#endif
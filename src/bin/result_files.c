@@ -0,0 +1,89 @@
+/**
+ * @file result_files.c
+ * @brief Accumulator and prior record files.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "result_files.h"
+#include "main.h"
+
+int acc_write(const char* filename, config_pars const* cp, set_data const* sdata, const uint32_t first, const uint32_t end)
+{
+  ckpt_buffer buf;
+  uint32_t s;
+  int ret;
+
+  ckbuf_init(&buf);
+  ckbuf_put(&buf, ACC_MAGIC, CKPT_MAGIC_SIZE);
+  put_stats_config(&buf, cp);
+  ckbuf_put(&buf, &first, sizeof(uint32_t));
+  ckbuf_put(&buf, &end, sizeof(uint32_t));
+
+  for(s=first; s<end; s+=UINT32_C(1)<<set_block_level(s, end)) ckpt_put_set_data(&buf, sdata+s);
+  ret=ckpt_write(filename, &buf);
+  ckbuf_free(&buf);
+  return ret;
+}
+
+int acc_read(const char* filename, config_pars const* cp, ckpt_buffer* buf, uint32_t* first, uint32_t* end)
+{
+  ckpt_buffer cfg;
+  bool same;
+
+  if(ckpt_read(filename, ACC_MAGIC, buf)) return -1;
+  ckbuf_init(&cfg);
+  put_stats_config(&cfg, cp);
+  same=ckbuf_match(buf, &cfg);
+  ckbuf_free(&cfg);
+
+  if(!same) {
+    fprintf(stderr,"%s: Error: Accumulator file '%s' was written with different parameters\n",__func__,filename);
+    return -1;
+  }
+
+  if(ckbuf_get(buf, first, sizeof(uint32_t)) || ckbuf_get(buf, end, sizeof(uint32_t))) return -1;
+
+  if(*end<*first) {
+    fprintf(stderr,"%s: Error: Invalid set range in accumulator file '%s'\n",__func__,filename);
+    return -1;
+  }
+  return 0;
+}
+
+int acc_load(ckpt_buffer* buf, config_pars const* cp, set_data* sdata, const uint32_t first, const uint32_t end)
+{
+  uint32_t s;
+
+  for(s=first; s<end; s+=UINT32_C(1)<<set_block_level(s, end)) if(ckpt_get_set_data(buf, sdata+s, cp)) return -1;
+  return 0;
+}
+
+int write_prior_records(const char* filename, config_pars const* cp, double const* recs, const uint32_t firstpath, const uint32_t endpath)
+{
+  FILE* f=fopen(filename,"w");
+  uint32_t path, i;
+
+  if(!f) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in write mode\n",__func__,filename);
+    return -1;
+  }
+  fprintf(f,"path");
+
+  for(i=0; i<cp->npriors; ++i) fprintf(f,"\t%s",cp->priors[i].par->name);
+  fprintf(f,"\textinct\tmaxedout\texttime\tfinalsize\tpeakinf\n");
+
+  for(path=firstpath; path<endpath; ++path) {
+    fprintf(f,"%" PRIu32,path);
+
+    for(i=0; i<cp->npriors; ++i) fprintf(f,"\t%.17g",recs[i]);
+    recs+=cp->npriors;
+    fprintf(f,"\t%.0f\t%.0f\t%.17g\t%.0f\t%.0f\n",recs[0],recs[1],recs[2],recs[3],recs[4]);
+    recs+=PRIOR_REC_NOUTCOMES;
+  }
+
+  if(fclose(f)) {
+    fprintf(stderr,"%s: Error: Cannot write file '%s'\n",__func__,filename);
+    return -1;
+  }
+  return 0;
+}
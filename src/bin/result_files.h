@@ -0,0 +1,90 @@
+/**
+ * @file result_files.h
+ * @brief Accumulator and prior record files.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * An accumulator file stores the merged statistics of a range of path sets,
+ * along with the parameters that determine them, such that the result can
+ * be extended, merged or cached. A prior record file lists the sampled
+ * parameters and the outcome of each path.
+ */
+
+#ifndef _RESULT_FILES_
+#define _RESULT_FILES_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "config.h"
+#include "checkpoint.h"
+
+#define ACC_MAGIC "ROACCU01"		//!< Accumulator file magic, including the format version
+
+struct set_data_;
+
+/**
+ * @brief Writes the statistics of a range of completed sets to an
+ * accumulator file.
+ *
+ * The range is stored as its decomposition into complete subtrees of the set
+ * merging tree, whose statistics must be stored in the slot of their first
+ * set.
+ *
+ * @param filename: Accumulator file name.
+ * @param cp: Configuration parameters.
+ * @param sdata: Statistics of each set of paths.
+ * @param first: Index of the first set of the range.
+ * @param end: Index following the last set of the range.
+ * @return 0 on success, -1 on a write error.
+ */
+int acc_write(const char* filename, config_pars const* cp, struct set_data_ const* sdata, const uint32_t first, const uint32_t end);
+
+/**
+ * @brief Reads an accumulator file and verifies that it was written with the
+ * same parameters.
+ *
+ * @param filename: Accumulator file name.
+ * @param cp: Configuration parameters.
+ * @param buf: Pointer to the buffer receiving the file content, whose read
+ * position is set to the statistics of the first subtree.
+ * @param first: Returns the index of the first set of the stored range.
+ * @param end: Returns the index following the last set of the stored range.
+ * @return 0 on success, -1 on an error.
+ */
+int acc_read(const char* filename, config_pars const* cp, ckpt_buffer* buf, uint32_t* first, uint32_t* end);
+
+/**
+ * @brief Loads the statistics of the range of sets of an accumulator file
+ * into the slots of the first set of its complete subtrees.
+ *
+ * @param buf: Pointer to the buffer returned by acc_read.
+ * @param cp: Configuration parameters.
+ * @param sdata: Statistics of each set of paths.
+ * @param first: Index of the first set of the stored range.
+ * @param end: Index following the last set of the stored range.
+ * @return 0 on success, -1 if the file is truncated.
+ */
+int acc_load(ckpt_buffer* buf, config_pars const* cp, struct set_data_* sdata, const uint32_t first, const uint32_t end);
+
+/**
+ * @brief Number of values recorded for each path when priors are set,
+ * following the sampled parameters.
+ */
+#define PRIOR_REC_NOUTCOMES (5)
+
+/**
+ * @brief Writes the sampled parameters and the outcome of paths to a file.
+ *
+ * @param filename: Output file name.
+ * @param cp: Pointer to the configuration parameters.
+ * @param recs: Records of the paths, starting with the first written path.
+ * @param firstpath: Index of the first written path.
+ * @param endpath: Index following the last written path.
+ * @return 0 on success, -1 on an error.
+ */
+int write_prior_records(const char* filename, config_pars const* cp, double const* recs, const uint32_t firstpath, const uint32_t endpath);
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @file seeds.c
+ * @brief Snapshot of current infections the simulation starts from.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "seeds.h"
+
+/**
+ * @brief Parses the fields of a seed individual.
+ *
+ * @param line: Line of the seed file, which is modified.
+ * @param seed: Returns the seed individual.
+ * @return 0 on success, -1 if the line is invalid.
+ */
+static int seeds_parse(char* line, ts_seed* seed)
+{
+  char* save;
+  char* end;
+  char* field[5];
+  int n=0;
+  double v;
+
+  for(field[n]=strtok_r(line," \t\r\n",&save); field[n] && n<4; field[n]=strtok_r(NULL," \t\r\n",&save)) ++n;
+
+  if(n<3 || field[n]) return -1;
+
+  seed->inftime=strtod(field[0],&end);
+
+  if(*end || !(seed->inftime<=0) || isinf(seed->inftime)) return -1;
+
+  if(!strcmp(field[1],"latent")) seed->phase=ts_seed_latent;
+  else if(!strcmp(field[1],"comm")) seed->phase=ts_seed_comm;
+  else return -1;
+
+  if(!strcmp(field[2],"unknown")) seed->test=ts_seed_test_unknown;
+  else if(!strcmp(field[2],"negative")) seed->test=ts_seed_test_negative;
+  else if(!strcmp(field[2],"positive")) seed->test=ts_seed_test_positive;
+  else return -1;
+
+  if(n==4) {
+    v=strtod(field[3],&end);
+
+    if(*end || !(v>=1) || v>UINT32_MAX-1 || v!=floor(v)) return -1;
+    seed->generation=(uint32_t)v;
+
+  } else seed->generation=1;
+  return 0;
+}
+
+int seeds_read(const char* filename, ts_seed** seeds, uint32_t* nseeds)
+{
+  FILE* f=fopen(filename,"r");
+  char* line=NULL;
+  char* ptr;
+  size_t alloc=0;
+  uint32_t nalloc=0;
+  uint32_t lineno=0;
+
+  *seeds=NULL;
+  *nseeds=0;
+
+  if(!f) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in read mode\n",__func__,filename);
+    return -1;
+  }
+
+  while(getline(&line,&alloc,f)>=0) {
+    ++lineno;
+
+    if((ptr=strchr(line,'#'))) *ptr=0;
+
+    if(!line[strspn(line," \t\r\n")]) continue;
+
+    if(*nseeds==nalloc) {
+      nalloc=(nalloc?2*nalloc:64);
+      *seeds=(ts_seed*)realloc(*seeds,nalloc*sizeof(ts_seed));
+    }
+
+    if(seeds_parse(line,*seeds+*nseeds)) {
+      fprintf(stderr,"%s: Error: Invalid seed individual on line %u of file '%s'\n",__func__,lineno,filename);
+      free(line);
+      fclose(f);
+      free(*seeds);
+      *seeds=NULL;
+      *nseeds=0;
+      return -1;
+    }
+    ++*nseeds;
+  }
+  free(line);
+  fclose(f);
+
+  if(!*nseeds) {
+    fprintf(stderr,"%s: Error: Seed file '%s' does not contain any seed individual\n",__func__,filename);
+    return -1;
+  }
+  return 0;
+}
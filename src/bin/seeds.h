@@ -0,0 +1,35 @@
+/**
+ * @file seeds.h
+ * @brief Snapshot of current infections the simulation starts from.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * A seed file lists the individuals that are infected at time 0, one per
+ * line, as space-separated fields INFTIME PHASE TEST [GENERATION]. INFTIME
+ * is the infection time, which cannot be positive, PHASE is the infection
+ * phase at time 0 (latent or comm), TEST is the testing status (unknown,
+ * negative or positive) and GENERATION is the optional infection generation
+ * (default value of 1). Empty lines and text following '#' are ignored.
+ */
+
+#ifndef _SEEDS_
+#define _SEEDS_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "timesim.h"
+
+/**
+ * @brief Reads a seed file.
+ *
+ * @param filename: Seed file name.
+ * @param seeds: Returns the allocated seed individuals.
+ * @param nseeds: Returns the number of seed individuals.
+ * @return 0 on success, -1 on an error.
+ */
+int seeds_read(const char* filename, ts_seed** seeds, uint32_t* nseeds);
+
+#endif
@@ -0,0 +1,209 @@
+/**
+ * @file sweep.c
+ * @brief Parameter sweep specifications.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "sweep.h"
+
+#define SWEEP_DOUBLE(name) {#name, offsetof(model_pars, name), ro_sweep_double}
+
+static const sweep_par sweep_pars[]={
+  SWEEP_DOUBLE(pinfpri), SWEEP_DOUBLE(tbar), SWEEP_DOUBLE(kappa), SWEEP_DOUBLE(t95), SWEEP_DOUBLE(lambda), SWEEP_DOUBLE(lambda_uncut), SWEEP_DOUBLE(lambdap), SWEEP_DOUBLE(g_ave), SWEEP_DOUBLE(p), SWEEP_DOUBLE(mu), SWEEP_DOUBLE(sigma), SWEEP_DOUBLE(rsigma), SWEEP_DOUBLE(pinf),
+#ifdef DUAL_PINF
+  SWEEP_DOUBLE(ppip), SWEEP_DOUBLE(rpinfp), SWEEP_DOUBLE(rpshedp), SWEEP_DOUBLE(qp),
+#endif
+  SWEEP_DOUBLE(R0), SWEEP_DOUBLE(lbar), SWEEP_DOUBLE(kappal), SWEEP_DOUBLE(l95), SWEEP_DOUBLE(q), SWEEP_DOUBLE(mbar), SWEEP_DOUBLE(kappaq), SWEEP_DOUBLE(m95),
+#ifdef CT_OUTPUT
+  SWEEP_DOUBLE(ctwindow), SWEEP_DOUBLE(pt),
+#endif
+  SWEEP_DOUBLE(pit), SWEEP_DOUBLE(itbar), SWEEP_DOUBLE(kappait), SWEEP_DOUBLE(it95), SWEEP_DOUBLE(pim), SWEEP_DOUBLE(imbar), SWEEP_DOUBLE(kappaim), SWEEP_DOUBLE(im95), SWEEP_DOUBLE(ttpr), SWEEP_DOUBLE(mtpr), SWEEP_DOUBLE(tdeltat),
+  {"tmax", offsetof(model_pars, tmax), ro_sweep_int32}, {"nstart", offsetof(model_pars, nstart), ro_sweep_uint32}, {"popsize", offsetof(model_pars, popsize), ro_sweep_uint32}
+};
+
+sweep_par const* sweep_find_par(const char* name, const size_t len)
+{
+  uint32_t i;
+
+  for(i=0; i<sizeof(sweep_pars)/sizeof(sweep_par); ++i) if(strlen(sweep_pars[i].name)==len && !strncmp(sweep_pars[i].name,name,len)) return sweep_pars+i;
+  return NULL;
+}
+
+/**
+ * @brief Adds the points of the grid defined by a line of a sweep file.
+ *
+ * @param ss: Pointer to the sweep specification.
+ * @param line: Line content, which is modified.
+ * @param lineno: Line number, for error messages.
+ * @return 0 on success, -1 on an error.
+ */
+static int sweep_add_line(sweep_spec* ss, char* line, const uint32_t lineno)
+{
+  uint32_t* cols=NULL;
+  double** vals=NULL;
+  uint32_t* nvals=NULL;
+  uint32_t nassigns=0;
+  uint64_t npoints=1;
+  uint64_t pt, rem;
+  double* row;
+  char* saveptr;
+  char* tok;
+  char* eq;
+  char* end;
+  sweep_par const* sp;
+  double v;
+  uint32_t a, c;
+  int ret=-1;
+
+  if((eq=strchr(line,'#'))) *eq=0;
+
+  for(tok=strtok_r(line," \t\r\n",&saveptr); tok; tok=strtok_r(NULL," \t\r\n",&saveptr)) {
+
+    if(!(eq=strchr(tok,'=')) || !(sp=sweep_find_par(tok,eq-tok))) {
+      fprintf(stderr,"%s: Error: Line %" PRIu32 ": '%s' is not an assignment to a parameter that can be swept\n",__func__,lineno,tok);
+      goto cleanup;
+    }
+
+    for(c=0; c<ss->npars && ss->pars[c]!=sp; ++c);
+
+    for(a=0; a<nassigns; ++a) if(cols[a]==c) {
+      fprintf(stderr,"%s: Error: Line %" PRIu32 ": Parameter '%s' is assigned more than once\n",__func__,lineno,sp->name);
+      goto cleanup;
+    }
+
+    //The rows of the previous points are widened, these points keeping the
+    //value of a new parameter from the command line
+    if(c==ss->npars) {
+      ss->pars=(sweep_par const**)realloc(ss->pars,(ss->npars+1)*sizeof(sweep_par const*));
+      ss->pars[ss->npars]=sp;
+
+      if(ss->npoints) {
+	ss->values=(double*)realloc(ss->values,ss->npoints*(ss->npars+1)*sizeof(double));
+
+	for(a=ss->npoints; a>0; --a) {
+	  memmove(ss->values+(a-1)*(ss->npars+1),ss->values+(a-1)*ss->npars,ss->npars*sizeof(double));
+	  ss->values[(a-1)*(ss->npars+1)+ss->npars]=NAN;
+	}
+      }
+      ++ss->npars;
+    }
+    cols=(uint32_t*)realloc(cols,(nassigns+1)*sizeof(uint32_t));
+    vals=(double**)realloc(vals,(nassigns+1)*sizeof(double*));
+    nvals=(uint32_t*)realloc(nvals,(nassigns+1)*sizeof(uint32_t));
+    cols[nassigns]=c;
+    vals[nassigns]=NULL;
+    nvals[nassigns]=0;
+    ++nassigns;
+
+    for(tok=eq+1;; tok=end+1) {
+      vals[nassigns-1]=(double*)realloc(vals[nassigns-1],(nvals[nassigns-1]+1)*sizeof(double));
+      v=vals[nassigns-1][nvals[nassigns-1]]=strtod(tok,&end);
+
+      if(end==tok || (*end && *end!=',') || !isfinite(v) || (sp->type!=ro_sweep_double && (v!=floor(v) || v<(sp->type==ro_sweep_int32?INT32_MIN:0) || v>(sp->type==ro_sweep_int32?INT32_MAX:UINT32_MAX)))) {
+	fprintf(stderr,"%s: Error: Line %" PRIu32 ": Invalid value for parameter '%s'\n",__func__,lineno,sp->name);
+	goto cleanup;
+      }
+      ++nvals[nassigns-1];
+
+      if(!*end) break;
+    }
+    npoints*=nvals[nassigns-1];
+  }
+
+  if(!nassigns) {
+    ret=0;
+    goto cleanup;
+  }
+
+  if(ss->npoints+npoints>UINT32_MAX) {
+    fprintf(stderr,"%s: Error: Line %" PRIu32 ": Too many sweep points\n",__func__,lineno);
+    goto cleanup;
+  }
+  ss->values=(double*)realloc(ss->values,(ss->npoints+npoints)*ss->npars*sizeof(double));
+
+  for(pt=0; pt<npoints; ++pt) {
+    row=ss->values+(ss->npoints+pt)*ss->npars;
+
+    for(c=0; c<ss->npars; ++c) row[c]=NAN;
+    rem=pt;
+
+    for(a=nassigns; a>0; --a) {
+      row[cols[a-1]]=vals[a-1][rem%nvals[a-1]];
+      rem/=nvals[a-1];
+    }
+  }
+  ss->npoints+=npoints;
+  ret=0;
+
+cleanup:
+  for(a=0; a<nassigns; ++a) free(vals[a]);
+  free(cols);
+  free(vals);
+  free(nvals);
+  return ret;
+}
+
+int sweep_read(sweep_spec* ss, const char* filename)
+{
+  FILE* f=fopen(filename,"r");
+  char* line=NULL;
+  size_t alloc=0;
+  uint32_t lineno=0;
+
+  ss->pars=NULL;
+  ss->npars=0;
+  ss->values=NULL;
+  ss->npoints=0;
+
+  if(!f) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in read mode\n",__func__,filename);
+    return -1;
+  }
+
+  while(getline(&line,&alloc,f)>=0) {
+
+    if(sweep_add_line(ss,line,++lineno)) {
+      free(line);
+      fclose(f);
+      return -1;
+    }
+  }
+  free(line);
+  fclose(f);
+
+  if(!ss->npoints) {
+    fprintf(stderr,"%s: Error: Sweep file '%s' does not define any point\n",__func__,filename);
+    return -1;
+  }
+  return 0;
+}
+
+void sweep_apply(sweep_spec const* ss, const uint32_t point, model_pars* pars)
+{
+  double const* row=ss->values+(size_t)point*ss->npars;
+  char* ptr;
+  uint32_t c;
+
+  for(c=0; c<ss->npars; ++c) if(!isnan(row[c])) {
+    ptr=(char*)pars+ss->pars[c]->offset;
+
+    if(ss->pars[c]->type==ro_sweep_double) *(double*)ptr=row[c];
+    else if(ss->pars[c]->type==ro_sweep_int32) *(int32_t*)ptr=(int32_t)row[c];
+    else *(uint32_t*)ptr=(uint32_t)row[c];
+  }
+}
+
+double sweep_value(sweep_par const* sp, model_pars const* pars)
+{
+  char const* ptr=(char const*)pars+sp->offset;
+
+  if(sp->type==ro_sweep_double) return *(double const*)ptr;
+  else if(sp->type==ro_sweep_int32) return *(int32_t const*)ptr;
+  return *(uint32_t const*)ptr;
+}
+
+void sweep_free(sweep_spec* ss)
+{
+  free(ss->pars);
+  free(ss->values);
+}
@@ -0,0 +1,97 @@
+/**
+ * @file sweep.h
+ * @brief Parameter sweep specifications.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * A sweep file lists the parameter points of a sweep. Each line contains
+ * space-separated assignments of the form NAME=VALUE[,VALUE...], where NAME
+ * is the name of the option of a numerical simulation parameter. A line
+ * with multiple values for some parameters defines the grid formed by all
+ * their combinations, the values of the last parameter varying the fastest,
+ * such that a line with single values defines a single point. The
+ * parameters that are not assigned by a line keep their value from the
+ * command line. Empty lines and text following '#' are ignored.
+ */
+
+#ifndef _SWEEP_
+#define _SWEEP_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include "model_parameters.h"
+
+/**
+ * Types of swept parameters.
+ */
+enum ro_sweep_type {ro_sweep_double, ro_sweep_int32, ro_sweep_uint32};
+
+/**
+ * Parameter that can be swept.
+ */
+typedef struct {
+  const char* name;	//!< Parameter name, which is the name of its option.
+  size_t offset;	//!< Offset of the parameter in the simulation parameters.
+  uint8_t type;		//!< Parameter type (value set using ro_sweep_type).
+} sweep_par;
+
+/**
+ * Sweep specification.
+ */
+typedef struct {
+  sweep_par const** pars;	//!< Swept parameters, in order of first appearance.
+  uint32_t npars;		//!< Number of swept parameters.
+  double* values;		//!< Value of each swept parameter for each point, or NAN if the point keeps the value from the command line.
+  uint32_t npoints;		//!< Number of points.
+} sweep_spec;
+
+/**
+ * @brief Returns the parameter of a given name that can be swept.
+ *
+ * @param name: Parameter name.
+ * @param len: Length of the name.
+ * @return a pointer to the parameter, or NULL if no parameter of this name
+ * can be swept.
+ */
+sweep_par const* sweep_find_par(const char* name, const size_t len);
+
+/**
+ * @brief Reads a sweep file.
+ *
+ * @param ss: Pointer to the sweep specification.
+ * @param filename: Sweep file name.
+ * @return 0 on success, -1 on an error.
+ */
+int sweep_read(sweep_spec* ss, const char* filename);
+
+/**
+ * @brief Assigns the values of a sweep point to simulation parameters.
+ *
+ * @param ss: Pointer to the sweep specification.
+ * @param point: Index of the point.
+ * @param pars: Simulation parameters.
+ */
+void sweep_apply(sweep_spec const* ss, const uint32_t point, model_pars* pars);
+
+/**
+ * @brief Returns the value of a swept parameter.
+ *
+ * @param sp: Pointer to the swept parameter.
+ * @param pars: Simulation parameters.
+ * @return the value of the parameter.
+ */
+double sweep_value(sweep_par const* sp, model_pars const* pars);
+
+/**
+ * @brief Frees the memory used by a sweep specification.
+ *
+ * @param ss: Pointer to the sweep specification.
+ */
+void sweep_free(sweep_spec* ss);
+
+#endif
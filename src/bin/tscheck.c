@@ -0,0 +1,76 @@
+/**
+ * @file tscheck.c
+ * @brief Self-check of the suspension of the time-ordered simulation.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "tscheck.h"
+
+void ts_check_init(ts_check* chk, const double time, const size_t iidatasize)
+{
+  ts_frontier_init(&chk->fr, iidatasize);
+  chk->buf=NULL;
+  chk->nabuf=0;
+  chk->time=time;
+  chk->serialise=false;
+}
+
+int ts_check_path(sim_vars* sv, ts_check* chk)
+{
+  std_summary_stats* const stats=(std_summary_stats*)sv->dataptr;
+  ts_frontier* const fr=timesim_frontier(sv);
+  rng_stream rngstate;
+  rng_stream endrngstate;
+  size_t size;
+  bool included;
+  bool rincluded;
+
+  do {
+
+    if(timesim_path_start(sv)) return -1;
+    timesim_advance(sv, chk->time);
+
+    if(chk->serialise) {
+      size=ts_frontier_serialised_size(fr);
+
+      if(size>chk->nabuf) {
+	chk->nabuf=size;
+	chk->buf=(char*)realloc(chk->buf,size);
+      }
+      ts_frontier_serialise(fr, chk->buf);
+
+      if(ts_frontier_deserialise(&chk->fr, chk->buf, size)) return -1;
+
+    } else ts_frontier_copy(&chk->fr, fr);
+    chk->serialise=!chk->serialise;
+    std_stats_path_copy(&chk->stats, stats);
+    rngstate=*(rng_stream*)sv->r->state;
+
+    included=timesim_path_end(sv);
+    endrngstate=*(rng_stream*)sv->r->state;
+
+    //The path is completed again from the saved state, which leaves the
+    //random number generator in the same state if the check succeeds
+    *(rng_stream*)sv->r->state=rngstate;
+    sv->brsim.frontier=&chk->fr;
+    sim_set_proc_data(sv, &chk->stats);
+    rincluded=timesim_path_end(sv);
+    sv->brsim.frontier=fr;
+    sim_set_proc_data(sv, stats);
+
+    if(rincluded!=included || memcmp(&endrngstate, sv->r->state, sizeof(rng_stream)) || !std_stats_path_equal(stats, &chk->stats)) {
+      fprintf(stderr,"%s: Error: The path resumed from its state at time %f differs from the uninterrupted path\n",__func__,chk->time);
+      return -1;
+    }
+
+  } while(!included);
+
+  return 0;
+}
+
+void ts_check_free(ts_check* chk)
+{
+  ts_frontier_free(&chk->fr);
+  free(chk->buf);
+  std_stats_free(&chk->stats);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file tscheck.h
+ * @brief Self-check of the suspension of the time-ordered simulation.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * Each path is suspended at the check time, and its frontier, its summary
+ * statistics and the state of the random number generator are saved. The
+ * path is completed, and is then completed again from the saved state. The
+ * frontier is alternately copied using ts_frontier_copy and round-tripped
+ * through ts_frontier_serialise and ts_frontier_deserialise. Both
+ * completions must be identical, in which case the random number generator
+ * ends in the same state and the results of the simulation are not affected
+ * by the check.
+ */
+
+#ifndef _TSCHECK_
+#define _TSCHECK_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <gsl/gsl_rng.h>
+
+#include "rngstream.h"
+#include "timesim.h"
+#include "standard_summary_stats.h"
+
+/**
+ * Suspension self-check state.
+ */
+typedef struct {
+  std_summary_stats stats;	//!< Summary statistics of the resumed path.
+  ts_frontier fr;		//!< Frontier of the resumed path.
+  char* buf;			//!< Serialised frontier.
+  size_t nabuf;			//!< Allocated size of the serialised frontier.
+  double time;			//!< Suspension time.
+  bool serialise;		//!< Whether the frontier of the next path is serialised instead of copied.
+} ts_check;
+
+/**
+ * @brief Initialises the suspension self-check.
+ *
+ * The summary statistics of the check must then be initialised using the
+ * same arguments as the summary statistics of the simulation.
+ *
+ * @param chk: Pointer to the self-check state.
+ * @param time: Suspension time.
+ * @param iidatasize: Size of the user-defined data of each infectious
+ * individual.
+ */
+void ts_check_init(ts_check* chk, const double time, const size_t iidatasize);
+
+/**
+ * @brief Performs the time-ordered simulation of a path and checks its
+ * suspension.
+ *
+ * Replaces timesim for the simulation of a path, whose results are
+ * identical if the check succeeds.
+ *
+ * @param sv: Pointer to the simulation variables.
+ * @param chk: Pointer to the self-check state.
+ * @return 0 if the check succeeds, -1 on an error or if the resumed path
+ * differs.
+ */
+int ts_check_path(sim_vars* sv, ts_check* chk);
+
+/**
+ * @brief Frees the memory used by the suspension self-check, including its
+ * summary statistics.
+ *
+ * @param chk: Pointer to the self-check state.
+ */
+void ts_check_free(ts_check* chk);
+
+#endif
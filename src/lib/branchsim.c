@@ -8,6 +8,22 @@
 
 #include "branchsim.h"
 
+/**
+ * @brief Initialises the parameter-dependent variables and functions of the
+ * branching simulation.
+ *
+ * @param sv: Pointer to the simulation handle.
+ */
+static void branchsim_init_pars(sim_vars* sv)
+{
+  ran_log_init(&sv->rl, (rng_stream*)sv->r->state, sv->pars.p);
+#ifdef DUAL_PINF
+  BR_GENINF_COND(&& (sv->pars.ppip==0 || sv->pars.rpinfp==1));
+#else
+  BR_GENINF_COND();
+#endif
+}
+
 void branchsim_init(sim_vars* sv)
 {
   sv->brsim.layers=(inflayer*)malloc(INIT_N_LAYERS*sizeof(inflayer));
@@ -22,13 +38,13 @@ void branchsim_init(sim_vars* sv)
     sv->ii_alloc_proc_func(&sv->brsim.layers[i].ii);
   }
   sv->brsim.nlayers=INIT_N_LAYERS;
-  ran_log_init(&sv->rl, (rng_stream*)sv->r->state, sv->pars.p);
+  branchsim_init_pars(sv);
+}
 
-#ifdef DUAL_PINF
-  BR_GENINF_COND(&& (sv->pars.ppip==0 || sv->pars.rpinfp==1));
-#else
-  BR_GENINF_COND();
-#endif
+void branchsim_set_pars(sim_vars* sv, model_pars const* pars)
+{
+  sim_set_pars(sv, pars);
+  branchsim_init_pars(sv);
 }
 
 int branchsim(sim_vars* sv)
@@ -103,6 +119,7 @@ int branchsim(sim_vars* sv)
 	if(npevents) { \
 	  sv->new_inf_proc_func(sv, &curlayer->ii, &(curlayer-1)->ii); \
 	  curlayer->ii.ninfections=0; \
+	  curlayer->ii.ntracedicts=0; \
 	  end_latent_per=curlayer->ii.end_comm_period-curlayer->ii.comm_period; \
 	  \
 	  for(e=npevents-1; e>=0; --e) { \
@@ -285,7 +302,7 @@ gen_event:
 
 	} else {
 #ifdef CT_OUTPUT
-	  if(!npevents) sv->new_inf_proc_func_noevent(sv, &curlayer->ii, &brsim->layers[0].ii);
+	  if(!npevents) sv->new_inf_proc_func_noevent(sv, &curlayer->ii, &(curlayer-1)->ii);
 	  else sv->end_inf_proc_func(sv, &curlayer->ii, &(curlayer-1)->ii);
 #else
 	  sv->new_inf_proc_func_noevent(sv, &curlayer->ii, &(curlayer-1)->ii);
@@ -39,6 +39,17 @@ typedef struct inflayer_ {
  */
 void branchsim_init(sim_vars* sv);
 
+/**
+ * @brief Changes the parameters of the branching simulation.
+ *
+ * The simulation must be initialised, and its population size, time type
+ * and path type are unchanged.
+ *
+ * @param sv: Pointer to the simulation handle.
+ * @param pars: Pointer to the new simulation parameters.
+ */
+void branchsim_set_pars(sim_vars* sv, model_pars const* pars);
+
 /**
  * @brief Performs the branching simulation.
  *
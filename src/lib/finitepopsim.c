@@ -14,6 +14,18 @@
 #define INIT_N_LAYERS (16) //!< Initial number of simulation layers
 #define II_ARRAY_GROW_FACT (1.5)  //!< Growing factor for the array of current infectious individuals across all layers.
 
+/**
+ * @brief Initialises the parameter-dependent variables and functions of the
+ * finite population simulation.
+ *
+ * @param sv: Pointer to the simulation handle.
+ */
+static void finitepopsim_init_pars(sim_vars* sv)
+{
+  ran_log_init(&sv->rl, (rng_stream*)sv->r->state, sv->pars.p);
+  FP_GENINF_COND();
+}
+
 void finitepopsim_init(sim_vars* sv)
 {
   memset(&sv->fpsim.rooti, 0, sizeof(individual));
@@ -27,14 +39,18 @@ void finitepopsim_init(sim_vars* sv)
 
   sv->ii_alloc_proc_func(&sv->fpsim.rooti.ii);
   for(int32_t i=sv->pars.popsize-1; i>=0; --i) sv->ii_alloc_proc_func(&sv->fpsim.is[i].ii);
-  ran_log_init(&sv->rl, (rng_stream*)sv->r->state, sv->pars.p);
 
   sv->fpsim.nactivated=0;
   sv->fpsim.activated=malloc(sv->pars.popsize*sizeof(individual*));
   sv->fpsim.neinfectious=0;
   sv->fpsim.einfectious=malloc(sv->pars.popsize*sizeof(individual*));
+  finitepopsim_init_pars(sv);
+}
 
-  FP_GENINF_COND();
+void finitepopsim_set_pars(sim_vars* sv, model_pars const* pars)
+{
+  sim_set_pars(sv, pars);
+  finitepopsim_init_pars(sv);
 }
 
 int finitepopsim(sim_vars* sv)
@@ -26,6 +26,17 @@
  */
 void finitepopsim_init(sim_vars* sv);
 
+/**
+ * @brief Changes the parameters of the finite population simulation.
+ *
+ * The simulation must be initialised, and its population size, time type
+ * and path type are unchanged.
+ *
+ * @param sv: Pointer to the simulation handle.
+ * @param pars: Pointer to the new simulation parameters.
+ */
+void finitepopsim_set_pars(sim_vars* sv, model_pars const* pars);
+
 /**
  * @brief Performs the branching simulation.
  *
@@ -0,0 +1,66 @@
+/**
+ * @file linear_histogram.h
+ * @brief Functions to manipulate fixed-range histograms with bins of equal width.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * A histogram with nbins regular bins over [xmin, xmin+nbins/nbinsperunit)
+ * uses nbins+2 counts. The first count is the underflow bin and the last
+ * count is the overflow bin. Histograms with the same binning are merged
+ * by adding their counts.
+ */
+
+#ifndef _LINEAR_HISTOGRAM_
+#define _LINEAR_HISTOGRAM_
+
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * @brief Returns the bin index for a value.
+ *
+ * @param x: Value.
+ * @param xmin: Lower edge of the first regular bin.
+ * @param nbinsperunit: Number of bins per unit.
+ * @param nbins: Number of regular bins.
+ * @return the bin index, 0 for underflow and nbins+1 for overflow.
+ */
+inline static uint32_t linhist_index(const double x, const double xmin, const int32_t nbinsperunit, const uint32_t nbins)
+{
+  const double pos=(x-xmin)*nbinsperunit;
+
+  if(pos<0) return 0;
+
+  if(pos>=nbins) return nbins+1;
+  return 1+(uint32_t)pos;
+}
+
+/**
+ * @brief Returns the lower edge of a bin.
+ *
+ * @param index: Bin index.
+ * @param xmin: Lower edge of the first regular bin.
+ * @param nbinsperunit: Number of bins per unit.
+ * @return the lower edge of the bin, or -INFINITY for the underflow bin.
+ */
+inline static double linhist_lower(const uint32_t index, const double xmin, const int32_t nbinsperunit)
+{
+  if(index==0) return -INFINITY;
+  return xmin+(index-1)/(double)nbinsperunit;
+}
+
+/**
+ * @brief Returns the upper edge of a bin.
+ *
+ * @param index: Bin index.
+ * @param xmin: Lower edge of the first regular bin.
+ * @param nbinsperunit: Number of bins per unit.
+ * @param nbins: Number of regular bins.
+ * @return the upper edge of the bin, or INFINITY for the overflow bin.
+ */
+inline static double linhist_upper(const uint32_t index, const double xmin, const int32_t nbinsperunit, const uint32_t nbins)
+{
+  if(index>nbins) return INFINITY;
+  return xmin+index/(double)nbinsperunit;
+}
+
+#endif
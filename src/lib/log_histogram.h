@@ -0,0 +1,112 @@
+/**
+ * @file log_histogram.h
+ * @brief Functions to manipulate log-bucketed histograms of unsigned integer values.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * Values smaller than 2^precbits are recorded exactly. Each larger octave
+ * [2^m, 2^(m+1)) is split into 2^(precbits-1) buckets of equal width, such
+ * that the relative error on a value represented by its bucket centre does
+ * not exceed 2^-precbits. The number of buckets is fixed for a given
+ * precision and histograms with the same precision are merged by adding
+ * their counts.
+ */
+
+#ifndef _LOG_HISTOGRAM_
+#define _LOG_HISTOGRAM_
+
+#include <stdint.h>
+#include <math.h>
+
+#define LHIST_DEFAULT_PRECBITS (5) //!< Default number of precision bits for log-bucketed histograms
+#define LHIST_MAX_PRECBITS (16)    //!< Maximum number of precision bits for log-bucketed histograms
+
+/**
+ * @brief Returns the number of buckets of a log-bucketed histogram.
+ *
+ * @param precbits: Number of precision bits (1 to LHIST_MAX_PRECBITS).
+ * @return the number of buckets.
+ */
+inline static uint32_t lhist_nbuckets(const uint32_t precbits){return (34-precbits)<<(precbits-1);}
+
+/**
+ * @brief Returns the bucket index for a value.
+ *
+ * @param value: Value.
+ * @param precbits: Number of precision bits.
+ * @return the bucket index.
+ */
+inline static uint32_t lhist_index(const uint32_t value, const uint32_t precbits)
+{
+  if(value < (UINT32_C(1)<<precbits)) return value;
+  const uint32_t shift=31-__builtin_clz(value)-(precbits-1);
+  return (shift<<(precbits-1))+(value>>shift);
+}
+
+/**
+ * @brief Returns the smallest value of a bucket.
+ *
+ * @param index: Bucket index.
+ * @param precbits: Number of precision bits.
+ * @return the smallest value of the bucket.
+ */
+inline static uint64_t lhist_lower(const uint32_t index, const uint32_t precbits)
+{
+  if(index < (UINT32_C(1)<<precbits)) return index;
+  const uint32_t shift=(index>>(precbits-1))-1;
+  return (uint64_t)(index-(shift<<(precbits-1)))<<shift;
+}
+
+/**
+ * @brief Returns the largest value of a bucket.
+ *
+ * @param index: Bucket index.
+ * @param precbits: Number of precision bits.
+ * @return the largest value of the bucket.
+ */
+inline static uint64_t lhist_upper(const uint32_t index, const uint32_t precbits)
+{
+  if(index < (UINT32_C(1)<<precbits)) return index;
+  const uint32_t shift=(index>>(precbits-1))-1;
+  return ((uint64_t)(index-(shift<<(precbits-1)))<<shift)+(UINT64_C(1)<<shift)-1;
+}
+
+/**
+ * @brief Returns the value at the centre of a bucket.
+ *
+ * @param index: Bucket index.
+ * @param precbits: Number of precision bits.
+ * @return the central value of the bucket.
+ */
+inline static double lhist_value(const uint32_t index, const uint32_t precbits){return 0.5*(lhist_lower(index, precbits)+lhist_upper(index, precbits));}
+
+/**
+ * @brief Computes a quantile from a log-bucketed histogram.
+ *
+ * The nearest-rank definition is used and the central value of the
+ * selected bucket is returned.
+ *
+ * @param counts: Bucket counts.
+ * @param precbits: Number of precision bits.
+ * @param ntot: Sum of the bucket counts.
+ * @param q: Cumulative probability, in the interval [0,1].
+ * @return the quantile value, or NAN if the histogram is empty.
+ */
+inline static double lhist_quantile(uint32_t const* counts, const uint32_t precbits, const uint64_t ntot, const double q)
+{
+  if(!ntot) return NAN;
+  uint64_t target=ceil(q*ntot);
+  uint64_t cum=0;
+  const uint32_t nbuckets=lhist_nbuckets(precbits);
+  uint32_t i;
+
+  if(target<1) target=1;
+
+  for(i=0; i<nbuckets; ++i) {
+    cum+=counts[i];
+
+    if(cum>=target) return lhist_value(i, precbits);
+  }
+  return lhist_value(nbuckets-1, precbits);
+}
+
+#endif
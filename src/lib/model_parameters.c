@@ -7,20 +7,20 @@
 #include <assert.h>
 #include "model_parameters.h"
 
-int model_solve_pars(model_pars* pars)
+int model_solve_pars_verbose(model_pars* pars, const bool verbose)
 {
   if(pars->popsize==0) {
-    printf("Model type:\nBranching process\n");
+    if(verbose) printf("Model type:\nBranching process\n");
 
-    if(model_solve_R0_group(pars)) {
+    if(model_solve_R0_group(pars, verbose)) {
       fprintf(stderr,"%s: Error: Cannot solve parameters for the basic reproduction number\n",__func__);
       return -2;
     }
 
   } else if(isnan(pars->lambdap)) {
-    printf("Model type:\nFinite population\nPopulation:\t%" PRIu32 "\n",pars->popsize);
+    if(verbose) printf("Model type:\nFinite population\nPopulation:\t%" PRIu32 "\n",pars->popsize);
 
-    if(model_solve_R0_group(pars)) {
+    if(model_solve_R0_group(pars, verbose)) {
       fprintf(stderr,"%s: Error: Cannot solve parameters for the basic reproduction number\n",__func__);
       return -3;
     }
@@ -29,7 +29,7 @@ int model_solve_pars(model_pars* pars)
   } else if(!isnan(pars->g_ave)) {
     pars->lambda=pars->g_ave*pars->lambdap/pars->popsize;
 
-    if(model_solve_R0_group(pars)) {
+    if(model_solve_R0_group(pars, verbose)) {
       fprintf(stderr,"%s: Error: Cannot solve parameters for the basic reproduction number\n",__func__);
       return -4;
     }
@@ -39,23 +39,27 @@ int model_solve_pars(model_pars* pars)
     return -5;
   }
   
-  printf("\nBasic reproduction parameters are:\n");
-  printf("lambda:\t\t%22.15e\n",pars->lambda);
-  printf("lambda_uncut:\t%22.15e\n",pars->lambda_uncut);
-  if(pars->popsize>0) printf("lambdap:\t%22.15e\n",pars->lambdap);
-  printf("tbar:\t\t%22.15e\n",pars->tbar);
-  printf("g_ave:\t\t%22.15e\n",pars->g_ave);
-  //printf("mu:\t\t%22.15e\n",pars->mu);
-  //printf("p:\t\t%22.15e\n",pars->p);
-  printf("pinf:\t\t%22.15e\n",pars->pinf);
-  printf("R0:\t\t%22.15e\n",pars->R0);
+  if(verbose) {
+    printf("\nBasic reproduction parameters are:\n");
+    printf("lambda:\t\t%22.15e\n",pars->lambda);
+    printf("lambda_uncut:\t%22.15e\n",pars->lambda_uncut);
+    if(pars->popsize>0) printf("lambdap:\t%22.15e\n",pars->lambdap);
+    printf("tbar:\t\t%22.15e\n",pars->tbar);
+    printf("g_ave:\t\t%22.15e\n",pars->g_ave);
+    //printf("mu:\t\t%22.15e\n",pars->mu);
+    //printf("p:\t\t%22.15e\n",pars->p);
+    printf("pinf:\t\t%22.15e\n",pars->pinf);
+    printf("R0:\t\t%22.15e\n",pars->R0);
+  }
 
 #ifdef DUAL_PINF
-  printf("\nParameters for the second category of probability of infection:\n");
-  printf("ppip:\t\t%22.15e\n",pars->ppip);
-  printf("rpinfp:\t\t%22.15e\n",pars->rpinfp);
-  printf("rpshedp:\t%22.15e\n",pars->rpshedp);
-  printf("qp:\t\t%22.15e\n",pars->qp);
+  if(verbose) {
+    printf("\nParameters for the second category of probability of infection:\n");
+    printf("ppip:\t\t%22.15e\n",pars->ppip);
+    printf("rpinfp:\t\t%22.15e\n",pars->rpinfp);
+    printf("rpshedp:\t%22.15e\n",pars->rpshedp);
+    printf("qp:\t\t%22.15e\n",pars->qp);
+  }
 #endif
 
   if((isnan(pars->kappa)==0) + (isnan(pars->t95)==0) != 1) {
@@ -63,19 +67,21 @@ int model_solve_pars(model_pars* pars)
     return -3;
   }
 
-  if(model_solve_gamma_group(&pars->tbar, &pars->kappa, &pars->t95)) {
+  if(model_solve_gamma_group(&pars->tbar, &pars->kappa, &pars->t95, verbose)) {
     fprintf(stderr,"%s: Error: Cannot solve parameters for the main time gamma distribution\n",__func__);
     return -4;
 
   }
   pars->ta=pars->tbar*pars->kappa;
   pars->tb=1/pars->kappa;
-  printf("\nParameters for the main time gamma distribution:\n");
-  printf("tbar:\t%22.15e\n",pars->tbar);
-  printf("kappa:\t%22.15e\n",pars->kappa);
-  printf("t95:\t%22.15e\n",pars->t95);
-  printf("ta:\t%22.15e\n",pars->ta);
-  printf("tb:\t%22.15e\n",pars->tb);
+  if(verbose) {
+    printf("\nParameters for the main time gamma distribution:\n");
+    printf("tbar:\t%22.15e\n",pars->tbar);
+    printf("kappa:\t%22.15e\n",pars->kappa);
+    printf("t95:\t%22.15e\n",pars->t95);
+    printf("ta:\t%22.15e\n",pars->ta);
+    printf("tb:\t%22.15e\n",pars->tb);
+  }
 
 #ifdef CT_OUTPUT
   if(!(pars->ctwindow>=0)) {
@@ -104,20 +110,22 @@ int model_solve_pars(model_pars* pars)
       return -5;
     }
 
-    if(model_solve_gamma_group(&pars->itbar, &pars->kappait, &pars->it95)) {
+    if(model_solve_gamma_group(&pars->itbar, &pars->kappait, &pars->it95, verbose)) {
       fprintf(stderr,"%s: Error: Cannot solve parameters for the interrupted main time gamma distribution\n",__func__);
       return -6;
 
     } else {
       pars->ita=pars->itbar*pars->kappait;
       pars->itb=1/pars->kappait;
-      printf("\nParameters for the interrupted main time gamma distribution:\n");
-      printf("pit:\t%22.15e\n",pars->pit);
-      printf("itbar:\t%22.15e\n",pars->itbar);
-      printf("kappait:%22.15e\n",pars->kappait);
-      printf("it95:\t%22.15e\n",pars->it95);
-      printf("ita:\t%22.15e\n",pars->ita);
-      printf("itb:\t%22.15e\n",pars->itb);
+      if(verbose) {
+	printf("\nParameters for the interrupted main time gamma distribution:\n");
+	printf("pit:\t%22.15e\n",pars->pit);
+	printf("itbar:\t%22.15e\n",pars->itbar);
+	printf("kappait:%22.15e\n",pars->kappait);
+	printf("it95:\t%22.15e\n",pars->it95);
+	printf("ita:\t%22.15e\n",pars->ita);
+	printf("itb:\t%22.15e\n",pars->itb);
+      }
     }
   }
 
@@ -128,20 +136,22 @@ int model_solve_pars(model_pars* pars)
       return -7;
     }
 
-    if(model_solve_gamma_group(&pars->mbar, &pars->kappaq, &pars->m95)) {
+    if(model_solve_gamma_group(&pars->mbar, &pars->kappaq, &pars->m95, verbose)) {
       fprintf(stderr,"%s: Error: Cannot solve parameters for the alternate time gamma distribution\n",__func__);
       return -8;
 
     } else {
       pars->ma=pars->mbar*pars->kappaq;
       pars->mb=1/pars->kappaq;
-      printf("\nParameters for the alternate time gamma distribution:\n");
-      printf("q:\t%22.15e\n",pars->q);
-      printf("mbar:\t%22.15e\n",pars->mbar);
-      printf("kappaq:\t%22.15e\n",pars->kappaq);
-      printf("m95:\t%22.15e\n",pars->m95);
-      printf("ma:\t%22.15e\n",pars->ma);
-      printf("mb:\t%22.15e\n",pars->mb);
+      if(verbose) {
+	printf("\nParameters for the alternate time gamma distribution:\n");
+	printf("q:\t%22.15e\n",pars->q);
+	printf("mbar:\t%22.15e\n",pars->mbar);
+	printf("kappaq:\t%22.15e\n",pars->kappaq);
+	printf("m95:\t%22.15e\n",pars->m95);
+	printf("ma:\t%22.15e\n",pars->ma);
+	printf("mb:\t%22.15e\n",pars->mb);
+      }
     }
 
     if(isnan(pars->pim)) pars->pim=pars->pit;
@@ -163,13 +173,15 @@ int model_solve_pars(model_pars* pars)
 	pars->ima=pars->ita;
 	pars->imb=pars->itb;
 
-	printf("\nParameters for the interrupted alternate time gamma distribution:\n");
-	printf("pim:\t%22.15e\n",pars->pim);
-	printf("imbar:\t%22.15e\n",pars->imbar);
-	printf("kappaim:%22.15e\n",pars->kappaim);
-	printf("im95:\t%22.15e\n",pars->im95);
-	printf("ima:\t%22.15e\n",pars->ima);
-	printf("imb:\t%22.15e\n",pars->imb);
+	if(verbose) {
+	  printf("\nParameters for the interrupted alternate time gamma distribution:\n");
+	  printf("pim:\t%22.15e\n",pars->pim);
+	  printf("imbar:\t%22.15e\n",pars->imbar);
+	  printf("kappaim:%22.15e\n",pars->kappaim);
+	  printf("im95:\t%22.15e\n",pars->im95);
+	  printf("ima:\t%22.15e\n",pars->ima);
+	  printf("imb:\t%22.15e\n",pars->imb);
+	}
 
       } else {
 
@@ -180,20 +192,22 @@ int model_solve_pars(model_pars* pars)
 	  return -9;
 	}
 
-	if(model_solve_gamma_group(&pars->imbar, &pars->kappaim, &pars->im95)) {
+	if(model_solve_gamma_group(&pars->imbar, &pars->kappaim, &pars->im95, verbose)) {
 	  fprintf(stderr,"%s: Error: Cannot solve parameters for the interrupted alternate time gamma distribution\n",__func__);
 	  return -10;
 
 	} else {
 	  pars->ima=pars->imbar*pars->kappaim;
 	  pars->imb=1/pars->kappaim;
-	  printf("\nParameters for the interrupted alternate time gamma distribution:\n");
-	  printf("pim:\t%22.15e\n",pars->pim);
-	  printf("imbar:\t%22.15e\n",pars->imbar);
-	  printf("kappaim:%22.15e\n",pars->kappaim);
-	  printf("im95:\t%22.15e\n",pars->im95);
-	  printf("ima:\t%22.15e\n",pars->ima);
-	  printf("imb:\t%22.15e\n",pars->imb);
+	  if(verbose) {
+	    printf("\nParameters for the interrupted alternate time gamma distribution:\n");
+	    printf("pim:\t%22.15e\n",pars->pim);
+	    printf("imbar:\t%22.15e\n",pars->imbar);
+	    printf("kappaim:%22.15e\n",pars->kappaim);
+	    printf("im95:\t%22.15e\n",pars->im95);
+	    printf("ima:\t%22.15e\n",pars->ima);
+	    printf("imb:\t%22.15e\n",pars->imb);
+	  }
 	}
       }
     }
@@ -206,33 +220,39 @@ int model_solve_pars(model_pars* pars)
       return -11;
     }
 
-    if(model_solve_gamma_group(&pars->lbar, &pars->kappal, &pars->l95)) {
+    if(model_solve_gamma_group(&pars->lbar, &pars->kappal, &pars->l95, verbose)) {
       fprintf(stderr,"%s: Error: Cannot solve parameters for the latent time gamma distribution\n",__func__);
       return -12;
 
     } else {
       pars->la=pars->lbar*pars->kappal;
       pars->lb=1/pars->kappal;
-      printf("\nParameters for the latent time gamma distribution:\n");
-      printf("lbar:\t%22.15e\n",pars->lbar);
-      printf("kappal:\t%22.15e\n",pars->kappal);
-      printf("l95:\t%22.15e\n",pars->l95);
-      printf("la:\t%22.15e\n",pars->la);
-      printf("lb:\t%22.15e\n",pars->lb);
+      if(verbose) {
+	printf("\nParameters for the latent time gamma distribution:\n");
+	printf("lbar:\t%22.15e\n",pars->lbar);
+	printf("kappal:\t%22.15e\n",pars->kappal);
+	printf("l95:\t%22.15e\n",pars->l95);
+	printf("la:\t%22.15e\n",pars->la);
+	printf("lb:\t%22.15e\n",pars->lb);
+      }
     }
   }
 
-  printf("\nBranching process effective reproduction number:\n");
+  if(verbose) {
+    printf("\nBranching process effective reproduction number:\n");
 #ifdef DUAL_PINF
-  printf("brReff:\t%22.15e\n",pars->R0*(pars->ppip>0?(1-pars->ppip)*(1+(isnan(pars->q)?0:pars->q*(pars->mbar/pars->tbar-1))) + pars->rpshedp*pars->ppip*pars->rpinfp*(1+(isnan(pars->qp)?0:pars->qp*(pars->mbar/pars->tbar-1))):(1+(isnan(pars->q)?0:pars->q*(pars->mbar/pars->tbar-1)))));
+    printf("brReff:\t%22.15e\n",pars->R0*(pars->ppip>0?(1-pars->ppip)*(1+(isnan(pars->q)?0:pars->q*(pars->mbar/pars->tbar-1))) + pars->rpshedp*pars->ppip*pars->rpinfp*(1+(isnan(pars->qp)?0:pars->qp*(pars->mbar/pars->tbar-1))):(1+(isnan(pars->q)?0:pars->q*(pars->mbar/pars->tbar-1)))));
 #else
-  printf("brReff:\t%22.15e\n",pars->R0*(1+(isnan(pars->q)?0:pars->q*(pars->mbar/pars->tbar-1))));
+    printf("brReff:\t%22.15e\n",pars->R0*(1+(isnan(pars->q)?0:pars->q*(pars->mbar/pars->tbar-1))));
 #endif
+  }
 
   return 0;
 }
 
-int model_solve_R0_group(model_pars* pars)
+int model_solve_pars(model_pars* pars){return model_solve_pars_verbose(pars, true);}
+
+int model_solve_R0_group(model_pars* pars, const bool verbose)
 {
   int ret;
 
@@ -302,14 +322,14 @@ int model_solve_R0_group(model_pars* pars)
   if(!isnan(pars->g_ave) || !isnan(pars->p) || !isnan(pars->mu)) {
     ret=0;
 
-    if(pars->grouptype&ro_group_log_plus_1) ret=model_solve_log_plus_1_group(pars);
+    if(pars->grouptype&ro_group_log_plus_1) ret=model_solve_log_plus_1_group(pars, verbose);
 
-    else if(pars->grouptype&ro_group_log) ret=model_solve_log_group(pars);
+    else if(pars->grouptype&ro_group_log) ret=model_solve_log_group(pars, verbose);
 
-    else if(pars->grouptype&ro_group_geom) ret=model_solve_geom_group(pars);
+    else if(pars->grouptype&ro_group_geom) ret=model_solve_geom_group(pars, verbose);
 
     //ro_group_gauss
-    else ret=model_solve_gauss_group(pars);
+    else ret=model_solve_gauss_group(pars, verbose);
 
     if(ret) return ret;
 
@@ -368,14 +388,14 @@ int model_solve_R0_group(model_pars* pars)
 
     } else pars->g_ave_transm=pars->g_ave=pars->R0/(pars->lambda*pars->tbar*pars->pinf)+1;
 
-    if(pars->grouptype&ro_group_log_plus_1) ret=model_solve_log_plus_1_group(pars);
+    if(pars->grouptype&ro_group_log_plus_1) ret=model_solve_log_plus_1_group(pars, verbose);
 
-    else if(pars->grouptype&ro_group_log) ret=model_solve_log_group(pars);
+    else if(pars->grouptype&ro_group_log) ret=model_solve_log_group(pars, verbose);
 
-    else if(pars->grouptype&ro_group_geom) ret=model_solve_geom_group(pars);
+    else if(pars->grouptype&ro_group_geom) ret=model_solve_geom_group(pars, verbose);
 
     //ro_group_gauss
-    else ret=model_solve_gauss_group(pars);
+    else ret=model_solve_gauss_group(pars, verbose);
 
     if(ret) return ret;
 
@@ -388,7 +408,7 @@ int model_solve_R0_group(model_pars* pars)
   return 0;
 }
 
-int model_solve_log_plus_1_group(model_pars* pars)
+int model_solve_log_plus_1_group(model_pars* pars, const bool verbose)
 {
   int ret;
 
@@ -501,15 +521,17 @@ int model_solve_log_plus_1_group(model_pars* pars)
       }
     }
   }
-  printf("\nParameters for the log+1 group distribution:\n");
-  printf("g_ave:\t%22.15e\n",pars->g_ave);
-  printf("g_ave_transm:\t%22.15e\n",pars->g_ave_transm);
-  printf("p:\t%22.15e\n",pars->p);
-  printf("mu:\t%22.15e\n",pars->mu);
+  if(verbose) {
+    printf("\nParameters for the log+1 group distribution:\n");
+    printf("g_ave:\t%22.15e\n",pars->g_ave);
+    printf("g_ave_transm:\t%22.15e\n",pars->g_ave_transm);
+    printf("p:\t%22.15e\n",pars->p);
+    printf("mu:\t%22.15e\n",pars->mu);
+  }
   return 0;
 }
 
-int model_solve_log_group(model_pars* pars)
+int model_solve_log_group(model_pars* pars, const bool verbose)
 {
   int ret;
 
@@ -596,15 +618,17 @@ int model_solve_log_group(model_pars* pars)
       }
     }
   }
-  printf("\nParameters for the log group distribution:\n");
-  printf("g_ave:\t%22.15e\n",pars->g_ave);
-  printf("g_ave_transm:\t%22.15e\n",pars->g_ave_transm);
-  printf("p:\t%22.15e\n",pars->p);
-  printf("mu:\t%22.15e\n",pars->mu);
+  if(verbose) {
+    printf("\nParameters for the log group distribution:\n");
+    printf("g_ave:\t%22.15e\n",pars->g_ave);
+    printf("g_ave_transm:\t%22.15e\n",pars->g_ave_transm);
+    printf("p:\t%22.15e\n",pars->p);
+    printf("mu:\t%22.15e\n",pars->mu);
+  }
   return 0;
 }
 
-int model_solve_geom_group(model_pars* pars)
+int model_solve_geom_group(model_pars* pars, const bool verbose)
 {
   //If g_ave is provided
   if(!isnan(pars->g_ave)) {
@@ -649,15 +673,17 @@ int model_solve_geom_group(model_pars* pars)
     pars->g_ave=(2 - pars->p) / (1 - pars->p);
     pars->g_ave_transm=pars->g_ave;
   }
-  printf("\nParameters for the log group distribution:\n");
-  printf("g_ave:\t%22.15e\n",pars->g_ave);
-  printf("g_ave_transm:\t%22.15e\n",pars->g_ave_transm);
-  printf("p:\t%22.15e\n",pars->p);
-  printf("mu:\t%22.15e\n",pars->mu);
+  if(verbose) {
+    printf("\nParameters for the log group distribution:\n");
+    printf("g_ave:\t%22.15e\n",pars->g_ave);
+    printf("g_ave_transm:\t%22.15e\n",pars->g_ave_transm);
+    printf("p:\t%22.15e\n",pars->p);
+    printf("mu:\t%22.15e\n",pars->mu);
+  }
   return 0;
 }
 
-int model_solve_gauss_group(model_pars* pars)
+int model_solve_gauss_group(model_pars* pars, const bool verbose)
 {
 
   if(pars->popsize!=0) {
@@ -747,11 +773,13 @@ int model_solve_gauss_group(model_pars* pars)
 
     pars->g_ave=gauss_trunc_g_ave(pars->mu,pars->sigma);
   }
-  printf("\nParameters for the Gaussian group distribution:\n");
-  printf("g_ave:\t%22.15e\n",pars->g_ave);
-  printf("mu:\t%22.15e\n",pars->mu);
-  printf("sigma:\t%22.15e\n",pars->sigma);
-  printf("rsigma:\t%22.15e\n",pars->rsigma);
+  if(verbose) {
+    printf("\nParameters for the Gaussian group distribution:\n");
+    printf("g_ave:\t%22.15e\n",pars->g_ave);
+    printf("mu:\t%22.15e\n",pars->mu);
+    printf("sigma:\t%22.15e\n",pars->sigma);
+    printf("rsigma:\t%22.15e\n",pars->rsigma);
+  }
   return 0;
 }
 
@@ -838,7 +866,7 @@ int model_solve_log_p_plus_1_from_transm_mean(model_pars* pars)
   return 0;
 }
 
-int model_solve_gamma_group(double* ave, double* kappa, double* x95)
+int model_solve_gamma_group(double* ave, double* kappa, double* x95, const bool verbose)
 {
   if(!(*ave>=0)) {
     fprintf(stderr,"%s: Error: The average of the distribution must be non-negative.\n",__func__);
@@ -851,7 +879,7 @@ int model_solve_gamma_group(double* ave, double* kappa, double* x95)
       fprintf(stderr,"%s: Error: The kappa parameter of the distribution must have a positive value.\n",__func__);
       return -1;
 
-    } else if(!(*kappa>1/ *ave)) fprintf(stderr,"%s: Warning: The selected kappa value will generate a monotonically decreasing distribution!.\n",__func__);
+    } else if(verbose && !(*kappa>1/ *ave)) fprintf(stderr,"%s: Warning: The selected kappa value will generate a monotonically decreasing distribution!.\n",__func__);
 
     if(*kappa != INFINITY) {
       double pars[2]={*ave * *kappa, *kappa};
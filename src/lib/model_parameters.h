@@ -30,7 +30,7 @@ enum ro_pricommper_model_flags {ro_pricommper_main=1, ro_pricommper_alt=2, ro_pr
 /**
  * Time model type.
  **/
-enum ro_time_model{ro_time_pri_created=1, ro_time_pri_flat_comm=2, ro_time_pri_infectious=3, ro_time_pri_end_comm=4, ro_time_pri_test_results=5, ro_time_first_pos_test_results=6};
+enum ro_time_model{ro_time_pri_created=1, ro_time_pri_flat_comm=2, ro_time_pri_infectious=3, ro_time_pri_end_comm=4, ro_time_pri_test_results=5, ro_time_first_pos_test_results=6, ro_time_snapshot=7};
 
 /**
  * Group model type. Flags used to specify the model. ro_log_group_attendees_plus_1,
@@ -126,6 +126,17 @@ typedef struct
  */
 int model_solve_pars(model_pars* pars);
 
+/**
+ * @brief Solve for all simulation parameters, optionally without printing
+ * them.
+ *
+ * @param pars: Simulation parameters.
+ * @param verbose: Print the solved parameters, as model_solve_pars does.
+ * @return 0 if the parameters could be determined, and a non-zero value
+ * otherwise.
+ */
+int model_solve_pars_verbose(model_pars* pars, const bool verbose);
+
 /**
  * @brief Solve for the R0-related simulation parameters.
  *
@@ -133,50 +144,55 @@ int model_solve_pars(model_pars* pars);
  * that have not been provided as an input.
  *
  * @param pars: Simulation parameters.
+ * @param verbose: Print the solved parameters.
  * @return 0 if the parameters could be determined, and a non-zero value
  * otherwise.
  */
-int model_solve_R0_group(model_pars* pars);
+int model_solve_R0_group(model_pars* pars, const bool verbose);
 
 /**
  * @brief Solve for the value of the p, mu and g_ave parameters of the
  * logarithmic plus 1 distribution, given one of the parameters.
  *
  * @param pars: Simulation parameters.
+ * @param verbose: Print the solved parameters.
  * @return 0 if the parameters could be determined, and a non-zero value
  * otherwise.
  */
-int model_solve_log_plus_1_group(model_pars* pars);
+int model_solve_log_plus_1_group(model_pars* pars, const bool verbose);
 
 /**
  * @brief Solve for the value of the p, mu and g_ave parameters of the
  * logarithmic distribution, given one of the parameters.
  *
  * @param pars: Simulation parameters.
+ * @param verbose: Print the solved parameters.
  * @return 0 if the parameters could be determined, and a non-zero value
  * otherwise.
  */
-int model_solve_log_group(model_pars* pars);
+int model_solve_log_group(model_pars* pars, const bool verbose);
 
 /**
  * @brief Solve for the value of the p, mu and g_ave parameters of the
  * geometric distribution, given one of the parameters.
  *
  * @param pars: Simulation parameters.
+ * @param verbose: Print the solved parameters.
  * @return 0 if the parameters could be determined, and a non-zero value
  * otherwise.
  */
-int model_solve_geom_group(model_pars* pars);
+int model_solve_geom_group(model_pars* pars, const bool verbose);
 
 /**
  * @brief Solve for the value of the mu, sigma and g_ave parameters of the
  * Gaussian distribution, given two of the parameters.
  *
  * @param pars: Simulation parameters.
+ * @param verbose: Print the solved parameters.
  * @return 0 if the parameters could be determined, and a non-zero value
  * otherwise.
  */
-int model_solve_gauss_group(model_pars* pars);
+int model_solve_gauss_group(model_pars* pars, const bool verbose);
 
 /**
  * @brief Solve for the value of lambda uncut, given lambda, for the log
@@ -308,10 +324,12 @@ int model_solve_log_p_plus_1_from_transm_mean(model_pars* pars);
  * @param ave: Gamma distribution average parameter.
  * @param kappa: Gamma distribution kappa parameter.
  * @param x95: Gamma distribution 95th percentile parameter.
+ * @param verbose: Print a warning for monotonically decreasing
+ * distributions.
  * @return 0 if the parameters could be determined, and a non-zero value
  * otherwise.
  */
-int model_solve_gamma_group(double* ave, double* kappa, double* x95);
+int model_solve_gamma_group(double* ave, double* kappa, double* x95, const bool verbose);
 
 /**
  * @brief Verifies the validity of the model parameters.
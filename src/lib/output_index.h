@@ -0,0 +1,224 @@
+/**
+ * @file output_index.h
+ * @brief Functions to write and read the path index files of timeline,
+ * contact tracing and transmission tree outputs.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * An index is a sidecar file, named after the output file followed by
+ * ".idx", that contains one entry per path record of the output file,
+ * sorted by offset. The file starts with the 8 byte magic "ROSINDEX",
+ * followed by an unsigned 32 bit version and an unsigned 32 bit output kind
+ * (0 for tlout, 1 for ctout, 2 for treeout). Each entry contains, in little
+ * endian, the unsigned 64 bit byte offset of the record in the output file,
+ * the unsigned 64 bit path index, the unsigned 32 bit record size in bytes,
+ * the unsigned 32 bit number of time bins (tlout), of entries (ctout) or of
+ * nodes (treeout) in the record and unsigned 32 bit flags.
+ */
+
+#ifndef _OUTPUT_INDEX_
+#define _OUTPUT_INDEX_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <endian.h>
+
+#define OIDX_MAGIC "ROSINDEX"		//!< Index file magic
+#define OIDX_VERSION (1)		//!< Index file format version
+#define OIDX_HEADER_SIZE (16)		//!< Size of the index file header
+#define OIDX_ENTRY_SIZE (28)		//!< Size of an index entry
+
+#define OIDX_KIND_TLOUT (0)		//!< Index of a timeline output file
+#define OIDX_KIND_CTOUT (1)		//!< Index of a contact tracing output file
+#define OIDX_KIND_TREEOUT (2)		//!< Index of a transmission tree output file
+
+#define OIDX_FLAG_EXTINCT (1)		//!< Entry flag for paths that go extinct
+#define OIDX_FLAG_MAXEDOUT (2)		//!< Entry flag for paths that max out an nimax or npostestmax limit
+
+/**
+ * Index entry.
+ */
+typedef struct {
+  uint64_t offset;	//!< Byte offset of the record.
+  uint64_t path;	//!< Path index.
+  uint32_t size;	//!< Record size in bytes.
+  uint32_t count;	//!< Number of time bins, of entries or of nodes in the record.
+  uint32_t flags;	//!< Entry flags.
+} oidx_entry;
+
+/**
+ * Index writer for the records of an output memory buffer.
+ */
+typedef struct {
+  int fd;		//!< Index file descriptor, or -1 if the output is not indexed.
+  oidx_entry* entries;	//!< Entries of the records of the current buffer, with offsets relative to the buffer.
+  uint32_t nentries;	//!< Number of entries.
+  uint32_t size;	//!< Allocated number of entries.
+  uint8_t* ebuf;	//!< Serialisation buffer.
+  uint64_t offset;	//!< File offset of the current buffer, for outputs written without an asynchronous writer.
+  uint64_t nrecs;	//!< Number of records before the current buffer, for outputs written without an asynchronous writer.
+} oidx_writer;
+
+/**
+ * @brief Writes the header of an index file.
+ *
+ * @param fd: Index file descriptor.
+ * @param kind: Output kind.
+ * @return 0 on success, -1 on a write error.
+ */
+inline static int oidx_write_header(const int fd, const uint32_t kind)
+{
+  uint8_t header[OIDX_HEADER_SIZE];
+
+  memcpy(header,OIDX_MAGIC,8);
+  *(uint32_t*)(header+8)=htole32(OIDX_VERSION);
+  *(uint32_t*)(header+12)=htole32(kind);
+
+  if(write(fd,header,OIDX_HEADER_SIZE)!=OIDX_HEADER_SIZE) {
+    perror(__func__);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Initialises an index writer.
+ *
+ * @param ow: Pointer to the index writer.
+ * @param fd: Index file descriptor, or -1 if the output is not indexed.
+ * @param offset: File offset of the first record of the output file.
+ */
+inline static void oidx_writer_init(oidx_writer* ow, const int fd, const uint64_t offset)
+{
+  ow->fd=fd;
+  ow->entries=NULL;
+  ow->nentries=0;
+  ow->size=0;
+  ow->ebuf=NULL;
+  ow->offset=offset;
+  ow->nrecs=0;
+}
+
+/**
+ * @brief Frees the memory used by an index writer.
+ *
+ * The index file descriptor is not closed.
+ *
+ * @param ow: Pointer to the index writer.
+ */
+inline static void oidx_writer_free(oidx_writer* ow)
+{
+  free(ow->entries);
+  free(ow->ebuf);
+  ow->entries=NULL;
+  ow->ebuf=NULL;
+  ow->size=0;
+}
+
+/**
+ * @brief Adds the entry of a record of the current buffer.
+ *
+ * @param ow: Pointer to the index writer.
+ * @param offset: Byte offset of the record in the buffer.
+ * @param path: Path index.
+ * @param size: Record size in bytes.
+ * @param count: Number of time bins or of entries in the record.
+ * @param flags: Entry flags.
+ */
+inline static void oidx_add(oidx_writer* ow, const uint64_t offset, const uint64_t path, const uint32_t size, const uint32_t count, const uint32_t flags)
+{
+  if(ow->nentries==ow->size) {
+    ow->size=(ow->size?2*ow->size:1024);
+    ow->entries=(oidx_entry*)realloc(ow->entries,ow->size*sizeof(oidx_entry));
+  }
+  oidx_entry* const e=ow->entries+ow->nentries++;
+  e->offset=offset;
+  e->path=path;
+  e->size=size;
+  e->count=count;
+  e->flags=flags;
+}
+
+/**
+ * @brief Serialises an index entry.
+ *
+ * @param buf: Output memory buffer of size OIDX_ENTRY_SIZE.
+ * @param e: Index entry.
+ */
+inline static void oidx_put_entry(uint8_t* buf, oidx_entry const* e)
+{
+  *(uint64_t*)buf=htole64(e->offset);
+  *(uint64_t*)(buf+8)=htole64(e->path);
+  *(uint32_t*)(buf+16)=htole32(e->size);
+  *(uint32_t*)(buf+20)=htole32(e->count);
+  *(uint32_t*)(buf+24)=htole32(e->flags);
+}
+
+/**
+ * @brief Reads a serialised index entry.
+ *
+ * @param buf: Input memory buffer of size OIDX_ENTRY_SIZE.
+ * @param e: Index entry.
+ */
+inline static void oidx_get_entry(uint8_t const* buf, oidx_entry* e)
+{
+  e->offset=le64toh(*(uint64_t const*)buf);
+  e->path=le64toh(*(uint64_t const*)(buf+8));
+  e->size=le32toh(*(uint32_t const*)(buf+16));
+  e->count=le32toh(*(uint32_t const*)(buf+20));
+  e->flags=le32toh(*(uint32_t const*)(buf+24));
+}
+
+/**
+ * @brief Writes the entries of the current buffer to the index file and
+ * clears them.
+ *
+ * The entries are written at their final position in the index file, such
+ * that buffers from different threads can be indexed concurrently.
+ *
+ * @param ow: Pointer to the index writer.
+ * @param offset: File offset of the current buffer.
+ * @param nrecs: Number of records before the current buffer in the output
+ * file.
+ * @return 0 on success, -1 on a write error.
+ */
+inline static int oidx_flush(oidx_writer* ow, const uint64_t offset, const uint64_t nrecs)
+{
+  if(ow->fd<0 || !ow->nentries) {
+    ow->nentries=0;
+    return 0;
+  }
+  const size_t nbytes=(size_t)ow->nentries*OIDX_ENTRY_SIZE;
+  uint32_t i;
+
+  ow->ebuf=(uint8_t*)realloc(ow->ebuf,ow->size*OIDX_ENTRY_SIZE);
+
+  for(i=0; i<ow->nentries; ++i) {
+    ow->entries[i].offset+=offset;
+    oidx_put_entry(ow->ebuf+i*OIDX_ENTRY_SIZE,ow->entries+i);
+  }
+  ow->nentries=0;
+
+  if(pwrite(ow->fd,ow->ebuf,nbytes,OIDX_HEADER_SIZE+nrecs*OIDX_ENTRY_SIZE)!=(ssize_t)nbytes) {
+    perror(__func__);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Returns the index file name of an output file.
+ *
+ * @param filename: Output file name.
+ * @return the allocated index file name.
+ */
+inline static char* oidx_filename(const char* filename)
+{
+  char* ret=(char*)malloc(strlen(filename)+5);
+  sprintf(ret,"%s.idx",filename);
+  return ret;
+}
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ * @file output_manifest.h
+ * @brief Functions to write and read manifests of sharded output files.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * A sharded output is made of independent shard files, each of them being a
+ * complete output file in the regular format, and of a text manifest that
+ * lists them. The manifest starts with the line
+ * "randoutbreaksim manifest 1", followed by the lines "format FORMAT",
+ * "header NPERS FLAGS" (only for outputs that have a file header, where NPERS
+ * and FLAGS are the values of the binary header of each shard), "nshards N",
+ * and then one line "NPATHS FILENAME" per shard, where NPATHS is the number of
+ * paths in the shard. Shard file names are relative to the directory of the
+ * manifest.
+ */
+
+#ifndef _OUTPUT_MANIFEST_
+#define _OUTPUT_MANIFEST_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define MANIFEST_MAGIC "randoutbreaksim manifest 1"
+
+/**
+ * Content of a manifest.
+ */
+typedef struct {
+  char format[16];	//!< Output format name.
+  bool hasheader;	//!< Whether the shards start with a file header.
+  uint32_t npers;	//!< Number of bins per unit of time stored in the header.
+  uint32_t flags;	//!< Flags byte stored in the header.
+  uint32_t nshards;	//!< Number of shards.
+  uint64_t* npaths;	//!< Number of paths in each shard.
+  char** files;		//!< Path of each shard file, including the directory of the manifest.
+} output_manifest;
+
+/**
+ * @brief Writes a manifest.
+ *
+ * @param fd: Manifest file descriptor.
+ * @param format: Output format name.
+ * @param hasheader: Whether the shards start with a file header.
+ * @param npers: Number of bins per unit of time stored in the header.
+ * @param flags: Flags byte stored in the header.
+ * @param nshards: Number of shards.
+ * @param files: Shard file names, relative to the directory of the manifest.
+ * @param npaths: Number of paths in each shard.
+ * @return 0 on success, -1 on a write error.
+ */
+inline static int manifest_write(const int fd, const char* format, const bool hasheader, const uint32_t npers, const uint32_t flags, const uint32_t nshards, char const* const* files, uint64_t const* npaths)
+{
+  uint32_t s;
+
+  if(dprintf(fd,"%s\nformat %s\n",MANIFEST_MAGIC,format)<0) return -1;
+
+  if(hasheader && dprintf(fd,"header %" PRIu32 " %" PRIu32 "\n",npers,flags)<0) return -1;
+
+  if(dprintf(fd,"nshards %" PRIu32 "\n",nshards)<0) return -1;
+
+  for(s=0; s<nshards; ++s) if(dprintf(fd,"%" PRIu64 " %s\n",npaths[s],files[s])<0) return -1;
+  return 0;
+}
+
+/**
+ * @brief Verifies if a file is a manifest.
+ *
+ * @param filename: File name.
+ * @return true if the file starts with the manifest magic line.
+ */
+inline static bool is_manifest(const char* filename)
+{
+  FILE* f=fopen(filename,"rb");
+  char buf[sizeof(MANIFEST_MAGIC)]={0};
+
+  if(!f) return false;
+  const bool ret=(fread(buf,1,sizeof(MANIFEST_MAGIC)-1,f)==sizeof(MANIFEST_MAGIC)-1 && !strcmp(buf,MANIFEST_MAGIC));
+  fclose(f);
+  return ret;
+}
+
+/**
+ * @brief Frees the memory used by the content of a manifest.
+ *
+ * @param om: Pointer to the manifest content.
+ */
+inline static void manifest_free(output_manifest* om)
+{
+  uint32_t s;
+
+  for(s=0; s<om->nshards; ++s) free(om->files[s]);
+  free(om->files);
+  free(om->npaths);
+  om->files=NULL;
+  om->npaths=NULL;
+  om->nshards=0;
+}
+
+/**
+ * @brief Reads a manifest.
+ *
+ * @param filename: Manifest file name.
+ * @param om: Pointer to the manifest content.
+ * @return 0 on success, -1 if the file cannot be read or is not a valid
+ * manifest.
+ */
+inline static int manifest_read(const char* filename, output_manifest* om)
+{
+  FILE* f=fopen(filename,"r");
+  char line[4096];
+  const char* slash=strrchr(filename,'/');
+  const size_t dirlen=(slash?slash-filename+1:0);
+  uint32_t s;
+
+  om->nshards=0;
+  om->files=NULL;
+  om->npaths=NULL;
+  om->hasheader=false;
+
+  if(!f) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in read mode\n",__func__,filename);
+    return -1;
+  }
+
+  if(!fgets(line,sizeof(line),f) || strncmp(line,MANIFEST_MAGIC,sizeof(MANIFEST_MAGIC)-1) || fscanf(f," format %15s",om->format)!=1) goto manifest_read_error;
+
+  if(fscanf(f," header %" SCNu32 " %" SCNu32,&om->npers,&om->flags)==2) om->hasheader=true;
+
+  if(fscanf(f," nshards %" SCNu32,&om->nshards)!=1) goto manifest_read_error;
+  om->files=(char**)calloc(om->nshards,sizeof(char*));
+  om->npaths=(uint64_t*)malloc(om->nshards*sizeof(uint64_t));
+
+  for(s=0; s<om->nshards; ++s) {
+
+    if(fscanf(f," %" SCNu64 " ",om->npaths+s)!=1 || !fgets(line,sizeof(line),f)) goto manifest_read_error;
+    line[strcspn(line,"\n")]=0;
+    om->files[s]=(char*)malloc(dirlen+strlen(line)+1);
+    memcpy(om->files[s],filename,dirlen);
+    strcpy(om->files[s]+dirlen,line);
+  }
+  fclose(f);
+  return 0;
+
+manifest_read_error:
+  fprintf(stderr,"%s: Error: File '%s' is not a valid manifest\n",__func__,filename);
+  fclose(f);
+  manifest_free(om);
+  return -1;
+}
+
+#endif
@@ -70,8 +70,23 @@ void sim_pars_init(model_pars* pars)
 
 void sim_init(sim_vars* sv, model_pars const* pars, const gsl_rng* r)
 {
-  sv->pars=*pars;
   sv->r=r;
+  sim_set_pars(sv, pars);
+
+  sv->dataptr=NULL;
+  sv->path_init_proc_func=dummy_proc_func_sv;
+  sv->path_end_proc_func=dummy_proc_bool_func_sv;
+  sv->pri_init_proc_func=dummy_proc_func_sv_ii2;
+  sv->ii_alloc_proc_func=default_ii_alloc_proc_func;
+  sv->new_event_proc_func=default_event_proc_func;
+  sv->new_inf_proc_func=dummy_proc_func_sv_ii2;
+  sv->new_inf_proc_func_noevent=dummy_proc_func_sv_ii2;
+  sv->end_inf_proc_func=dummy_proc_func_sv_ii2;
+}
+
+void sim_set_pars(sim_vars* sv, model_pars const* pars)
+{
+  sv->pars=*pars;
 
   if(pars->pinfpri==1) sv->gen_n_pri_inf=gen_n_pri_inf_nstart;
   else sv->gen_n_pri_inf=gen_n_pri_inf_binom_pinfpri_nstart;
@@ -79,6 +94,7 @@ void sim_init(sim_vars* sv, model_pars const* pars, const gsl_rng* r)
   switch(pars->timetype) {
     case ro_time_pri_created:
     case ro_time_first_pos_test_results:
+    case ro_time_snapshot:
       sv->gen_time_origin_func=gen_time_origin_pri_created;
       break;
 
@@ -100,14 +116,4 @@ void sim_init(sim_vars* sv, model_pars const* pars, const gsl_rng* r)
   }
 
   PER_COND;
-
-  sv->dataptr=NULL;
-  sv->path_init_proc_func=dummy_proc_func_sv;
-  sv->path_end_proc_func=dummy_proc_bool_func_sv;
-  sv->pri_init_proc_func=dummy_proc_func_sv_ii2;
-  sv->ii_alloc_proc_func=default_ii_alloc_proc_func;
-  sv->new_event_proc_func=default_event_proc_func;
-  sv->new_inf_proc_func=dummy_proc_func_sv_ii2;
-  sv->new_inf_proc_func_noevent=dummy_proc_func_sv_ii2;
-  sv->end_inf_proc_func=dummy_proc_func_sv_ii2;
 }
@@ -25,12 +25,17 @@ extern int __ro_debug;
 //#define DEBUG_PRINTF(...) {if(__ro_debug) printf(__VA_ARGS__);} //!< Debug print function
 
 struct inflayer_;
+struct ts_frontier_;
+struct ts_seed_;
 
 typedef struct {
   struct inflayer_* layers;	//!< Array of current infectious individuals across all layers
   uint32_t nlayers;	//!< Current maximum number of layers that has been used so far 
   uint32_t naevents;    //!< Number of allocated events for each layer
   void (*gen_att_inf_func)(struct sim_vars_*, infindividual* ii);              	        //!< Pointer to the function used to generate attendees and new infections during one event
+  struct ts_frontier_* frontier;	//!< Frontier of the current path for the time-ordered simulation
+  struct ts_seed_ const* seeds;	//!< Snapshot of current infections the paths of the time-ordered simulation start from, or NULL
+  uint32_t nseeds;	//!< Number of individuals in the snapshot of current infections
 } brsim_vars;
 
 typedef struct {
@@ -94,6 +99,21 @@ void sim_pars_init(model_pars* pars);
  */
 void sim_init(sim_vars* sv, model_pars const* pars, const gsl_rng* r);
 
+/**
+ * @brief Sets the simulation parameters.
+ *
+ * This function selects the functions that generate the time periods and
+ * the number of primary infectious individuals for the new parameters. It
+ * is called by sim_init, and the model-specific functions
+ * branchsim_set_pars and finitepopsim_set_pars must be used to change the
+ * parameters of an initialised simulation. The time and path types must be
+ * unchanged.
+ *
+ * @param sv: Pointer to the simulation handle.
+ * @param pars: Pointer to the simulation parameters
+ */
+void sim_set_pars(sim_vars* sv, model_pars const* pars);
+
 /**
  * @brief Initialises the simulation-level data pointer for user-defined functions.
  *
@@ -6,7 +6,54 @@
 
 #include "standard_summary_stats.h"
 
-void std_stats_init(sim_vars* sv, const uint32_t nbinsperunit, bool ngeninfs)
+GEN_STD_STATS_FUNCS(0,0,0,0)
+GEN_STD_STATS_FUNCS(0,0,0,1)
+GEN_STD_STATS_FUNCS(0,0,1,0)
+GEN_STD_STATS_FUNCS(0,0,1,1)
+GEN_STD_STATS_FUNCS(0,1,0,0)
+GEN_STD_STATS_FUNCS(0,1,0,1)
+GEN_STD_STATS_FUNCS(0,1,1,0)
+GEN_STD_STATS_FUNCS(0,1,1,1)
+GEN_STD_STATS_FUNCS(1,0,0,0)
+GEN_STD_STATS_FUNCS(1,0,0,1)
+GEN_STD_STATS_FUNCS(1,0,1,0)
+GEN_STD_STATS_FUNCS(1,0,1,1)
+GEN_STD_STATS_FUNCS(1,1,0,0)
+GEN_STD_STATS_FUNCS(1,1,0,1)
+GEN_STD_STATS_FUNCS(1,1,1,0)
+GEN_STD_STATS_FUNCS(1,1,1,1)
+
+/*
+ * The preprocessing macros below are used by the main STD_STATS_COND macro.
+ */
+#define STD_STATS_FUNC(NAME,INF,NEWINF,POSTEST,EXT) NAME ## _ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT
+#define STD_STATS_SET_FUNCS(INF,NEWINF,POSTEST,EXT) \
+  sim_set_path_init_proc_func(sv, STD_STATS_FUNC(std_stats_path_init,INF,NEWINF,POSTEST,EXT)); \
+  sim_set_path_end_proc_func(sv, STD_STATS_FUNC(std_stats_path_end,INF,NEWINF,POSTEST,EXT)); \
+  if(sv->pars.timetype==ro_time_pri_created || sv->pars.timetype==ro_time_pri_flat_comm || sv->pars.timetype==ro_time_first_pos_test_results) sim_set_pri_init_proc_func(sv, STD_STATS_FUNC(std_stats_pri_init,INF,NEWINF,POSTEST,EXT)); \
+  else sim_set_pri_init_proc_func(sv, STD_STATS_FUNC(std_stats_pri_init_rel,INF,NEWINF,POSTEST,EXT)); \
+  if(sv->pars.timetype==ro_time_first_pos_test_results) { \
+    sim_set_new_inf_proc_func(sv, STD_STATS_FUNC(std_stats_new_inf_first_pos_test_results,INF,NEWINF,POSTEST,EXT)); \
+    if(stats->nainfbins) {sim_set_end_inf_proc_func(sv, STD_STATS_FUNC(std_stats_end_inf_rec_ninfs,INF,NEWINF,POSTEST,EXT)); sim_set_new_inf_proc_noevent_func(sv, STD_STATS_FUNC(std_stats_noevent_new_inf_rec_ninfs_first_pos_test_results,INF,NEWINF,POSTEST,EXT));} \
+    else {sim_set_end_inf_proc_func(sv, STD_STATS_FUNC(std_stats_end_inf,INF,NEWINF,POSTEST,EXT)); sim_set_new_inf_proc_noevent_func(sv, STD_STATS_FUNC(std_stats_noevent_new_inf_first_pos_test_results,INF,NEWINF,POSTEST,EXT));} \
+  } else { \
+    sim_set_new_inf_proc_func(sv, STD_STATS_FUNC(std_stats_new_inf,INF,NEWINF,POSTEST,EXT)); \
+    if(stats->nainfbins) {sim_set_end_inf_proc_func(sv, STD_STATS_FUNC(std_stats_end_inf_rec_ninfs,INF,NEWINF,POSTEST,EXT)); sim_set_new_inf_proc_noevent_func(sv, STD_STATS_FUNC(std_stats_noevent_new_inf_rec_ninfs,INF,NEWINF,POSTEST,EXT));} \
+    else {sim_set_end_inf_proc_func(sv, STD_STATS_FUNC(std_stats_end_inf,INF,NEWINF,POSTEST,EXT)); sim_set_new_inf_proc_noevent_func(sv, STD_STATS_FUNC(std_stats_noevent_new_inf,INF,NEWINF,POSTEST,EXT));} \
+  } \
+  if(stats->nimax < UINT32_MAX) sim_set_new_event_proc_func(sv, std_stats_new_event_nimax); \
+  else if(stats->npostestmax < UINT32_MAX) sim_set_new_event_proc_func(sv, STD_STATS_FUNC(std_stats_new_event_npostestmax,INF,NEWINF,POSTEST,EXT)); \
+  else sim_set_new_event_proc_func(sv, STD_STATS_FUNC(std_stats_new_event,INF,NEWINF,POSTEST,EXT));
+#define STD_STATS_COND_EXT(INF,NEWINF,POSTEST) if(stats->tlchans&std_stats_tl_ext) {STD_STATS_SET_FUNCS(INF,NEWINF,POSTEST,1)} else {STD_STATS_SET_FUNCS(INF,NEWINF,POSTEST,0)}
+#define STD_STATS_COND_POSTEST(INF,NEWINF) if(stats->tlchans&std_stats_tl_postest) {STD_STATS_COND_EXT(INF,NEWINF,1)} else {STD_STATS_COND_EXT(INF,NEWINF,0)}
+#define STD_STATS_COND_NEWINF(INF) if(stats->tlchans&std_stats_tl_newinf) {STD_STATS_COND_POSTEST(INF,1)} else {STD_STATS_COND_POSTEST(INF,0)}
+
+/**
+ * Assigns the processing functions matching the selected timeline channels.
+ */
+#define STD_STATS_COND if(stats->tlchans&std_stats_tl_inf) {STD_STATS_COND_NEWINF(1)} else {STD_STATS_COND_NEWINF(0)}
+
+void std_stats_init(sim_vars* sv, const uint32_t nbinsperunit, bool ngeninfs, uint32_t tlchans)
 {
   std_summary_stats* stats=(std_summary_stats*)sv->dataptr;
 
@@ -23,18 +70,21 @@ void std_stats_init(sim_vars* sv, const uint32_t nbinsperunit, bool ngeninfs)
     stats->abs_tmax=sv->pars.tmax;
   }
 
+  if(ngeninfs) tlchans|=std_stats_tl_ext;
+  stats->tlchans=tlchans;
+
   stats->tlshift=stats->tlshifta=0;
-  stats->inf_timeline=(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t));
-  stats->newinf_timeline=(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t));
-  stats->postest_timeline=(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t));
-  stats->newpostest_timeline=(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t));
+  stats->inf_timeline=(tlchans&std_stats_tl_inf?(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t)):NULL);
+  stats->newinf_timeline=(tlchans&std_stats_tl_newinf?(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t)):NULL);
+  stats->postest_timeline=(tlchans&std_stats_tl_postest?(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t)):NULL);
+  stats->newpostest_timeline=(tlchans&std_stats_tl_postest?(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t)):NULL);
   #ifdef SEC_INF_TIMELINES
-  stats->secinf_timeline=(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t));
-  stats->newsecinf_timeline=(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t));
-  stats->secpostest_timeline=(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t));
-  stats->newsecpostest_timeline=(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t));
+  stats->secinf_timeline=(tlchans&std_stats_tl_inf?(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t)):NULL);
+  stats->newsecinf_timeline=(tlchans&std_stats_tl_newinf?(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t)):NULL);
+  stats->secpostest_timeline=(tlchans&std_stats_tl_postest?(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t)):NULL);
+  stats->newsecpostest_timeline=(tlchans&std_stats_tl_postest?(uint32_t*)malloc(stats->tnpersa*sizeof(uint32_t)):NULL);
   #endif
-  stats->ext_timeline=(ext_timeline_info*)malloc(stats->tnpersa*sizeof(ext_timeline_info));
+  stats->ext_timeline=(tlchans&std_stats_tl_ext?(ext_timeline_info*)malloc(stats->tnpersa*sizeof(ext_timeline_info)):NULL);
 
   int32_t i;
 
@@ -51,43 +101,319 @@ void std_stats_init(sim_vars* sv, const uint32_t nbinsperunit, bool ngeninfs)
 
   stats->lmax=UINT32_MAX;
   stats->nimax=UINT32_MAX;
+  stats->npostestmax=UINT32_MAX;
+  stats->obs=NULL;
+  stats->obsmaxdist=INFINITY;
 
 #ifdef CT_OUTPUT
   stats->nactentries=INIT_NACTENTRIES;
-  stats->ctentries=(ctposinf**)malloc(INIT_NACTENTRIES*sizeof(ctposinf*));
-
-  for(i=stats->nactentries-1; i>=0; --i) stats->ctentries[i]=(ctposinf*)malloc(sizeof(ctposinf));
+  stats->ctentries=(ctposinf*)malloc(INIT_NACTENTRIES*sizeof(ctposinf));
+  stats->ctsortbuf=(ctposinf*)malloc(INIT_NACTENTRIES*sizeof(ctposinf));
 #endif
+  stats->treenodes=NULL;
 }
 
 void std_stats_free(std_summary_stats* stats)
 {
-  free(stats->inf_timeline-stats->tlshifta);
-  free(stats->newinf_timeline-stats->tlshifta);
-  free(stats->postest_timeline-stats->tlshifta);
-  free(stats->newpostest_timeline-stats->tlshifta);
+  if(stats->tlchans&std_stats_tl_inf) {
+    free(stats->inf_timeline-stats->tlshifta);
 #ifdef SEC_INF_TIMELINES
-  free(stats->secinf_timeline-stats->tlshifta);
-  free(stats->newsecinf_timeline-stats->tlshifta);
-  free(stats->secpostest_timeline-stats->tlshifta);
-  free(stats->newsecpostest_timeline-stats->tlshifta);
+    free(stats->secinf_timeline-stats->tlshifta);
 #endif
+  }
 
-  ext_timeline_info* const set=stats->ext_timeline-stats->tlshifta;
-  int32_t i;
+  if(stats->tlchans&std_stats_tl_newinf) {
+    free(stats->newinf_timeline-stats->tlshifta);
+#ifdef SEC_INF_TIMELINES
+    free(stats->newsecinf_timeline-stats->tlshifta);
+#endif
+  }
 
-  if(stats->nainfbins) {
+  if(stats->tlchans&std_stats_tl_postest) {
+    free(stats->postest_timeline-stats->tlshifta);
+    free(stats->newpostest_timeline-stats->tlshifta);
+#ifdef SEC_INF_TIMELINES
+    free(stats->secpostest_timeline-stats->tlshifta);
+    free(stats->newsecpostest_timeline-stats->tlshifta);
+#endif
+  }
 
-    for(i=stats->tnpersa-1; i>=0; --i) {
-      //printf("Free ext_timeline[%i] (%p)\n",i-stats->tlshifta,set[i].ngeninfs);
-      free(set[i].ngeninfs);
+  if(stats->tlchans&std_stats_tl_ext) {
+    ext_timeline_info* const set=stats->ext_timeline-stats->tlshifta;
+    int32_t i;
+
+    if(stats->nainfbins) {
+
+      for(i=stats->tnpersa-1; i>=0; --i) {
+	//printf("Free ext_timeline[%i] (%p)\n",i-stats->tlshifta,set[i].ngeninfs);
+	free(set[i].ngeninfs);
+      }
     }
+    free(set);
   }
-  free(stats->ext_timeline-stats->tlshifta);
 
 #ifdef CT_OUTPUT
-
-  for(i=stats->nactentries-1; i>=0; --i) free(stats->ctentries[i]);
   free(stats->ctentries);
+  free(stats->ctsortbuf);
+#endif
+  free(stats->treenodes);
+}
+
+/**
+ * @brief Copies a timeline, including its negative time indices.
+ *
+ * @param dsttl: Destination timeline, shifted by dst->tlshifta, which is
+ * reallocated if the allocated sizes differ.
+ * @param dst: Pointer to the destination standard summary statistics.
+ * @param srctl: Source timeline, shifted by src->tlshifta.
+ * @param src: Pointer to the source standard summary statistics.
+ * @return the destination timeline, shifted by src->tlshifta.
+ */
+static uint32_t* std_stats_timeline_copy(uint32_t* dsttl, std_summary_stats const* dst, uint32_t const* srctl, std_summary_stats const* src)
+{
+  if(dst->tlshifta!=src->tlshifta || dst->tnpersa!=src->tnpersa) {
+    free(dsttl-dst->tlshifta);
+    dsttl=(uint32_t*)malloc(src->tnpersa*sizeof(uint32_t))+src->tlshifta;
+  }
+  memcpy(dsttl-src->tlshifta,srctl-src->tlshifta,src->tnpersa*sizeof(uint32_t));
+  return dsttl;
+}
+
+void std_stats_path_copy(std_summary_stats* dst, std_summary_stats const* src)
+{
+  if(src->tlchans&std_stats_tl_inf) {
+    dst->inf_timeline=std_stats_timeline_copy(dst->inf_timeline,dst,src->inf_timeline,src);
+#ifdef SEC_INF_TIMELINES
+    dst->secinf_timeline=std_stats_timeline_copy(dst->secinf_timeline,dst,src->secinf_timeline,src);
+#endif
+  }
+
+  if(src->tlchans&std_stats_tl_newinf) {
+    dst->newinf_timeline=std_stats_timeline_copy(dst->newinf_timeline,dst,src->newinf_timeline,src);
+#ifdef SEC_INF_TIMELINES
+    dst->newsecinf_timeline=std_stats_timeline_copy(dst->newsecinf_timeline,dst,src->newsecinf_timeline,src);
+#endif
+  }
+
+  if(src->tlchans&std_stats_tl_postest) {
+    dst->postest_timeline=std_stats_timeline_copy(dst->postest_timeline,dst,src->postest_timeline,src);
+    dst->newpostest_timeline=std_stats_timeline_copy(dst->newpostest_timeline,dst,src->newpostest_timeline,src);
+#ifdef SEC_INF_TIMELINES
+    dst->secpostest_timeline=std_stats_timeline_copy(dst->secpostest_timeline,dst,src->secpostest_timeline,src);
+    dst->newsecpostest_timeline=std_stats_timeline_copy(dst->newsecpostest_timeline,dst,src->newsecpostest_timeline,src);
+#endif
+  }
+
+  if(src->tlchans&std_stats_tl_ext) {
+    ext_timeline_info* set=dst->ext_timeline-dst->tlshifta;
+    ext_timeline_info const* const srcset=src->ext_timeline-src->tlshifta;
+    int32_t i;
+
+    //The infection bins of each interval are reallocated along with the
+    //extended timeline
+    if(dst->tlshifta!=src->tlshifta || dst->tnpersa!=src->tnpersa || dst->nainfbins!=src->nainfbins) {
+
+      if(dst->nainfbins) for(i=dst->tnpersa-1; i>=0; --i) free(set[i].ngeninfs);
+      free(set);
+      set=(ext_timeline_info*)malloc(src->tnpersa*sizeof(ext_timeline_info));
+
+      if(src->nainfbins) for(i=src->tnpersa-1; i>=0; --i) set[i].ngeninfs=(uint64_t*)malloc(src->nainfbins*sizeof(uint64_t));
+      dst->nainfbins=src->nainfbins;
+    }
+
+    for(i=src->tnpersa-1; i>=0; --i) {
+      uint64_t* const ngeninfs=set[i].ngeninfs;
+      set[i]=srcset[i];
+      set[i].ngeninfs=ngeninfs;
+
+      if(src->nainfbins) memcpy(ngeninfs,srcset[i].ngeninfs,src->nainfbins*sizeof(uint64_t));
+    }
+    dst->ext_timeline=set+src->tlshifta;
+  }
+  dst->tlshifta=src->tlshifta;
+  dst->tnpersa=src->tnpersa;
+
+#ifdef CT_OUTPUT
+  if(dst->nactentries<src->nctentries) {
+    dst->nactentries=src->nactentries;
+    dst->ctentries=(ctposinf*)realloc(dst->ctentries,dst->nactentries*sizeof(ctposinf));
+    dst->ctsortbuf=(ctposinf*)realloc(dst->ctsortbuf,dst->nactentries*sizeof(ctposinf));
+  }
+  memcpy(dst->ctentries,src->ctentries,src->nctentries*sizeof(ctposinf));
+  dst->nctentries=src->nctentries;
+  dst->curctid=src->curctid;
+#endif
+
+  if(src->treenodes) {
+
+    if(dst->natreenodes<src->ntreenodes) {
+      dst->natreenodes=src->natreenodes;
+      dst->treenodes=(tree_node*)realloc(dst->treenodes,dst->natreenodes*sizeof(tree_node));
+    }
+    memcpy(dst->treenodes,src->treenodes,src->ntreenodes*sizeof(tree_node));
+    dst->ntreenodes=src->ntreenodes;
+  }
+
+#ifdef OBSREFF_OUTPUT
+  //Fields of the scratch individual that are not assigned by the time
+  //period functions are carried over between transmission events
+  dst->iibuf=src->iibuf;
+#endif
+  dst->extinction_time=src->extinction_time;
+  dst->abs_tmax=src->abs_tmax;
+  dst->first_pos_test_results_time=src->first_pos_test_results_time;
+  dst->ninfbins=src->ninfbins;
+  dst->abs_maxnpers=src->abs_maxnpers;
+  dst->abs_npers=src->abs_npers;
+  dst->tlshift=src->tlshift;
+  dst->maxedoutmintimeindex=src->maxedoutmintimeindex;
+  dst->obsnevents=src->obsnevents;
+  dst->rejected=src->rejected;
+  dst->extinction=src->extinction;
+}
+
+/**
+ * @brief Compares two timelines, including their negative time indices.
+ *
+ * @param tl1: First timeline, shifted by stats->tlshifta.
+ * @param tl2: Second timeline, shifted by stats->tlshifta.
+ * @param stats: Pointer to the standard summary statistics of either
+ * timeline, whose allocated sizes are identical.
+ * @return true if the timelines are identical.
+ */
+inline static bool std_stats_timeline_equal(uint32_t const* tl1, uint32_t const* tl2, std_summary_stats const* stats)
+{
+  return !memcmp(tl1-stats->tlshifta,tl2-stats->tlshifta,stats->tnpersa*sizeof(uint32_t));
+}
+
+/**
+ * @brief Compares two times, which are identical if they are both NaN.
+ *
+ * @param t1: First time.
+ * @param t2: Second time.
+ * @return true if the times are identical.
+ */
+inline static bool std_stats_time_equal(const double t1, const double t2){return (t1==t2 || (isnan(t1) && isnan(t2)));}
+
+bool std_stats_path_equal(std_summary_stats const* stats1, std_summary_stats const* stats2)
+{
+  int32_t i;
+
+  if(stats1->tlchans!=stats2->tlchans || stats1->tlshifta!=stats2->tlshifta || stats1->tnpersa!=stats2->tnpersa || stats1->nainfbins!=stats2->nainfbins) return false;
+
+  if(!std_stats_time_equal(stats1->extinction_time,stats2->extinction_time) || !std_stats_time_equal(stats1->abs_tmax,stats2->abs_tmax) || !std_stats_time_equal(stats1->first_pos_test_results_time,stats2->first_pos_test_results_time)) return false;
+
+  if(stats1->ninfbins!=stats2->ninfbins || stats1->abs_maxnpers!=stats2->abs_maxnpers || stats1->abs_npers!=stats2->abs_npers || stats1->tlshift!=stats2->tlshift || stats1->maxedoutmintimeindex!=stats2->maxedoutmintimeindex || stats1->obsnevents!=stats2->obsnevents || stats1->rejected!=stats2->rejected || stats1->extinction!=stats2->extinction) return false;
+
+  if(stats1->tlchans&std_stats_tl_inf) {
+
+    if(!std_stats_timeline_equal(stats1->inf_timeline,stats2->inf_timeline,stats1)) return false;
+#ifdef SEC_INF_TIMELINES
+
+    if(!std_stats_timeline_equal(stats1->secinf_timeline,stats2->secinf_timeline,stats1)) return false;
+#endif
+  }
+
+  if(stats1->tlchans&std_stats_tl_newinf) {
+
+    if(!std_stats_timeline_equal(stats1->newinf_timeline,stats2->newinf_timeline,stats1)) return false;
+#ifdef SEC_INF_TIMELINES
+
+    if(!std_stats_timeline_equal(stats1->newsecinf_timeline,stats2->newsecinf_timeline,stats1)) return false;
+#endif
+  }
+
+  if(stats1->tlchans&std_stats_tl_postest) {
+
+    if(!std_stats_timeline_equal(stats1->postest_timeline,stats2->postest_timeline,stats1) || !std_stats_timeline_equal(stats1->newpostest_timeline,stats2->newpostest_timeline,stats1)) return false;
+#ifdef SEC_INF_TIMELINES
+
+    if(!std_stats_timeline_equal(stats1->secpostest_timeline,stats2->secpostest_timeline,stats1) || !std_stats_timeline_equal(stats1->newsecpostest_timeline,stats2->newsecpostest_timeline,stats1)) return false;
+#endif
+  }
+
+  if(stats1->tlchans&std_stats_tl_ext) {
+    ext_timeline_info const* const set1=stats1->ext_timeline-stats1->tlshifta;
+    ext_timeline_info const* const set2=stats2->ext_timeline-stats2->tlshifta;
+
+    for(i=stats1->tnpersa-1; i>=0; --i) {
+
+      if(set1[i].n!=set2[i].n || set1[i].rsum!=set2[i].rsum || set1[i].r2sum!=set2[i].r2sum || set1[i].commpersum!=set2[i].commpersum) return false;
+#ifdef NUMEVENTSSTATS
+
+      if(set1[i].neventssum!=set2[i].neventssum) return false;
+#endif
+#ifdef OBSREFF_OUTPUT
+
+      if(set1[i].nobs!=set2[i].nobs || set1[i].robssum!=set2[i].robssum || set1[i].robs2sum!=set2[i].robs2sum) return false;
 #endif
+
+      if(stats1->nainfbins && memcmp(set1[i].ngeninfs,set2[i].ngeninfs,stats1->nainfbins*sizeof(uint64_t))) return false;
+    }
+  }
+
+#ifdef CT_OUTPUT
+  if(stats1->nctentries!=stats2->nctentries || stats1->curctid!=stats2->curctid || memcmp(stats1->ctentries,stats2->ctentries,stats1->nctentries*sizeof(ctposinf))) return false;
+#endif
+
+  if(stats1->treenodes) {
+    tree_node const* n1;
+    tree_node const* n2;
+
+    if(stats1->ntreenodes!=stats2->ntreenodes) return false;
+
+    for(i=stats1->ntreenodes-1; i>=0; --i) {
+      n1=stats1->treenodes+i;
+      n2=stats2->treenodes+i;
+
+      if(n1->inftime!=n2->inftime || n1->end_latent_period!=n2->end_latent_period || n1->end_comm_period!=n2->end_comm_period || n1->parent!=n2->parent || n1->generation!=n2->generation || n1->event!=n2->event || n1->ninf!=n2->ninf || n1->commpertype!=n2->commpertype) return false;
+    }
+  }
+  return true;
+}
+
+int std_stats_set_proc_funcs(sim_vars* sv)
+{
+  std_summary_stats* stats=(std_summary_stats*)sv->dataptr;
+
+  if(stats->nimax < UINT32_MAX && !(stats->tlchans&std_stats_tl_newinf)) {
+    fprintf(stderr,"%s: Error: The nimax limit requires the new infection timeline channel\n",__func__);
+    return -1;
+  }
+
+  if((stats->npostestmax < UINT32_MAX || sv->pars.pathtype!=ro_all_paths) && !(stats->tlchans&std_stats_tl_postest)) {
+    fprintf(stderr,"%s: Error: The npostestmax limit and the selection of paths based on their observability require the positive test timeline channel\n",__func__);
+    return -1;
+  }
+
+  if(sv->pars.timetype==ro_time_first_pos_test_results && !(stats->tlchans&std_stats_tl_inf)) {
+    fprintf(stderr,"%s: Error: A time relative to the first positive test results requires the infection timeline channel\n",__func__);
+    return -1;
+  }
+
+  if(stats->obs) {
+
+    if(!(stats->tlchans&stats->obschan)) {
+      fprintf(stderr,"%s: Error: The comparison with an observed series requires the compared timeline channel\n",__func__);
+      return -1;
+    }
+
+    if(sv->pars.timetype==ro_time_first_pos_test_results) {
+      fprintf(stderr,"%s: Error: The comparison with an observed series cannot be used with a time relative to the first positive test results\n",__func__);
+      return -1;
+    }
+
+    if(stats->nobs>stats->npers) {
+      fprintf(stderr,"%s: Error: The observed series cannot be longer than the timelines\n",__func__);
+      return -1;
+    }
+  }
+
+  STD_STATS_COND;
+
+  if(stats->obs && stats->obsmaxdist<INFINITY) {
+    stats->obs_new_event_proc_func=sv->new_event_proc_func;
+    sim_set_new_event_proc_func(sv, std_stats_new_event_obs);
+  }
+  return 0;
 }
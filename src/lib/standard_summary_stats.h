@@ -17,8 +17,23 @@
 #include "simulation.h"
 
 #define INIT_NINF_ALLOC (16) //!< Initial number of allocated bins for the ninf histogram
-#define INIT_NACTENTRIES (16)
-#define CTENTRIES_GROWFACT (1.5)
+#define INIT_NACTENTRIES (16) //!< Initial number of allocated contact tracing entries
+#define CTENTRIES_GROWFACT (1.5) //!< Growth factor for the contact tracing entry storage
+#define CTSORT_RADIX_BITS (8) //!< Number of key bits processed by each pass of the contact tracing entry radix sort
+#define CTSORT_NBUCKETS (1<<CTSORT_RADIX_BITS) //!< Number of buckets for each pass of the contact tracing entry radix sort
+#define INIT_NATREENODES (64) //!< Initial number of allocated transmission tree nodes
+#define TREENODES_GROWFACT (1.5) //!< Growth factor for the transmission tree node storage
+
+/**
+ * Timeline channels filled by the standard summary statistics. Unselected
+ * channels are not allocated, reset or filled.
+ */
+enum std_stats_tl_channels {std_stats_tl_inf=1, std_stats_tl_newinf=2, std_stats_tl_postest=4, std_stats_tl_ext=8, std_stats_tl_all=15};
+
+/**
+ * Distances between a timeline and an observed series.
+ */
+enum std_stats_obs_dists {std_stats_obs_l1, std_stats_obs_l2, std_stats_obs_linf};
 
 extern int __ro_debug;
 #ifdef DEBUG_PRINTF
@@ -28,15 +43,32 @@ extern int __ro_debug;
 //#define DEBUG_PRINTF(...) {if(__ro_debug) printf(__VA_ARGS__);} //!< Debug print function
 
 #ifdef CT_OUTPUT
+/**
+ * Contact tracing entry. The memory layout matches the ctout record layout.
+ */
 typedef struct {
-  int32_t postesttime;
-  int32_t presymtime;
-  int32_t id;
-  int32_t pid;
-  uint32_t ntracedcts;
+  int32_t postesttime;		//!< Time of the positive test result (in minutes).
+  int32_t presymtime;		//!< Presymptomatic time (in minutes), or INT32_MAX.
+  int32_t id;			//!< Individual ID.
+  int32_t pid;			//!< Parent ID.
+  uint32_t ntracedcts;		//!< Number of traced contacts.
 } ctposinf;
 #endif
 
+/**
+ * Transmission tree node, for an infectious individual of the current path.
+ */
+typedef struct {
+  double inftime;		//!< Infection time.
+  double end_latent_period;	//!< End of the latent period.
+  double end_comm_period;	//!< End of the communicable period.
+  uint32_t parent;		//!< Index of the parent node, or UINT32_MAX for a primary individual.
+  uint32_t generation;		//!< Infection generation.
+  uint32_t event;		//!< Index of the parent's transmission event that generated the infection, among the parent's events with infections.
+  uint32_t ninf;		//!< Number of infections generated by the individual.
+  uint8_t commpertype;		//!< Type of communicable period (ro_commper_type flags).
+} tree_node;
+
 typedef struct
 {
   uint32_t   n;	               //!< Number of infectious creating infections in the timeline bin.
@@ -86,11 +118,15 @@ typedef struct
   uint32_t nainfbins;		//!< Number of allocated infectious individual bins.
   uint32_t ninfbins;		//!< Number of used infectious individual bins.
 #ifdef CT_OUTPUT
-  ctposinf** ctentries;
-  uint32_t nctentries;
-  uint32_t nactentries;
-  int32_t curctid;
+  ctposinf* ctentries;		//!< Contiguous storage for the contact tracing entries of the current path.
+  ctposinf* ctsortbuf;		//!< Scratch storage used to sort the contact tracing entries.
+  uint32_t nctentries;		//!< Number of contact tracing entries for the current path.
+  uint32_t nactentries;		//!< Number of allocated contact tracing entries.
+  int32_t curctid;		//!< Last assigned contact tracing ID for the current path.
 #endif
+  tree_node* treenodes;		//!< Transmission tree nodes of the current path, in creation order, or NULL if the transmission tree is not recorded.
+  uint32_t ntreenodes;		//!< Number of transmission tree nodes for the current path.
+  uint32_t natreenodes;		//!< Number of allocated transmission tree nodes.
   int32_t abs_maxnpers;		//!< Absolute maximum number of potential positive integer intervals for the simulation. This number can decrease during the simulation of a path (=nbinsperunit*abs_tmax).
   int32_t abs_npers;		//!< Actual number of absolute simulated positive integer intervals. This number can only increase during the simulation of a path (=floor(nbinsperunit*(end_comm_period+tdeltat+npostestmaxnunits)) for positive tests and floor(nbinsperunit*end_comm_period) for negative tests when using time_rel_first_pos_test).
   int32_t npers;		//!< Maximum number of desired positive integer intervals (=nbinsperunit*tmax).
@@ -105,12 +141,23 @@ typedef struct
   uint32_t npostestmax;         //!< Maximum number of positive test results during an interval of duration npostestmaxnunits for each individual that starts when the test results are received. Extinction is set to false and the simulation does not proceed further if this maximum is exceeded.
   uint32_t npostestmaxnunits;    //!< Interval duration for the maximum number of positive test results
   int32_t maxedoutmintimeindex; //!< *Minimum time index which maxed out the allowed number of infected individuals or positive test results.
+  uint32_t tlchans;		//!< Filled timeline channels (std_stats_tl_channels flags).
+  uint32_t const* obs;		//!< Observed series compared with a timeline, for each integer interval from 0, or NULL.
+  uint32_t nobs;		//!< Number of integer intervals of the observed series.
+  uint32_t obschan;		//!< Timeline channel compared with the observed series (std_stats_tl_inf, std_stats_tl_newinf or std_stats_tl_postest for the new positive test results).
+  uint32_t obsdist;		//!< Distance between the timeline and the observed series (value set using std_stats_obs_dists).
+  double obsmaxdist;		//!< Distance above which a path is rejected, or INFINITY. Paths are not rejected early when the distance is INFINITY.
+  uint32_t obsnevents;		//!< *Number of new events since the distance lower bound was last checked.
+  bool (*obs_new_event_proc_func)(sim_vars* sv, infindividual* ii); //!< New event processing function called for paths that are not rejected.
   //uint32_t n_ended_infections;
+  bool rejected;		//!< *Set to true if the path was rejected early because its distance to the observed series exceeds obsmaxdist.
   bool extinction;		//!< *Set to true if extinction does not occur before abs_tmax.
 } std_summary_stats;
 
 typedef struct {
   uint32_t ninf;
+  uint32_t ninfevents;		//!< Number of transmission events with infections.
+  uint32_t treeid;		//!< Transmission tree node index.
 #ifdef OBSREFF_OUTPUT
   uint32_t nobsinf;
 #endif
@@ -127,8 +174,13 @@ typedef struct {
  * statistics, if used.
  *
  * @param sv: Pointer to the simulation variables.
+ * @param nbinsperunit: Number of timeline bins per unit of time.
+ * @param ngeninfs: Record the number of infections generated by each
+ * infectious individual. Implies the std_stats_tl_ext channel.
+ * @param tlchans: Timeline channels to be filled (std_stats_tl_channels
+ * flags).
  */
-void std_stats_init(sim_vars *sv, const uint32_t nbinsperunit, bool ngeninfs);
+void std_stats_init(sim_vars *sv, const uint32_t nbinsperunit, bool ngeninfs, uint32_t tlchans);
 
 /**
  * @brief Initialises elements of the standard summary statistics
@@ -138,44 +190,62 @@ void std_stats_init(sim_vars *sv, const uint32_t nbinsperunit, bool ngeninfs);
  * elements of the standard summary statistics, if used
  *
  * @param sv: Pointer to the simulation variables.
- * elements will be initialised.
+ * @param tlchans: Filled timeline channels.
  */
-inline static void std_stats_path_init(sim_vars* sv)
+inline static void std_stats_path_init_gen(sim_vars* sv, const uint32_t tlchans)
 {
   std_summary_stats* stats=(std_summary_stats*)sv->dataptr;
   stats->extinction_time=-INFINITY;
   const uint32_t nerase=stats->tlshift+stats->abs_npers;
-  memset(stats->inf_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
-  memset(stats->newinf_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
-  memset(stats->postest_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
-  memset(stats->newpostest_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
+
+  if(tlchans&std_stats_tl_inf) {
+    memset(stats->inf_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
 #ifdef SEC_INF_TIMELINES
-  memset(stats->secinf_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
-  memset(stats->newsecinf_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
-  memset(stats->secpostest_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
-  memset(stats->newsecpostest_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
+    memset(stats->secinf_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
 #endif
-  int32_t i;
-  ext_timeline_info* const set=stats->ext_timeline-stats->tlshift;
+  }
 
-  if(stats->nainfbins) {
-    stats->ninfbins=1;
+  if(tlchans&std_stats_tl_newinf) {
+    memset(stats->newinf_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
+#ifdef SEC_INF_TIMELINES
+    memset(stats->newsecinf_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
+#endif
+  }
 
-    for(i=nerase-1; i>=0; --i) {
-      set[i].n=set[i].rsum=set[i].r2sum=set[i].commpersum=0;
+  if(tlchans&std_stats_tl_postest) {
+    memset(stats->postest_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
+    memset(stats->newpostest_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
+#ifdef SEC_INF_TIMELINES
+    memset(stats->secpostest_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
+    memset(stats->newsecpostest_timeline-stats->tlshift,0,nerase*sizeof(uint32_t));
+#endif
+  }
+
+  if(tlchans&std_stats_tl_ext) {
+    int32_t i;
+    ext_timeline_info* const set=stats->ext_timeline-stats->tlshift;
+
+    if(stats->nainfbins) {
+      stats->ninfbins=1;
+
+      for(i=nerase-1; i>=0; --i) {
+	set[i].n=set[i].rsum=set[i].r2sum=set[i].commpersum=0;
 #ifdef NUMEVENTSSTATS
-      set[i].neventssum=0;
+	set[i].neventssum=0;
 #endif
 #ifdef OBSREFF_OUTPUT
-      set[i].nobs=set[i].robssum=set[i].robs2sum=0;
+	set[i].nobs=set[i].robssum=set[i].robs2sum=0;
 #endif
-      memset(set[i].ngeninfs,0,stats->nainfbins*sizeof(uint64_t));
-    }
+	memset(set[i].ngeninfs,0,stats->nainfbins*sizeof(uint64_t));
+      }
 
-  } else memset(stats->ext_timeline-stats->tlshift,0,nerase*sizeof(ext_timeline_info));
+    } else memset(stats->ext_timeline-stats->tlshift,0,nerase*sizeof(ext_timeline_info));
+  }
 
   stats->extinction=true;
   stats->maxedoutmintimeindex=INT32_MAX;
+  stats->rejected=false;
+  stats->obsnevents=0;
 
   if(sv->pars.timetype==ro_time_first_pos_test_results) {
     stats->abs_maxnpers=INT32_MAX;
@@ -189,7 +259,8 @@ inline static void std_stats_path_init(sim_vars* sv)
   stats->nctentries=0;
   stats->curctid=0;
 #endif
-  if(stats->ext_timeline[0].n!=0) {
+  stats->ntreenodes=0;
+  if((tlchans&std_stats_tl_ext) && stats->ext_timeline[0].n!=0) {
     printf("ext: %u, %u, %u, %u\n",stats->ext_timeline[0].n,nerase,stats->tlshift,stats->abs_npers);
   }
 }
@@ -200,9 +271,10 @@ inline static void std_stats_path_init(sim_vars* sv)
  * This function must be called after the simulation of each path.
  *
  * @param sv: Pointer to the simulation variables.
+ * @param tlchans: Filled timeline channels.
  * @return true if the path is valid and false otherwise.
  */
-inline static bool std_stats_path_end(sim_vars* sv)
+inline static bool std_stats_path_end_gen(sim_vars* sv, const uint32_t tlchans)
 {
   const int32_t maxedoutmintimeindex=((std_summary_stats*)sv->dataptr)->maxedoutmintimeindex;
 
@@ -216,8 +288,6 @@ inline static bool std_stats_path_end(sim_vars* sv)
 
   } else tnvpers=stats->abs_npers+stats->tlshift;
 
-  ext_timeline_info* const et=stats->ext_timeline-stats->tlshift;
-
   if(sv->pars.timetype==ro_time_first_pos_test_results) {
 
     if(isinf(stats->first_pos_test_results_time)) return false;
@@ -249,15 +319,28 @@ inline static bool std_stats_path_end(sim_vars* sv)
     DEBUG_PRINTF("Before merging: %i negatives and %u total. First positive test found at %i\n",stats->tlshift,tnvpers,tlppt0idx);
     DEBUG_PRINTF("First positive test found at %i => %i negative periods and %u total valid periods. maxedoutmintimeindex set to %i\n",tlppt0idx,stats->tlppnnpers,stats->tlpptnvpers,stats->maxedoutmintimeindex);
 
-    stats->pp_inf_timeline=stats->inf_timeline+tlppt0idx;
-    stats->pp_newinf_timeline=stats->newinf_timeline+tlppt0idx;
-    stats->pp_newpostest_timeline=stats->newpostest_timeline+tlppt0idx;
+    if(tlchans&std_stats_tl_inf) {
+      stats->pp_inf_timeline=stats->inf_timeline+tlppt0idx;
+#ifdef SEC_INF_TIMELINES
+      stats->pp_secinf_timeline=stats->secinf_timeline+tlppt0idx;
+#endif
+    }
+
+    if(tlchans&std_stats_tl_newinf) {
+      stats->pp_newinf_timeline=stats->newinf_timeline+tlppt0idx;
+#ifdef SEC_INF_TIMELINES
+      stats->pp_newsecinf_timeline=stats->newsecinf_timeline+tlppt0idx;
+#endif
+    }
+
+    if(tlchans&std_stats_tl_postest) {
+      stats->pp_newpostest_timeline=stats->newpostest_timeline+tlppt0idx;
 #ifdef SEC_INF_TIMELINES
-    stats->pp_secinf_timeline=stats->secinf_timeline+tlppt0idx;
-    stats->pp_newsecinf_timeline=stats->newsecinf_timeline+tlppt0idx;
-    stats->pp_newsecpostest_timeline=stats->newsecpostest_timeline+tlppt0idx;
+      stats->pp_newsecpostest_timeline=stats->newsecpostest_timeline+tlppt0idx;
 #endif
-    stats->pp_ext_timeline=stats->ext_timeline+tlppt0idx;
+    }
+
+    if(tlchans&std_stats_tl_ext) stats->pp_ext_timeline=stats->ext_timeline+tlppt0idx;
     //Check if the last index is even. If it is, there is a single fine bin in
     //the last merged bin
     j=(tnvpers-stats->tlshift-tlppt0idx)/2;
@@ -265,46 +348,76 @@ inline static bool std_stats_path_end(sim_vars* sv)
 
     for(k=0; k<j; ++k) {
       i=2*k;
-      DEBUG_PRINTF("[%i] = [%i] (%u) + [%i] (%u)\n",k,i+tlppt0idx,stats->pp_inf_timeline[i],i+1+tlppt0idx,stats->pp_inf_timeline[i+1]);
-      stats->pp_inf_timeline[k]=(stats->pp_inf_timeline[i]>stats->pp_inf_timeline[i+1]?stats->pp_inf_timeline[i]:stats->pp_inf_timeline[i+1]);
-      stats->pp_newinf_timeline[k]=stats->pp_newinf_timeline[i]+stats->pp_newinf_timeline[i+1];
-      stats->pp_newpostest_timeline[k]=stats->pp_newpostest_timeline[i]+stats->pp_newpostest_timeline[i+1];
+
+      if(tlchans&std_stats_tl_inf) {
+	DEBUG_PRINTF("[%i] = [%i] (%u) + [%i] (%u)\n",k,i+tlppt0idx,stats->pp_inf_timeline[i],i+1+tlppt0idx,stats->pp_inf_timeline[i+1]);
+	stats->pp_inf_timeline[k]=(stats->pp_inf_timeline[i]>stats->pp_inf_timeline[i+1]?stats->pp_inf_timeline[i]:stats->pp_inf_timeline[i+1]);
 #ifdef SEC_INF_TIMELINES
-      stats->pp_secinf_timeline[k]=(stats->pp_secinf_timeline[i]>stats->pp_secinf_timeline[i+1]?stats->pp_secinf_timeline[i]:stats->pp_secinf_timeline[i+1]);
-      stats->pp_newsecinf_timeline[k]=stats->pp_newsecinf_timeline[i]+stats->pp_newsecinf_timeline[i+1];
-      stats->pp_newsecpostest_timeline[k]=stats->pp_newsecpostest_timeline[i]+stats->pp_newsecpostest_timeline[i+1];
-#endif
-
-      stats->pp_ext_timeline[k].n=stats->pp_ext_timeline[i].n+stats->pp_ext_timeline[i+1].n;
-      stats->pp_ext_timeline[k].rsum=stats->pp_ext_timeline[i].rsum+stats->pp_ext_timeline[i+1].rsum;
-      stats->pp_ext_timeline[k].r2sum=stats->pp_ext_timeline[i].r2sum+stats->pp_ext_timeline[i+1].r2sum;
-      #ifdef OBSREFF_OUTPUT
-      stats->pp_ext_timeline[k].nobs=stats->pp_ext_timeline[i].nobs+stats->pp_ext_timeline[i+1].nobs;
-      stats->pp_ext_timeline[k].robssum=stats->pp_ext_timeline[i].robssum+stats->pp_ext_timeline[i+1].robssum;
-      stats->pp_ext_timeline[k].robs2sum=stats->pp_ext_timeline[i].robs2sum+stats->pp_ext_timeline[i+1].robs2sum;
-      #endif
+	stats->pp_secinf_timeline[k]=(stats->pp_secinf_timeline[i]>stats->pp_secinf_timeline[i+1]?stats->pp_secinf_timeline[i]:stats->pp_secinf_timeline[i+1]);
+#endif
+      }
+
+      if(tlchans&std_stats_tl_newinf) {
+	stats->pp_newinf_timeline[k]=stats->pp_newinf_timeline[i]+stats->pp_newinf_timeline[i+1];
+#ifdef SEC_INF_TIMELINES
+	stats->pp_newsecinf_timeline[k]=stats->pp_newsecinf_timeline[i]+stats->pp_newsecinf_timeline[i+1];
+#endif
+      }
+
+      if(tlchans&std_stats_tl_postest) {
+	stats->pp_newpostest_timeline[k]=stats->pp_newpostest_timeline[i]+stats->pp_newpostest_timeline[i+1];
+#ifdef SEC_INF_TIMELINES
+	stats->pp_newsecpostest_timeline[k]=stats->pp_newsecpostest_timeline[i]+stats->pp_newsecpostest_timeline[i+1];
+#endif
+      }
+
+      if(tlchans&std_stats_tl_ext) {
+	stats->pp_ext_timeline[k].n=stats->pp_ext_timeline[i].n+stats->pp_ext_timeline[i+1].n;
+	stats->pp_ext_timeline[k].rsum=stats->pp_ext_timeline[i].rsum+stats->pp_ext_timeline[i+1].rsum;
+	stats->pp_ext_timeline[k].r2sum=stats->pp_ext_timeline[i].r2sum+stats->pp_ext_timeline[i+1].r2sum;
+#ifdef OBSREFF_OUTPUT
+	stats->pp_ext_timeline[k].nobs=stats->pp_ext_timeline[i].nobs+stats->pp_ext_timeline[i+1].nobs;
+	stats->pp_ext_timeline[k].robssum=stats->pp_ext_timeline[i].robssum+stats->pp_ext_timeline[i+1].robssum;
+	stats->pp_ext_timeline[k].robs2sum=stats->pp_ext_timeline[i].robs2sum+stats->pp_ext_timeline[i+1].robs2sum;
+#endif
+      }
     }
 
     if(single) {
       i=-stats->tlshift+tnvpers-1;
-      DEBUG_PRINTF("[%i] = [%i] (%u)\n",j,i,stats->inf_timeline[i]);
-      stats->pp_inf_timeline[j]=stats->inf_timeline[i];
-      stats->pp_newinf_timeline[j]=stats->newinf_timeline[i];
-      stats->pp_newpostest_timeline[j]=stats->newpostest_timeline[i];
+
+      if(tlchans&std_stats_tl_inf) {
+	DEBUG_PRINTF("[%i] = [%i] (%u)\n",j,i,stats->inf_timeline[i]);
+	stats->pp_inf_timeline[j]=stats->inf_timeline[i];
 #ifdef SEC_INF_TIMELINES
-      stats->pp_secinf_timeline[j]=stats->secinf_timeline[i];
-      stats->pp_newsecinf_timeline[j]=stats->newsecinf_timeline[i];
-      stats->pp_newsecpostest_timeline[j]=stats->newsecpostest_timeline[i];
-#endif
-
-      stats->pp_ext_timeline[j].n=stats->ext_timeline[i].n;
-      stats->pp_ext_timeline[j].rsum=stats->ext_timeline[i].rsum;
-      stats->pp_ext_timeline[j].r2sum=stats->ext_timeline[i].r2sum;
-      #ifdef OBSREFF_OUTPUT
-      stats->pp_ext_timeline[j].nobs=stats->ext_timeline[i].nobs;
-      stats->pp_ext_timeline[j].robssum=stats->ext_timeline[i].robssum;
-      stats->pp_ext_timeline[j].robs2sum=stats->ext_timeline[i].robs2sum;
-      #endif
+	stats->pp_secinf_timeline[j]=stats->secinf_timeline[i];
+#endif
+      }
+
+      if(tlchans&std_stats_tl_newinf) {
+	stats->pp_newinf_timeline[j]=stats->newinf_timeline[i];
+#ifdef SEC_INF_TIMELINES
+	stats->pp_newsecinf_timeline[j]=stats->newsecinf_timeline[i];
+#endif
+      }
+
+      if(tlchans&std_stats_tl_postest) {
+	stats->pp_newpostest_timeline[j]=stats->newpostest_timeline[i];
+#ifdef SEC_INF_TIMELINES
+	stats->pp_newsecpostest_timeline[j]=stats->newsecpostest_timeline[i];
+#endif
+      }
+
+      if(tlchans&std_stats_tl_ext) {
+	stats->pp_ext_timeline[j].n=stats->ext_timeline[i].n;
+	stats->pp_ext_timeline[j].rsum=stats->ext_timeline[i].rsum;
+	stats->pp_ext_timeline[j].r2sum=stats->ext_timeline[i].r2sum;
+#ifdef OBSREFF_OUTPUT
+	stats->pp_ext_timeline[j].nobs=stats->ext_timeline[i].nobs;
+	stats->pp_ext_timeline[j].robssum=stats->ext_timeline[i].robssum;
+	stats->pp_ext_timeline[j].robs2sum=stats->ext_timeline[i].robs2sum;
+#endif
+      }
     } 
 
     //Check if the first (negative) index is odd. If it is, there is a single fine bin in
@@ -314,48 +427,70 @@ inline static bool std_stats_path_end(sim_vars* sv)
 
     for(k=-1; k>=j; --k) {
       i=2*k;
-      DEBUG_PRINTF("[%i] = [%i] (%u) + [%i] (%u)\n",k,i+tlppt0idx,stats->pp_inf_timeline[i],i+1+tlppt0idx,stats->pp_inf_timeline[i+1]);
-      stats->pp_inf_timeline[k]=(stats->pp_inf_timeline[i]>stats->pp_inf_timeline[i+1]?stats->pp_inf_timeline[i]:stats->pp_inf_timeline[i+1]);
-      stats->pp_newinf_timeline[k]=stats->pp_newinf_timeline[i]+stats->pp_newinf_timeline[i+1];
-      #ifdef SEC_INF_TIMELINES
-      stats->pp_secinf_timeline[k]=(stats->pp_secinf_timeline[i]>stats->pp_secinf_timeline[i+1]?stats->pp_secinf_timeline[i]:stats->pp_secinf_timeline[i+1]);
-      stats->pp_newsecinf_timeline[k]=stats->pp_newsecinf_timeline[i]+stats->pp_newsecinf_timeline[i+1];
-      #endif
 
-      stats->pp_ext_timeline[k].n=stats->pp_ext_timeline[i].n+stats->pp_ext_timeline[i+1].n;
-      stats->pp_ext_timeline[k].rsum=stats->pp_ext_timeline[i].rsum+stats->pp_ext_timeline[i+1].rsum;
-      stats->pp_ext_timeline[k].r2sum=stats->pp_ext_timeline[i].rsum+stats->pp_ext_timeline[i+1].r2sum;
-      #ifdef OBSREFF_OUTPUT
-      stats->pp_ext_timeline[k].nobs=stats->pp_ext_timeline[i].nobs+stats->pp_ext_timeline[i+1].nobs;
-      stats->pp_ext_timeline[k].robssum=stats->pp_ext_timeline[i].robssum+stats->pp_ext_timeline[i+1].robssum;
-      stats->pp_ext_timeline[k].robs2sum=stats->pp_ext_timeline[i].robs2sum+stats->pp_ext_timeline[i+1].robs2sum;
-      #endif
+      if(tlchans&std_stats_tl_inf) {
+	DEBUG_PRINTF("[%i] = [%i] (%u) + [%i] (%u)\n",k,i+tlppt0idx,stats->pp_inf_timeline[i],i+1+tlppt0idx,stats->pp_inf_timeline[i+1]);
+	stats->pp_inf_timeline[k]=(stats->pp_inf_timeline[i]>stats->pp_inf_timeline[i+1]?stats->pp_inf_timeline[i]:stats->pp_inf_timeline[i+1]);
+#ifdef SEC_INF_TIMELINES
+	stats->pp_secinf_timeline[k]=(stats->pp_secinf_timeline[i]>stats->pp_secinf_timeline[i+1]?stats->pp_secinf_timeline[i]:stats->pp_secinf_timeline[i+1]);
+#endif
+      }
+
+      if(tlchans&std_stats_tl_newinf) {
+	stats->pp_newinf_timeline[k]=stats->pp_newinf_timeline[i]+stats->pp_newinf_timeline[i+1];
+#ifdef SEC_INF_TIMELINES
+	stats->pp_newsecinf_timeline[k]=stats->pp_newsecinf_timeline[i]+stats->pp_newsecinf_timeline[i+1];
+#endif
+      }
+
+      if(tlchans&std_stats_tl_ext) {
+	stats->pp_ext_timeline[k].n=stats->pp_ext_timeline[i].n+stats->pp_ext_timeline[i+1].n;
+	stats->pp_ext_timeline[k].rsum=stats->pp_ext_timeline[i].rsum+stats->pp_ext_timeline[i+1].rsum;
+	stats->pp_ext_timeline[k].r2sum=stats->pp_ext_timeline[i].rsum+stats->pp_ext_timeline[i+1].r2sum;
+#ifdef OBSREFF_OUTPUT
+	stats->pp_ext_timeline[k].nobs=stats->pp_ext_timeline[i].nobs+stats->pp_ext_timeline[i+1].nobs;
+	stats->pp_ext_timeline[k].robssum=stats->pp_ext_timeline[i].robssum+stats->pp_ext_timeline[i+1].robssum;
+	stats->pp_ext_timeline[k].robs2sum=stats->pp_ext_timeline[i].robs2sum+stats->pp_ext_timeline[i+1].robs2sum;
+#endif
+      }
     }
 
     if(single) {
       i=-stats->tlshift;
-      DEBUG_PRINTF("[%i] = [%i] (%u)\n",j-1,i,stats->inf_timeline[i]);
-      stats->pp_inf_timeline[j-1]=stats->inf_timeline[i];
-      stats->pp_newinf_timeline[j-1]=stats->newinf_timeline[i];
-      #ifdef SEC_INF_TIMELINES
-      stats->pp_secinf_timeline[j-1]=stats->secinf_timeline[i];
-      stats->pp_newsecinf_timeline[j-1]=stats->newsecinf_timeline[i];
-      #endif
 
-      stats->pp_ext_timeline[j-1].n=stats->ext_timeline[i].n;
-      stats->pp_ext_timeline[j-1].rsum=stats->ext_timeline[i].rsum;
-      stats->pp_ext_timeline[j-1].r2sum=stats->ext_timeline[i].r2sum;
-      #ifdef OBSREFF_OUTPUT
-      stats->pp_ext_timeline[j-1].nobs=stats->ext_timeline[i].nobs;
-      stats->pp_ext_timeline[j-1].robssum=stats->ext_timeline[i].robssum;
-      stats->pp_ext_timeline[j-1].robs2sum=stats->ext_timeline[i].robs2sum;
-      #endif
+      if(tlchans&std_stats_tl_inf) {
+	DEBUG_PRINTF("[%i] = [%i] (%u)\n",j-1,i,stats->inf_timeline[i]);
+	stats->pp_inf_timeline[j-1]=stats->inf_timeline[i];
+#ifdef SEC_INF_TIMELINES
+	stats->pp_secinf_timeline[j-1]=stats->secinf_timeline[i];
+#endif
+      }
+
+      if(tlchans&std_stats_tl_newinf) {
+	stats->pp_newinf_timeline[j-1]=stats->newinf_timeline[i];
+#ifdef SEC_INF_TIMELINES
+	stats->pp_newsecinf_timeline[j-1]=stats->newsecinf_timeline[i];
+#endif
+      }
+
+      if(tlchans&std_stats_tl_ext) {
+	stats->pp_ext_timeline[j-1].n=stats->ext_timeline[i].n;
+	stats->pp_ext_timeline[j-1].rsum=stats->ext_timeline[i].rsum;
+	stats->pp_ext_timeline[j-1].r2sum=stats->ext_timeline[i].r2sum;
+#ifdef OBSREFF_OUTPUT
+	stats->pp_ext_timeline[j-1].nobs=stats->ext_timeline[i].nobs;
+	stats->pp_ext_timeline[j-1].robssum=stats->ext_timeline[i].robssum;
+	stats->pp_ext_timeline[j-1].robs2sum=stats->ext_timeline[i].robs2sum;
+#endif
+      }
     } 
 
-    memset(stats->pp_newpostest_timeline-stats->tlppnnpers,0,stats->tlppnnpers*sizeof(uint32_t));
-    #ifdef SEC_INF_TIMELINES
-    memset(stats->pp_newsecpostest_timeline-stats->tlppnnpers,0,stats->tlppnnpers*sizeof(uint32_t));
-    #endif
+    if(tlchans&std_stats_tl_postest) {
+      memset(stats->pp_newpostest_timeline-stats->tlppnnpers,0,stats->tlppnnpers*sizeof(uint32_t));
+#ifdef SEC_INF_TIMELINES
+      memset(stats->pp_newsecpostest_timeline-stats->tlppnnpers,0,stats->tlppnnpers*sizeof(uint32_t));
+#endif
+    }
 
   } else {
     stats->tlppnnpers=stats->tlshift;
@@ -393,6 +528,10 @@ inline static bool std_stats_path_end(sim_vars* sv)
 
   }
 
+  if(!(tlchans&std_stats_tl_ext)) return includepath;
+
+  ext_timeline_info* const et=stats->ext_timeline-stats->tlshift;
+
   if(stats->ninfbins) {
 
     for(i=tnvpers-2; i>=0; --i) {
@@ -445,9 +584,37 @@ inline static bool std_stats_path_end(sim_vars* sv)
  **/
 void std_stats_free(std_summary_stats* stats);
 
-inline static void std_stats_pri_init(sim_vars* sv, infindividual* parent, infindividual* child) {
+/**
+ * @brief Copies the state of the current path of standard summary
+ * statistics.
+ *
+ * This function can be used to resample paths that are suspended by the
+ * time-ordered simulation. Both summary statistics must have been
+ * initialised using the same arguments, and the path of the source summary
+ * statistics must not have ended.
+ *
+ * @param dst: Pointer to the destination standard summary statistics.
+ * @param src: Pointer to the source standard summary statistics.
+ **/
+void std_stats_path_copy(std_summary_stats* dst, std_summary_stats const* src);
+
+/**
+ * @brief Compares the states of the current paths of two standard summary
+ * statistics.
+ *
+ * This function can be used to check that a path that is resumed from a
+ * copy made by std_stats_path_copy is identical to the original path. Both
+ * summary statistics must have been initialised using the same arguments.
+ *
+ * @param stats1: Pointer to the first standard summary statistics.
+ * @param stats2: Pointer to the second standard summary statistics.
+ * @return true if the states of the paths are identical.
+ **/
+bool std_stats_path_equal(std_summary_stats const* stats1, std_summary_stats const* stats2);
+
+inline static void std_stats_pri_init_gen(sim_vars* sv, infindividual* parent, infindividual* child, const uint32_t tlchans) {
   //We have to use parent here!
-  if(sv->event_time < ((std_summary_stats*)sv->dataptr)->abs_tmax && parent->generation <= ((std_summary_stats*)sv->dataptr)->lmax) {
+  if((tlchans&std_stats_tl_newinf) && sv->event_time < ((std_summary_stats*)sv->dataptr)->abs_tmax && parent->generation <= ((std_summary_stats*)sv->dataptr)->lmax) {
     DEBUG_PRINTF("Pri inf at %i\n",(int)floor(((std_summary_stats*)sv->dataptr)->nbinsperunit*sv->event_time));
     ((std_summary_stats*)sv->dataptr)->newinf_timeline[(int)floor(((std_summary_stats*)sv->dataptr)->nbinsperunit*sv->event_time)]+=parent->ninfections;
 #ifdef SEC_INF_TIMELINES
@@ -456,6 +623,28 @@ inline static void std_stats_pri_init(sim_vars* sv, infindividual* parent, infin
   }
 }
 
+/**
+ * @brief Extends a timeline towards negative time indices.
+ *
+ * The current content of the timeline is preserved and the new bins are
+ * zeroed. The memory of the current timeline is freed.
+ *
+ * @param timeline: Timeline, shifted by stats->tlshifta.
+ * @param stats: Pointer to the standard summary statistics.
+ * @param newshift: New allocated negative shift.
+ * @param newsize: New allocated size.
+ * @return the new timeline, shifted by newshift.
+ */
+inline static uint32_t* std_stats_timeline_grow_front(uint32_t* timeline, std_summary_stats const* stats, const uint32_t newshift, const uint32_t newsize)
+{
+  const uint32_t dshift=newshift-stats->tlshifta;
+  uint32_t* newarray=(uint32_t*)malloc(newsize*sizeof(uint32_t));
+  memset(newarray,0,dshift*sizeof(uint32_t));
+  memcpy(newarray+dshift,timeline-stats->tlshifta,stats->tnpersa*sizeof(uint32_t));
+  free(timeline-stats->tlshifta);
+  return newarray+newshift;
+}
+
 /**
  * @brief Allocates memory for a new primary individual.
  *
@@ -464,8 +653,9 @@ inline static void std_stats_pri_init(sim_vars* sv, infindividual* parent, infin
  *
  * @param sv: Pointer to the simulation variables.
  * @param ii: Infectious individuals.
+ * @param tlchans: Filled timeline channels.
  **/
-inline static void std_stats_pri_init_rel(sim_vars* sv, infindividual* parent, infindividual* child)
+inline static void std_stats_pri_init_rel_gen(sim_vars* sv, infindividual* parent, infindividual* child, const uint32_t tlchans)
 {
   const int32_t newshift=ceil(((std_summary_stats*)sv->dataptr)->nbinsperunit*(-child->end_comm_period+(child->comm_period+child->latent_period)));
 
@@ -477,87 +667,56 @@ inline static void std_stats_pri_init_rel(sim_vars* sv, infindividual* parent, i
       const uint32_t dshift=newshift-stats->tlshifta;
       const uint32_t newsize=newshift+stats->npers;
 
-      uint32_t* newarray=(uint32_t*)malloc(newsize*sizeof(uint32_t));
-      memset(newarray,0,dshift*sizeof(uint32_t));
-      memcpy(newarray+dshift,stats->inf_timeline-stats->tlshifta,stats->tnpersa*sizeof(uint32_t));
-      free(stats->inf_timeline-stats->tlshifta);
-      stats->inf_timeline=newarray+newshift;
-
-      newarray=(uint32_t*)malloc(newsize*sizeof(uint32_t));
-      memset(newarray,0,dshift*sizeof(uint32_t));
-      memcpy(newarray+dshift,stats->newinf_timeline-stats->tlshifta,stats->tnpersa*sizeof(uint32_t));
-      free(stats->newinf_timeline-stats->tlshifta);
-      stats->newinf_timeline=newarray+newshift;
-
-      newarray=(uint32_t*)malloc(newsize*sizeof(uint32_t));
-      memset(newarray,0,dshift*sizeof(uint32_t));
-      memcpy(newarray+dshift,stats->postest_timeline-stats->tlshifta,stats->tnpersa*sizeof(uint32_t));
-      free(stats->postest_timeline-stats->tlshifta);
-      stats->postest_timeline=newarray+newshift;
-
-      newarray=(uint32_t*)malloc(newsize*sizeof(uint32_t));
-      memset(newarray,0,dshift*sizeof(uint32_t));
-      memcpy(newarray+dshift,stats->newpostest_timeline-stats->tlshifta,stats->tnpersa*sizeof(uint32_t));
-      free(stats->newpostest_timeline-stats->tlshifta);
-      stats->newpostest_timeline=newarray+newshift;
+      if(tlchans&std_stats_tl_inf) {
+	stats->inf_timeline=std_stats_timeline_grow_front(stats->inf_timeline,stats,newshift,newsize);
+#ifdef SEC_INF_TIMELINES
+	stats->secinf_timeline=std_stats_timeline_grow_front(stats->secinf_timeline,stats,newshift,newsize);
+#endif
+      }
 
-      #ifdef SEC_INF_TIMELINES
-      memset(newarray,0,dshift*sizeof(uint32_t));
-      memcpy(newarray+dshift,stats->secinf_timeline-stats->tlshifta,stats->tnpersa*sizeof(uint32_t));
-      free(stats->secinf_timeline-stats->tlshifta);
-      stats->secinf_timeline=newarray+newshift;
-
-      newarray=(uint32_t*)malloc(newsize*sizeof(uint32_t));
-      memset(newarray,0,dshift*sizeof(uint32_t));
-      memcpy(newarray+dshift,stats->newsecinf_timeline-stats->tlshifta,stats->tnpersa*sizeof(uint32_t));
-      free(stats->newsecinf_timeline-stats->tlshifta);
-      stats->newsecinf_timeline=newarray+newshift;
-
-      newarray=(uint32_t*)malloc(newsize*sizeof(uint32_t));
-      memset(newarray,0,dshift*sizeof(uint32_t));
-      memcpy(newarray+dshift,stats->secpostest_timeline-stats->tlshifta,stats->tnpersa*sizeof(uint32_t));
-      free(stats->secpostest_timeline-stats->tlshifta);
-      stats->secpostest_timeline=newarray+newshift;
-
-      newarray=(uint32_t*)malloc(newsize*sizeof(uint32_t));
-      memset(newarray,0,dshift*sizeof(uint32_t));
-      memcpy(newarray+dshift,stats->newsecpostest_timeline-stats->tlshifta,stats->tnpersa*sizeof(uint32_t));
-      free(stats->newsecpostest_timeline-stats->tlshifta);
-      stats->newsecpostest_timeline=newarray+newshift;
-      #endif
+      if(tlchans&std_stats_tl_newinf) {
+	stats->newinf_timeline=std_stats_timeline_grow_front(stats->newinf_timeline,stats,newshift,newsize);
+#ifdef SEC_INF_TIMELINES
+	stats->newsecinf_timeline=std_stats_timeline_grow_front(stats->newsecinf_timeline,stats,newshift,newsize);
+#endif
+      }
 
-      ext_timeline_info* newarray_ext=malloc(newsize*sizeof(ext_timeline_info));
-      memset(newarray_ext,0,dshift*sizeof(ext_timeline_info));
-      memcpy(newarray_ext+dshift,stats->ext_timeline-stats->tlshifta,stats->tnpersa*sizeof(ext_timeline_info));
-      free(stats->ext_timeline-stats->tlshifta);
+      if(tlchans&std_stats_tl_postest) {
+	stats->postest_timeline=std_stats_timeline_grow_front(stats->postest_timeline,stats,newshift,newsize);
+	stats->newpostest_timeline=std_stats_timeline_grow_front(stats->newpostest_timeline,stats,newshift,newsize);
+#ifdef SEC_INF_TIMELINES
+	stats->secpostest_timeline=std_stats_timeline_grow_front(stats->secpostest_timeline,stats,newshift,newsize);
+	stats->newsecpostest_timeline=std_stats_timeline_grow_front(stats->newsecpostest_timeline,stats,newshift,newsize);
+#endif
+      }
 
-      int32_t i;
+      if(tlchans&std_stats_tl_ext) {
+	ext_timeline_info* newarray_ext=malloc(newsize*sizeof(ext_timeline_info));
+	memset(newarray_ext,0,dshift*sizeof(ext_timeline_info));
+	memcpy(newarray_ext+dshift,stats->ext_timeline-stats->tlshifta,stats->tnpersa*sizeof(ext_timeline_info));
+	free(stats->ext_timeline-stats->tlshifta);
 
-      if(stats->nainfbins) {
-	uint64_t* newarray64;
+	int32_t i;
 
-	for(i=dshift-1; i>=0; --i) {
-	  newarray64=(uint64_t*)malloc(stats->nainfbins*sizeof(uint64_t));
-	  memset(newarray64,0,stats->nainfbins*sizeof(uint64_t));
-	  newarray_ext[i].ngeninfs=newarray64;
-	  //printf("ext_timeline[%i].ngeninfs=%p\n",i-newshift,newarray64);
+	if(stats->nainfbins) {
+	  uint64_t* newarray64;
+
+	  for(i=dshift-1; i>=0; --i) {
+	    newarray64=(uint64_t*)malloc(stats->nainfbins*sizeof(uint64_t));
+	    memset(newarray64,0,stats->nainfbins*sizeof(uint64_t));
+	    newarray_ext[i].ngeninfs=newarray64;
+	    //printf("ext_timeline[%i].ngeninfs=%p\n",i-newshift,newarray64);
+	  }
 	}
+	stats->ext_timeline=newarray_ext+newshift;
       }
-      stats->ext_timeline=newarray_ext+newshift;
 
       stats->tlshifta=newshift;
       stats->tnpersa=newsize;
     }
   }
 
-  //We have to use parent here!
-  if(sv->event_time < ((std_summary_stats*)sv->dataptr)->abs_tmax && parent->generation <= ((std_summary_stats*)sv->dataptr)->lmax) {
-    DEBUG_PRINTF("Pri inf at %i\n",(int)floor(((std_summary_stats*)sv->dataptr)->nbinsperunit*sv->event_time));
-    ((std_summary_stats*)sv->dataptr)->newinf_timeline[(int)floor(((std_summary_stats*)sv->dataptr)->nbinsperunit*sv->event_time)]+=parent->ninfections;
-#ifdef SEC_INF_TIMELINES
-    ((std_summary_stats*)sv->dataptr)->newsecinf_timeline[(int)floor(((std_summary_stats*)sv->dataptr)->nbinsperunit*sv->event_time)]+=parent->ninfectionsp;
-#endif
-  }
+  std_stats_pri_init_gen(sv, parent, child, tlchans);
 }
 
 /**
@@ -572,28 +731,173 @@ inline static void std_stats_ii_alloc(infindividual* ii){
   ii->dataptr=malloc(sizeof(std_stats_inf_data));
 }
 
+/**
+ * @brief Enables the recording of the transmission tree of each path.
+ *
+ * This function must be called after std_stats_init.
+ *
+ * @param stats: Pointer to the standard summary statistics.
+ */
+inline static void std_stats_record_tree(std_summary_stats* stats)
+{
+  stats->natreenodes=INIT_NATREENODES;
+  stats->treenodes=(tree_node*)malloc(INIT_NATREENODES*sizeof(tree_node));
+  stats->ntreenodes=0;
+}
+
+/**
+ * @brief Adds a transmission tree node for a new infectious individual.
+ *
+ * Nodes are added in the order the individuals are created, such that the
+ * index of a parent node is always smaller than the index of its children.
+ * The number of infections from the individual is set once its last
+ * transmission event has been processed.
+ *
+ * @param stats: Pointer to the standard summary statistics.
+ * @param ii: Infectious individual.
+ * @param parent: Infectious individual's parent.
+ */
+inline static void std_stats_add_tree_node(std_summary_stats* stats, infindividual* ii, infindividual* parent)
+{
+  if(stats->ntreenodes==stats->natreenodes) {
+    stats->natreenodes*=TREENODES_GROWFACT;
+    stats->treenodes=(tree_node*)realloc(stats->treenodes,stats->natreenodes*sizeof(tree_node));
+  }
+  tree_node* const node=stats->treenodes+stats->ntreenodes;
+  ((std_stats_inf_data*)ii->dataptr)->treeid=stats->ntreenodes;
+  ++(stats->ntreenodes);
+
+  node->end_comm_period=ii->end_comm_period;
+  node->end_latent_period=ii->end_comm_period-ii->comm_period;
+  node->inftime=node->end_latent_period-ii->latent_period;
+
+  //Primary individuals are generated by the root individual
+  if(parent->generation) {
+    node->parent=((std_stats_inf_data*)parent->dataptr)->treeid;
+    node->event=((std_stats_inf_data*)parent->dataptr)->ninfevents-1;
+
+  } else {
+    node->parent=UINT32_MAX;
+    node->event=0;
+  }
+  node->generation=ii->generation;
+  node->ninf=0;
+  node->commpertype=ii->commpertype;
+  DEBUG_PRINTF("%s: %u %u %u %22.15e\n",__func__, stats->ntreenodes-1, node->parent, node->event, node->inftime);
+}
+
 #ifdef CT_OUTPUT
 inline static void std_stats_add_ct_entry(std_summary_stats* stats, const double postesttime, const double presymtime, const int32_t id, const int32_t pid, const uint32_t ntracedcts){
-  ++(stats->nctentries);
-  DEBUG_PRINTF("%s: %u %22.15e %22.15e %i %i %u\n",__func__, stats->nctentries, postesttime, presymtime, id, pid, ntracedcts);
+  DEBUG_PRINTF("%s: %u %22.15e %22.15e %i %i %u\n",__func__, stats->nctentries+1, postesttime, presymtime, id, pid, ntracedcts);
 
   if(stats->nctentries==stats->nactentries) {
     stats->nactentries*=CTENTRIES_GROWFACT;
-    stats->ctentries=(ctposinf**)realloc(stats->ctentries,stats->nactentries*sizeof(ctposinf*));
+    stats->ctentries=(ctposinf*)realloc(stats->ctentries,stats->nactentries*sizeof(ctposinf));
+    stats->ctsortbuf=(ctposinf*)realloc(stats->ctsortbuf,stats->nactentries*sizeof(ctposinf));
+  }
+  ctposinf* const entry=stats->ctentries+stats->nctentries;
+  ++(stats->nctentries);
 
-    int32_t i;
-    for(i=stats->nctentries; i<stats->nactentries; ++i) stats->ctentries[i]=(ctposinf*)malloc(sizeof(ctposinf));
+  entry->postesttime=postesttime*1440; //time in minutes
+  entry->presymtime=(isinf(presymtime)?INT32_MAX:presymtime*1440); //time in minutes
+  entry->id=id;
+  entry->pid=pid;
+  entry->ntracedcts=ntracedcts;
+  DEBUG_PRINTF("%s: Encoded: %i %i %u %u %u\n",__func__, entry->postesttime, entry->presymtime, entry->id, entry->pid, entry->ntracedcts);
+}
+
+/**
+ * @brief Sorts the contact tracing entries of the current path by positive
+ * test time.
+ *
+ * A stable LSD radix sort is performed on the integer positive test time.
+ * Passes for which all entries share the same digit are skipped.
+ *
+ * @param stats: Pointer to the standard summary statistics.
+ */
+inline static void std_stats_sort_ct_entries(std_summary_stats* stats)
+{
+  const uint32_t n=stats->nctentries;
+
+  if(n<2) return;
+  uint32_t counts[32/CTSORT_RADIX_BITS][CTSORT_NBUCKETS];
+  uint32_t i, p, key;
+  ctposinf* src=stats->ctentries;
+  ctposinf* dst=stats->ctsortbuf;
+  ctposinf* swap;
+
+  memset(counts,0,sizeof(counts));
+
+  //Flipping the sign bit maps signed times onto ordered unsigned keys
+  for(i=0; i<n; ++i) {
+    key=(uint32_t)src[i].postesttime^UINT32_C(0x80000000);
+
+    for(p=0; p<32/CTSORT_RADIX_BITS; ++p) ++counts[p][(key>>(p*CTSORT_RADIX_BITS))&(CTSORT_NBUCKETS-1)];
   }
 
-  stats->ctentries[stats->nctentries-1]->postesttime=postesttime*1440; //time in minutes
-  stats->ctentries[stats->nctentries-1]->presymtime=(isinf(presymtime)?INT32_MAX:presymtime*1440); //time in minutes
-  stats->ctentries[stats->nctentries-1]->id=id;
-  stats->ctentries[stats->nctentries-1]->pid=pid;
-  stats->ctentries[stats->nctentries-1]->ntracedcts=ntracedcts;
-  DEBUG_PRINTF("%s: Encoded: %i %i %u %u %u\n",__func__,  stats->ctentries[stats->nctentries-1]->postesttime, stats->ctentries[stats->nctentries-1]->presymtime, stats->ctentries[stats->nctentries-1]->id=id, stats->ctentries[stats->nctentries-1]->pid=pid, stats->ctentries[stats->nctentries-1]->ntracedcts);
+  for(p=0; p<32/CTSORT_RADIX_BITS; ++p) {
+    const uint32_t shift=p*CTSORT_RADIX_BITS;
+    uint32_t* const cnt=counts[p];
+
+    if(cnt[(((uint32_t)src[0].postesttime^UINT32_C(0x80000000))>>shift)&(CTSORT_NBUCKETS-1)]==n) continue;
+    uint32_t sum=0, c;
+
+    for(i=0; i<CTSORT_NBUCKETS; ++i) {
+      c=cnt[i];
+      cnt[i]=sum;
+      sum+=c;
+    }
+
+    for(i=0; i<n; ++i) dst[cnt[(((uint32_t)src[i].postesttime^UINT32_C(0x80000000))>>shift)&(CTSORT_NBUCKETS-1)]++]=src[i];
+    swap=src;
+    src=dst;
+    dst=swap;
+  }
+
+  if(src!=stats->ctentries) {
+    stats->ctsortbuf=stats->ctentries;
+    stats->ctentries=src;
+  }
 }
 #endif
 
+#ifdef OBSREFF_OUTPUT
+/**
+ * @brief Computes the number of interrupted child infections whose
+ * communicable period ends after the interruption time.
+ *
+ * Only the periods that determine if the interruption occurs before the
+ * natural end of the communicable period are generated. When the latent,
+ * communicable and interrupted periods are all fixed, the outcome is the same
+ * for all child infections and no random number is drawn.
+ *
+ * @param sv: Pointer to the simulation variables.
+ * @param ecp0: Parent end of communicable period plus the test results delay.
+ * @param n: Number of interrupted child infections.
+ * @param alt: Indicates if the children have an alternate communicable period.
+ * @return the number of child infections whose interruption ends their
+ * communicable period.
+ */
+inline static uint32_t std_stats_n_int_before_end(sim_vars* sv, const double ecp0, const uint32_t n, const bool alt)
+{
+  const model_pars* pars=&sv->pars;
+  const bool fixedlat=!(pars->kappal<INFINITY);
+  const bool fixedcomm=isinf(alt?pars->kappaq:pars->kappa);
+  const bool fixedint=isinf(alt?pars->kappaim:pars->kappait);
+  const double lat=(isnan(pars->kappal)?0:pars->lbar);
+  const double comm=(alt?pars->mbar:pars->tbar);
+  const double intper=(alt?pars->imbar:pars->itbar);
+
+  if(!n) return 0;
+
+  if(fixedlat && fixedcomm && fixedint) return (ecp0 + intper < sv->event_time + lat + comm ? n : 0);
+  uint32_t nint=0;
+  uint32_t i;
+
+  for(i=n; i>0; --i) nint+=(ecp0 + (fixedint?intper:(alt?gsl_ran_gamma(sv->r, pars->ima, pars->imb):gsl_ran_gamma(sv->r, pars->ita, pars->itb))) < sv->event_time + (fixedlat?lat:gsl_ran_gamma(sv->r, pars->la, pars->lb)) + (fixedcomm?comm:(alt?gsl_ran_gamma(sv->r, pars->ma, pars->mb):gsl_ran_gamma(sv->r, pars->ta, pars->tb))));
+  return nint;
+}
+
 /**
  * @brief Compute the number of observed child infections for events occurring
  * after a time cut.
@@ -601,13 +905,23 @@ inline static void std_stats_add_ct_entry(std_summary_stats* stats, const double
  * Adds the number of observed infections for the current event to the number of observed infections from
  * the current infectious individual, for events that return false.
  *
+ * Since all infections of an event are generated independently, the number
+ * of observed infections is obtained by successively splitting the number of
+ * interruptible infections using binomial draws, according to the
+ * communicable period type, to the interruption probability and to the
+ * true positive rates. Periods are only generated for the infections whose
+ * observation depends on the interruption time (see
+ * std_stats_n_int_before_end). With DUAL_PINF, the time periods of each
+ * infection are generated, since the alternate period probability depends on
+ * the child infection.
+ *
  * @param sv: Pointer to the simulation variables.
  */
-#ifdef OBSREFF_OUTPUT
 inline static void std_stats_calc_obs_child_inf_after_time_cut(sim_vars* sv, infindividual* ii)
 {
   //This will not work for the finite population algorithm 
     if(ii->commpertype&ro_commper_true_positive_test) {
+#ifdef DUAL_PINF
       std_summary_stats* stats=(std_summary_stats*)sv->dataptr;
       uint32_t ci;
 
@@ -623,8 +937,38 @@ inline static void std_stats_calc_obs_child_inf_after_time_cut(sim_vars* sv, inf
 	sv->gen_time_periods_func(sv, &stats->iibuf, ii, sv->event_time);
 #endif
 	((std_stats_inf_data*)ii->dataptr)->nobsinf+=((stats->iibuf.commpertype&ro_commper_int_true_positive_test)==ro_commper_int_true_positive_test);
-	DEBUG_PRINTF("Adding %u to the number of observed infections, for a total of %u\n",((stats->iibuf.commpertype&ro_commper_true_positive_test)!=0),((std_stats_inf_data*)ii->dataptr)->nobsinf);
       }
+#else
+      const model_pars* pars=&sv->pars;
+#ifdef CT_OUTPUT
+      //Only successfully traced infections can be interrupted
+      const uint32_t n=ii->ntracedicts;
+      const double pit=(pars->pit>0?pars->pitnet:0);
+      const double pim=(pars->q>0 && pars->pim>0?pars->pimnet:0);
+#else
+      const uint32_t n=ii->ninfections;
+      const double pit=(pars->pit>0?pars->pit:0);
+      const double pim=(pars->q>0 && pars->pim>0?pars->pim:0);
+#endif
+      const double q=(pars->q>0?pars->q:0);
+      const double ttpr=(pars->ttpr>0?pars->ttpr:0);
+      const double mtpr=(isnan(pars->tdeltat) || !(pars->mtpr>0)?0:pars->mtpr);
+      const double ecp0=ii->end_comm_period + pars->tdeltat;
+      //Interrupted main period infections with a true positive test
+      const double pmain=(1-q)*pit*ttpr;
+      const uint32_t nmain=(pmain>0 && n?gsl_ran_binomial(sv->r, pmain, n):0);
+      //Interrupted alternate period infections, out of the remaining ones
+      const uint32_t nalt=(pim>0 && n>nmain?gsl_ran_binomial(sv->r, q*pim/(1-pmain), n-nmain):0);
+      //Interrupted alternate period infections that were tested positive
+      //independently of the interruption time
+      const uint32_t nalttested=(mtpr>0 && nalt?gsl_ran_binomial(sv->r, mtpr, nalt):0);
+      //Remaining interrupted alternate period infections that are tested
+      //positive if the interruption occurs before the end of the period
+      const uint32_t nalttestedint=(mtpr>0 && nalt>nalttested?gsl_ran_binomial(sv->r, mtpr, nalt-nalttested):0);
+
+      ((std_stats_inf_data*)ii->dataptr)->nobsinf+=std_stats_n_int_before_end(sv, ecp0, nmain, false) + nalttested + std_stats_n_int_before_end(sv, ecp0, nalttestedint, true);
+#endif
+      DEBUG_PRINTF("Number of observed infections is now %u\n",((std_stats_inf_data*)ii->dataptr)->nobsinf);
     }
 }
 #endif
@@ -638,10 +982,11 @@ inline static void std_stats_calc_obs_child_inf_after_time_cut(sim_vars* sv, inf
  * the simulation engine through a call of sim_set_new_event_proc_func.
  *
  * @param sv: Pointer to the simulation variables.
+ * @param tlchans: Filled timeline channels.
  * @return true if the event time is before abs_tmax and new infections were
  * generated, and false otherwise.
  **/
-inline static bool std_stats_new_event(sim_vars* sv, infindividual* ii)
+inline static bool std_stats_new_event_gen(sim_vars* sv, infindividual* ii, const uint32_t tlchans)
 {
 #ifdef CT_OUTPUT
   ((std_stats_inf_data*)ii->dataptr)->ntracedcts+=ii->ntracednicts+ii->ntracedicts;
@@ -650,13 +995,17 @@ inline static bool std_stats_new_event(sim_vars* sv, infindividual* ii)
 
   if(ii->ninfections) {
     ((std_stats_inf_data*)ii->dataptr)->ninf+=ii->ninfections;
+    ++(((std_stats_inf_data*)ii->dataptr)->ninfevents);
     DEBUG_PRINTF("%s: Number of infections incremented to %u\n",__func__,((std_stats_inf_data*)ii->dataptr)->ninf);
 
     if(sv->event_time < ((std_summary_stats*)sv->dataptr)->abs_tmax && ii->generation <= ((std_summary_stats*)sv->dataptr)->lmax) {
-      ((std_summary_stats*)sv->dataptr)->newinf_timeline[(int)floor(((std_summary_stats*)sv->dataptr)->nbinsperunit*sv->event_time)]+=ii->ninfections;
+
+      if(tlchans&std_stats_tl_newinf) {
+	((std_summary_stats*)sv->dataptr)->newinf_timeline[(int)floor(((std_summary_stats*)sv->dataptr)->nbinsperunit*sv->event_time)]+=ii->ninfections;
 #ifdef SEC_INF_TIMELINES
-      ((std_summary_stats*)sv->dataptr)->newsecinf_timeline[(int)floor(((std_summary_stats*)sv->dataptr)->nbinsperunit*sv->event_time)]+=ii->ninfectionsp;
+	((std_summary_stats*)sv->dataptr)->newsecinf_timeline[(int)floor(((std_summary_stats*)sv->dataptr)->nbinsperunit*sv->event_time)]+=ii->ninfectionsp;
 #endif
+      }
       return true;
     }
 #ifdef OBSREFF_OUTPUT
@@ -675,7 +1024,8 @@ inline static bool std_stats_new_event(sim_vars* sv, infindividual* ii)
  * exceeds nimax, then set the extinction for the current path to false and
  * update the value for the minimum time index where the maximum number of
  * infectious individuals was exceeded if required. This function must be assigned to
- * the simulation engine through a call of sim_set_new_event_proc_func.
+ * the simulation engine through a call of sim_set_new_event_proc_func. The
+ * std_stats_tl_newinf channel must be filled.
  *
  * @param sv: Pointer to the simulation variables.
  * @return true if the event time is before abs_tmax and new infections were
@@ -690,6 +1040,7 @@ inline static bool std_stats_new_event_nimax(sim_vars* sv, infindividual* ii)
 
   if(ii->ninfections) {
     ((std_stats_inf_data*)ii->dataptr)->ninf+=ii->ninfections;
+    ++(((std_stats_inf_data*)ii->dataptr)->ninfevents);
     DEBUG_PRINTF("%s: Number of infections incremented to %u\n",__func__,((std_stats_inf_data*)ii->dataptr)->ninf);
 
     if(sv->event_time < ((std_summary_stats*)sv->dataptr)->abs_tmax) {
@@ -741,13 +1092,15 @@ nimax_event_false:
  * exceeds npostestmax, then set the extinction for the current path to false and
  * update the value for the minimum time index where the maximum number of
  * recent positive test results was exceeded if required. This function must be assigned to
- * the simulation engine through a call of sim_set_new_event_proc_func.
+ * the simulation engine through a call of sim_set_new_event_proc_func. The
+ * std_stats_tl_postest channel must be filled.
  *
  * @param sv: Pointer to the simulation variables.
+ * @param tlchans: Filled timeline channels.
  * @return true if the event time is before abs_tmax and new infections were
  * generated, and false otherwise.
  **/
-inline static bool std_stats_new_event_npostestmax(sim_vars* sv, infindividual* ii)
+inline static bool std_stats_new_event_npostestmax_gen(sim_vars* sv, infindividual* ii, const uint32_t tlchans)
 {
 #ifdef CT_OUTPUT
   ((std_stats_inf_data*)ii->dataptr)->ntracedcts+=ii->ntracednicts+ii->ntracedicts;
@@ -756,6 +1109,7 @@ inline static bool std_stats_new_event_npostestmax(sim_vars* sv, infindividual*
 
   if(ii->ninfections) {
     ((std_stats_inf_data*)ii->dataptr)->ninf+=ii->ninfections;
+    ++(((std_stats_inf_data*)ii->dataptr)->ninfevents);
     DEBUG_PRINTF("%s: Number of infections incremented to %u\n",__func__,((std_stats_inf_data*)ii->dataptr)->ninf);
 
     if(sv->event_time < ((std_summary_stats*)sv->dataptr)->abs_tmax) {
@@ -764,10 +1118,13 @@ inline static bool std_stats_new_event_npostestmax(sim_vars* sv, infindividual*
       if(ii->generation <= ((std_summary_stats*)sv->dataptr)->lmax) {
 
 	if(((std_summary_stats*)sv->dataptr)->postest_timeline[eti] < ((std_summary_stats*)sv->dataptr)->npostestmax) {
-	  ((std_summary_stats*)sv->dataptr)->newinf_timeline[eti]+=ii->ninfections;
+
+	  if(tlchans&std_stats_tl_newinf) {
+	    ((std_summary_stats*)sv->dataptr)->newinf_timeline[eti]+=ii->ninfections;
 #ifdef SEC_INF_TIMELINES
-	  ((std_summary_stats*)sv->dataptr)->newsecinf_timeline[eti]+=ii->ninfectionsp;
+	    ((std_summary_stats*)sv->dataptr)->newsecinf_timeline[eti]+=ii->ninfectionsp;
 #endif
+	  }
 
 	} else {
 	  ((std_summary_stats*)sv->dataptr)->extinction=false;
@@ -791,14 +1148,83 @@ npostestmax_event_false:
   return false;
 }
 
-inline static void std_stats_fill_newpostest(sim_vars* sv, infindividual* ii, infindividual* parent)
+/**
+ * @brief Computes the distance between the compared timeline of the current
+ * path and the observed series.
+ *
+ * The timeline bins can only increase during the simulation of a path. The
+ * distance computed using only the excess of the bins over the observed
+ * series is thus a lower bound of the final distance at any point of the
+ * simulation.
+ *
+ * @param stats: Pointer to the standard summary statistics.
+ * @param excess: Only include the excess of the bins over the observed series.
+ * @return the distance.
+ **/
+inline static double std_stats_obs_distance(std_summary_stats const* stats, const bool excess)
+{
+  uint32_t const* tl=(stats->obschan==std_stats_tl_inf?stats->inf_timeline:(stats->obschan==std_stats_tl_newinf?stats->newinf_timeline:stats->newpostest_timeline));
+  double diff, sum=0;
+  int32_t i;
+
+  for(i=stats->nobs-1; i>=0; --i) {
+    diff=(double)tl[i]-stats->obs[i];
+
+    if(diff<0) {
+
+      if(excess) continue;
+      diff=-diff;
+    }
+
+    if(stats->obsdist==std_stats_obs_l1) sum+=diff;
+    else if(stats->obsdist==std_stats_obs_l2) sum+=diff*diff;
+    else if(diff>sum) sum=diff;
+  }
+  return (stats->obsdist==std_stats_obs_l2?sqrt(sum):sum);
+}
+
+/**
+ * @brief Processes a new transmission event for a path that is compared
+ * with an observed series.
+ *
+ * The lower bound of the distance to the observed series is checked every
+ * nobs events. Once it exceeds obsmaxdist, the path is rejected and no new
+ * infection is generated, such that the simulation of the path ends as soon
+ * as the existing events have been processed. Otherwise the event is
+ * processed by obs_new_event_proc_func. This function must be assigned to the
+ * simulation engine through a call of sim_set_new_event_proc_func.
+ *
+ * @param sv: Pointer to the simulation variables.
+ * @param ii: Pointer to the infectious individual for the event.
+ * @return false if the path is rejected, and the returned value of
+ * obs_new_event_proc_func otherwise.
+ **/
+inline static bool std_stats_new_event_obs(sim_vars* sv, infindividual* ii)
+{
+  std_summary_stats* stats=(std_summary_stats*)sv->dataptr;
+
+  if(stats->rejected) return false;
+
+  if(++stats->obsnevents>=stats->nobs) {
+    stats->obsnevents=0;
+
+    if(std_stats_obs_distance(stats,true)>stats->obsmaxdist) {
+      DEBUG_PRINTF("%s: Path rejected\n",__func__);
+      stats->rejected=true;
+      return false;
+    }
+  }
+  return stats->obs_new_event_proc_func(sv, ii);
+}
+
+inline static void std_stats_fill_newpostest(sim_vars* sv, infindividual* ii, infindividual* parent, const uint32_t tlchans)
 {
   if(ii->commpertype&ro_commper_true_positive_test) {
     const int trt=floor(((std_summary_stats*)sv->dataptr)->nbinsperunit*(ii->end_comm_period+sv->pars.tdeltat));
 
     DEBUG_PRINTF("New pos test at %i\n",trt);
 
-    if(trt<((std_summary_stats*)sv->dataptr)->abs_maxnpers) {
+    if((tlchans&std_stats_tl_postest) && trt<((std_summary_stats*)sv->dataptr)->abs_maxnpers) {
       ++(((std_summary_stats*)sv->dataptr)->newpostest_timeline[trt]);
 
       #ifdef SEC_INF_TIMELINES
@@ -815,6 +1241,8 @@ inline static void std_stats_fill_newpostest(sim_vars* sv, infindividual* ii, in
     if(ii->commpertype&ro_commper_int) ++(((std_stats_inf_data*)parent->dataptr)->nobsinf);
     DEBUG_PRINTF("Number of observed infections for the parent increased by 1, for a total of %u\n",((std_stats_inf_data*)parent->dataptr)->nobsinf);
 #endif
+
+    if(!(tlchans&std_stats_tl_postest)) return;
     int32_t i;
     const int32_t end_npostestmax_per_i=trt+((std_summary_stats*)sv->dataptr)->nbinsperunit*((std_summary_stats*)sv->dataptr)->npostestmaxnunits-1;
 
@@ -829,6 +1257,11 @@ inline static void std_stats_fill_newpostest(sim_vars* sv, infindividual* ii, in
     for(i=(end_npostestmax_per_i>=((std_summary_stats*)sv->dataptr)->abs_maxnpers?((std_summary_stats*)sv->dataptr)->abs_maxnpers-1:end_npostestmax_per_i); i>=trt; --i) ++(((std_summary_stats*)sv->dataptr)->postest_timeline[i]);
     #endif
   }
+#ifdef CT_OUTPUT
+
+  //Children of an individual without a positive test have no known parent
+  else ((std_stats_inf_data*)ii->dataptr)->id=0;
+#endif
 }
 
 /**
@@ -842,10 +1275,12 @@ inline static void std_stats_fill_newpostest(sim_vars* sv, infindividual* ii, in
  * @param sv: Pointer to the simulation variables.
  * @param ii: Infectious individual.
  * @param parent: Infectious individual's parent.
+ * @param tlchans: Filled timeline channels.
  **/
-inline static void std_stats_new_inf(sim_vars* sv, infindividual* ii, infindividual* parent)
+inline static void std_stats_new_inf_gen(sim_vars* sv, infindividual* ii, infindividual* parent, const uint32_t tlchans)
 {
   ((std_stats_inf_data*)ii->dataptr)->ninf=0;
+  ((std_stats_inf_data*)ii->dataptr)->ninfevents=0;
   DEBUG_PRINTF("%s: Number of infections initialized to 0.\n",__func__);
 #ifdef OBSREFF_OUTPUT
   ((std_stats_inf_data*)ii->dataptr)->nobsinf=0;
@@ -855,7 +1290,26 @@ inline static void std_stats_new_inf(sim_vars* sv, infindividual* ii, infindivid
   //++(*(uint32_t*)(ii-1)->dataptr);
   //DEBUG_PRINTF("Number of parent infections incremented to %u\n",*(uint32_t*)(ii-1)->dataptr);
   DEBUG_PRINTF("%s\n",__func__);
-  std_stats_fill_newpostest(sv, ii, parent);
+  std_stats_fill_newpostest(sv, ii, parent, tlchans);
+
+  if(((std_summary_stats*)sv->dataptr)->treenodes) std_stats_add_tree_node((std_summary_stats*)sv->dataptr, ii, parent);
+}
+
+/**
+ * @brief Extends a timeline towards positive time indices.
+ *
+ * The new bins are zeroed.
+ *
+ * @param timeline: Timeline.
+ * @param stats: Pointer to the standard summary statistics.
+ * @param newsize: New allocated size.
+ * @return the new timeline.
+ */
+inline static uint32_t* std_stats_timeline_grow_back(uint32_t* timeline, std_summary_stats const* stats, const uint32_t newsize)
+{
+  timeline=(uint32_t*)realloc(timeline,newsize*sizeof(uint32_t));
+  memset(timeline+stats->tnpersa,0,(newsize-stats->tnpersa)*sizeof(uint32_t));
+  return timeline;
 }
 
 /**
@@ -864,8 +1318,9 @@ inline static void std_stats_new_inf(sim_vars* sv, infindividual* ii, infindivid
  *
  * @param sv: Pointer to the simulation variables.
  * @param ii: Infectious individual.
+ * @param tlchans: Filled timeline channels.
  */
-inline static void first_pos_test_results_update(sim_vars* sv, infindividual* ii)
+inline static void first_pos_test_results_update(sim_vars* sv, infindividual* ii, const uint32_t tlchans)
 {
   std_summary_stats* const stats=(std_summary_stats*)sv->dataptr;
 
@@ -893,43 +1348,42 @@ inline static void first_pos_test_results_update(sim_vars* sv, infindividual* ii
   if(newsize > stats->tnpersa) {
     const uint32_t dsize=newsize-stats->tnpersa;
 
-    stats->inf_timeline=(uint32_t*)realloc(stats->inf_timeline,newsize*sizeof(uint32_t));
-    memset(stats->inf_timeline+stats->tnpersa,0,dsize*sizeof(uint32_t));
-
-    stats->newinf_timeline=(uint32_t*)realloc(stats->newinf_timeline,newsize*sizeof(uint32_t));
-    memset(stats->newinf_timeline+stats->tnpersa,0,dsize*sizeof(uint32_t));
-
-    stats->postest_timeline=(uint32_t*)realloc(stats->postest_timeline,newsize*sizeof(uint32_t));
-    memset(stats->postest_timeline+stats->tnpersa,0,dsize*sizeof(uint32_t));
-
-    stats->newpostest_timeline=(uint32_t*)realloc(stats->newpostest_timeline,newsize*sizeof(uint32_t));
-    memset(stats->newpostest_timeline+stats->tnpersa,0,dsize*sizeof(uint32_t));
-
-    #ifdef SEC_INF_TIMELINES
-    stats->secinf_timeline=(uint32_t*)realloc(stats->secinf_timeline,newsize*sizeof(uint32_t));
-    memset(stats->secinf_timeline+stats->tnpersa,0,dsize*sizeof(uint32_t));
-
-    stats->newsecinf_timeline=(uint32_t*)realloc(stats->newsecinf_timeline,newsize*sizeof(uint32_t));
-    memset(stats->newsecinf_timeline+stats->tnpersa,0,dsize*sizeof(uint32_t));
+    if(tlchans&std_stats_tl_inf) {
+      stats->inf_timeline=std_stats_timeline_grow_back(stats->inf_timeline,stats,newsize);
+#ifdef SEC_INF_TIMELINES
+      stats->secinf_timeline=std_stats_timeline_grow_back(stats->secinf_timeline,stats,newsize);
+#endif
+    }
 
-    stats->secpostest_timeline=(uint32_t*)realloc(stats->secpostest_timeline,newsize*sizeof(uint32_t));
-    memset(stats->secpostest_timeline+stats->tnpersa,0,dsize*sizeof(uint32_t));
+    if(tlchans&std_stats_tl_newinf) {
+      stats->newinf_timeline=std_stats_timeline_grow_back(stats->newinf_timeline,stats,newsize);
+#ifdef SEC_INF_TIMELINES
+      stats->newsecinf_timeline=std_stats_timeline_grow_back(stats->newsecinf_timeline,stats,newsize);
+#endif
+    }
 
-    stats->newsecpostest_timeline=(uint32_t*)realloc(stats->newsecpostest_timeline,newsize*sizeof(uint32_t));
-    memset(stats->newsecpostest_timeline+stats->tnpersa,0,dsize*sizeof(uint32_t));
-    #endif
+    if(tlchans&std_stats_tl_postest) {
+      stats->postest_timeline=std_stats_timeline_grow_back(stats->postest_timeline,stats,newsize);
+      stats->newpostest_timeline=std_stats_timeline_grow_back(stats->newpostest_timeline,stats,newsize);
+#ifdef SEC_INF_TIMELINES
+      stats->secpostest_timeline=std_stats_timeline_grow_back(stats->secpostest_timeline,stats,newsize);
+      stats->newsecpostest_timeline=std_stats_timeline_grow_back(stats->newsecpostest_timeline,stats,newsize);
+#endif
+    }
 
-    stats->ext_timeline=(ext_timeline_info*)realloc(stats->ext_timeline,newsize*sizeof(ext_timeline_info));
-    memset(stats->ext_timeline+stats->tnpersa,0,dsize*sizeof(ext_timeline_info));
+    if(tlchans&std_stats_tl_ext) {
+      stats->ext_timeline=(ext_timeline_info*)realloc(stats->ext_timeline,newsize*sizeof(ext_timeline_info));
+      memset(stats->ext_timeline+stats->tnpersa,0,dsize*sizeof(ext_timeline_info));
 
-    if(stats->nainfbins) {
-      uint64_t* newarray64;
-      int32_t i;
+      if(stats->nainfbins) {
+	uint64_t* newarray64;
+	int32_t i;
 
-      for(i=dsize-1; i>=0; --i) {
-	newarray64=(uint64_t*)malloc(stats->nainfbins*sizeof(uint64_t));
-	memset(newarray64,0,stats->nainfbins*sizeof(uint64_t));
-	stats->ext_timeline[stats->tnpersa+i].ngeninfs=newarray64;
+	for(i=dsize-1; i>=0; --i) {
+	  newarray64=(uint64_t*)malloc(stats->nainfbins*sizeof(uint64_t));
+	  memset(newarray64,0,stats->nainfbins*sizeof(uint64_t));
+	  stats->ext_timeline[stats->tnpersa+i].ngeninfs=newarray64;
+	}
       }
     }
     stats->tnpersa=newsize;
@@ -949,21 +1403,22 @@ inline static void first_pos_test_results_update(sim_vars* sv, infindividual* ii
  * @param sv: Pointer to the simulation variables.
  * @param ii: Infectious individual.
  * @param parent: Infectious individual's parent.
+ * @param tlchans: Filled timeline channels.
  **/
-inline static void std_stats_new_inf_first_pos_test_results(sim_vars* sv, infindividual* ii, infindividual* parent)
+inline static void std_stats_new_inf_first_pos_test_results_gen(sim_vars* sv, infindividual* ii, infindividual* parent, const uint32_t tlchans)
 {
-  first_pos_test_results_update(sv, ii);
-  std_stats_new_inf(sv, ii, parent);
+  first_pos_test_results_update(sv, ii, tlchans);
+  std_stats_new_inf_gen(sv, ii, parent, tlchans);
 }
 
-inline static void std_stats_fill_inf_ext_n(sim_vars* sv, infindividual* ii)
+inline static void std_stats_fill_inf_ext_n(sim_vars* sv, infindividual* ii, const uint32_t tlchans)
 {
   const double start_comm_per=ii->end_comm_period-ii->comm_period;
   const int32_t start_latent_per_i=floor(((std_summary_stats*)sv->dataptr)->nbinsperunit*(ii->end_comm_period-(ii->comm_period+ii->latent_period)));
   const int32_t end_comm_per_i=(((std_summary_stats*)sv->dataptr)->nbinsperunit*ii->end_comm_period >= ((std_summary_stats*)sv->dataptr)->abs_maxnpers ? ((std_summary_stats*)sv->dataptr)->abs_maxnpers-1 : floor(((std_summary_stats*)sv->dataptr)->nbinsperunit*ii->end_comm_period));
   int32_t i;
 
-  if(start_comm_per < ((std_summary_stats*)sv->dataptr)->abs_tmax) {
+  if((tlchans&std_stats_tl_ext) && start_comm_per < ((std_summary_stats*)sv->dataptr)->abs_tmax) {
     const int32_t start_comm_per_i=floor(((std_summary_stats*)sv->dataptr)->nbinsperunit*start_comm_per);
     ((std_summary_stats*)sv->dataptr)->ext_timeline[start_comm_per_i].rsum+=((std_stats_inf_data*)ii->dataptr)->ninf;
     ((std_summary_stats*)sv->dataptr)->ext_timeline[start_comm_per_i].r2sum+=((std_stats_inf_data*)ii->dataptr)->ninf*((std_stats_inf_data*)ii->dataptr)->ninf;
@@ -981,6 +1436,8 @@ inline static void std_stats_fill_inf_ext_n(sim_vars* sv, infindividual* ii)
 #endif
   }
 
+  if(!(tlchans&std_stats_tl_inf)) return;
+
   #ifdef SEC_INF_TIMELINES
   if(ii->inftypep) for(i=start_latent_per_i; i<=end_comm_per_i; ++i) {
     ++(((std_summary_stats*)sv->dataptr)->inf_timeline[i]);
@@ -1011,11 +1468,14 @@ inline static void std_stats_fill_inf_ext_n(sim_vars* sv, infindividual* ii)
  * @param sv: Pointer to the simulation variables.
  * @param ii: Infectious individual.
  * @param parent: Infectious individual's parent.
+ * @param tlchans: Filled timeline channels.
  **/
-inline static void std_stats_end_inf(sim_vars* sv, infindividual* ii, infindividual* parent)
+inline static void std_stats_end_inf_gen(sim_vars* sv, infindividual* ii, infindividual* parent, const uint32_t tlchans)
 {
   DEBUG_PRINTF("Number of infections was %u\n",((std_stats_inf_data*)ii->dataptr)->ninf);
 
+  if(((std_summary_stats*)sv->dataptr)->treenodes) ((std_summary_stats*)sv->dataptr)->treenodes[((std_stats_inf_data*)ii->dataptr)->treeid].ninf=((std_stats_inf_data*)ii->dataptr)->ninf;
+
 #ifdef CT_OUTPUT
   if(ii->commpertype&ro_commper_true_positive_test) std_stats_add_ct_entry((std_summary_stats*)sv->dataptr, ii->end_comm_period+sv->pars.tdeltat, ((ii->commpertype&ro_commper_alt)?ii->end_comm_period-ii->comm_period+ii->presym_comm_period:INFINITY),  ((std_stats_inf_data*)ii->dataptr)->id, ((ii->commpertype&ro_commper_int)? ((std_stats_inf_data*)parent->dataptr)->id:-((std_stats_inf_data*)parent->dataptr)->id), ((std_stats_inf_data*)ii->dataptr)->ntracedcts);
 #endif
@@ -1029,7 +1489,7 @@ inline static void std_stats_end_inf(sim_vars* sv, infindividual* ii, infindivid
     if(ii->end_comm_period > ((std_summary_stats*)sv->dataptr)->extinction_time) ((std_summary_stats*)sv->dataptr)->extinction_time=ii->end_comm_period;
   }
 
-  std_stats_fill_inf_ext_n(sv, ii);
+  std_stats_fill_inf_ext_n(sv, ii, tlchans);
 }
 
 /**
@@ -1038,13 +1498,15 @@ inline static void std_stats_end_inf(sim_vars* sv, infindividual* ii, infindivid
  * record the number of infections generated by each infectious individual.
  *
  * In addition to calling the function std_stats_end_inf, this function records
- * the number of infections generated by each infectious individual.
+ * the number of infections generated by each infectious individual. The
+ * std_stats_tl_ext channel must be filled.
  *
  * @param sv: Pointer to the simulation variables.
  * @param ii: Infectious individual.
  * @param parent: Infectious individual's parent.
+ * @param tlchans: Filled timeline channels.
  **/
-inline static void std_stats_end_inf_rec_ninfs(sim_vars* sv, infindividual* ii, infindividual* parent)
+inline static void std_stats_end_inf_rec_ninfs_gen(sim_vars* sv, infindividual* ii, infindividual* parent, const uint32_t tlchans)
 {
   const double start_comm_per=ii->end_comm_period-ii->comm_period;
 
@@ -1071,7 +1533,7 @@ inline static void std_stats_end_inf_rec_ninfs(sim_vars* sv, infindividual* ii,
     ++(stats->ext_timeline[start_comm_per_i].ngeninfs[((std_stats_inf_data*)ii->dataptr)->ninf]);
   }
 
-  std_stats_end_inf(sv, ii, parent);
+  std_stats_end_inf_gen(sv, ii, parent, tlchans);
 }
 
 /**
@@ -1089,8 +1551,9 @@ inline static void std_stats_end_inf_rec_ninfs(sim_vars* sv, infindividual* ii,
  * @param sv: Pointer to the simulation variables.
  * @param ii: Pointer to the infectious individual.
  * @param parent: Pointer to the infectious individual's parent.
+ * @param tlchans: Filled timeline channels.
  **/
-inline static void std_stats_noevent_new_inf(sim_vars* sv, infindividual* ii, infindividual* parent)
+inline static void std_stats_noevent_new_inf_gen(sim_vars* sv, infindividual* ii, infindividual* parent, const uint32_t tlchans)
 {
   DEBUG_PRINTF("%s\n",__func__);
   DEBUG_PRINTF("Number of infections was 0\n");
@@ -1100,7 +1563,9 @@ inline static void std_stats_noevent_new_inf(sim_vars* sv, infindividual* ii, in
   ((std_stats_inf_data*)ii->dataptr)->nobsinf=0;
 #endif
 
-  std_stats_fill_newpostest(sv, ii, parent);
+  std_stats_fill_newpostest(sv, ii, parent, tlchans);
+
+  if(((std_summary_stats*)sv->dataptr)->treenodes) std_stats_add_tree_node((std_summary_stats*)sv->dataptr, ii, parent);
 
 #ifdef CT_OUTPUT
   if(ii->commpertype&ro_commper_true_positive_test) std_stats_add_ct_entry((std_summary_stats*)sv->dataptr, ii->end_comm_period+sv->pars.tdeltat, ((ii->commpertype&ro_commper_alt)?ii->end_comm_period-ii->comm_period+ii->presym_comm_period:INFINITY), ((std_stats_inf_data*)ii->dataptr)->id, ((ii->commpertype&ro_commper_int)?((std_stats_inf_data*)parent->dataptr)->id:-((std_stats_inf_data*)parent->dataptr)->id), ((std_stats_inf_data*)ii->dataptr)->ntracedcts);
@@ -1115,7 +1580,7 @@ inline static void std_stats_noevent_new_inf(sim_vars* sv, infindividual* ii, in
     if(ii->end_comm_period > ((std_summary_stats*)sv->dataptr)->extinction_time) ((std_summary_stats*)sv->dataptr)->extinction_time=ii->end_comm_period;
   }
 
-  std_stats_fill_inf_ext_n(sv, ii);
+  std_stats_fill_inf_ext_n(sv, ii, tlchans);
 }
 
 /**
@@ -1134,11 +1599,12 @@ inline static void std_stats_noevent_new_inf(sim_vars* sv, infindividual* ii, in
  * @param sv: Pointer to the simulation variables.
  * @param ii: Pointer to the infectious individual.
  * @param parent: Pointer to the infectious individual's parent.
+ * @param tlchans: Filled timeline channels.
  **/
-inline static void std_stats_noevent_new_inf_first_pos_test_results(sim_vars* sv, infindividual* ii, infindividual* parent)
+inline static void std_stats_noevent_new_inf_first_pos_test_results_gen(sim_vars* sv, infindividual* ii, infindividual* parent, const uint32_t tlchans)
 {
-  first_pos_test_results_update(sv, ii);
-  std_stats_noevent_new_inf(sv, ii, parent);
+  first_pos_test_results_update(sv, ii, tlchans);
+  std_stats_noevent_new_inf_gen(sv, ii, parent, tlchans);
 }
 
 /**
@@ -1147,13 +1613,15 @@ inline static void std_stats_noevent_new_inf_first_pos_test_results(sim_vars* sv
  * generated by each infectious individual.
  *
  * In addition to calling the function std_stats_noevent_new_inf, this function records
- * the number of infections generated by each infectious individual.
+ * the number of infections generated by each infectious individual. The
+ * std_stats_tl_ext channel must be filled.
  *
  * @param sv: Pointer to the simulation variables.
  * @param ii: Pointer to the infectious individual.
  * @param parent: Pointer to the infectious individual's parent.
+ * @param tlchans: Filled timeline channels.
  **/
-inline static void std_stats_noevent_new_inf_rec_ninfs(sim_vars* sv, infindividual* ii, infindividual* parent)
+inline static void std_stats_noevent_new_inf_rec_ninfs_gen(sim_vars* sv, infindividual* ii, infindividual* parent, const uint32_t tlchans)
 {
   const double start_comm_per=ii->end_comm_period-ii->comm_period;
 
@@ -1162,7 +1630,7 @@ inline static void std_stats_noevent_new_inf_rec_ninfs(sim_vars* sv, infindividu
     ++(((std_summary_stats*)sv->dataptr)->ext_timeline[start_comm_per_i].ngeninfs[0]);
   }
 
-  std_stats_noevent_new_inf(sv, ii, parent);
+  std_stats_noevent_new_inf_gen(sv, ii, parent, tlchans);
 }
 
 /**
@@ -1177,11 +1645,80 @@ inline static void std_stats_noevent_new_inf_rec_ninfs(sim_vars* sv, infindividu
  * @param sv: Pointer to the simulation variables.
  * @param ii: Pointer to the infectious individual.
  * @param parent: Pointer to the infectious individual's parent.
+ * @param tlchans: Filled timeline channels.
  **/
-inline static void std_stats_noevent_new_inf_rec_ninfs_first_pos_test_results(sim_vars* sv, infindividual* ii, infindividual* parent)
+inline static void std_stats_noevent_new_inf_rec_ninfs_first_pos_test_results_gen(sim_vars* sv, infindividual* ii, infindividual* parent, const uint32_t tlchans)
 {
-  first_pos_test_results_update(sv, ii);
-  std_stats_noevent_new_inf_rec_ninfs(sv, ii, parent);
+  first_pos_test_results_update(sv, ii, tlchans);
+  std_stats_noevent_new_inf_rec_ninfs_gen(sv, ii, parent, tlchans);
 }
 
+/**
+ * Timeline channel flags for the given channel selection digits (0 or 1).
+ */
+#define STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT) ((INF)*std_stats_tl_inf|(NEWINF)*std_stats_tl_newinf|(POSTEST)*std_stats_tl_postest|(EXT)*std_stats_tl_ext)
+
+/**
+ * Generates the processing functions of the standard summary statistics for a
+ * given timeline channel selection. The generated functions have the same names
+ * as their generic counterparts, without the _gen suffix and with the channel
+ * selection digits appended.
+ */
+#define GEN_STD_STATS_FUNCS(INF,NEWINF,POSTEST,EXT) \
+  inline static void std_stats_path_init_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv){std_stats_path_init_gen(sv, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));} \
+  inline static bool std_stats_path_end_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv){return std_stats_path_end_gen(sv, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));} \
+  inline static void std_stats_pri_init_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv, infindividual* parent, infindividual* child){std_stats_pri_init_gen(sv, parent, child, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));} \
+  inline static void std_stats_pri_init_rel_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv, infindividual* parent, infindividual* child){std_stats_pri_init_rel_gen(sv, parent, child, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));} \
+  inline static bool std_stats_new_event_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv, infindividual* ii){return std_stats_new_event_gen(sv, ii, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));} \
+  inline static bool std_stats_new_event_npostestmax_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv, infindividual* ii){return std_stats_new_event_npostestmax_gen(sv, ii, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));} \
+  inline static void std_stats_new_inf_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_new_inf_gen(sv, ii, parent, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));} \
+  inline static void std_stats_new_inf_first_pos_test_results_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_new_inf_first_pos_test_results_gen(sv, ii, parent, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));} \
+  inline static void std_stats_end_inf_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_end_inf_gen(sv, ii, parent, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));} \
+  inline static void std_stats_end_inf_rec_ninfs_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_end_inf_rec_ninfs_gen(sv, ii, parent, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));} \
+  inline static void std_stats_noevent_new_inf_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_noevent_new_inf_gen(sv, ii, parent, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));} \
+  inline static void std_stats_noevent_new_inf_first_pos_test_results_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_noevent_new_inf_first_pos_test_results_gen(sv, ii, parent, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));} \
+  inline static void std_stats_noevent_new_inf_rec_ninfs_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_noevent_new_inf_rec_ninfs_gen(sv, ii, parent, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));} \
+  inline static void std_stats_noevent_new_inf_rec_ninfs_first_pos_test_results_ ## INF ## _ ## NEWINF ## _ ## POSTEST ## _ ## EXT(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_noevent_new_inf_rec_ninfs_first_pos_test_results_gen(sv, ii, parent, STD_STATS_TLCHANS(INF,NEWINF,POSTEST,EXT));}
+
+/*
+ * Processing functions filling all the timeline channels.
+ */
+inline static void std_stats_path_init(sim_vars* sv){std_stats_path_init_gen(sv, std_stats_tl_all);}
+inline static bool std_stats_path_end(sim_vars* sv){return std_stats_path_end_gen(sv, std_stats_tl_all);}
+inline static void std_stats_pri_init(sim_vars* sv, infindividual* parent, infindividual* child){std_stats_pri_init_gen(sv, parent, child, std_stats_tl_all);}
+inline static void std_stats_pri_init_rel(sim_vars* sv, infindividual* parent, infindividual* child){std_stats_pri_init_rel_gen(sv, parent, child, std_stats_tl_all);}
+inline static bool std_stats_new_event(sim_vars* sv, infindividual* ii){return std_stats_new_event_gen(sv, ii, std_stats_tl_all);}
+inline static bool std_stats_new_event_npostestmax(sim_vars* sv, infindividual* ii){return std_stats_new_event_npostestmax_gen(sv, ii, std_stats_tl_all);}
+inline static void std_stats_new_inf(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_new_inf_gen(sv, ii, parent, std_stats_tl_all);}
+inline static void std_stats_new_inf_first_pos_test_results(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_new_inf_first_pos_test_results_gen(sv, ii, parent, std_stats_tl_all);}
+inline static void std_stats_end_inf(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_end_inf_gen(sv, ii, parent, std_stats_tl_all);}
+inline static void std_stats_end_inf_rec_ninfs(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_end_inf_rec_ninfs_gen(sv, ii, parent, std_stats_tl_all);}
+inline static void std_stats_noevent_new_inf(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_noevent_new_inf_gen(sv, ii, parent, std_stats_tl_all);}
+inline static void std_stats_noevent_new_inf_first_pos_test_results(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_noevent_new_inf_first_pos_test_results_gen(sv, ii, parent, std_stats_tl_all);}
+inline static void std_stats_noevent_new_inf_rec_ninfs(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_noevent_new_inf_rec_ninfs_gen(sv, ii, parent, std_stats_tl_all);}
+inline static void std_stats_noevent_new_inf_rec_ninfs_first_pos_test_results(sim_vars* sv, infindividual* ii, infindividual* parent){std_stats_noevent_new_inf_rec_ninfs_first_pos_test_results_gen(sv, ii, parent, std_stats_tl_all);}
+
+/**
+ * @brief Assigns the processing functions of the standard summary statistics
+ * to the simulation engine.
+ *
+ * The functions matching the timeline channels that were selected with
+ * std_stats_init are selected, such that unused channels are never filled.
+ * The time type, the recording of the number of infections generated by each
+ * infectious individual and the nimax/npostestmax limits are also taken into
+ * account. This function must be called after std_stats_init and after the
+ * nimax and npostestmax members have been set. The nimax limit requires the
+ * std_stats_tl_newinf channel, the npostestmax limit and non-default path
+ * types require the std_stats_tl_postest channel and a time relative to the
+ * first positive test results requires the std_stats_tl_inf channel. When
+ * an observed series is set, the compared channel is required and the new
+ * event processing function is wrapped by std_stats_new_event_obs if
+ * obsmaxdist is finite.
+ *
+ * @param sv: Pointer to the simulation variables.
+ * @return 0 if successful, or -1 if the selected channels do not meet the
+ * requirements.
+ */
+int std_stats_set_proc_funcs(sim_vars* sv);
+
 #endif
@@ -0,0 +1,137 @@
+/**
+ * @file summary_output.h
+ * @brief Functions to compute and print the summary statistics of timelines
+ * and path distributions.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * These functions are shared by the simulation executable and by the tools
+ * that reduce timeline output files, such that both produce the same result
+ * layout.
+ */
+
+#ifndef _SUMMARY_OUTPUT_
+#define _SUMMARY_OUTPUT_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include "log_histogram.h"
+
+/**
+ * @brief Computes a sample mean and standard deviation for a number of
+ * paths.
+ *
+ * @param sum: Sum of the values.
+ * @param sum2: Sum of the squared values.
+ * @param n: Number of paths.
+ * @param mean: Pointer to the computed mean.
+ * @param std: Pointer to the computed standard deviation.
+ */
+inline static void count_mean_std(const double sum, const double sum2, const double n, double* mean, double* std)
+{
+  *mean=sum/n;
+  *std=sqrt(n/(n-1.)*(sum2/n-*mean**mean));
+}
+
+/**
+ * @brief Computes a sample mean and standard deviation for a number of
+ * entries that can be null.
+ *
+ * @param sum: Sum of the values.
+ * @param sum2: Sum of the squared values.
+ * @param n: Number of entries.
+ * @param mean: Pointer to the computed mean, NAN if there is no entry.
+ * @param std: Pointer to the computed standard deviation, INFINITY if there
+ * is a single entry and NAN if there is no entry.
+ */
+inline static void ratio_mean_std(const double sum, const double sum2, const uint64_t n, double* mean, double* std)
+{
+  *mean=(n?sum/n:NAN);
+  *std=(n>1?sqrt(n/(n-1.)*(sum2/n-*mean**mean)):(n?INFINITY:NAN));
+}
+
+/**
+ * @brief Prints the timeline statistics of a channel.
+ *
+ * @param title: Timeline description.
+ * @param tls: Timeline statistics, stored as six consecutive timelines: the
+ * mean and the standard deviation for paths with extinction, for paths
+ * without extinction and for all paths.
+ * @param nbins: Number of timeline bins.
+ * @param shift: Index of the bin for time 0.
+ * @param nbinsperunit: Number of bins per unit of time.
+ * @param maxedoutmintimeindex: Earliest bin index where the maximum was reached.
+ */
+inline static void print_timeline(const char* title, double const* tls, const uint32_t nbins, const int32_t shift, const int32_t nbinsperunit, const int32_t maxedoutmintimeindex)
+{
+  int32_t j;
+
+  printf("\n%s, for paths with extinction vs no extinction vs overall is:\n",title);
+  for(j=0; j<nbins; ++j) printf("%6.2f: %22.15e +/- %22.15e\t%22.15e +/- %22.15e\t%22.15e +/- %22.15e%s\n",(j-shift)/(double)nbinsperunit,tls[j],tls[nbins+j],tls[2*nbins+j],tls[3*nbins+j],tls[4*nbins+j],tls[5*nbins+j],(j-shift<maxedoutmintimeindex?"":" (max reached, biased if simulation cut)"));
+}
+
+/**
+ * @brief Prints the quantiles of a timeline channel.
+ *
+ * Paths that do not reach a given time bin, as well as null counts, are not
+ * expected to be recorded in the histograms. The null value bucket of each
+ * bin is thus set such that the total count of the bin is the number of
+ * paths.
+ *
+ * @param title: Timeline description.
+ * @param qsk: Log-bucketed histograms of the timeline values, stored one
+ * bin after the other.
+ * @param nbins: Number of timeline bins.
+ * @param shift: Index of the bin for time 0.
+ * @param nbinsperunit: Number of bins per unit of time.
+ * @param maxedoutmintimeindex: Earliest bin index where the maximum was reached.
+ * @param quantiles: Cumulative probabilities of the quantiles.
+ * @param nquantiles: Number of quantiles.
+ * @param precbits: Number of precision bits of the histograms.
+ * @param npaths: Number of paths.
+ */
+inline static void print_timeline_quantiles(const char* title, uint32_t* qsk, const uint32_t nbins, const int32_t shift, const int32_t nbinsperunit, const int32_t maxedoutmintimeindex, double const* quantiles, const uint32_t nquantiles, const uint32_t precbits, const uint64_t npaths)
+{
+  const uint32_t nqbuckets=lhist_nbuckets(precbits);
+  uint32_t q;
+  int32_t j;
+
+  for(j=nbins-1; j>=0; --j) {
+    qsk[j*nqbuckets]=npaths;
+
+    for(q=nqbuckets-1; q>0; --q) qsk[j*nqbuckets]-=qsk[j*nqbuckets+q];
+  }
+
+  printf("\n%s quantiles, for all paths, for cumulative probabilities",title);
+  for(q=0; q<nquantiles; ++q) printf(" %g",quantiles[q]);
+  printf(" are:\n");
+
+  for(j=0; j<nbins; ++j) {
+    printf("%6.2f:",(j-shift)/(double)nbinsperunit);
+    for(q=0; q<nquantiles; ++q) printf(" %22.15e",lhist_quantile(qsk+j*nqbuckets,precbits,npaths,quantiles[q]));
+    printf("%s\n",(j-shift<maxedoutmintimeindex?"":" (max reached, biased if simulation cut)"));
+  }
+}
+
+/**
+ * @brief Prints the non-empty buckets of a log-bucketed per path
+ * distribution.
+ *
+ * @param title: Distribution description.
+ * @param counts: Bucket counts.
+ * @param precbits: Number of precision bits.
+ */
+inline static void print_lhist_distribution(const char* title, uint32_t const* counts, const uint32_t precbits)
+{
+  const uint32_t nlbuckets=lhist_nbuckets(precbits);
+  uint32_t b;
+
+  printf("\n%s:\n",title);
+  printf("      lower\t      upper\t               count\n");
+
+  for(b=0; b<nlbuckets; ++b) if(counts[b] > 0) printf("%11" PRIu64 "\t%11" PRIu64 "\t%20" PRIu32 "\n",lhist_lower(b,precbits),lhist_upper(b,precbits),counts[b]);
+}
+
+#endif
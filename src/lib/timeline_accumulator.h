@@ -0,0 +1,153 @@
+/**
+ * @file timeline_accumulator.h
+ * @brief Functions to manipulate blocks of integer timeline accumulators.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * An accumulator stores a fixed number of fields of 64-bit unsigned integers
+ * per timeline bin in a single memory block. Each field is contiguous in
+ * memory, and the fields are stored one after the other. Unused bins are
+ * kept before the first bin and after the last bin of each field, such that
+ * the timeline can grow in either direction without reallocating the block
+ * at each extension. Sums of squares are stored using two fields, for the
+ * lower and upper 32 bits of each squared value, such that accumulators
+ * remain exact and can be merged by adding their fields.
+ */
+
+#ifndef _TIMELINE_ACCUMULATOR_
+#define _TIMELINE_ACCUMULATOR_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Timeline accumulator.
+ */
+typedef struct {
+  uint64_t* block;	//!< Memory block containing all the fields.
+  uint32_t nfields;	//!< Number of fields.
+  uint32_t nabins;	//!< Number of allocated bins per field.
+  uint32_t nhbins;	//!< Number of unused bins before the first bin of each field.
+  uint32_t nbins;	//!< Number of bins in use per field.
+} tlaccumulator;
+
+/**
+ * @brief Initialises a timeline accumulator.
+ *
+ * All bins are initialised to zero.
+ *
+ * @param acc: Pointer to the accumulator.
+ * @param nfields: Number of fields.
+ * @param nbins: Initial number of bins per field.
+ */
+inline static void tlacc_init(tlaccumulator* acc, const uint32_t nfields, const uint32_t nbins)
+{
+  acc->nfields=nfields;
+  acc->nabins=acc->nbins=nbins;
+  acc->nhbins=0;
+  acc->block=(nfields?(uint64_t*)calloc((size_t)nfields*nbins,sizeof(uint64_t)):NULL);
+}
+
+/**
+ * @brief Frees the memory used by a timeline accumulator.
+ *
+ * @param acc: Pointer to the accumulator.
+ */
+inline static void tlacc_free(tlaccumulator* acc){free(acc->block); acc->block=NULL;}
+
+/**
+ * @brief Returns a pointer to the first bin of a field.
+ *
+ * @param acc: Pointer to the accumulator.
+ * @param field: Field index.
+ * @return the pointer to the first bin of the field.
+ */
+inline static uint64_t* tlacc_field(tlaccumulator const* acc, const uint32_t field){return acc->block+(size_t)field*acc->nabins+acc->nhbins;}
+
+/**
+ * @brief Extends a timeline accumulator on both ends.
+ *
+ * The new bins are zeroed. If the unused bins are insufficient, the block is
+ * reallocated and half of the new number of bins in use is reserved as
+ * unused bins on each side that had to grow.
+ *
+ * @param acc: Pointer to the accumulator.
+ * @param ndiff: Number of bins to add before the first bin.
+ * @param pdiff: Number of bins to add after the last bin.
+ */
+inline static void tlacc_extend(tlaccumulator* acc, const uint32_t ndiff, const uint32_t pdiff)
+{
+  const uint32_t newnbins=acc->nbins+ndiff+pdiff;
+
+  if(ndiff <= acc->nhbins && acc->nhbins+acc->nbins+pdiff <= acc->nabins) {
+    acc->nhbins-=ndiff;
+    acc->nbins=newnbins;
+    return;
+  }
+  const uint32_t newnhbins=(ndiff>acc->nhbins?newnbins>>1:acc->nhbins-ndiff);
+  const uint32_t newnabins=newnhbins+newnbins+(acc->nhbins+acc->nbins+pdiff>acc->nabins?newnbins>>1:acc->nabins-acc->nhbins-acc->nbins-pdiff);
+  uint64_t* newblock=(acc->nfields?(uint64_t*)calloc((size_t)acc->nfields*newnabins,sizeof(uint64_t)):NULL);
+  uint32_t f;
+
+  for(f=0; f<acc->nfields; ++f) memcpy(newblock+(size_t)f*newnabins+newnhbins+ndiff,tlacc_field(acc,f),acc->nbins*sizeof(uint64_t));
+  free(acc->block);
+  acc->block=newblock;
+  acc->nabins=newnabins;
+  acc->nhbins=newnhbins;
+  acc->nbins=newnbins;
+}
+
+/**
+ * @brief Adds the content of a timeline accumulator to another one.
+ *
+ * Both accumulators must have the same number of fields, and the destination
+ * accumulator must contain all the bins of the source accumulator.
+ *
+ * @param dst: Pointer to the destination accumulator.
+ * @param src: Pointer to the source accumulator.
+ * @param shift: Index of the destination bin corresponding to the first
+ * source bin.
+ */
+inline static void tlacc_merge(tlaccumulator* dst, tlaccumulator const* src, const uint32_t shift)
+{
+  uint32_t f, j;
+
+  for(f=0; f<src->nfields; ++f) {
+    uint64_t* restrict d=tlacc_field(dst,f)+shift;
+    uint64_t const* restrict s=tlacc_field(src,f);
+
+    for(j=0; j<src->nbins; ++j) d[j]+=s[j];
+  }
+}
+
+/**
+ * @brief Adds counts to a sum field and to the two fields of a sum of squares.
+ *
+ * @param sum: Pointer to the first bin of the sum field.
+ * @param sum2lo: Pointer to the first bin of the field for the lower 32 bits of the squares.
+ * @param sum2hi: Pointer to the first bin of the field for the upper 32 bits of the squares.
+ * @param counts: Counts.
+ * @param n: Number of bins.
+ */
+inline static void tlacc_add_counts(uint64_t* restrict sum, uint64_t* restrict sum2lo, uint64_t* restrict sum2hi, uint32_t const* restrict counts, const uint32_t n)
+{
+  uint32_t j;
+
+  for(j=0; j<n; ++j) {
+    const uint64_t v2=(uint64_t)counts[j]*counts[j];
+    sum[j]+=counts[j];
+    sum2lo[j]+=(uint32_t)v2;
+    sum2hi[j]+=v2>>32;
+  }
+}
+
+/**
+ * @brief Returns the value of a sum of squares as a double.
+ *
+ * @param sum2lo: Sum of the lower 32 bits of the squares.
+ * @param sum2hi: Sum of the upper 32 bits of the squares.
+ * @return the sum of squares, correctly rounded to double precision.
+ */
+inline static double tlacc_sum2(const uint64_t sum2lo, const uint64_t sum2hi){return (double)(((unsigned __int128)sum2hi<<32)+sum2lo);}
+
+#endif
@@ -0,0 +1,637 @@
+/**
+ * @file timesim.c
+ * @brief Time-ordered branching simulation functions.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "timesim.h"
+
+/**
+ * Header of a serialised frontier.
+ */
+typedef struct {
+  uint64_t iidatasize;	//!< Size of the user-defined data of each node.
+  double time;		//!< Time up to which the path has been simulated.
+  uint32_t nunodes;	//!< Number of used nodes.
+  uint32_t nfreenodes;	//!< Number of free nodes in the stack.
+  uint32_t nheap;	//!< Number of pending events.
+  uint32_t nodesize;	//!< Size of each node, to detect a different compilation.
+} ts_frontier_header;
+
+/**
+ * @brief Initialises the parameter-dependent variables and functions of the
+ * time-ordered simulation.
+ *
+ * @param sv: Pointer to the simulation handle.
+ */
+static void timesim_init_pars(sim_vars* sv)
+{
+  ran_log_init(&sv->rl, (rng_stream*)sv->r->state, sv->pars.p);
+#ifdef DUAL_PINF
+  BR_GENINF_COND(&& (sv->pars.ppip==0 || sv->pars.rpinfp==1));
+#else
+  BR_GENINF_COND();
+#endif
+}
+
+/**
+ * @brief Frees all the nodes of a frontier, except its root node.
+ *
+ * @param fr: Pointer to the frontier.
+ */
+static void ts_frontier_reset(ts_frontier* fr)
+{
+  fr->nunodes=1;
+  fr->nfreenodes=0;
+  fr->nheap=0;
+  fr->time=-INFINITY;
+}
+
+/**
+ * @brief Grows the number of allocated nodes of a frontier.
+ *
+ * The pointers to the existing nodes are invalidated.
+ *
+ * @param fr: Pointer to the frontier.
+ * @param nfree: Minimum number of free nodes after the call.
+ */
+static void ts_frontier_grow(ts_frontier* fr, const uint32_t nfree)
+{
+  uint32_t nanodes=fr->nanodes;
+  uint32_t i;
+
+  while(nanodes-fr->nunodes+fr->nfreenodes<nfree) nanodes*=TSNODES_GROW_FACT;
+  DEBUG_PRINTF("Growing frontier nodes to %u\n",nanodes);
+  fr->nodes=(ts_node*)realloc(fr->nodes,nanodes*sizeof(ts_node));
+  fr->iidata=(char*)realloc(fr->iidata,nanodes*fr->iidatasize);
+  fr->freenodes=(uint32_t*)realloc(fr->freenodes,nanodes*sizeof(uint32_t));
+  fr->heap=(uint32_t*)realloc(fr->heap,nanodes*sizeof(uint32_t));
+
+  for(i=0; i<nanodes; ++i) fr->nodes[i].ii.dataptr=fr->iidata+i*fr->iidatasize;
+  fr->nanodes=nanodes;
+}
+
+/**
+ * @brief Returns the number of free nodes of a frontier.
+ *
+ * @param fr: Pointer to the frontier.
+ */
+inline static uint32_t ts_frontier_nfree(ts_frontier const* fr){return fr->nanodes-fr->nunodes+fr->nfreenodes;}
+
+/**
+ * @brief Allocates a free node.
+ *
+ * The nodes that were freed during the current path are reused first.
+ *
+ * @param fr: Pointer to the frontier, which must have a free node.
+ * @return the index of the node.
+ */
+inline static uint32_t ts_node_alloc(ts_frontier* fr){return (fr->nfreenodes?fr->freenodes[--fr->nfreenodes]:fr->nunodes++);}
+
+/**
+ * @brief Adds a node to the heap of pending events.
+ *
+ * @param fr: Pointer to the frontier.
+ * @param node: Index of the node.
+ */
+static void ts_heap_push(ts_frontier* fr, const uint32_t node)
+{
+  const double t=fr->nodes[node].next_event_time;
+  uint32_t i=fr->nheap++;
+  uint32_t p;
+
+  while(i) {
+    p=(i-1)/2;
+
+    if(fr->nodes[fr->heap[p]].next_event_time<=t) break;
+    fr->heap[i]=fr->heap[p];
+    i=p;
+  }
+  fr->heap[i]=node;
+}
+
+/**
+ * @brief Removes the node with the earliest pending event from the heap of
+ * pending events.
+ *
+ * @param fr: Pointer to the frontier.
+ * @return the index of the node.
+ */
+static uint32_t ts_heap_pop(ts_frontier* fr)
+{
+  const uint32_t top=fr->heap[0];
+  const uint32_t last=fr->heap[--fr->nheap];
+  const double t=fr->nodes[last].next_event_time;
+  uint32_t i=0;
+  uint32_t c;
+
+  for(;;) {
+    c=2*i+1;
+
+    if(c>=fr->nheap) break;
+
+    if(c+1<fr->nheap && fr->nodes[fr->heap[c+1]].next_event_time<fr->nodes[fr->heap[c]].next_event_time) ++c;
+
+    if(t<=fr->nodes[fr->heap[c]].next_event_time) break;
+    fr->heap[i]=fr->heap[c];
+    i=c;
+  }
+  fr->heap[i]=last;
+  return top;
+}
+
+/**
+ * @brief Generates the time of the next pending transmission event of a node.
+ *
+ * The transmission events of an individual are uniformly distributed over
+ * its communicable period. They are generated in increasing order, the next
+ * event time being the minimum of the remaining event times over the end of
+ * the communicable period.
+ *
+ * @param sv: Pointer to the simulation handle.
+ * @param node: Pointer to the node, whose next_event_time is the time of
+ * its previous event, or the start of its communicable period.
+ */
+inline static void ts_gen_next_event_time(sim_vars* sv, ts_node* node)
+{
+  node->next_event_time+=(node->ii.end_comm_period-node->next_event_time)*(1-pow(gsl_rng_uniform(sv->r),1./(node->ii.nevents-node->cureventi)));
+}
+
+/**
+ * @brief Releases a reference to a node, and frees the node and its
+ * ancestors that are no longer referenced.
+ *
+ * @param fr: Pointer to the frontier.
+ * @param node: Index of the node.
+ */
+inline static void ts_node_release(ts_frontier* fr, uint32_t node)
+{
+  while(node && !--fr->nodes[node].nrefs) {
+    fr->freenodes[fr->nfreenodes++]=node;
+    node=fr->nodes[node].parent;
+  }
+}
+
+/**
+ * @brief Generates the transmission events of a new infectious individual,
+ * whose time periods have been generated.
+ *
+ * @param sv: Pointer to the simulation handle.
+ * @param fr: Pointer to the frontier.
+ * @param n: Index of the node of the individual.
+ * @param full_comm_period: Communicable period of the individual, including
+ * its part before time 0 that is not simulated for a seed individual. It
+ * determines the overlap of the contact tracing window with the latent period.
+ */
+static void ts_node_start(sim_vars* sv, ts_frontier* fr, const uint32_t n, const double full_comm_period)
+{
+  model_pars const* sim=&(sv->pars);
+  ts_node* node=fr->nodes+n;
+  ts_node* parent=fr->nodes+node->parent;
+#ifdef CT_OUTPUT
+  uint32_t npevents=0;
+  int e;
+  double end_latent_per;
+  double ct_latent_overlap;
+
+  //If the CT window starts before the communicable period, generate
+  //pseudo-events and calculate the number of traced contacts
+  if(full_comm_period<sim->ctwindow) {
+    ct_latent_overlap=sim->ctwindow-full_comm_period;
+    npevents=gsl_ran_poisson(sv->r, sim->lambda*ct_latent_overlap);
+    DEBUG_PRINTF("Number of pre-events is %u during %f\n",npevents,ct_latent_overlap);
+
+    if(npevents) {
+      sv->new_inf_proc_func(sv, &node->ii, &parent->ii);
+      node->ii.ninfections=0;
+      node->ii.ntracedicts=0;
+      end_latent_per=node->ii.end_comm_period-full_comm_period;
+
+      for(e=npevents-1; e>=0; --e) {
+	sv->event_time=end_latent_per-ct_latent_overlap*gsl_rng_uniform(sv->r);
+	node->ii.nattendees=sv->gen_att_func(sv);
+	node->ii.ntracednicts=gsl_ran_binomial(sv->r, sim->pt, node->ii.nattendees-1);
+	sv->new_event_proc_func(sv, &node->ii);
+      }
+    }
+  }
+#endif
+
+  node->ii.nevents=gsl_ran_poisson(sv->r, sim->lambda*node->ii.comm_period);
+  DEBUG_PRINTF("Nevents (%f*%f) is %i\n", sim->lambda, node->ii.comm_period, node->ii.nevents);
+
+  if(!node->ii.nevents) {
+#ifdef CT_OUTPUT
+    if(!npevents) sv->new_inf_proc_func_noevent(sv, &node->ii, &parent->ii);
+    else sv->end_inf_proc_func(sv, &node->ii, &parent->ii);
+#else
+    sv->new_inf_proc_func_noevent(sv, &node->ii, &parent->ii);
+#endif
+    ts_node_release(fr, n);
+    return;
+  }
+
+#ifdef CT_OUTPUT
+  if(!npevents) sv->new_inf_proc_func(sv, &node->ii, &parent->ii);
+#else
+  sv->new_inf_proc_func(sv, &node->ii, &parent->ii);
+#endif
+  node->cureventi=0;
+  node->next_event_time=node->ii.end_comm_period-node->ii.comm_period;
+  ts_gen_next_event_time(sv, node);
+  ts_heap_push(fr, n);
+}
+
+/**
+ * @brief Processes the earliest pending transmission event.
+ *
+ * @param sv: Pointer to the simulation handle.
+ * @param fr: Pointer to the frontier.
+ */
+static void ts_process_event(sim_vars* sv, ts_frontier* fr)
+{
+#ifdef DUAL_PINF
+  model_pars const* sim=&(sv->pars);
+#endif
+  const uint32_t n=ts_heap_pop(fr);
+  ts_node* node=fr->nodes+n;
+  ts_node* child;
+  uint32_t c, i;
+
+  sv->event_time=node->next_event_time;
+  DEBUG_PRINTF("Event %i/%i at time %f\n",node->cureventi,node->ii.nevents,sv->event_time);
+  sv->brsim.gen_att_inf_func(sv, &node->ii);
+#ifdef CT_OUTPUT
+  if((node->ii.commpertype&ro_commper_true_positive_test) && sv->event_time>=node->ii.end_comm_period-sv->pars.ctwindow) {
+    node->ii.ntracednicts=gsl_ran_binomial(sv->r, sv->pars.pt, node->ii.nattendees-1-node->ii.ninfections);
+
+    if(node->ii.ninfections) node->ii.ntracedicts=gsl_ran_binomial(sv->r, sv->pars.pt, node->ii.ninfections);
+    else node->ii.ntracedicts=0;
+    node->ii.gen_ct_time_periods_func=sv->gen_time_periods_func;
+
+  } else {
+    node->ii.ntracednicts=node->ii.ntracedicts=0;
+    node->ii.gen_ct_time_periods_func=sv->gen_time_periods_func_no_int;
+  }
+#endif
+
+  if(sv->new_event_proc_func(sv, &node->ii) && node->ii.ninfections) {
+    //The event time is modified by the latent pseudo-events of the children
+    const double event_time=sv->event_time;
+
+    if(ts_frontier_nfree(fr)<node->ii.ninfections) {
+      ts_frontier_grow(fr, node->ii.ninfections);
+      node=fr->nodes+n;
+    }
+
+    for(i=0; i<node->ii.ninfections; ++i) {
+      c=ts_node_alloc(fr);
+      child=fr->nodes+c;
+      child->ii.generation=node->ii.generation+1;
+      child->parent=n;
+      child->nrefs=1;
+      ++node->nrefs;
+      sv->event_time=event_time;
+
+#ifdef DUAL_PINF
+      //The number of infections is known, so the infection category must be
+      //randomly assigned based on the counts of remaining individuals for
+      //each category.
+      if(gsl_rng_uniform(sv->r) < ((double)node->ii.ninfectionsp) / (node->ii.ninfectionsf + node->ii.ninfectionsp)) {
+	--(node->ii.ninfectionsp);
+	child->ii.inftypep=true;
+	child->ii.q=sim->qp;
+	child->ii.pinf=sim->pinf*sim->rpshedp;
+
+      } else {
+	--(node->ii.ninfectionsf);
+	child->ii.inftypep=false;
+	child->ii.q=sim->q;
+	child->ii.pinf=sim->pinf;
+      }
+#endif
+#ifdef CT_OUTPUT
+      child->ii.traced=(i < node->ii.ntracedicts);
+      node->ii.gen_ct_time_periods_func(sv, &child->ii, &node->ii, event_time);
+#else
+      sv->gen_time_periods_func(sv, &child->ii, &node->ii, event_time);
+#endif
+      ts_node_start(sv, fr, c, child->ii.comm_period);
+    }
+    sv->event_time=event_time;
+  }
+
+  if(++(node->cureventi) < node->ii.nevents) {
+    ts_gen_next_event_time(sv, node);
+    ts_heap_push(fr, n);
+
+  } else {
+    sv->end_inf_proc_func(sv, &node->ii, &fr->nodes[node->parent].ii);
+    ts_node_release(fr, n);
+  }
+}
+
+/**
+ * @brief Generates the time periods of a seed individual.
+ *
+ * The time periods are sampled by rejection, conditionally on the infection
+ * phase at time 0 and on the testing status of the seed individual, and its
+ * communicable period is then truncated to its part after time 0. The
+ * summary statistics recover the infection time as
+ * end_comm_period-(comm_period+latent_period), so the end of the
+ * communicable period is recomputed from this sum, and the periods of a
+ * truncated individual are assigned directly, such that this difference is
+ * exactly the seed infection time.
+ *
+ * @param sv: Pointer to the simulation handle.
+ * @param seed: Pointer to the seed individual.
+ * @param ii: Infectious individual.
+ * @param root: Root individual.
+ * @param full_comm_period: Returns the communicable period before its
+ * truncation.
+ * @return 0 on success, -1 if no time periods satisfying the conditions
+ * were generated after TS_SEED_MAX_ATTEMPTS attempts.
+ */
+static int ts_seed_gen_time_periods(sim_vars* sv, ts_seed const* seed, infindividual* ii, infindividual* root, double* full_comm_period)
+{
+  double end_latent_per;
+  uint32_t i;
+
+  for(i=0; i<TS_SEED_MAX_ATTEMPTS; ++i) {
+    //The parent of a seed individual is unknown, so its communicable period
+    //cannot be interrupted by contact tracing
+    sv->gen_time_periods_func_no_int(sv, ii, root, seed->inftime);
+    ii->end_comm_period=(ii->comm_period+ii->latent_period)+seed->inftime;
+    end_latent_per=ii->end_comm_period-ii->comm_period;
+
+    if((seed->phase==ts_seed_latent?end_latent_per>0:end_latent_per<=0 && ii->end_comm_period>0) && (seed->test==ts_seed_test_unknown || (seed->test==ts_seed_test_positive)==((ii->commpertype&ro_commper_true_positive_test)!=0))) {
+      DEBUG_PRINTF("Seed individual infected at %f: latent period is %f, comm period is %f, end comm is %f (%u attempts)\n",seed->inftime,ii->latent_period,ii->comm_period,ii->end_comm_period,i+1);
+
+      *full_comm_period=ii->comm_period;
+
+      if(end_latent_per<0) {
+	ii->comm_period=ii->end_comm_period;
+	ii->latent_period=-seed->inftime;
+      }
+      return 0;
+    }
+  }
+  fprintf(stderr,"%s: Error: Cannot sample time periods for a seed individual infected at time %f that are consistent with its infection phase and testing status\n",__func__,seed->inftime);
+  return -1;
+}
+
+void timesim_init(sim_vars* sv, const size_t iidatasize)
+{
+  sv->brsim.layers=NULL;
+  sv->brsim.nlayers=0;
+  sv->brsim.frontier=(ts_frontier*)malloc(sizeof(ts_frontier));
+  sv->brsim.seeds=NULL;
+  sv->brsim.nseeds=0;
+  ts_frontier_init(sv->brsim.frontier, iidatasize);
+  timesim_init_pars(sv);
+}
+
+int timesim_path_start(sim_vars* sv)
+{
+  ts_frontier* fr=sv->brsim.frontier;
+  ts_seed const* const seeds=sv->brsim.seeds;
+  ts_node* node;
+  ts_node* root;
+  double full_comm_period;
+  uint32_t n;
+  int32_t i;
+  int32_t nstart;
+
+#ifdef DUAL_PINF
+  model_pars const* sim=&(sv->pars);
+  const double pinfpinf=sim->ppip*sim->rpinfp/(1+sim->ppip*(sim->rpinfp-1));
+  const bool pri_first_cat=sim->pricommpertype&ro_pricommper_first_cat;
+  const bool pri_second_cat=sim->pricommpertype&ro_pricommper_second_cat;
+#endif
+
+  ts_frontier_reset(fr);
+  nstart=(seeds?sv->brsim.nseeds:sv->gen_n_pri_inf(sv));
+  sv->path_init_proc_func(sv);
+
+  for(i=nstart-1; i>=0; --i) {
+    DEBUG_PRINTF("initial individual %i\n",i);
+
+    if(!ts_frontier_nfree(fr)) ts_frontier_grow(fr, 1);
+    root=fr->nodes;
+    n=ts_node_alloc(fr);
+    node=fr->nodes+n;
+    node->ii.generation=(seeds?seeds[i].generation:1);
+    node->parent=0;
+    node->nrefs=1;
+    sv->event_time=0;
+
+#ifdef DUAL_PINF
+    if(pri_second_cat || (!pri_first_cat && gsl_rng_uniform(sv->r) < pinfpinf)) {
+#ifdef SEC_INF_TIMELINES
+      root->ii.ninfectionsf=0;
+      root->ii.ninfectionsp=1;
+#endif
+      node->ii.inftypep=true;
+      node->ii.q=sim->qp;
+      node->ii.pinf=sim->pinf*sim->rpshedp;
+
+    } else {
+#ifdef SEC_INF_TIMELINES
+      root->ii.ninfectionsf=1;
+      root->ii.ninfectionsp=0;
+#endif
+      node->ii.inftypep=false;
+      node->ii.q=sim->q;
+      node->ii.pinf=sim->pinf;
+    }
+#endif
+
+    if(seeds) {
+
+      if(ts_seed_gen_time_periods(sv, seeds+i, &node->ii, &root->ii, &full_comm_period)) return -1;
+      sv->event_time=seeds[i].inftime;
+
+    } else {
+      sv->gen_pri_time_periods_func(sv, &node->ii, &root->ii, 0);
+      sv->gen_time_origin_func(sv, &node->ii);
+      full_comm_period=node->ii.comm_period;
+    }
+    sv->pri_init_proc_func(sv, &root->ii, &node->ii);
+    ts_node_start(sv, fr, n, full_comm_period);
+  }
+  return 0;
+}
+
+uint32_t timesim_advance(sim_vars* sv, const double time)
+{
+  ts_frontier* fr=sv->brsim.frontier;
+
+  while(fr->nheap && fr->nodes[fr->heap[0]].next_event_time<time) ts_process_event(sv, fr);
+
+  if(time>fr->time) fr->time=time;
+  return fr->nheap;
+}
+
+bool timesim_path_end(sim_vars* sv)
+{
+  timesim_advance(sv, INFINITY);
+  return sv->path_end_proc_func(sv);
+}
+
+int timesim(sim_vars* sv)
+{
+  do {
+
+    if(timesim_path_start(sv)) return -1;
+
+  } while(!timesim_path_end(sv));
+
+  return 0;
+}
+
+void timesim_free(sim_vars* sv)
+{
+  ts_frontier_free(sv->brsim.frontier);
+  free(sv->brsim.frontier);
+}
+
+void ts_frontier_init(ts_frontier* fr, const size_t iidatasize)
+{
+  uint32_t i;
+
+  fr->iidatasize=iidatasize;
+  fr->nanodes=INIT_N_TSNODES;
+  fr->nodes=(ts_node*)malloc(INIT_N_TSNODES*sizeof(ts_node));
+  fr->iidata=(char*)malloc(INIT_N_TSNODES*iidatasize);
+  fr->freenodes=(uint32_t*)malloc(INIT_N_TSNODES*sizeof(uint32_t));
+  fr->heap=(uint32_t*)malloc(INIT_N_TSNODES*sizeof(uint32_t));
+
+  for(i=0; i<INIT_N_TSNODES; ++i) fr->nodes[i].ii.dataptr=fr->iidata+i*iidatasize;
+  fr->nodes[0].parent=0;
+  fr->nodes[0].ii.commpertype=0;
+  fr->nodes[0].ii.generation=0;
+  fr->nodes[0].ii.nevents=1;
+  fr->nodes[0].ii.nattendees=1;
+  fr->nodes[0].ii.ninfections=1;
+  fr->nodes[0].cureventi=0;
+  fr->nodes[0].nrefs=1;
+  ts_frontier_reset(fr);
+}
+
+void ts_frontier_copy(ts_frontier* dst, ts_frontier const* src)
+{
+  uint32_t i;
+
+  if(dst->nanodes<src->nunodes || dst->iidatasize!=src->iidatasize) {
+
+    if(dst->nanodes<src->nunodes) dst->nanodes=src->nunodes;
+    dst->iidatasize=src->iidatasize;
+    dst->nodes=(ts_node*)realloc(dst->nodes,dst->nanodes*sizeof(ts_node));
+    dst->iidata=(char*)realloc(dst->iidata,dst->nanodes*dst->iidatasize);
+    dst->freenodes=(uint32_t*)realloc(dst->freenodes,dst->nanodes*sizeof(uint32_t));
+    dst->heap=(uint32_t*)realloc(dst->heap,dst->nanodes*sizeof(uint32_t));
+
+    for(i=src->nunodes; i<dst->nanodes; ++i) dst->nodes[i].ii.dataptr=dst->iidata+i*dst->iidatasize;
+  }
+  //The unused nodes are not copied
+  memcpy(dst->nodes,src->nodes,src->nunodes*sizeof(ts_node));
+  memcpy(dst->iidata,src->iidata,src->nunodes*src->iidatasize);
+  memcpy(dst->freenodes,src->freenodes,src->nfreenodes*sizeof(uint32_t));
+  memcpy(dst->heap,src->heap,src->nheap*sizeof(uint32_t));
+
+  for(i=0; i<src->nunodes; ++i) dst->nodes[i].ii.dataptr=dst->iidata+i*dst->iidatasize;
+  dst->nunodes=src->nunodes;
+  dst->nfreenodes=src->nfreenodes;
+  dst->nheap=src->nheap;
+  dst->time=src->time;
+}
+
+size_t ts_frontier_serialised_size(ts_frontier const* fr)
+{
+  return sizeof(ts_frontier_header)+fr->nunodes*(sizeof(ts_node)+fr->iidatasize)+(fr->nfreenodes+fr->nheap)*sizeof(uint32_t);
+}
+
+void ts_frontier_serialise(ts_frontier const* fr, void* buf)
+{
+  ts_frontier_header hdr={fr->iidatasize, fr->time, fr->nunodes, fr->nfreenodes, fr->nheap, sizeof(ts_node)};
+  char* ptr=(char*)buf;
+
+  memcpy(ptr,&hdr,sizeof(hdr));
+  ptr+=sizeof(hdr);
+  memcpy(ptr,fr->nodes,fr->nunodes*sizeof(ts_node));
+  ptr+=fr->nunodes*sizeof(ts_node);
+  memcpy(ptr,fr->iidata,fr->nunodes*fr->iidatasize);
+  ptr+=fr->nunodes*fr->iidatasize;
+  memcpy(ptr,fr->freenodes,fr->nfreenodes*sizeof(uint32_t));
+  ptr+=fr->nfreenodes*sizeof(uint32_t);
+  memcpy(ptr,fr->heap,fr->nheap*sizeof(uint32_t));
+}
+
+int ts_frontier_deserialise(ts_frontier* fr, const void* buf, const size_t size)
+{
+  char const* ptr=(char const*)buf;
+  ts_frontier_header hdr;
+  ts_frontier src;
+  uint32_t i;
+
+  if(size<sizeof(hdr)) {
+    fprintf(stderr,"%s: Error: Truncated frontier\n",__func__);
+    return -1;
+  }
+  memcpy(&hdr,ptr,sizeof(hdr));
+
+  if(hdr.nodesize!=sizeof(ts_node) || hdr.iidatasize!=fr->iidatasize) {
+    fprintf(stderr,"%s: Error: Frontier was serialised by an incompatible simulation\n",__func__);
+    return -1;
+  }
+
+  src.iidatasize=hdr.iidatasize;
+  src.time=hdr.time;
+  src.nanodes=src.nunodes=hdr.nunodes;
+  src.nfreenodes=hdr.nfreenodes;
+  src.nheap=hdr.nheap;
+
+  if(!src.nunodes || src.nfreenodes>=src.nunodes || src.nheap>=src.nunodes || size!=ts_frontier_serialised_size(&src)) {
+    fprintf(stderr,"%s: Error: Invalid frontier size\n",__func__);
+    return -1;
+  }
+  ptr+=sizeof(hdr);
+  src.nodes=(ts_node*)ptr;
+  ptr+=src.nunodes*sizeof(ts_node);
+  src.iidata=(char*)ptr;
+  ptr+=src.nunodes*src.iidatasize;
+  src.freenodes=(uint32_t*)ptr;
+  ptr+=src.nfreenodes*sizeof(uint32_t);
+  src.heap=(uint32_t*)ptr;
+
+  //The buffer can be unaligned, so it is only accessed through memcpy
+  ts_frontier_copy(fr, &src);
+
+  for(i=0; i<fr->nfreenodes; ++i) if(!fr->freenodes[i] || fr->freenodes[i]>=fr->nunodes) goto invalid;
+
+  for(i=0; i<fr->nheap; ++i) if(!fr->heap[i] || fr->heap[i]>=fr->nunodes) goto invalid;
+
+  for(i=0; i<fr->nunodes; ++i) {
+
+    if(fr->nodes[i].parent>=fr->nunodes) goto invalid;
+#ifdef CT_OUTPUT
+    //Function pointers are not valid across processes. They are reassigned
+    //for each transmission event before being used
+    fr->nodes[i].ii.gen_ct_time_periods_func=NULL;
+#endif
+  }
+  return 0;
+
+invalid:
+  fprintf(stderr,"%s: Error: Invalid frontier node index\n",__func__);
+  ts_frontier_reset(fr);
+  return -1;
+}
+
+void ts_frontier_free(ts_frontier* fr)
+{
+  free(fr->nodes);
+  free(fr->iidata);
+  free(fr->freenodes);
+  free(fr->heap);
+}
@@ -0,0 +1,236 @@
+/**
+ * @file timesim.h
+ * @brief Time-ordered branching simulation functions.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * The time-ordered simulation generates the same branching process as
+ * branchsim, but processes the transmission events of a path in increasing
+ * time order instead of depth-first. The state of a path, or frontier,
+ * consists of the infectious individuals that are still live, either
+ * because they have pending transmission events, or because they are the
+ * parent of a live individual, and of a heap of the pending events. Each
+ * live individual with pending events has exactly one event in the heap,
+ * as its event times are generated sequentially in increasing order. A path
+ * can thus be suspended at any time, copied cheaply for resampling,
+ * serialised and resumed later, while calling the same user-defined
+ * processing functions as branchsim. The user-defined data of each
+ * individual is stored in the frontier, such that it must have a fixed size
+ * and must not contain pointers.
+ *
+ * Instead of primary individuals, the paths can start from a snapshot of the
+ * infections that are current at time 0. The time periods of each seed
+ * individual are sampled conditionally on its infection time, on its
+ * infection phase at time 0 and on its testing status. The communicable
+ * period of a seed individual that is communicable at time 0 is truncated
+ * to its remaining part, over which its transmission events are generated,
+ * such that its statistics only include the infections that occur after
+ * time 0.
+ */
+
+#ifndef _TIMESIM_
+#define _TIMESIM_
+
+#include "branchsim.h"
+
+#define INIT_N_TSNODES (64) //!< Initial number of frontier nodes
+#define TSNODES_GROW_FACT (1.5)  //!< Growing factor for the frontier nodes.
+#define TS_SEED_MAX_ATTEMPTS (100000) //!< Maximum number of attempts to sample the time periods of a seed individual
+
+/**
+ * Infection phase of a seed individual at time 0.
+ */
+enum ts_seed_phase {ts_seed_latent, ts_seed_comm};
+
+/**
+ * Testing status of a seed individual. A positive individual has a
+ * communicable period that ends with a true positive test.
+ */
+enum ts_seed_test {ts_seed_test_unknown, ts_seed_test_negative, ts_seed_test_positive};
+
+/**
+ * Seed individual of a snapshot of current infections.
+ */
+typedef struct ts_seed_ {
+  double inftime;		//!< Infection time, which cannot be positive.
+  uint32_t generation;		//!< Infection generation, which must be at least 1.
+  uint8_t phase;		//!< Infection phase at time 0 (value set using ts_seed_phase).
+  uint8_t test;			//!< Testing status (value set using ts_seed_test).
+} ts_seed;
+
+/**
+ * Frontier node.
+ */
+typedef struct {
+  infindividual ii;		//!< Infectious individual.
+  double next_event_time;	//!< Time of the next pending transmission event.
+  uint32_t cureventi;		//!< Index of the next pending transmission event.
+  uint32_t parent;		//!< Index of the parent node.
+  uint32_t nrefs;		//!< Number of references to the node: one while the individual has pending transmission events, and one for each live child.
+} ts_node;
+
+/**
+ * Frontier of a path of the time-ordered simulation.
+ */
+typedef struct ts_frontier_ {
+  ts_node* nodes;		//!< Nodes. The first node is the root individual of the primary individuals.
+  char* iidata;			//!< Contiguous storage for the user-defined data of the nodes.
+  uint32_t* freenodes;		//!< Stack of the indices of the free nodes below nunodes.
+  uint32_t* heap;		//!< Binary heap of the indices of the nodes with pending events, ordered by next_event_time.
+  size_t iidatasize;		//!< Size of the user-defined data of each node.
+  double time;			//!< Time up to which the path has been simulated.
+  uint32_t nanodes;		//!< Number of allocated nodes.
+  uint32_t nunodes;		//!< Number of used nodes. The nodes from this index have not been used since the start of the path and are free.
+  uint32_t nfreenodes;		//!< Number of free nodes in the stack.
+  uint32_t nheap;		//!< Number of pending events.
+} ts_frontier;
+
+/**
+ * @brief Initialises the time-ordered simulation.
+ *
+ * This function must be called to initialise the time-ordered simulation,
+ * instead of branchsim_init. The parameters are changed using
+ * branchsim_set_pars, and the user-defined function set using
+ * sim_set_ii_alloc_proc_func is not called.
+ *
+ * @param sv: Pointer to the simulation handle.
+ * @param iidatasize: Size of the user-defined data of each infectious
+ * individual.
+ */
+void timesim_init(sim_vars* sv, const size_t iidatasize);
+
+/**
+ * @brief Sets the snapshot of current infections the paths start from.
+ *
+ * The simulation time type must be ro_time_snapshot. The number of primary
+ * individuals and their time periods are then not used. The seed individuals
+ * are not copied.
+ *
+ * @param sv: Pointer to the simulation handle.
+ * @param seeds: Seed individuals, or NULL to start from primary individuals.
+ * @param nseeds: Number of seed individuals.
+ */
+inline static void timesim_set_seeds(sim_vars* sv, ts_seed const* seeds, const uint32_t nseeds){sv->brsim.seeds=seeds; sv->brsim.nseeds=nseeds;}
+
+/**
+ * @brief Starts a new path.
+ *
+ * The primary or seed individuals are created and the path is suspended at
+ * time -INFINITY, before any transmission event.
+ *
+ * @param sv: Pointer to the simulation handle.
+ * @return 0 on success, -1 if the time periods of a seed individual could
+ * not be sampled.
+ */
+int timesim_path_start(sim_vars* sv);
+
+/**
+ * @brief Advances the current path.
+ *
+ * All the pending transmission events that occur before the provided time
+ * are processed, in increasing time order, and the path is suspended.
+ *
+ * @param sv: Pointer to the simulation handle.
+ * @param time: Time until which the path is simulated.
+ * @return the number of remaining pending events.
+ */
+uint32_t timesim_advance(sim_vars* sv, const double time);
+
+/**
+ * @brief Ends the current path.
+ *
+ * All the remaining transmission events are processed.
+ *
+ * @param sv: Pointer to the simulation handle.
+ * @return the value returned by the path_end_proc_func user-defined
+ * function.
+ */
+bool timesim_path_end(sim_vars* sv);
+
+/**
+ * @brief Performs the time-ordered simulation.
+ *
+ * Performs the simulation as branchsim does, as configured through the
+ * simulation variables. This function can be called multiple times in a row.
+ *
+ * @param sv: Pointer to the simulation variables.
+ * @return 0 if there is no error.
+ */
+int timesim(sim_vars* sv);
+
+/**
+ * @brief Frees the dynamic memory used in the simulation handle.
+ *
+ * Does not free the memory related to the simulation-level data pointer
+ * for the user-defined functions.
+ *
+ * @param sv: Pointer to the simulation variables.
+ */
+void timesim_free(sim_vars* sv);
+
+/**
+ * @brief Initialises an empty frontier.
+ *
+ * @param fr: Pointer to the frontier.
+ * @param iidatasize: Size of the user-defined data of each infectious
+ * individual.
+ */
+void ts_frontier_init(ts_frontier* fr, const size_t iidatasize);
+
+/**
+ * @brief Copies a frontier.
+ *
+ * Only the nodes used by the current path are copied, such that the cost
+ * of the copy does not depend on the number of allocated nodes. The memory
+ * of the destination frontier is reused when it is large enough.
+ *
+ * @param dst: Pointer to the initialised destination frontier.
+ * @param src: Pointer to the source frontier.
+ */
+void ts_frontier_copy(ts_frontier* dst, ts_frontier const* src);
+
+/**
+ * @brief Returns the size of the serialised frontier.
+ *
+ * @param fr: Pointer to the frontier.
+ */
+size_t ts_frontier_serialised_size(ts_frontier const* fr);
+
+/**
+ * @brief Serialises a frontier.
+ *
+ * The serialised frontier can only be read by a program compiled with the
+ * same compilation flags.
+ *
+ * @param fr: Pointer to the frontier.
+ * @param buf: Output buffer, of size ts_frontier_serialised_size.
+ */
+void ts_frontier_serialise(ts_frontier const* fr, void* buf);
+
+/**
+ * @brief Deserialises a frontier.
+ *
+ * @param fr: Pointer to the initialised frontier.
+ * @param buf: Serialised frontier.
+ * @param size: Size of the serialised frontier.
+ * @return 0 on success, -1 if the serialised frontier is invalid.
+ */
+int ts_frontier_deserialise(ts_frontier* fr, const void* buf, const size_t size);
+
+/**
+ * @brief Frees the memory used by a frontier.
+ *
+ * @param fr: Pointer to the frontier.
+ */
+void ts_frontier_free(ts_frontier* fr);
+
+/**
+ * @brief Returns the frontier of the current path.
+ *
+ * The frontier can be swapped with another one to suspend the current path
+ * and resume another path.
+ *
+ * @param sv: Pointer to the simulation handle.
+ */
+inline static ts_frontier* timesim_frontier(sim_vars* sv){return sv->brsim.frontier;}
+
+#endif
@@ -0,0 +1,393 @@
+/**
+ * @file tlout_codec.h
+ * @brief Functions to encode and decode the records of timeline output files.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ *
+ * In the encoded format, which is flagged in the file header, each integer is
+ * stored as an unsigned LEB128 varint (7 bits per byte, least significant
+ * group first, the most significant bit of a byte being set when more bytes
+ * follow). Signed integers are zig-zag mapped first, such that small
+ * magnitudes use few bytes. Each timeline of a record is stored as a
+ * sequence of tokens that describe the differences between successive bins,
+ * starting from a value of zero before the first bin. A token with its least
+ * significant bit set describes a run of (token>>1)+1 zero differences, and
+ * a token with its least significant bit cleared describes a single non-zero
+ * difference whose zig-zag mapped value is token>>1.
+ */
+
+#ifndef _TLOUT_CODEC_
+#define _TLOUT_CODEC_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <endian.h>
+#include <sys/types.h>
+
+#define TLO_HEADER_SIZE (5)		//!< Size of the file header
+#define TLO_FLAG_POSTEST (8)		//!< Header flag for the positive test timelines
+#define TLO_FLAG_SECINF (16)		//!< Header flag for the timelines of the second category of infection
+#define TLO_FLAG_ENCODED (32)		//!< Header flag for encoded records
+#define TLO_FLAG_SELECTED (64)		//!< Header flag for files that only contain selected paths, the header then ending with the number of skipped paths
+
+#define TLO_VARINT_MAXSIZE (5)		//!< Maximum encoded size of a 32 bit integer or of a timeline token
+
+/**
+ * Decoded timeline output record.
+ */
+typedef struct {
+  uint32_t nbins;	//!< Number of time bins.
+  uint32_t nbefore;	//!< Number of time bins before t=0.
+  int32_t maxedout;	//!< Period where the path maxes out a limit, or INT32_MAX.
+  int32_t extinction;	//!< Period where the path goes extinct, INT32_MAX or -INT32_MAX.
+  uint32_t* values;	//!< Timeline values, stored one timeline after the other.
+  uint32_t size;	//!< Allocated number of values.
+} tlo_record;
+
+/**
+ * @brief Returns whether timeline records include the number of bins before
+ * t=0 for the given header flags.
+ */
+inline static bool tlo_has_reltime(const uint8_t flags){return (flags&7)!=1;}
+
+/**
+ * @brief Returns the size of the file header for the given header flags.
+ */
+inline static uint32_t tlo_header_size(const uint8_t flags){return TLO_HEADER_SIZE+((flags&TLO_FLAG_SELECTED)?8:0);}
+
+/**
+ * @brief Returns the number of timelines per record for the given header
+ * flags.
+ */
+inline static uint32_t tlo_ntimelines(const uint8_t flags){return (2+((flags&TLO_FLAG_POSTEST)!=0))*(1+((flags&TLO_FLAG_SECINF)!=0));}
+
+/**
+ * @brief Zig-zag maps a signed integer.
+ */
+inline static uint64_t tlo_zigzag(const int64_t v){return ((uint64_t)v<<1)^(uint64_t)(v>>63);}
+
+/**
+ * @brief Reverses the zig-zag mapping of an integer.
+ */
+inline static int64_t tlo_unzigzag(const uint64_t u){return (int64_t)(u>>1)^-(int64_t)(u&1);}
+
+/**
+ * @brief Writes an unsigned varint.
+ *
+ * @param buf: Output memory buffer.
+ * @param v: Value.
+ * @return a pointer to the byte following the written varint.
+ */
+inline static uint8_t* tlo_put_varint(uint8_t* buf, uint64_t v)
+{
+  while(v>=0x80) {
+    *buf++=(uint8_t)(v|0x80);
+    v>>=7;
+  }
+  *buf++=(uint8_t)v;
+  return buf;
+}
+
+/**
+ * @brief Reads an unsigned varint.
+ *
+ * @param buf: Pointer to the input pointer, which is advanced past the
+ * varint.
+ * @param end: End of the input memory buffer.
+ * @param v: Decoded value.
+ * @return 0 on success, -1 if the varint is truncated or too long.
+ */
+inline static int tlo_get_varint(uint8_t const** buf, uint8_t const* end, uint64_t* v)
+{
+  uint8_t const* p=*buf;
+  uint32_t shift=0;
+  *v=0;
+
+  for(;;) {
+
+    if(p==end || shift>56) return -1;
+    *v|=(uint64_t)(*p&0x7F)<<shift;
+
+    if(!(*p++&0x80)) break;
+    shift+=7;
+  }
+  *buf=p;
+  return 0;
+}
+
+/**
+ * @brief Encodes the header of a timeline output record.
+ *
+ * @param buf: Output memory buffer.
+ * @param reltime: Whether the number of bins before t=0 is written.
+ * @param nbins: Number of time bins.
+ * @param nbefore: Number of time bins before t=0.
+ * @param maxedout: Period where the path maxes out a limit, or INT32_MAX.
+ * @param extinction: Period where the path goes extinct.
+ * @return a pointer to the byte following the encoded header.
+ */
+inline static uint8_t* tlo_encode_record_header(uint8_t* buf, const bool reltime, const uint32_t nbins, const uint32_t nbefore, const int32_t maxedout, const int32_t extinction)
+{
+  buf=tlo_put_varint(buf,nbins);
+
+  if(reltime) buf=tlo_put_varint(buf,nbefore);
+  buf=tlo_put_varint(buf,tlo_zigzag(maxedout));
+  return tlo_put_varint(buf,tlo_zigzag(extinction));
+}
+
+/**
+ * @brief Encodes a timeline.
+ *
+ * The encoded size does not exceed TLO_VARINT_MAXSIZE bytes per bin.
+ *
+ * @param buf: Output memory buffer.
+ * @param tl: Timeline values.
+ * @param nbins: Number of time bins.
+ * @return a pointer to the byte following the encoded timeline.
+ */
+inline static uint8_t* tlo_encode_timeline(uint8_t* buf, uint32_t const* tl, const uint32_t nbins)
+{
+  uint32_t prev=0;
+  uint32_t nzeros=0;
+  uint32_t b;
+
+  for(b=0; b<nbins; ++b) {
+
+    if(tl[b]==prev) ++nzeros;
+
+    else {
+
+      if(nzeros) {
+	buf=tlo_put_varint(buf,((uint64_t)(nzeros-1)<<1)|1);
+	nzeros=0;
+      }
+      buf=tlo_put_varint(buf,tlo_zigzag((int64_t)tl[b]-prev)<<1);
+      prev=tl[b];
+    }
+  }
+
+  if(nzeros) buf=tlo_put_varint(buf,((uint64_t)(nzeros-1)<<1)|1);
+  return buf;
+}
+
+/**
+ * @brief Decodes a timeline.
+ *
+ * @param buf: Pointer to the input pointer, which is advanced past the
+ * timeline.
+ * @param end: End of the input memory buffer.
+ * @param tl: Decoded timeline values.
+ * @param nbins: Number of time bins.
+ * @return 0 on success, -1 if the input is corrupted.
+ */
+inline static int tlo_decode_timeline(uint8_t const** buf, uint8_t const* end, uint32_t* tl, const uint32_t nbins)
+{
+  uint32_t prev=0;
+  uint32_t b=0;
+  uint64_t token;
+
+  while(b<nbins) {
+
+    if(tlo_get_varint(buf,end,&token)) return -1;
+
+    if(token&1) {
+
+      if((token>>1) >= nbins-b) return -1;
+      const uint32_t bend=b+(token>>1)+1;
+
+      for(; b<bend; ++b) tl[b]=prev;
+
+    } else tl[b++]=(prev+=(uint32_t)tlo_unzigzag(token>>1));
+  }
+  return 0;
+}
+
+/**
+ * @brief Returns the number of time bins of a written record.
+ *
+ * @param buf: Record memory buffer.
+ * @param encoded: Whether the record is encoded.
+ * @return the number of time bins.
+ */
+inline static uint32_t tlo_record_nbins(uint8_t const* buf, const bool encoded)
+{
+  if(encoded) {
+    uint64_t v;
+
+    tlo_get_varint(&buf,buf+TLO_VARINT_MAXSIZE,&v);
+    return v;
+  }
+  return le32toh(*(uint32_t const*)buf);
+}
+
+/**
+ * @brief Returns the size of a written record without decoding its
+ * timelines.
+ *
+ * @param buf: Input memory buffer.
+ * @param end: End of the input memory buffer.
+ * @param flags: File header flags.
+ * @return the record size in bytes, or -1 if the input is corrupted or
+ * truncated.
+ */
+inline static ssize_t tlo_record_size(uint8_t const* buf, uint8_t const* end, const uint8_t flags)
+{
+  const uint32_t ntls=tlo_ntimelines(flags);
+
+  if(!(flags&TLO_FLAG_ENCODED)) {
+    const size_t hsize=(tlo_has_reltime(flags)?16:12);
+
+    if(end-buf < (ssize_t)hsize) return -1;
+    const uint64_t size=hsize+4*(uint64_t)ntls*le32toh(*(uint32_t const*)buf);
+
+    if((uint64_t)(end-buf) < size) return -1;
+    return size;
+  }
+  uint8_t const* const start=buf;
+  uint64_t nbins, token, b;
+  uint32_t i, t;
+
+  if(tlo_get_varint(&buf,end,&nbins) || nbins>UINT32_MAX) return -1;
+
+  for(i=2+tlo_has_reltime(flags); i>0; --i) if(tlo_get_varint(&buf,end,&token)) return -1;
+
+  for(t=0; t<ntls; ++t) {
+
+    for(b=0; b<nbins;) {
+
+      if(tlo_get_varint(&buf,end,&token)) return -1;
+
+      if(token&1) {
+
+	if((token>>1) >= nbins-b) return -1;
+	b+=(token>>1)+1;
+
+      } else ++b;
+    }
+  }
+  return buf-start;
+}
+
+/**
+ * @brief Encodes a decoded record.
+ *
+ * @param buf: Output memory buffer.
+ * @param rec: Decoded record.
+ * @param flags: File header flags.
+ * @return the number of written bytes.
+ */
+inline static size_t tlo_encode_record(uint8_t* buf, tlo_record const* rec, const uint8_t flags)
+{
+  uint8_t* const start=buf;
+  const uint32_t ntls=tlo_ntimelines(flags);
+  uint32_t t;
+
+  buf=tlo_encode_record_header(buf,tlo_has_reltime(flags),rec->nbins,rec->nbefore,rec->maxedout,rec->extinction);
+
+  for(t=0; t<ntls; ++t) buf=tlo_encode_timeline(buf,rec->values+t*rec->nbins,rec->nbins);
+  return buf-start;
+}
+
+/**
+ * @brief Decodes an encoded record.
+ *
+ * @param buf: Input memory buffer.
+ * @param end: End of the input memory buffer.
+ * @param flags: File header flags.
+ * @param rec: Decoded record, whose values array is reallocated as needed.
+ * @return the number of read bytes, or -1 if the input is corrupted or
+ * truncated.
+ */
+inline static ssize_t tlo_decode_record(uint8_t const* buf, uint8_t const* end, const uint8_t flags, tlo_record* rec)
+{
+  uint8_t const* const start=buf;
+  const uint32_t ntls=tlo_ntimelines(flags);
+  uint64_t v;
+  uint32_t t;
+
+  if(tlo_get_varint(&buf,end,&v) || v>UINT32_MAX) return -1;
+  rec->nbins=v;
+
+  if(tlo_has_reltime(flags)) {
+
+    if(tlo_get_varint(&buf,end,&v) || v>UINT32_MAX) return -1;
+    rec->nbefore=v;
+
+  } else rec->nbefore=0;
+
+  if(tlo_get_varint(&buf,end,&v)) return -1;
+  rec->maxedout=tlo_unzigzag(v);
+
+  if(tlo_get_varint(&buf,end,&v)) return -1;
+  rec->extinction=tlo_unzigzag(v);
+
+  if((uint64_t)ntls*rec->nbins > rec->size) {
+    rec->size=ntls*rec->nbins;
+    rec->values=(uint32_t*)realloc(rec->values,rec->size*sizeof(uint32_t));
+  }
+
+  for(t=0; t<ntls; ++t) if(tlo_decode_timeline(&buf,end,rec->values+t*rec->nbins,rec->nbins)) return -1;
+  return buf-start;
+}
+
+/**
+ * @brief Reads a raw record.
+ *
+ * @param buf: Input memory buffer.
+ * @param end: End of the input memory buffer.
+ * @param flags: File header flags.
+ * @param rec: Decoded record, whose values array is reallocated as needed.
+ * @return the number of read bytes, or -1 if the input is truncated.
+ */
+inline static ssize_t tlo_read_raw_record(uint8_t const* buf, uint8_t const* end, const uint8_t flags, tlo_record* rec)
+{
+  const bool reltime=tlo_has_reltime(flags);
+  const size_t hsize=(reltime?16:12);
+  const uint32_t ntls=tlo_ntimelines(flags);
+  uint32_t i;
+
+  if(end-buf < (ssize_t)hsize) return -1;
+  rec->nbins=le32toh(((uint32_t const*)buf)[0]);
+  rec->nbefore=(reltime?le32toh(((uint32_t const*)buf)[1]):0);
+  rec->maxedout=(int32_t)le32toh(((uint32_t const*)buf)[1+reltime]);
+  rec->extinction=(int32_t)le32toh(((uint32_t const*)buf)[2+reltime]);
+  const uint64_t nvalues=(uint64_t)ntls*rec->nbins;
+
+  if((uint64_t)(end-buf-hsize) < 4*nvalues) return -1;
+
+  if(nvalues > rec->size) {
+    rec->size=nvalues;
+    rec->values=(uint32_t*)realloc(rec->values,rec->size*sizeof(uint32_t));
+  }
+
+  for(i=0; i<nvalues; ++i) rec->values[i]=le32toh(((uint32_t const*)(buf+hsize))[i]);
+  return hsize+4*nvalues;
+}
+
+/**
+ * @brief Writes a raw record.
+ *
+ * @param buf: Output memory buffer.
+ * @param rec: Decoded record.
+ * @param flags: File header flags.
+ * @return the number of written bytes.
+ */
+inline static size_t tlo_write_raw_record(uint8_t* buf, tlo_record const* rec, const uint8_t flags)
+{
+  const bool reltime=tlo_has_reltime(flags);
+  const size_t hsize=(reltime?16:12);
+  const uint32_t nvalues=tlo_ntimelines(flags)*rec->nbins;
+  uint32_t i;
+
+  ((uint32_t*)buf)[0]=htole32(rec->nbins);
+
+  if(reltime) ((uint32_t*)buf)[1]=htole32(rec->nbefore);
+  ((uint32_t*)buf)[1+reltime]=htole32(rec->maxedout);
+  ((uint32_t*)buf)[2+reltime]=htole32(rec->extinction);
+
+  for(i=0; i<nvalues; ++i) ((uint32_t*)(buf+hsize))[i]=htole32(rec->values[i]);
+  return hsize+4*nvalues;
+}
+
+#endif
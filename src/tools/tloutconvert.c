@@ -0,0 +1,121 @@
+/**
+ * @file tloutconvert.c
+ * @brief Tool converting randoutbreaksim timeline output files between the
+ * raw and the encoded record formats.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "tloutconvert.h"
+
+int main(const int nargs, const char* args[])
+{
+  if(nargs!=3) {
+    printf("Usage: %s INPUT OUTPUT\n",args[0]);
+    printf("Converts a timeline output file with encoded records into a file with raw records, or a file with raw records into a file with encoded records.\n");
+    return 1;
+  }
+  const int in=open(args[1],O_RDONLY);
+  struct stat st;
+  int fd;
+
+  if(in<0 || fstat(in,&st)) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in read mode\n",args[0],args[1]);
+    return 1;
+  }
+
+  if(st.st_size<TLO_HEADER_SIZE) {
+    fprintf(stderr,"%s: Error: File '%s' is not a timeline output file\n",args[0],args[1]);
+    return 1;
+  }
+  uint8_t const* const data=(uint8_t const*)mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,in,0);
+
+  if(data==MAP_FAILED) {
+    perror(args[1]);
+    return 1;
+  }
+  madvise((void*)data,st.st_size,MADV_SEQUENTIAL);
+
+  if((fd=open(args[2],O_WRONLY|O_CREAT|O_TRUNC,S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH))<0) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in write mode\n",args[0],args[2]);
+    return 1;
+  }
+  const uint8_t flags=data[4];
+  const uint32_t hsize=tlo_header_size(flags);
+  uint8_t header[TLO_HEADER_SIZE+8];
+  uint64_t nrecs;
+
+  if(st.st_size<hsize) {
+    fprintf(stderr,"%s: Error: File '%s' is not a timeline output file\n",args[0],args[1]);
+    return 1;
+  }
+  memcpy(header,data,hsize);
+  header[4]=flags^TLO_FLAG_ENCODED;
+
+  if(write(fd,header,hsize)!=hsize) {
+    perror(args[2]);
+    return 1;
+  }
+
+  if(convert_records(fd,data+hsize,data+st.st_size,flags,&nrecs)) {
+    fprintf(stderr,"%s: Error: File '%s' is corrupted after %" PRIu64 " records\n",args[0],args[1],nrecs);
+    return 1;
+  }
+  printf("Converted %" PRIu64 " %s records into %s records in '%s'\n",nrecs,(flags&TLO_FLAG_ENCODED?"encoded":"raw"),(flags&TLO_FLAG_ENCODED?"raw":"encoded"),args[2]);
+  munmap((void*)data,st.st_size);
+  close(in);
+  close(fd);
+  return 0;
+}
+
+int convert_records(const int fd, uint8_t const* in, uint8_t const* end, const uint8_t flags, uint64_t* nrecs)
+{
+  const bool encoded=(flags&TLO_FLAG_ENCODED);
+  const uint32_t ntls=tlo_ntimelines(flags);
+  tlo_record rec={0};
+  size_t bufsize=CONVERT_BUFSIZE;
+  uint8_t* buf=(uint8_t*)malloc(bufsize);
+  size_t used=0;
+  size_t maxsize;
+  ssize_t n;
+  *nrecs=0;
+
+  while(in<end) {
+    n=(encoded?tlo_decode_record(in,end,flags,&rec):tlo_read_raw_record(in,end,flags,&rec));
+
+    if(n<0) {
+      free(rec.values);
+      free(buf);
+      return -1;
+    }
+    in+=n;
+    maxsize=(encoded?16+4*(size_t)ntls*rec.nbins:4*TLO_VARINT_MAXSIZE+TLO_VARINT_MAXSIZE*(size_t)ntls*rec.nbins);
+
+    if(used+maxsize > bufsize) {
+
+      if(write(fd,buf,used)!=(ssize_t)used) {
+	perror(__func__);
+	free(rec.values);
+	free(buf);
+	return -1;
+      }
+      used=0;
+
+      if(maxsize > bufsize) {
+	bufsize=maxsize;
+	buf=(uint8_t*)realloc(buf,bufsize);
+      }
+    }
+    used+=(encoded?tlo_write_raw_record(buf+used,&rec,flags):tlo_encode_record(buf+used,&rec,flags));
+    ++*nrecs;
+  }
+
+  if(write(fd,buf,used)!=(ssize_t)used) {
+    perror(__func__);
+    free(rec.values);
+    free(buf);
+    return -1;
+  }
+  free(rec.values);
+  free(buf);
+  return 0;
+}
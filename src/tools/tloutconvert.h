@@ -0,0 +1,40 @@
+/**
+ * @file tloutconvert.h
+ * @brief Tool converting randoutbreaksim timeline output files between the
+ * raw and the encoded record formats.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <endian.h>
+
+#include "tlout_codec.h"
+
+#define CONVERT_BUFSIZE (1<<20)
+
+/**
+ * @brief Main function.
+ *
+ * Usage: tloutconvert INPUT OUTPUT
+ */
+int main(const int nargs, const char* args[]);
+
+/**
+ * @brief Converts the records of a timeline output file.
+ *
+ * @param fd: Output file descriptor, positioned after the file header.
+ * @param in: Records of the input file.
+ * @param end: End of the input file.
+ * @param flags: Header flags of the input file.
+ * @param nrecs: Number of converted records.
+ * @return 0 on success, -1 on an error.
+ */
+int convert_records(const int fd, uint8_t const* in, uint8_t const* end, const uint8_t flags, uint64_t* nrecs);
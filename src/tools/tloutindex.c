@@ -0,0 +1,111 @@
+/**
+ * @file tloutindex.c
+ * @brief Tool building the path index of existing randoutbreaksim timeline
+ * output files.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "tloutindex.h"
+
+int main(const int nargs, const char* args[])
+{
+  if(nargs!=2) {
+    printf("Usage: %s FILE\n",args[0]);
+    printf("Builds the index sidecar file FILE.idx of a timeline output file with raw or encoded records. If FILE is the manifest of a sharded output, an index is built for each shard. The paths are numbered in file order, following the shard order for sharded outputs. For files that only contain selected paths, these numbers are thus record numbers rather than simulation path indices. Contact tracing output files cannot be indexed after the fact, since they do not delimit paths.\n");
+    return 1;
+  }
+  uint64_t nrecs;
+
+  if(is_manifest(args[1])) {
+    output_manifest om;
+    uint64_t npaths=0;
+    uint32_t s;
+
+    if(manifest_read(args[1],&om)) return 1;
+
+    if(strcmp(om.format,"tlout")) {
+      fprintf(stderr,"%s: Error: Only timeline outputs can be indexed\n",args[0]);
+      return 1;
+    }
+
+    for(s=0; s<om.nshards; ++s) {
+
+      if(index_file(om.files[s],npaths,&nrecs)) return 1;
+      npaths+=nrecs;
+    }
+    printf("Indexed %" PRIu64 " records from %" PRIu32 " shards\n",npaths,om.nshards);
+    manifest_free(&om);
+
+  } else {
+
+    if(index_file(args[1],0,&nrecs)) return 1;
+    printf("Indexed %" PRIu64 " records\n",nrecs);
+  }
+  return 0;
+}
+
+int index_file(const char* filename, const uint64_t firstpath, uint64_t* nrecs)
+{
+  const int in=open(filename,O_RDONLY);
+  struct stat st;
+  *nrecs=0;
+
+  if(in<0 || fstat(in,&st)) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in read mode\n",__func__,filename);
+    return -1;
+  }
+
+  if(st.st_size<TLO_HEADER_SIZE) {
+    fprintf(stderr,"%s: Error: File '%s' is not a timeline output file\n",__func__,filename);
+    return -1;
+  }
+  uint8_t const* const data=(uint8_t const*)mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,in,0);
+
+  if(data==MAP_FAILED) {
+    perror(filename);
+    return -1;
+  }
+  madvise((void*)data,st.st_size,MADV_SEQUENTIAL);
+  char* idxname=oidx_filename(filename);
+  const int fd=open(idxname,O_RDWR|O_CREAT|O_TRUNC,S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+
+  if(fd<0) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in write mode\n",__func__,idxname);
+    return -1;
+  }
+  free(idxname);
+
+  if(oidx_write_header(fd,OIDX_KIND_TLOUT)) return -1;
+  const uint8_t flags=data[4];
+  const bool encoded=(flags&TLO_FLAG_ENCODED);
+  uint8_t const* const end=data+st.st_size;
+  uint8_t const* buf=data+tlo_header_size(flags);
+  tlo_record rec={0};
+  oidx_writer ow;
+  ssize_t n;
+
+  oidx_writer_init(&ow,fd,0);
+
+  while(buf<end) {
+    n=(encoded?tlo_decode_record(buf,end,flags,&rec):tlo_read_raw_record(buf,end,flags,&rec));
+
+    if(n<0) {
+      fprintf(stderr,"%s: Error: File '%s' is corrupted after %" PRIu64 " records\n",__func__,filename,*nrecs);
+      return -1;
+    }
+    oidx_add(&ow,buf-data,firstpath+*nrecs,n,rec.nbins,(rec.extinction!=INT32_MAX?OIDX_FLAG_EXTINCT:0)|(rec.maxedout!=INT32_MAX?OIDX_FLAG_MAXEDOUT:0));
+    buf+=n;
+    ++*nrecs;
+
+    //Entries are written in blocks to bound the memory usage
+    if(ow.nentries==ow.size && oidx_flush(&ow,0,*nrecs-ow.nentries)) return -1;
+  }
+
+  if(oidx_flush(&ow,0,*nrecs-ow.nentries)) return -1;
+  oidx_writer_free(&ow);
+  free(rec.values);
+  munmap((void*)data,st.st_size);
+  close(in);
+  close(fd);
+  return 0;
+}
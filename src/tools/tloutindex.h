@@ -0,0 +1,41 @@
+/**
+ * @file tloutindex.h
+ * @brief Tool building the path index of existing randoutbreaksim timeline
+ * output files.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <endian.h>
+
+#include "tlout_codec.h"
+#include "output_index.h"
+#include "output_manifest.h"
+
+/**
+ * @brief Main function.
+ *
+ * Usage: tloutindex FILE
+ */
+int main(const int nargs, const char* args[]);
+
+/**
+ * @brief Builds the index of a timeline output file.
+ *
+ * Since the path indices are not stored in timeline output files, the
+ * records are numbered in file order, starting from firstpath.
+ *
+ * @param filename: Timeline output file name.
+ * @param firstpath: Path index of the first record.
+ * @param nrecs: Number of indexed records.
+ * @return 0 on success, -1 on an error.
+ */
+int index_file(const char* filename, const uint64_t firstpath, uint64_t* nrecs);
@@ -0,0 +1,96 @@
+/**
+ * @file tloutmerge.c
+ * @brief Tool merging the shards of a sharded randoutbreaksim output into a
+ * single output file.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "tloutmerge.h"
+
+int main(const int nargs, const char* args[])
+{
+  if(nargs!=3) {
+    printf("Usage: %s MANIFEST OUTPUT\n",args[0]);
+    printf("Merges the shards listed in the manifest of a sharded tlout or ctout output into a single output file in the regular format.\n");
+    return 1;
+  }
+  output_manifest om;
+  uint32_t s;
+  int fd;
+
+  if(manifest_read(args[1],&om)) return 1;
+
+  if((fd=open(args[2],O_WRONLY|O_CREAT|O_TRUNC,S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH))<0) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in write mode\n",args[0],args[2]);
+    return 1;
+  }
+
+  char header[TLO_HEADER_SIZE+8]={0};
+  const size_t hsize=(om.hasheader?tlo_header_size(om.flags):0);
+
+  if(om.hasheader) {
+    *(uint32_t*)header=htole32(om.npers);
+    header[4]=om.flags;
+
+    if(write(fd,header,hsize)!=hsize) {
+      perror(args[2]);
+      return 1;
+    }
+  }
+  char* buf=(char*)malloc(MERGE_BUFSIZE);
+  uint64_t npaths=0;
+  uint64_t nskipped=0;
+
+  for(s=0; s<om.nshards; ++s) {
+
+    if(append_file(fd,om.files[s],header,hsize,buf,&nskipped)) return 1;
+    npaths+=om.npaths[s];
+  }
+
+  if(hsize>TLO_HEADER_SIZE) {
+    nskipped=htole64(nskipped);
+
+    if(pwrite(fd,&nskipped,8,TLO_HEADER_SIZE)!=8) {
+      perror(args[2]);
+      return 1;
+    }
+  }
+  printf("Merged %" PRIu32 " %s shards containing %" PRIu64 " paths into '%s'\n",om.nshards,om.format,npaths,args[2]);
+  free(buf);
+  close(fd);
+  manifest_free(&om);
+  return 0;
+}
+
+int append_file(const int fd, const char* filename, const char* header, const size_t hsize, char* buf, uint64_t* nskipped)
+{
+  const int in=open(filename,O_RDONLY);
+  ssize_t n;
+
+  if(in<0) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in read mode\n",__func__,filename);
+    return -1;
+  }
+
+  if(read(in,buf,hsize)!=hsize || memcmp(buf,header,(hsize<TLO_HEADER_SIZE?hsize:TLO_HEADER_SIZE))) {
+    fprintf(stderr,"%s: Error: The header of file '%s' does not match the manifest\n",__func__,filename);
+    return -1;
+  }
+
+  if(hsize>TLO_HEADER_SIZE) *nskipped+=le64toh(*(uint64_t const*)(buf+TLO_HEADER_SIZE));
+
+  while((n=read(in,buf,MERGE_BUFSIZE))>0) {
+
+    if(write(fd,buf,n)!=n) {
+      perror(__func__);
+      return -1;
+    }
+  }
+
+  if(n<0) {
+    perror(filename);
+    return -1;
+  }
+  close(in);
+  return 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file tloutmerge.h
+ * @brief Tool merging the shards of a sharded randoutbreaksim output into a
+ * single output file.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <endian.h>
+
+#include "output_manifest.h"
+#include "tlout_codec.h"
+
+#define MERGE_BUFSIZE (1<<20)
+
+/**
+ * @brief Main function.
+ *
+ * Usage: tloutmerge MANIFEST OUTPUT
+ */
+int main(const int nargs, const char* args[]);
+
+/**
+ * @brief Appends the content of a file to an output file.
+ *
+ * The input file must start with the provided header, which is not copied.
+ * For timeline outputs that only contain selected paths, the number of
+ * skipped paths stored at the end of the header is not compared, and is
+ * instead added to the total.
+ *
+ * @param fd: Output file descriptor.
+ * @param filename: Input file name.
+ * @param header: Expected file header.
+ * @param hsize: Size of the file header.
+ * @param buf: Memory buffer of size MERGE_BUFSIZE.
+ * @param nskipped: Pointer to the total number of skipped paths.
+ * @return 0 on success, -1 on an error.
+ */
+int append_file(const int fd, const char* filename, const char* header, const size_t hsize, char* buf, uint64_t* nskipped);
@@ -0,0 +1,548 @@
+/**
+ * @file tloutreduce.c
+ * @brief Tool computing the summary statistics of randoutbreaksim timeline
+ * output files.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include "tloutreduce.h"
+
+int main(const int nargs, const char* args[])
+{
+  reduce_input in={.files=NULL, .nfiles=0, .curfile=0, .nthreads=sysconf(_SC_NPROCESSORS_ONLN), .nbinsperunit=1, .tlquantiles=NULL, .ntlquantiles=0, .tlqprecbits=LHIST_DEFAULT_PRECBITS, .pathhists=false, .phprecbits=LHIST_DEFAULT_PRECBITS, .minfinalsize=0, .maxfinalsize=UINT64_MAX, .minpostesttime=-INFINITY, .maxpostesttime=INFINITY, .postestfilter=false, .nskipped=0, .error=false};
+  const char* opt;
+  int i;
+
+  for(i=1; i<nargs; ++i) {
+
+    if(args[i][0]!='-') {
+
+      if(is_manifest(args[i])) {
+	output_manifest om;
+	uint32_t s;
+
+	if(manifest_read(args[i],&om)) return 1;
+
+	if(strcmp(om.format,"tlout")) {
+	  fprintf(stderr,"%s: Error: Manifest '%s' does not list timeline output shards\n",args[0],args[i]);
+	  return 1;
+	}
+	in.files=(reduce_file*)realloc(in.files,(in.nfiles+om.nshards)*sizeof(reduce_file));
+
+	for(s=0; s<om.nshards; ++s) in.files[in.nfiles++].name=strdup(om.files[s]);
+	manifest_free(&om);
+
+      } else {
+	in.files=(reduce_file*)realloc(in.files,(in.nfiles+1)*sizeof(reduce_file));
+	in.files[in.nfiles++].name=strdup(args[i]);
+      }
+      continue;
+    }
+    opt=args[i]+1+(args[i][1]=='-');
+
+    if(!strcmp(opt,"pathhists")) {
+      in.pathhists=true;
+      continue;
+    }
+
+    if(i+1==nargs) {
+      fprintf(stderr,"%s: Error: Missing value for option '%s'\n",args[0],args[i]);
+      return 1;
+    }
+    ++i;
+
+    if(!strcmp(opt,"nthreads")) sscanf(args[i],"%" SCNu32,&in.nthreads);
+
+    else if(!strcmp(opt,"nbinsperunit")) sscanf(args[i],"%" SCNi32,&in.nbinsperunit);
+
+    else if(!strcmp(opt,"tlquantiles")) {
+      char* list=strdup(args[i]);
+      char* tok=strtok(list,",");
+
+      while(tok) {
+	in.tlquantiles=(double*)realloc(in.tlquantiles,(in.ntlquantiles+1)*sizeof(double));
+
+	if(sscanf(tok,"%lf",in.tlquantiles+in.ntlquantiles)!=1 || !(in.tlquantiles[in.ntlquantiles]>=0) || !(in.tlquantiles[in.ntlquantiles]<=1)) {
+	  fprintf(stderr,"%s: Error: Timeline quantiles must be values in the interval [0,1]\n",args[0]);
+	  return 1;
+	}
+	++in.ntlquantiles;
+	tok=strtok(NULL,",");
+      }
+      free(list);
+
+    } else if(!strcmp(opt,"tlqprecbits")) sscanf(args[i],"%" SCNu32,&in.tlqprecbits);
+
+    else if(!strcmp(opt,"phprecbits")) sscanf(args[i],"%" SCNu32,&in.phprecbits);
+
+    else if(!strcmp(opt,"minfinalsize")) sscanf(args[i],"%" SCNu64,&in.minfinalsize);
+
+    else if(!strcmp(opt,"maxfinalsize")) sscanf(args[i],"%" SCNu64,&in.maxfinalsize);
+
+    else if(!strcmp(opt,"minpostesttime")) {
+      sscanf(args[i],"%lf",&in.minpostesttime);
+      in.postestfilter=true;
+
+    } else if(!strcmp(opt,"maxpostesttime")) {
+      sscanf(args[i],"%lf",&in.maxpostesttime);
+      in.postestfilter=true;
+
+    } else {
+      fprintf(stderr,"%s: Error: Unknown option '%s'\n",args[0],args[i-1]);
+      return 1;
+    }
+  }
+
+  if(!in.nfiles) {
+    printf("Usage: %s [OPTIONS] FILE [FILE ...]\n",args[0]);
+    printf("Computes the summary statistics of the paths stored in timeline output files with raw or encoded records, or in the shards listed in manifests, and prints them using the same layout as randoutbreaksim. The files are mapped in memory and reduced in parallel in blocks of records, such that they can be larger than the available memory. Blocks are delimited using the index sidecar files when they are available, which is recommended for files with encoded records.\n");
+    printf("\nOptions:\n");
+    printf("\t--nthreads VALUE\t\tNumber of threads (default value of the number of online processors).\n");
+    printf("\t--nbinsperunit VALUE\t\tNumber of time bins per unit of time used for the simulation (default value of 1).\n");
+    printf("\t--tlquantiles LIST\t\tComma-separated list of cumulative probabilities for which the quantiles of the current infection, new infection and new positive test timelines are reported for each time bin.\n");
+    printf("\t--tlqprecbits VALUE\t\tNumber of precision bits for the timeline quantile histograms (default value of %i, maximum value of %i).\n",LHIST_DEFAULT_PRECBITS,LHIST_MAX_PRECBITS);
+    printf("\t--pathhists\t\t\tCompute histograms of the final size (total number of new infections) and of the peak number of current infections for each path.\n");
+    printf("\t--phprecbits VALUE\t\tNumber of precision bits for the final size and peak histograms (default value of %i, maximum value of %i).\n",LHIST_DEFAULT_PRECBITS,LHIST_MAX_PRECBITS);
+    printf("\t--minfinalsize VALUE\t\tOnly select paths whose final size is at least VALUE.\n");
+    printf("\t--maxfinalsize VALUE\t\tOnly select paths whose final size is at most VALUE.\n");
+    printf("\t--minpostesttime VALUE\t\tOnly select paths with a positive test whose first positive test occurs in a time bin starting at or after VALUE.\n");
+    printf("\t--maxpostesttime VALUE\t\tOnly select paths with a positive test whose first positive test occurs in a time bin starting at or before VALUE.\n");
+    printf("\nThe statistics that depend on exact event times, such as the mean extinction time, cannot be computed from timeline output files and are not reported.\n");
+    return 1;
+  }
+
+  if(in.nthreads<1 || in.nbinsperunit<1) {
+    fprintf(stderr,"%s: Error: nthreads and nbinsperunit must be positive\n",args[0]);
+    return 1;
+  }
+
+  if(in.tlqprecbits<1 || in.tlqprecbits>LHIST_MAX_PRECBITS || in.phprecbits<1 || in.phprecbits>LHIST_MAX_PRECBITS) {
+    fprintf(stderr,"%s: Error: tlqprecbits and phprecbits must be in the interval [1,%i]\n",args[0],LHIST_MAX_PRECBITS);
+    return 1;
+  }
+  uint32_t f, t;
+
+  for(f=0; f<in.nfiles; ++f) {
+
+    if(open_input(in.files+f)) return 1;
+
+    if(in.files[f].flags&TLO_FLAG_SELECTED) in.nskipped+=le64toh(*(uint64_t const*)(in.files[f].data+TLO_HEADER_SIZE));
+
+    if(f==0) {
+      in.flags=in.files[f].flags&~(TLO_FLAG_ENCODED|TLO_FLAG_SELECTED);
+      in.npers=le32toh(*(uint32_t const*)in.files[f].data);
+
+    } else if((in.files[f].flags&~(TLO_FLAG_ENCODED|TLO_FLAG_SELECTED))!=in.flags || le32toh(*(uint32_t const*)in.files[f].data)!=in.npers) {
+      fprintf(stderr,"%s: Error: File '%s' has a header that is incompatible with the header of file '%s'\n",args[0],in.files[f].name,in.files[0].name);
+      return 1;
+    }
+  }
+
+  if(in.postestfilter && !(in.flags&TLO_FLAG_POSTEST)) {
+    fprintf(stderr,"%s: Error: Paths cannot be selected based on their positive tests, since the files do not contain positive test timelines\n",args[0]);
+    return 1;
+  }
+  in.nqtls=(in.ntlquantiles?2+((in.flags&TLO_FLAG_POSTEST)!=0):0);
+  pthread_mutex_init(&in.lock,NULL);
+  reduce_data* rdata=(reduce_data*)calloc(in.nthreads,sizeof(reduce_data));
+  pthread_t* threads=(pthread_t*)malloc(in.nthreads*sizeof(pthread_t));
+  const uint32_t nlbuckets=lhist_nbuckets(in.phprecbits);
+
+  for(t=0; t<in.nthreads; ++t) {
+    rdata[t].in=&in;
+    //Bins are added as records are read
+    tlacc_init(&rdata[t].acc,6*tlo_ntimelines(in.flags),0);
+
+    if(in.pathhists) {
+      rdata[t].finalsize_hist=(uint32_t*)calloc(nlbuckets,sizeof(uint32_t));
+      rdata[t].peakinf_hist=(uint32_t*)calloc(nlbuckets,sizeof(uint32_t));
+    }
+    rdata[t].maxedoutmintimeindex=INT32_MAX;
+
+    if(pthread_create(threads+t,NULL,reduce_thread,rdata+t)) {
+      fprintf(stderr,"%s: Error: Cannot create thread %" PRIu32 "\n",args[0],t);
+      return 1;
+    }
+  }
+
+  for(t=0; t<in.nthreads; ++t) pthread_join(threads[t],NULL);
+
+  if(in.error) return 1;
+
+  for(t=1; t<in.nthreads; ++t) {
+    merge_data(rdata,rdata+t);
+    free_data(rdata+t);
+  }
+
+  if(!rdata->npaths[0] && !rdata->npaths[1]) {
+    fprintf(stderr,"%s: Error: None of the %" PRIu64 " paths passes the path filters\n",args[0],rdata->nrecs);
+    return 1;
+  }
+  printf("Reduced %" PRIu64 " paths from %" PRIu32 " files, of which %" PRIu64 " pass the path filters\n",rdata->nrecs,in.nfiles,rdata->npaths[0]+rdata->npaths[1]);
+
+  if(in.nskipped) printf("The files only contain selected paths, %" PRIu64 " simulated paths not being written. The statistics only describe the written paths\n",in.nskipped);
+  print_results(rdata);
+  free_data(rdata);
+  free(rdata);
+  free(threads);
+  pthread_mutex_destroy(&in.lock);
+
+  for(f=0; f<in.nfiles; ++f) {
+    munmap((void*)in.files[f].data,in.files[f].size);
+
+    if(in.files[f].idx) munmap((void*)in.files[f].idx,in.files[f].idxsize);
+    free((char*)in.files[f].name);
+  }
+  free(in.files);
+  free(in.tlquantiles);
+  return 0;
+}
+
+int open_input(reduce_file* rf)
+{
+  int fd=open(rf->name,O_RDONLY);
+  struct stat st;
+
+  if(fd<0 || fstat(fd,&st)) {
+    fprintf(stderr,"%s: Error: Cannot open file '%s' in read mode\n",__func__,rf->name);
+    return -1;
+  }
+
+  if(st.st_size<TLO_HEADER_SIZE) {
+    fprintf(stderr,"%s: Error: File '%s' is not a timeline output file\n",__func__,rf->name);
+    return -1;
+  }
+  rf->size=st.st_size;
+  rf->data=(uint8_t const*)mmap(NULL,rf->size,PROT_READ,MAP_PRIVATE,fd,0);
+  close(fd);
+
+  if(rf->data==MAP_FAILED) {
+    perror(rf->name);
+    return -1;
+  }
+  //Each thread reads contiguous blocks of records
+  madvise((void*)rf->data,rf->size,MADV_SEQUENTIAL);
+  rf->flags=rf->data[4];
+  rf->next=tlo_header_size(rf->flags);
+
+  if(rf->size<rf->next) {
+    fprintf(stderr,"%s: Error: File '%s' is not a timeline output file\n",__func__,rf->name);
+    return -1;
+  }
+  rf->idx=NULL;
+  rf->nentries=0;
+
+  char* idxname=oidx_filename(rf->name);
+
+  if((fd=open(idxname,O_RDONLY))<0) {
+    free(idxname);
+    return 0;
+  }
+
+  if(!fstat(fd,&st) && st.st_size>=OIDX_HEADER_SIZE && (st.st_size-OIDX_HEADER_SIZE)%OIDX_ENTRY_SIZE==0) {
+    rf->idxsize=st.st_size;
+    rf->idx=(uint8_t const*)mmap(NULL,rf->idxsize,PROT_READ,MAP_PRIVATE,fd,0);
+
+    if(rf->idx==MAP_FAILED) rf->idx=NULL;
+  }
+  close(fd);
+
+  if(rf->idx) {
+    oidx_entry first, last;
+    rf->nentries=(rf->idxsize-OIDX_HEADER_SIZE)/OIDX_ENTRY_SIZE;
+
+    if(rf->nentries) {
+      oidx_get_entry(rf->idx+OIDX_HEADER_SIZE,&first);
+      oidx_get_entry(rf->idx+OIDX_HEADER_SIZE+(rf->nentries-1)*OIDX_ENTRY_SIZE,&last);
+    }
+
+    //An index that does not match the file, for instance because the file was
+    //converted after it was indexed, is ignored
+    if(memcmp(rf->idx,OIDX_MAGIC,8) || le32toh(*(uint32_t const*)(rf->idx+12))!=OIDX_KIND_TLOUT || (rf->nentries?first.offset!=rf->next || last.offset+last.size!=rf->size:rf->size!=rf->next)) {
+      fprintf(stderr,"%s: Warning: Ignoring index file '%s', which does not match file '%s'\n",__func__,idxname,rf->name);
+      munmap((void*)rf->idx,rf->idxsize);
+      rf->idx=NULL;
+      rf->nentries=0;
+    }
+  }
+  free(idxname);
+  return 0;
+}
+
+bool next_block(reduce_input* in, reduce_file** rf, uint64_t* start, uint64_t* end)
+{
+  reduce_file* f;
+  bool ret=false;
+
+  pthread_mutex_lock(&in->lock);
+
+  while(!in->error && in->curfile<in->nfiles) {
+    f=in->files+in->curfile;
+
+    if(f->next==f->size) {
+      ++in->curfile;
+      continue;
+    }
+    *rf=f;
+    *start=f->next;
+
+    if(f->idx) {
+      const uint64_t target=*start+REDUCE_CHUNKSIZE;
+      uint64_t lo=0, hi=f->nentries, mid;
+      oidx_entry e;
+
+      //Binary search for the first record starting at or after the target
+      //offset
+      while(lo<hi) {
+	mid=(lo+hi)>>1;
+	oidx_get_entry(f->idx+OIDX_HEADER_SIZE+mid*OIDX_ENTRY_SIZE,&e);
+
+	if(e.offset<target) lo=mid+1;
+	else hi=mid;
+      }
+
+      if(lo<f->nentries) {
+	oidx_get_entry(f->idx+OIDX_HEADER_SIZE+lo*OIDX_ENTRY_SIZE,&e);
+	*end=e.offset;
+
+      } else *end=f->size;
+
+    } else {
+      ssize_t n;
+      *end=*start;
+
+      while(*end<f->size && *end-*start<REDUCE_CHUNKSIZE) {
+
+	if((n=tlo_record_size(f->data+*end,f->data+f->size,f->flags))<0) {
+	  fprintf(stderr,"%s: Error: File '%s' is corrupted at offset %" PRIu64 "\n",__func__,f->name,*end);
+	  in->error=true;
+	  break;
+	}
+	*end+=n;
+      }
+
+      if(in->error) break;
+    }
+    f->next=*end;
+    ret=true;
+    break;
+  }
+  pthread_mutex_unlock(&in->lock);
+  return ret;
+}
+
+void* reduce_thread(void* arg)
+{
+  reduce_data* rd=(reduce_data*)arg;
+  reduce_file* rf;
+  uint64_t start, end;
+  ssize_t n;
+
+  while(next_block(rd->in,&rf,&start,&end)) {
+    const bool encoded=(rf->flags&TLO_FLAG_ENCODED);
+    uint8_t const* buf=rf->data+start;
+    uint8_t const* const bend=rf->data+end;
+
+    while(buf<bend) {
+      n=(encoded?tlo_decode_record(buf,bend,rf->flags,&rd->rec):tlo_read_raw_record(buf,bend,rf->flags,&rd->rec));
+
+      if(n<0) {
+	fprintf(stderr,"%s: Error: File '%s' is corrupted at offset %" PRIu64 "\n",__func__,rf->name,(uint64_t)(buf-rf->data));
+	rd->in->error=true;
+	return NULL;
+      }
+      buf+=n;
+      ++rd->nrecs;
+      add_record(rd);
+    }
+  }
+  return NULL;
+}
+
+void add_record(reduce_data* rd)
+{
+  reduce_input const* in=rd->in;
+  tlo_record const* rec=&rd->rec;
+  const uint32_t nbins=rec->nbins;
+  uint32_t const* inf=rec->values;
+  uint32_t const* newinf=rec->values+nbins;
+  uint64_t finalsize=0;
+  uint32_t peakinf=0;
+  uint32_t b;
+
+  for(b=0; b<nbins; ++b) {
+    finalsize+=newinf[b];
+
+    if(inf[b]>peakinf) peakinf=inf[b];
+  }
+
+  if(finalsize<in->minfinalsize || finalsize>in->maxfinalsize) return;
+
+  if(in->postestfilter) {
+    uint32_t const* newpostest=rec->values+2*nbins;
+
+    for(b=0; b<nbins; ++b) if(newpostest[b]) break;
+
+    if(b==nbins) return;
+    const double t=((int32_t)b-(int32_t)rec->nbefore)/(double)in->nbinsperunit;
+
+    if(t<in->minpostesttime || t>in->maxpostesttime) return;
+  }
+  const int32_t ndiff=(int32_t)rec->nbefore-rd->nneg;
+  const int32_t pdiff=(int32_t)(nbins-rec->nbefore)-(int32_t)(rd->acc.nbins-rd->nneg);
+
+  if(ndiff>0 || pdiff>0) extend_bins(rd,(ndiff>0?ndiff:0),(pdiff>0?pdiff:0));
+  const uint32_t shift=rd->nneg-rec->nbefore;
+  const int noext=(rec->extinction==INT32_MAX);
+  const uint32_t ntls=tlo_ntimelines(in->flags);
+  uint32_t t, field;
+
+  for(t=0; t<ntls; ++t) {
+    field=(2*t+noext)*3;
+    tlacc_add_counts(tlacc_field(&rd->acc,field)+shift,tlacc_field(&rd->acc,field+1)+shift,tlacc_field(&rd->acc,field+2)+shift,rec->values+t*nbins,nbins);
+  }
+
+  if(in->nqtls) {
+    const uint32_t nqbuckets=lhist_nbuckets(in->tlqprecbits);
+    uint32_t const* tl;
+
+    for(t=0; t<in->nqtls; ++t) {
+      tl=rec->values+t*nbins;
+
+      for(b=0; b<nbins; ++b) if(tl[b]) ++rd->qsk[t][(shift+b)*nqbuckets+lhist_index(tl[b],in->tlqprecbits)];
+    }
+  }
+
+  if(in->pathhists) {
+    ++rd->finalsize_hist[lhist_index(finalsize<UINT32_MAX?finalsize:UINT32_MAX,in->phprecbits)];
+    ++rd->peakinf_hist[lhist_index(peakinf,in->phprecbits)];
+  }
+  ++rd->npaths[noext];
+  rd->pm+=(rec->maxedout<INT32_MAX);
+
+  if(noext) {
+    ++rd->nnzpaths;
+
+    if(rec->maxedout<rd->maxedoutmintimeindex) rd->maxedoutmintimeindex=rec->maxedout;
+
+  } else if(rec->extinction!=-INT32_MAX) {
+    ++rd->penz;
+    ++rd->nnzpaths;
+  }
+}
+
+void extend_bins(reduce_data* rd, const uint32_t ndiff, const uint32_t pdiff)
+{
+  const uint32_t nbins=rd->acc.nbins;
+  const size_t qsize=(rd->in->ntlquantiles?lhist_nbuckets(rd->in->tlqprecbits):0)*sizeof(uint32_t);
+  uint32_t* qsk;
+  uint32_t c;
+
+  tlacc_extend(&rd->acc,ndiff,pdiff);
+  rd->nneg+=ndiff;
+
+  for(c=0; c<rd->in->nqtls; ++c) {
+    qsk=(uint32_t*)calloc(rd->acc.nbins,qsize);
+
+    if(nbins) memcpy((char*)qsk+ndiff*qsize,rd->qsk[c],nbins*qsize);
+    free(rd->qsk[c]);
+    rd->qsk[c]=qsk;
+  }
+}
+
+void merge_data(reduce_data* dst, reduce_data const* src)
+{
+  const int32_t ndiff=src->nneg-dst->nneg;
+  const int32_t pdiff=(int32_t)(src->acc.nbins-src->nneg)-(int32_t)(dst->acc.nbins-dst->nneg);
+
+  if(ndiff>0 || pdiff>0) extend_bins(dst,(ndiff>0?ndiff:0),(pdiff>0?pdiff:0));
+  const uint32_t shift=dst->nneg-src->nneg;
+  const uint32_t nqbuckets=(dst->in->ntlquantiles?lhist_nbuckets(dst->in->tlqprecbits):0);
+  const uint32_t nlbuckets=lhist_nbuckets(dst->in->phprecbits);
+  const size_t nqvals=(size_t)src->acc.nbins*nqbuckets;
+  size_t i;
+  uint32_t c;
+
+  tlacc_merge(&dst->acc,&src->acc,shift);
+
+  for(c=0; c<dst->in->nqtls; ++c) for(i=0; i<nqvals; ++i) dst->qsk[c][(size_t)shift*nqbuckets+i]+=src->qsk[c][i];
+
+  if(dst->in->pathhists) {
+
+    for(i=0; i<nlbuckets; ++i) {
+      dst->finalsize_hist[i]+=src->finalsize_hist[i];
+      dst->peakinf_hist[i]+=src->peakinf_hist[i];
+    }
+  }
+  dst->nrecs+=src->nrecs;
+  dst->npaths[0]+=src->npaths[0];
+  dst->npaths[1]+=src->npaths[1];
+  dst->penz+=src->penz;
+  dst->nnzpaths+=src->nnzpaths;
+  dst->pm+=src->pm;
+
+  if(src->maxedoutmintimeindex<dst->maxedoutmintimeindex) dst->maxedoutmintimeindex=src->maxedoutmintimeindex;
+}
+
+void print_results(reduce_data* rd)
+{
+  reduce_input const* in=rd->in;
+  const char* tltitles[6]={"Current infection (non-isolated infected individuals) timeline", "New infections (new infected individuals) timeline", "New positive test timeline",
+    "Current infection (non-isolated infected individuals) timeline for the second infection category", "New infections (new infected individuals) timeline for the second infection category", "New positive test timeline for the second infection category"};
+  const bool postest=(in->flags&TLO_FLAG_POSTEST);
+  const uint32_t ntls=tlo_ntimelines(in->flags);
+  const uint32_t nbins=rd->acc.nbins;
+  const uint64_t ntot=rd->npaths[0]+rd->npaths[1];
+  const double npaths[3]={rd->npaths[0], rd->npaths[1], ntot};
+  const double pe=rd->npaths[0]/(double)ntot;
+  const double penz=rd->penz/(double)rd->nnzpaths;
+  const double pm=rd->pm/(double)ntot;
+  const char* biased=(rd->maxedoutmintimeindex<INT32_MAX?" (max reached, could be biased if simulation cut)":"");
+  double* tls=(double*)malloc(6*nbins*sizeof(double));
+  uint64_t const* sum[2];
+  uint64_t const* sum2lo[2];
+  uint64_t const* sum2hi[2];
+  uint32_t t, j, e;
+
+  printf("\nComputed simulation results:\n");
+  printf("Probability of extinction and its statistical uncertainty: %22.15e +/- %22.15e%s\n",penz,sqrt(penz*(1.-penz)/(rd->nnzpaths-1.)),biased);
+  printf("Probability of non outgoing outbreak and its statistical uncertainty: %22.15e +/- %22.15e%s\n",pe,sqrt(pe*(1.-pe)/(ntot-1.)),biased);
+  printf("Probability of reaching maximum as defined by nimax/npostestmax and its statistical uncertainty: %22.15e +/- %22.15e\n",pm,sqrt(pm*(1.-pm)/(ntot-1.)));
+
+  for(t=0; t<ntls; ++t) {
+
+    for(e=0; e<2; ++e) {
+      sum[e]=tlacc_field(&rd->acc,(2*t+e)*3);
+      sum2lo[e]=tlacc_field(&rd->acc,(2*t+e)*3+1);
+      sum2hi[e]=tlacc_field(&rd->acc,(2*t+e)*3+2);
+    }
+
+    for(j=0; j<nbins; ++j) {
+
+      for(e=0; e<2; ++e) count_mean_std(sum[e][j],tlacc_sum2(sum2lo[e][j],sum2hi[e][j]),npaths[e],tls+2*e*nbins+j,tls+(2*e+1)*nbins+j);
+      count_mean_std(sum[0][j]+sum[1][j],tlacc_sum2(sum2lo[0][j]+sum2lo[1][j],sum2hi[0][j]+sum2hi[1][j]),npaths[2],tls+4*nbins+j,tls+5*nbins+j);
+    }
+    //Files without positive test timelines skip the corresponding titles
+    print_timeline(tltitles[postest || t<2?t:t+1],tls,nbins,rd->nneg,in->nbinsperunit,rd->maxedoutmintimeindex);
+  }
+  free(tls);
+
+  for(t=0; t<in->nqtls; ++t) print_timeline_quantiles(tltitles[t],rd->qsk[t],nbins,rd->nneg,in->nbinsperunit,rd->maxedoutmintimeindex,in->tlquantiles,in->ntlquantiles,in->tlqprecbits,ntot);
+
+  if(in->pathhists) {
+    print_lhist_distribution("Distribution of the final size (total number of new infections) per path",rd->finalsize_hist,in->phprecbits);
+    print_lhist_distribution("Distribution of the peak number of current infections (non-isolated infected individuals) per path",rd->peakinf_hist,in->phprecbits);
+  }
+}
+
+void free_data(reduce_data* rd)
+{
+  uint32_t c;
+
+  tlacc_free(&rd->acc);
+
+  for(c=0; c<3; ++c) free(rd->qsk[c]);
+  free(rd->finalsize_hist);
+  free(rd->peakinf_hist);
+  free(rd->rec.values);
+}
@@ -0,0 +1,168 @@
+/**
+ * @file tloutreduce.h
+ * @brief Tool computing the summary statistics of randoutbreaksim timeline
+ * output files.
+ * @author <Pierre-Luc.Drouin@drdc-rddc.gc.ca>, Defence Research and Development Canada Ottawa Research Centre.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <endian.h>
+
+#include <pthread.h>
+
+#include "tlout_codec.h"
+#include "output_index.h"
+#include "output_manifest.h"
+#include "log_histogram.h"
+#include "timeline_accumulator.h"
+#include "summary_output.h"
+
+#define REDUCE_CHUNKSIZE (1<<24)	//!< Approximate size of the blocks of records assigned to threads
+
+/**
+ * Input timeline output file.
+ */
+typedef struct {
+  const char* name;		//!< File name.
+  uint8_t const* data;		//!< Mapped file content.
+  uint64_t size;		//!< File size.
+  uint8_t flags;		//!< Header flags.
+  uint8_t const* idx;		//!< Mapped index file, or NULL if the file is not indexed.
+  uint64_t idxsize;		//!< Index file size.
+  uint64_t nentries;		//!< Number of index entries.
+  uint64_t next;		//!< Offset of the first record that is not assigned to a thread yet.
+} reduce_file;
+
+/**
+ * Reduction options and input state shared by the threads.
+ */
+typedef struct {
+  reduce_file* files;		//!< Input files.
+  uint32_t nfiles;		//!< Number of input files.
+  uint32_t curfile;		//!< Index of the file containing the next record that is not assigned to a thread.
+  uint8_t flags;		//!< Header flags of the input files, without the encoding flag.
+  uint32_t npers;		//!< Number of time bins starting from t=0 stored in the headers.
+  uint32_t nthreads;		//!< Number of threads.
+  int32_t nbinsperunit;		//!< Number of time bins per unit of time.
+  double* tlquantiles;		//!< Cumulative probabilities of the timeline quantiles.
+  uint32_t ntlquantiles;	//!< Number of timeline quantiles.
+  uint32_t tlqprecbits;		//!< Number of precision bits for the timeline quantile histograms.
+  uint32_t nqtls;		//!< Number of timelines with quantile histograms.
+  bool pathhists;		//!< Whether the final size and peak distributions are computed.
+  uint32_t phprecbits;		//!< Number of precision bits for the final size and peak histograms.
+  uint64_t minfinalsize;	//!< Minimum final size of the selected paths.
+  uint64_t maxfinalsize;	//!< Maximum final size of the selected paths.
+  double minpostesttime;	//!< Minimum time of the first positive test of the selected paths.
+  double maxpostesttime;	//!< Maximum time of the first positive test of the selected paths.
+  bool postestfilter;		//!< Whether the paths are selected based on the time of their first positive test.
+  uint64_t nskipped;		//!< Number of simulated paths that are not written to the input files.
+  bool error;			//!< Whether an error occurred in a thread.
+  pthread_mutex_t lock;		//!< Lock for the assignment of records to threads.
+} reduce_input;
+
+/**
+ * Reduction results of a thread.
+ */
+typedef struct {
+  reduce_input* in;		//!< Pointer to the shared input.
+  tlaccumulator acc;		//!< Sums and sums of squares of each timeline, for paths with and without extinction.
+  int32_t nneg;			//!< Number of accumulator bins before t=0.
+  uint32_t* qsk[3];		//!< Quantile histograms of the timelines of the first infection category, stored one bin after the other.
+  uint32_t* finalsize_hist;	//!< Final size histogram.
+  uint32_t* peakinf_hist;	//!< Peak current infection histogram.
+  uint64_t nrecs;		//!< Number of read records.
+  uint64_t npaths[2];		//!< Number of selected paths with and without extinction.
+  uint64_t penz;		//!< Number of selected paths with extinction and an initial infection.
+  uint64_t nnzpaths;		//!< Number of selected paths with an initial infection.
+  uint64_t pm;			//!< Number of selected paths that max out a limit.
+  int32_t maxedoutmintimeindex;	//!< Earliest period where a selected path without extinction maxes out a limit.
+  tlo_record rec;		//!< Current record.
+} reduce_data;
+
+/**
+ * @brief Main function.
+ *
+ * Usage: tloutreduce [OPTIONS] FILE [FILE ...]
+ */
+int main(const int nargs, const char* args[]);
+
+/**
+ * @brief Maps an input file and its index, if any.
+ *
+ * @param rf: Pointer to the input file, whose name is set.
+ * @return 0 on success, -1 on an error.
+ */
+int open_input(reduce_file* rf);
+
+/**
+ * @brief Assigns the next block of records to a thread.
+ *
+ * Blocks are delimited using the index of the file when it is available, and
+ * by skipping over the records otherwise.
+ *
+ * @param in: Pointer to the shared input.
+ * @param rf: Pointer to the input file of the block.
+ * @param start: Offset of the first record of the block.
+ * @param end: Offset following the last record of the block.
+ * @return true if a block was assigned, false if all the records were
+ * assigned or if an error occurred.
+ */
+bool next_block(reduce_input* in, reduce_file** rf, uint64_t* start, uint64_t* end);
+
+/**
+ * @brief Thread function reducing blocks of records.
+ *
+ * @param arg: Pointer to the thread reduction results.
+ */
+void* reduce_thread(void* arg);
+
+/**
+ * @brief Adds the current record to the reduction results of a thread, if
+ * it passes the path filters.
+ *
+ * @param rd: Pointer to the thread reduction results.
+ */
+void add_record(reduce_data* rd);
+
+/**
+ * @brief Extends the time bins of the reduction results of a thread on both
+ * ends.
+ *
+ * @param rd: Pointer to the thread reduction results.
+ * @param ndiff: Number of bins to add before the first bin.
+ * @param pdiff: Number of bins to add after the last bin.
+ */
+void extend_bins(reduce_data* rd, const uint32_t ndiff, const uint32_t pdiff);
+
+/**
+ * @brief Adds the reduction results of a thread to the results of another
+ * thread.
+ *
+ * @param dst: Pointer to the destination reduction results.
+ * @param src: Pointer to the source reduction results.
+ */
+void merge_data(reduce_data* dst, reduce_data const* src);
+
+/**
+ * @brief Prints the reduction results.
+ *
+ * @param rd: Pointer to the merged reduction results.
+ */
+void print_results(reduce_data* rd);
+
+/**
+ * @brief Frees the memory used by the reduction results of a thread.
+ *
+ * @param rd: Pointer to the thread reduction results.
+ */
+void free_data(reduce_data* rd);